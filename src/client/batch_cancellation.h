@@ -0,0 +1,85 @@
+#pragma once
+
+#include "integration_methods/cancellation_token.h"
+#include "messages.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * @file batch_cancellation.h
+ * @brief Модуль флагов отмены для одного пакета задач
+ */
+
+/**
+ * @class BatchCancellation
+ * @brief Хранит отдельный флаг отмены для каждого задания в пакете
+ *
+ * Набор заданий фиксируется при создании, поэтому отмена и чтение флагов
+ * из разных потоков не требуют блокировок. Флаги относятся только к этому
+ * пакету: пакеты того же задания, полученные позже, отмена не затрагивает
+ */
+class BatchCancellation
+{
+public:
+    /**
+     * @brief Конструктор
+     * @param tasks Задачи пакета
+     */
+    explicit BatchCancellation(const std::vector<Task> &tasks)
+    {
+        for (const auto &task : tasks)
+        {
+            if (tokens_.find(task.job_id) == tokens_.end())
+            {
+                tokens_.emplace(task.job_id, std::make_unique<CancellationToken>());
+            }
+        }
+    }
+
+    // Запрет копирования
+    BatchCancellation(const BatchCancellation &) = delete;
+    BatchCancellation &operator=(const BatchCancellation &) = delete;
+
+    /**
+     * @brief Прерывает задачи одного задания
+     * @param job_id ID задания
+     * @return true, если в пакете есть задачи этого задания
+     */
+    bool cancel_job(uint64_t job_id)
+    {
+        auto it = tokens_.find(job_id);
+        if (it == tokens_.end())
+        {
+            return false;
+        }
+        it->second->cancel();
+        return true;
+    }
+
+    /**
+     * @brief Прерывает все задачи пакета
+     */
+    void cancel_all()
+    {
+        for (auto &[job_id, token] : tokens_)
+        {
+            token->cancel();
+        }
+    }
+
+    /**
+     * @brief Геттер флага отмены задания
+     * @param job_id ID задания
+     * @return Флаг отмены (неотменяемый, если задания нет в пакете)
+     */
+    const CancellationToken &token_for(uint64_t job_id) const
+    {
+        auto it = tokens_.find(job_id);
+        return it != tokens_.end() ? *it->second : CancellationToken::none();
+    }
+
+private:
+    // Флаги отмены: job_id -> флаг
+    std::map<uint64_t, std::unique_ptr<CancellationToken>> tokens_;
+};
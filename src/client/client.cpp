@@ -2,14 +2,17 @@
 #include "about.h"
 #include "utils.h"
 #include "logger.h"
+#include "protocol.h"
 #include "integration_methods/trapezoidal_rule.h"
 #include "integration_methods/simpsons_rule.h"
 #include <chrono>
+#include <random>
 #include <stdexcept>
 
 Client::Client(const std::string &server_address,
                uint16_t server_port)
-    : client_id_(0),
+    : client_version_(CLIENT_VERSION),
+      client_id_(0),
       system_info_(),
       network_manager_(nullptr),
       integrator_(nullptr),
@@ -26,7 +29,7 @@ Client::Client(const std::string &server_address,
     LOG_INFO("System info collected: {} cores, {} MB RAM",
              system_info_.cpu_cores, system_info_.total_ram_mb);
 
-    // Создаём интегратор с методом трапеций по умолчанию
+    // Метод задаёт сервер для каждой задачи, метод Симпсона - для задач без метода
     auto strategy = std::make_unique<SimpsonsRule>();
     integrator_ = std::make_shared<Integrator>(std::move(strategy));
     LOG_INFO("Integration method: {}", integrator_->get_current_method());
@@ -37,6 +40,10 @@ Client::Client(const std::string &server_address,
     // Создаём worker pool
     worker_pool_ = std::make_unique<WorkerPool>(system_info_.cpu_cores, integrator_);
 
+    // Обмен задачами с другими клиентами
+    peer_exchange_ = std::make_unique<PeerExchange>([this](uint64_t thief_id)
+                                                    { return give_away_tasks(thief_id); });
+
     LOG_INFO("Client initialized successfully");
 }
 
@@ -57,65 +64,115 @@ void Client::run()
     try
     {
         // 1. Подключение к серверу
-        LOG_INFO("=== STEP 1: Connecting to server ===");
-        network_manager_->connect();
-
-        // 2. Handshake
-        LOG_INFO("=== STEP 2: Performing handshake ===");
-        HandshakeResponse handshake = network_manager_->perform_handshake(
-            client_version_,
-            system_info_);
-
-        client_id_ = handshake.assigned_client_id;
-        LOG_INFO("Assigned client ID: {}", client_id_);
-
-        // 3. Получение задач
-        LOG_INFO("=== STEP 3: Waiting for tasks ===");
-        TaskBatch task_batch = network_manager_->receive_tasks();
-        LOG_INFO("Received {} tasks", task_batch.tasks.size());
-
-        if (task_batch.tasks.empty())
+        // Порт для запросов кражи работы сообщается серверу при handshake
+        uint16_t peer_port = 0;
+        try
         {
-            LOG_WARN("No tasks received, exiting");
-            return;
+            peer_port = peer_exchange_->start();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_WARN("Work stealing disabled: {}", e.what());
         }
 
-        // 4. Выполнение задач
-        LOG_INFO("=== STEP 4: Executing tasks ===");
-        auto start_time = std::chrono::high_resolution_clock::now();
-
-        std::vector<Result> results = execute_tasks(task_batch.tasks);
+        // 2. Handshake: перегруженный подключениями сервер просит повторить позже
+        ProtocolCapabilities capabilities = protocol::local_capabilities();
+        capabilities.kernels = integrator_->get_supported_kernels();
+        capabilities.integrands = integrator_->get_supported_integrands();
+        capabilities.reduction_modes = integrator_->get_supported_reductions();
 
-        auto end_time = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> elapsed = end_time - start_time;
+        HandshakeResponse handshake;
+        std::mt19937 random(std::random_device{}());
+        for (size_t attempt = 1;; ++attempt)
+        {
+            LOG_INFO("=== STEP 1: Connecting to server ===");
+            network_manager_->connect();
 
-        LOG_INFO("All tasks completed in {:.3f} seconds", elapsed.count());
+            LOG_INFO("=== STEP 2: Performing handshake ===");
+            handshake = network_manager_->perform_handshake(
+                client_version_,
+                system_info_,
+                integrator_->get_current_method(),
+                peer_port,
+                capabilities);
+            if (handshake.accepted)
+            {
+                break;
+            }
 
-        // 5. Отправка результатов
-        LOG_INFO("=== STEP 5: Sending results ===");
-        ResultBatch result_batch;
-        result_batch.client_id = client_id_;
-        result_batch.results = results;
-        result_batch.total_time_seconds = elapsed.count();
+            network_manager_->disconnect();
+            if (attempt >= MAX_HANDSHAKE_ATTEMPTS)
+            {
+                throw std::runtime_error("Server is still busy after " + std::to_string(attempt) + " attempts");
+            }
 
-        network_manager_->send_results(result_batch);
-        LOG_INFO("Results sent successfully");
+            // Случайная добавка разносит повторные подключения клиентов во времени
+            std::uniform_int_distribution<uint32_t> jitter(0, handshake.retry_after_ms / 2);
+            std::chrono::milliseconds delay(handshake.retry_after_ms + jitter(random));
+            LOG_INFO("Retrying handshake in {} ms (attempt {})", delay.count(), attempt + 1);
+            std::this_thread::sleep_for(delay);
+        }
 
-        // 6. Ожидание команды STOP_WORK
-        LOG_INFO("=== STEP 6: Waiting for STOP_WORK command ===");
-        Command cmd = network_manager_->receive_command();
+        client_id_ = handshake.assigned_client_id;
+        protocol_ = handshake.protocol;
+        LOG_INFO("Assigned client ID: {}", client_id_);
 
-        if (cmd.type == CommandType::STOP_WORK)
+        // 3. Обработка заданий: клиент остаётся подключенным между заданиями
+        LOG_INFO("=== STEP 3: Waiting for commands ===");
+        executor_thread_ = std::thread(&Client::executor_loop, this);
+        if (protocol::has_feature(protocol_, CAP_WORK_STEALING))
         {
-            LOG_INFO("Received STOP_WORK command: {}", cmd.message);
+            stealer_thread_ = std::thread(&Client::stealer_loop, this);
         }
         else
         {
-            LOG_WARN("Unexpected command received: {}", static_cast<int>(cmd.type));
+            LOG_INFO("Work stealing is not supported by the server");
+            peer_exchange_->stop();
+        }
+
+        while (true)
+        {
+            Command cmd = network_manager_->receive_command();
+
+            if (cmd.type == CommandType::START_WORK)
+            {
+                LOG_INFO("Received START_WORK command: {}", cmd.message);
+                enqueue_batch(network_manager_->receive_tasks());
+            }
+            else if (cmd.type == CommandType::CANCEL_JOB)
+            {
+                LOG_INFO("Received CANCEL_JOB command: job {}", cmd.message);
+                cancel_job(std::stoull(cmd.message));
+            }
+            else if (cmd.type == CommandType::SET_WORKERS)
+            {
+                // Машину делят несколько клиентов: сервер выделил этому клиенту часть ядер
+                LOG_INFO("Received SET_WORKERS command: {} threads", cmd.message);
+                worker_pool_->set_num_threads(static_cast<uint32_t>(std::stoul(cmd.message)));
+            }
+            else if (cmd.type == CommandType::PEERS)
+            {
+                peer_exchange_->set_peers(PeerExchange::parse_peers(cmd.message, client_id_));
+            }
+            else if (cmd.type == CommandType::STOP_WORK)
+            {
+                LOG_INFO("Received STOP_WORK command: {}", cmd.message);
+                break;
+            }
+            else if (cmd.type == CommandType::PING)
+            {
+                LOG_DEBUG("Received PING");
+            }
+            else
+            {
+                LOG_WARN("Unexpected command received: {}", static_cast<int>(cmd.type));
+            }
         }
 
-        // 7. Завершение
-        LOG_INFO("=== STEP 7: Shutting down ===");
+        // 4. Завершение
+        LOG_INFO("=== STEP 4: Shutting down ===");
+        stop_executor(false);
+        peer_exchange_->stop();
         network_manager_->disconnect();
 
         LOG_INFO("Client finished successfully");
@@ -123,6 +180,9 @@ void Client::run()
     catch (const std::exception &e)
     {
         LOG_ERROR("Client error: {}", e.what());
+        // Отданные задачи не ждём: разрыв соединений с ворами вернёт их исполнителю
+        peer_exchange_->stop();
+        stop_executor(true);
         throw;
     }
 }
@@ -138,16 +198,270 @@ void Client::set_integration_strategy(std::unique_ptr<IIntegrationStrategy> stra
     LOG_INFO("Integration strategy changed to: {}", integrator_->get_current_method());
 }
 
+void Client::enqueue_batch(TaskBatch batch)
+{
+    LOG_INFO("Received {} tasks", batch.tasks.size());
+
+    PendingBatch pending;
+    pending.cancellation = std::make_shared<BatchCancellation>(batch.tasks);
+    pending.batch = std::move(batch);
+
+    {
+        std::lock_guard<std::mutex> lock(batches_mutex_);
+        batches_.push_back(std::move(pending));
+    }
+    // Очередь ждут исполнитель и поток кражи
+    batches_cv_.notify_all();
+}
+
+void Client::cancel_job(uint64_t job_id)
+{
+    // Прерываются только пакеты, полученные до команды: последующие пакеты
+    // того же задания сервер отправил уже после отмены
+    size_t cancelled = 0;
+    {
+        std::lock_guard<std::mutex> lock(batches_mutex_);
+        for (auto &pending : batches_)
+        {
+            if (pending.cancellation->cancel_job(job_id))
+            {
+                cancelled++;
+            }
+        }
+    }
+
+    LOG_INFO("Job {}: {} batch(es) interrupted", job_id, cancelled);
+}
+
+void Client::executor_loop()
+{
+    while (true)
+    {
+        PendingBatch pending;
+        {
+            std::unique_lock<std::mutex> lock(batches_mutex_);
+            batches_cv_.wait(lock, [this]
+                             { return executor_stopping_ || !batches_.empty(); });
+            if (batches_.empty())
+            {
+                break;
+            }
+
+            // Пакет остаётся в очереди до отправки результатов, чтобы его можно было прервать.
+            // Задачи у первого пакета не забирают, поэтому копия остаётся актуальной
+            pending = batches_.front();
+        }
+
+        try
+        {
+            // Выполнение задач
+            auto start_time = std::chrono::high_resolution_clock::now();
+
+            std::vector<Result> results = execute_tasks(pending.batch.tasks, pending.cancellation.get());
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed = end_time - start_time;
+
+            LOG_INFO("All tasks completed in {:.3f} seconds", elapsed.count());
+
+            ResultBatch result_batch;
+            result_batch.client_id = client_id_;
+            result_batch.telemetry = telemetry_collector_.collect(pending.batch.tasks,
+                                                                  results,
+                                                                  elapsed.count(),
+                                                                  worker_pool_->get_num_threads());
+            // Скорость сервер учитывает по методу, которым выполнен пакет
+            result_batch.telemetry.method = integrator_->get_method_name(
+                pending.batch.tasks.empty() ? 0 : pending.batch.tasks.front().kernel);
+            result_batch.total_time_seconds = elapsed.count();
+
+            if (pending.stolen)
+            {
+                // Результаты украденных задач отправит серверу их владелец
+                result_batch.results = std::move(results);
+                try
+                {
+                    PeerExchange::return_results(*pending.stolen, result_batch);
+                }
+                catch (const std::exception &e)
+                {
+                    LOG_WARN("Failed to return results to client {}: {}", pending.stolen->owner_id, e.what());
+                }
+            }
+            else
+            {
+                collect_given_away(pending, results);
+                result_batch.results = std::move(results);
+
+                // Основной поток только читает из сокета, поэтому отправка не требует синхронизации
+                network_manager_->send_results(result_batch);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            // Основной поток обнаружит разрыв соединения при чтении следующей команды
+            LOG_ERROR("Executor error: {}", e.what());
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(batches_mutex_);
+            batches_.pop_front();
+        }
+        batches_cv_.notify_all();
+    }
+}
+
+void Client::stealer_loop()
+{
+    auto backoff = STEAL_POLL_INTERVAL;
+    size_t failed_attempts = MAX_FAILED_STEALS;
+
+    std::unique_lock<std::mutex> lock(batches_mutex_);
+    while (!executor_stopping_)
+    {
+        if (!batches_.empty())
+        {
+            // Появилась работа: после её выполнения снова можно красть
+            backoff = STEAL_POLL_INTERVAL;
+            failed_attempts = 0;
+        }
+
+        // Крадём, только когда исполнителю нечего делать. Между заданиями попытки
+        // прекращаются, чтобы простаивающие клиенты не опрашивали друг друга
+        if (!batches_.empty() || failed_attempts >= MAX_FAILED_STEALS || !peer_exchange_->has_peers())
+        {
+            batches_cv_.wait_for(lock, STEAL_POLL_INTERVAL);
+            continue;
+        }
+
+        lock.unlock();
+        auto work = peer_exchange_->try_steal(client_id_);
+        lock.lock();
+
+        if (!work)
+        {
+            // Красть не у кого: попытки становятся реже, пока работы нет
+            failed_attempts++;
+            batches_cv_.wait_for(lock, backoff);
+            backoff = std::min(backoff * 2, MAX_STEAL_BACKOFF);
+            continue;
+        }
+
+        PendingBatch pending;
+        pending.cancellation = std::make_shared<BatchCancellation>(work->batch.tasks);
+        pending.batch = work->batch;
+        pending.stolen = std::make_shared<StolenWork>(std::move(*work));
+        batches_.push_back(std::move(pending));
+        batches_cv_.notify_all();
+    }
+}
+
+StealOffer Client::give_away_tasks(uint64_t thief_id)
+{
+    StealOffer offer;
+
+    std::lock_guard<std::mutex> lock(batches_mutex_);
+    if (executor_stopping_)
+    {
+        return offer;
+    }
+
+    // Последний пакет очереди начнётся позже всех
+    for (size_t i = batches_.size(); i-- > 1;)
+    {
+        PendingBatch &pending = batches_[i];
+        if (pending.stolen || !pending.given_away.empty() || pending.batch.tasks.empty())
+        {
+            continue;
+        }
+
+        auto &tasks = pending.batch.tasks;
+        size_t count = (tasks.size() + 1) / 2;
+        auto split = tasks.end() - static_cast<std::ptrdiff_t>(count);
+
+        offer.batch.tasks.assign(split, tasks.end());
+        tasks.erase(split, tasks.end());
+
+        pending.given_away = offer.batch.tasks;
+        pending.given_away_results = offer.results.get_future().share();
+
+        LOG_INFO("Client {} takes {} of {} queued tasks", thief_id, count, count + tasks.size());
+        break;
+    }
+
+    return offer;
+}
+
+void Client::collect_given_away(const PendingBatch &pending, std::vector<Result> &results)
+{
+    if (pending.given_away.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        if (pending.given_away_results.wait_for(GIVEN_AWAY_TIMEOUT) != std::future_status::ready)
+        {
+            throw std::runtime_error("timed out waiting for results");
+        }
+
+        const ResultBatch &returned = pending.given_away_results.get();
+        if (returned.results.size() != pending.given_away.size())
+        {
+            throw std::runtime_error("results do not match the given tasks");
+        }
+
+        results.insert(results.end(), returned.results.begin(), returned.results.end());
+        return;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN("Given away tasks are executed locally: {}", e.what());
+    }
+
+    auto own = execute_tasks(pending.given_away, pending.cancellation.get());
+    results.insert(results.end(), own.begin(), own.end());
+}
+
+void Client::stop_executor(bool cancel)
+{
+    {
+        std::lock_guard<std::mutex> lock(batches_mutex_);
+        executor_stopping_ = true;
+        if (cancel)
+        {
+            for (auto &pending : batches_)
+            {
+                pending.cancellation->cancel_all();
+            }
+        }
+    }
+    batches_cv_.notify_all();
+
+    if (stealer_thread_.joinable())
+    {
+        stealer_thread_.join();
+    }
+
+    if (executor_thread_.joinable())
+    {
+        executor_thread_.join();
+    }
+}
+
 SystemInfo Client::collect_system_info()
 {
     return sys_utils::collect_system_info();
 }
 
-std::vector<Result> Client::execute_tasks(const std::vector<Task> &tasks)
+std::vector<Result> Client::execute_tasks(const std::vector<Task> &tasks,
+                                          const BatchCancellation *cancellation)
 {
     LOG_INFO("Executing {} tasks using {} threads...",
-             tasks.size(), system_info_.cpu_cores);
+             tasks.size(), worker_pool_->get_num_threads());
 
     // Используем worker pool для параллельного выполнения
-    return worker_pool_->execute_tasks_parallel(tasks);
+    return worker_pool_->execute_tasks_parallel(tasks, cancellation);
 }
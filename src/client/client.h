@@ -4,10 +4,19 @@
 #include "task_executor.h"
 #include "worker_pool.h"
 #include "integrator.h"
+#include "batch_cancellation.h"
+#include "telemetry_collector.h"
+#include "peer_exchange.h"
 #include "messages.h"
 #include "systeminfo.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 /**
  * @file client.h
@@ -19,6 +28,14 @@
  * @brief Главный контроллер клиентского приложения
  * 
  * Координирует работу всех компонентов: сеть, вычисления, многопоточность.
+ *
+ * Команды сервера читаются в основном потоке даже во время вычислений,
+ * а пакеты задач выполняются по очереди отдельным потоком-исполнителем.
+ * Поэтому команда CANCEL_JOB прерывает уже выполняющиеся задачи.
+ *
+ * Когда очередь исполнителя пуста, клиент крадёт половину ещё не начатых
+ * задач у других клиентов (см. PeerExchange) и сам отдаёт им задачи из
+ * пакетов, ожидающих в очереди
  */
 class Client
 {
@@ -48,11 +65,12 @@ public:
      * Выполняет полный цикл работы:
      * 1. Подключение к серверу
      * 2. Handshake
-     * 3. Получение задач
-     * 4. Выполнение задач
-     * 5. Отправка результатов
-     * 6. Ожидание команды STOP_WORK
-     * 7. Завершение
+     * 3. Обработка команд сервера до команды STOP_WORK:
+     *    на каждую START_WORK - получение пакета задач и постановка его в очередь исполнителя,
+     *    на CANCEL_JOB - прерывание задач задания во всех полученных пакетах,
+     *    на SET_WORKERS - изменение числа рабочих потоков,
+     *    на PEERS - обновление списка клиентов для кражи работы
+     * 4. Завершение
      * 
      * @throws std::runtime_error при критических ошибках
      */
@@ -71,17 +89,84 @@ private:
      */
     SystemInfo collect_system_info();
 
+    /**
+     * @struct PendingBatch
+     * @brief Полученный пакет задач и его флаги отмены
+     */
+    struct PendingBatch
+    {
+        TaskBatch batch;
+        std::shared_ptr<BatchCancellation> cancellation;
+        // Задачи пакета, отданные другому клиенту, и их результаты
+        std::vector<Task> given_away;
+        std::shared_future<ResultBatch> given_away_results;
+        // Пакет украден у другого клиента: результаты возвращаются ему, а не серверу
+        std::shared_ptr<StolenWork> stolen;
+    };
+
+    /**
+     * @brief Ставит пакет задач в очередь исполнителя
+     * @param batch Пакет задач
+     */
+    void enqueue_batch(TaskBatch batch);
+
+    /**
+     * @brief Прерывает задачи задания во всех полученных пакетах
+     * @param job_id ID задания
+     */
+    void cancel_job(uint64_t job_id);
+
+    /**
+     * @brief Функция потока-исполнителя: выполняет пакеты по порядку и отправляет результаты
+     */
+    void executor_loop();
+
+    /**
+     * @brief Функция потока кражи: пока очередь исполнителя пуста, крадёт задачи у других клиентов
+     */
+    void stealer_loop();
+
+    /**
+     * @brief Отдаёт вору половину задач последнего ожидающего пакета
+     *
+     * Выполняющийся пакет, украденные пакеты и пакеты, у которых уже забрали задачи, не трогаются
+     *
+     * @param thief_id ID клиента-вора
+     * @return Отданные задачи (пустой пакет, если отдать нечего)
+     */
+    StealOffer give_away_tasks(uint64_t thief_id);
+
+    /**
+     * @brief Дополняет результаты пакета результатами отданных задач
+     *
+     * Если вор не вернул результаты, задачи выполняются самостоятельно
+     *
+     * @param pending Пакет
+     * @param results Результаты собственных задач пакета
+     */
+    void collect_given_away(const PendingBatch &pending, std::vector<Result> &results);
+
+    /**
+     * @brief Останавливает потоки исполнителя и кражи
+     * @param cancel Прервать невыполненные задачи
+     */
+    void stop_executor(bool cancel);
+
     /**
      * @brief Выполняет задачи параллельно
      * @param tasks Вектор задач
+     * @param cancellation Флаги отмены заданий пакета
      * @return Вектор результатов
      */
-    std::vector<Result> execute_tasks(const std::vector<Task> &tasks);
+    std::vector<Result> execute_tasks(const std::vector<Task> &tasks,
+                                      const BatchCancellation *cancellation);
 
     // Версия клиента
     std::string client_version_;
     // ID клиента, присвоенный сервером
     uint64_t client_id_;
+    // Параметры протокола, согласованные при handshake
+    ProtocolSettings protocol_;
     // Информация о системе
     SystemInfo system_info_;
     
@@ -93,4 +178,31 @@ private:
     std::unique_ptr<TaskExecutor> task_executor_;
     // Пул потоков для параллельных вычислений
     std::unique_ptr<WorkerPool> worker_pool_;
+
+    // Очередь пакетов исполнителя (первый - выполняется)
+    std::deque<PendingBatch> batches_;
+    // Защищает batches_ и executor_stopping_
+    std::mutex batches_mutex_;
+    std::condition_variable batches_cv_;
+    // Исполнитель должен завершиться, когда очередь опустеет
+    bool executor_stopping_ = false;
+    // Поток-исполнитель
+    std::thread executor_thread_;
+    // Сбор производительности для отчётов серверу (только в потоке-исполнителе)
+    TelemetryCollector telemetry_collector_;
+    // Обмен задачами с другими клиентами
+    std::unique_ptr<PeerExchange> peer_exchange_;
+    // Поток кражи задач
+    std::thread stealer_thread_;
+
+    // Интервал проверки очереди потоком кражи
+    static constexpr std::chrono::milliseconds STEAL_POLL_INTERVAL{50};
+    // Наибольшая пауза между неудачными попытками кражи
+    static constexpr std::chrono::milliseconds MAX_STEAL_BACKOFF{1000};
+    // Число неудачных попыток подряд, после которого кража ждёт новой работы от сервера
+    static constexpr size_t MAX_FAILED_STEALS = 6;
+    // Сколько раз повторять handshake, если сервер перегружен подключениями
+    static constexpr size_t MAX_HANDSHAKE_ATTEMPTS = 20;
+    // Сколько ждать результатов отданных задач, прежде чем выполнить их самому
+    static constexpr std::chrono::seconds GIVEN_AWAY_TIMEOUT{60};
 };
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "messages.h"
+
+/**
+ * @file accumulators.h
+ * @brief Накопители сумм узлов для методов интегрирования
+ *
+ * При 10^10 слагаемых обычная сумма в double теряет несколько знаков.
+ * Методы интегрирования параметризуются накопителем, который выбирается
+ * для задания (Task::reduction):
+ * - PlainAccumulator - обычная сумма, как раньше
+ * - CompensatedAccumulator - ошибки округления каждого сложения копятся
+ *   отдельно (TwoSum), результат - double
+ * - DoubleDoubleAccumulator - сумма хранится парой hi + lo (около 32 знаков),
+ *   результат передаётся серверу обеими частями
+ *
+ * Компенсированные накопители ведут LANES независимых сумм без ветвлений,
+ * поэтому цикл по блоку векторизуется компилятором
+ *
+ * @note Требуют строгой арифметики IEEE 754 (без -ffast-math)
+ */
+
+/**
+ * @struct DoubleDouble
+ * @brief Число hi + lo, где |lo| не больше половины младшего разряда hi
+ */
+struct DoubleDouble
+{
+    double hi = 0.0;
+    double lo = 0.0;
+};
+
+namespace accumulation
+{
+    /**
+     * @brief Сумма a + b и её точная ошибка округления (TwoSum, без ветвлений)
+     */
+    inline DoubleDouble two_sum(double a, double b)
+    {
+        double s = a + b;
+        double bb = s - a;
+        return {s, (a - (s - bb)) + (b - bb)};
+    }
+
+    /**
+     * @brief Нормализует пару, у которой |hi| >= |lo|
+     */
+    inline DoubleDouble fast_two_sum(double hi, double lo)
+    {
+        double s = hi + lo;
+        return {s, lo - (s - hi)};
+    }
+
+    /**
+     * @brief Произведение a * b и его точная ошибка округления
+     */
+    inline DoubleDouble two_prod(double a, double b)
+    {
+        double p = a * b;
+        return {p, std::fma(a, b, -p)};
+    }
+
+    /**
+     * @brief Частное a / b с точностью double-double
+     */
+    inline DoubleDouble quotient(double a, double b)
+    {
+        double q = a / b;
+        // Остаток a - q * b вычисляется fma точно
+        return fast_two_sum(q, std::fma(-q, b, a) / b);
+    }
+
+    /**
+     * @brief Произведение чисел double-double
+     */
+    inline DoubleDouble multiply(const DoubleDouble &a, const DoubleDouble &b)
+    {
+        DoubleDouble p = two_prod(a.hi, b.hi);
+        return fast_two_sum(p.hi, p.lo + (a.hi * b.lo + a.lo * b.hi));
+    }
+} // namespace accumulation
+
+/**
+ * @class PlainAccumulator
+ * @brief Обычная сумма в double (результаты совпадают с прежними побитово)
+ */
+class PlainAccumulator
+{
+public:
+    static constexpr uint32_t REDUCTION = REDUCTION_PLAIN;
+
+    void add(double x)
+    {
+        sum_ += x;
+    }
+
+    void add_block(const double *x, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            sum_ += x[i];
+        }
+    }
+
+    /**
+     * @brief Сумма, умноженная на factor / divisor
+     */
+    DoubleDouble scaled(double factor, double divisor) const
+    {
+        return {sum_ * factor / divisor, 0.0};
+    }
+
+private:
+    double sum_ = 0.0;
+};
+
+/**
+ * @class CompensatedAccumulator
+ * @brief Компенсированная сумма: ошибки округления сложений копятся отдельно
+ *
+ * Погрешность не растёт с числом слагаемых (порядка одного округления
+ * результата плюс n * eps^2 от суммы ошибок)
+ */
+class CompensatedAccumulator
+{
+public:
+    static constexpr uint32_t REDUCTION = REDUCTION_COMPENSATED;
+    // Количество независимых сумм
+    static constexpr size_t LANES = 4;
+
+    void add(double x)
+    {
+        step(0, x);
+    }
+
+    void add_block(const double *x, size_t count)
+    {
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            for (size_t lane = 0; lane < LANES; ++lane)
+            {
+                step(lane, x[i + lane]);
+            }
+        }
+        for (; i < count; ++i)
+        {
+            step(0, x[i]);
+        }
+    }
+
+    DoubleDouble scaled(double factor, double divisor) const
+    {
+        return {total() * factor / divisor, 0.0};
+    }
+
+private:
+    /**
+     * @brief Сумма всех полос, округлённая один раз
+     */
+    double total() const
+    {
+        DoubleDouble sum;
+        double errors = 0.0;
+        for (size_t lane = 0; lane < LANES; ++lane)
+        {
+            sum = accumulation::two_sum(sum.hi, sums_[lane]);
+            errors += sum.lo + errors_[lane];
+        }
+        return sum.hi + errors;
+    }
+
+    void step(size_t lane, double x)
+    {
+        double s = sums_[lane] + x;
+        double bb = s - sums_[lane];
+        errors_[lane] += (sums_[lane] - (s - bb)) + (x - bb);
+        sums_[lane] = s;
+    }
+
+    // Суммы полос
+    double sums_[LANES] = {};
+    // Накопленные ошибки округления полос
+    double errors_[LANES] = {};
+};
+
+/**
+ * @class DoubleDoubleAccumulator
+ * @brief Сумма double-double: после каждого сложения пара hi + lo нормализуется
+ *
+ * Масштабирование (например, h / 3 в методе Симпсона) тоже выполняется
+ * в double-double, и результат передаётся серверу обеими частями
+ */
+class DoubleDoubleAccumulator
+{
+public:
+    static constexpr uint32_t REDUCTION = REDUCTION_DOUBLE_DOUBLE;
+    // Количество независимых сумм
+    static constexpr size_t LANES = 4;
+
+    void add(double x)
+    {
+        step(0, x);
+    }
+
+    void add_block(const double *x, size_t count)
+    {
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            for (size_t lane = 0; lane < LANES; ++lane)
+            {
+                step(lane, x[i + lane]);
+            }
+        }
+        for (; i < count; ++i)
+        {
+            step(0, x[i]);
+        }
+    }
+
+    DoubleDouble scaled(double factor, double divisor) const
+    {
+        DoubleDouble sum;
+        for (size_t lane = 0; lane < LANES; ++lane)
+        {
+            DoubleDouble s = accumulation::two_sum(sum.hi, hi_[lane]);
+            sum = accumulation::fast_two_sum(s.hi, s.lo + sum.lo + lo_[lane]);
+        }
+        return accumulation::multiply(sum, accumulation::quotient(factor, divisor));
+    }
+
+private:
+    void step(size_t lane, double x)
+    {
+        double s = hi_[lane] + x;
+        double bb = s - hi_[lane];
+        double e = (hi_[lane] - (s - bb)) + (x - bb) + lo_[lane];
+        hi_[lane] = s + e;
+        lo_[lane] = e - (hi_[lane] - s);
+    }
+
+    // Старшие части сумм полос
+    double hi_[LANES] = {};
+    // Младшие части сумм полос
+    double lo_[LANES] = {};
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * @file cancellation_token.h
+ * @brief Флаг кооперативной отмены вычислений
+ */
+
+/**
+ * @class CancellationToken
+ * @brief Флаг, который методы интегрирования проверяют в контрольных точках
+ *
+ * Отмена кооперативная: вычисление не прерывается принудительно, а само
+ * останавливается в ближайшей контрольной точке и возвращает результат
+ * для уже пройденной части отрезка
+ */
+class CancellationToken
+{
+public:
+    CancellationToken() = default;
+
+    // Запрет копирования
+    CancellationToken(const CancellationToken &) = delete;
+    CancellationToken &operator=(const CancellationToken &) = delete;
+
+    /**
+     * @brief Запрашивает отмену (потокобезопасно)
+     */
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Проверяет, запрошена ли отмена
+     * @return true, если вычисление нужно остановить
+     */
+    bool is_cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Флаг, который никогда не будет выставлен
+     * @return Ссылка на общий неотменяемый флаг
+     */
+    static const CancellationToken &none()
+    {
+        static const CancellationToken token;
+        return token;
+    }
+
+private:
+    // Флаг отмены
+    std::atomic<bool> cancelled_{false};
+};
@@ -2,19 +2,41 @@
 
 #include <string>
 #include <cmath>
+#include <cstdint>
 #include <stdexcept>
+#include "accumulators.h"
+#include "cancellation_token.h"
+#include "integrands.h"
 
 /**
  * @file integration_strategy.h
  * @brief Интерфейс стратегии численного интегрирования
  */
 
+/**
+ * @struct PartialIntegral
+ * @brief Результат интегрирования, которое могло быть остановлено досрочно
+ */
+struct PartialIntegral
+{
+    // Значение интеграла на отрезке [lower, end]
+    double value = 0.0;
+    // Правая граница фактически пройденной части отрезка
+    double end = 0.0;
+    // true, если пройден весь отрезок
+    bool complete = false;
+    // Младшая часть значения (для накопителя double-double: интеграл равен value + value_low)
+    double value_low = 0.0;
+};
+
 /**
  * @class IIntegrationStrategy
- * @brief Интерфейс для стратегий численного интегрирования функции 1/ln(x)
+ * @brief Интерфейс для стратегий численного интегрирования
  *
  * Данный интерфейс реализует паттерн Strategy для легкой подмены
- * различных методы численного интегрирования (прямоугольникой, трапеций, Симпсона и т.д.)
+ * различных методы численного интегрирования (прямоугольникой, трапеций, Симпсона и т.д.).
+ * Каждая стратегия интегрирует одну функцию из реестра integrands.h,
+ * по умолчанию - 1/ln(x)
  */
 class IIntegrationStrategy
 {
@@ -22,7 +44,7 @@ public:
     virtual ~IIntegrationStrategy() = default;
 
     /**
-     * @brief Вычисляет определённый интеграл функции 1/ln(x) на заданном отрезке
+     * @brief Вычисляет определённый интеграл функции на заданном отрезке
      *
      * @param lower Нижний предел интегрирования
      * @param upper Верхний предел интегрирования
@@ -34,68 +56,119 @@ public:
      */
     virtual double integrate(double lower, double upper, double step) const = 0;
 
+    /**
+     * @brief Вычисляет интеграл с контрольными точками отмены
+     *
+     * Если отмена запрошена, вычисление останавливается в ближайшей
+     * контрольной точке и возвращает интеграл по пройденной части [lower, end].
+     * Оставшийся отрезок [end, upper] можно досчитать отдельно с тем же шагом
+     *
+     * @param lower Нижний предел интегрирования
+     * @param upper Верхний предел интегрирования
+     * @param step Шаг интегрирования
+     * @param token Флаг отмены
+     * @return Значение интеграла и пройденная часть отрезка
+     *
+     * @throws std::invalid_argument если параметры некорректны
+     * @throws std::runtime_error если возникла ошибка при вычислении
+     */
+    virtual PartialIntegral integrate_partial(double lower, double upper, double step,
+                                              const CancellationToken &token) const = 0;
+
+    /**
+     * @brief Вычисляет интеграл функции с заданными параметрами
+     *
+     * @param lower Нижний предел интегрирования
+     * @param upper Верхний предел интегрирования
+     * @param step Шаг интегрирования
+     * @param integrand Функция задачи: параметр (k для 1/ln(x)^k, s для x^s/ln(x)) или байткод выражения
+     * @param token Флаг отмены
+     * @return Значение интеграла и пройденная часть отрезка
+     *
+     * @throws std::invalid_argument если параметры некорректны
+     */
+    virtual PartialIntegral integrate_partial(double lower, double upper, double step, const IntegrandSpec &integrand,
+                                              const CancellationToken &token) const = 0;
+
     /**
      * @brief Возвращает название метода интегрирования
      * @return Строка с названием метода
      */
     virtual std::string get_method_name() const = 0;
+
+    /**
+     * @brief Возвращает ID интегрируемой функции
+     * @return Значение IntegrandId
+     */
+    virtual uint32_t get_integrand() const = 0;
 };
 
 /**
  * @class IntegrationStrategyBase
- * @brief Базовая реализация стратегии с общими методами валидации и вычисления функции
+ * @brief Базовая реализация стратегии с общими методами валидации
+ *
+ * Предоставляет общую логику для интегрирования функции Integrand:
+ * - Валидация параметров и области определения функции. Она проверяется
+ *   один раз для всего отрезка, поэтому в точках проверок нет
+ * - Интегрирование функции с параметрами по умолчанию
  *
- * Предоставляет общую логику для интегрирования функции 1/ln(x):
- * - Валидация параметров
- * - Вычисление функции с проверками
- * - Обработка особых случаев
+ * @tparam Integrand Функция из реестра integrands.h
  */
+template <class Integrand>
 class IntegrationStrategyBase : public IIntegrationStrategy
 {
 public:
     virtual ~IntegrationStrategyBase() = default;
 
-protected:
+    using IIntegrationStrategy::integrate_partial;
+
     /**
-     * @brief Вычисляет значение функции 1/ln(x)
-     *
-     * @param x Аргумент функции (должен быть > 0 и != 1)
-     * @return Значение 1/ln(x)
-     *
-     * @throws std::runtime_error если x <= 0 или x слишком близко к 1
+     * @brief Вычисляет интеграл без возможности отмены
+     */
+    double integrate(double lower, double upper, double step) const override
+    {
+        return integrate_partial(lower, upper, step, CancellationToken::none()).value;
+    }
+
+    /**
+     * @brief Вычисляет интеграл функции с параметром по умолчанию
      */
-    static double function(double x)
+    PartialIntegral integrate_partial(double lower, double upper, double step,
+                                      const CancellationToken &token) const override
     {
-        // Проверка 1: x должен быть положительным
-        if (x <= 0.0)
-        {
-            throw std::runtime_error("Function 1/ln(x) is undefined for x <= 0");
-        }
-
-        double ln_x = std::log(x);
-
-        // Проверка 2: ln(x) не должен быть близок к нулю (x близко к 1)
-        constexpr double EPSILON = 1e-10;
-        if (std::abs(ln_x) < EPSILON)
-        {
-            throw std::runtime_error("Function 1/ln(x) is undefined for x too close to 1 ");
-        }
-
-        return 1.0 / ln_x;
+        static const IntegrandSpec default_integrand{Integrand::ID, Integrand::DEFAULT_PARAMETER, {}};
+        return integrate_partial(lower, upper, step, default_integrand, token);
     }
 
+    uint32_t get_integrand() const override
+    {
+        return Integrand::ID;
+    }
+
+protected:
+    // Количество вычислений функции между проверками флага отмены (чётное)
+    static constexpr uint64_t CANCELLATION_CHECK_INTERVAL = 4096;
+    // Минимальное число оставшихся интервалов, при котором остановка имеет смысл
+    static constexpr uint64_t MIN_REMAINING_INTERVALS = 4;
+    // Количество узлов, значения функции в которых вычисляются одним блоком
+    // (делит CANCELLATION_CHECK_INTERVAL)
+    static constexpr uint64_t BLOCK_SIZE = 256;
+
+    static_assert(CANCELLATION_CHECK_INTERVAL % BLOCK_SIZE == 0,
+                  "Cancellation checkpoints must fall on block boundaries");
+
     /**
-     * @brief Валидирует параметры интегрирования для функции 1/ln(x)
+     * @brief Валидирует параметры интегрирования
      *
      * @param lower Нижний предел интегрирования
      * @param upper Верхний предел интегрирования
      * @param step Шаг интегрирования
+     * @param integrand Параметры функции
      *
      * @throws std::invalid_argument если параметры некорректны
      */
-    static void validate_parameters(double lower, double upper, double step)
+    static void validate_parameters(double lower, double upper, double step, const IntegrandSpec &integrand)
     {
-        // ограничения для интегрирования 1/ln(x)
         // true - все хорошо
         bool result = true;
         
@@ -103,12 +176,8 @@ protected:
         // и быть меньше длины интегрируемого интервала
         result &= !(lower >= upper || step <= 0.0 || step >= (upper - lower));
 
-        // Нижний предел должен быть положительным
-        result &= !(lower <= 0.0);
-
-        // Интервал не должен содержать x = 1
-        result &= !(lower < 1.0 && upper > 1.0);
-        result &= !(std::abs(lower - 1.0) < 1e-10 || std::abs(upper - 1.0) < 1e-10);
+        // Функция должна быть определена на всём отрезке
+        result &= Integrand::is_valid_domain(lower, upper, integrand);
 
         if (!result) throw std::invalid_argument("Incorrect parameters");
     }
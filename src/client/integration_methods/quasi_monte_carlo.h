@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cancellation_token.h"
+#include "integrands.h"
+#include "messages.h"
+#include "sobol_sequence.h"
+
+/**
+ * @file quasi_monte_carlo.h
+ * @brief Метод квази-Монте-Карло для многомерных интегралов
+ */
+
+/**
+ * @struct QmcPartial
+ * @brief Суммы значений функции в точках [first, end) последовательности
+ */
+struct QmcPartial
+{
+    // Сумма значений функции
+    double sum = 0.0;
+    // Сумма квадратов значений функции
+    double sum_squares = 0.0;
+    // Номер первой точки, которая не вычислена
+    uint64_t end = 0;
+    // true, если вычислены все точки
+    bool complete = false;
+};
+
+/**
+ * @class BasicQuasiMonteCarlo
+ * @brief Метод квази-Монте-Карло для функции Integrand
+ *
+ * Задача вычисляет суммы значений функции и их квадратов в точках
+ * скремблированной последовательности Соболя с номерами [first, last),
+ * отображённых в область интегрирования. Оценку интеграла (объём области,
+ * умноженный на среднее значение) сервер получает, сложив суммы всех задач
+ * реплики. Точки генерируются и функция вычисляется блоками по BLOCK_SIZE
+ *
+ * @tparam Integrand Функция из реестра integrands.h
+ */
+template <class Integrand>
+class BasicQuasiMonteCarlo
+{
+public:
+    // Количество точек между проверками флага отмены
+    static constexpr uint64_t CANCELLATION_CHECK_INTERVAL = 4096;
+    // Количество точек, генерируемых и вычисляемых одним блоком (делит CANCELLATION_CHECK_INTERVAL)
+    static constexpr uint64_t BLOCK_SIZE = 256;
+
+    static_assert(CANCELLATION_CHECK_INTERVAL % BLOCK_SIZE == 0,
+                  "Cancellation checkpoints must fall on block boundaries");
+
+    /**
+     * @brief Вычисляет суммы значений функции в точках [first, last)
+     *
+     * Флаг отмены проверяется каждые CANCELLATION_CHECK_INTERVAL точек,
+     * при отмене возвращаются суммы по вычисленной части [first, end)
+     *
+     * @param first Номер первой точки
+     * @param last Номер точки, следующей за последней
+     * @param sampling Область и скремблирование
+     * @param integrand Параметры функции
+     * @param token Флаг отмены
+     * @return Суммы и вычисленная часть точек
+     *
+     * @throws std::invalid_argument если параметры некорректны
+     */
+    QmcPartial integrate_partial(uint64_t first, uint64_t last, const QmcSampling &sampling,
+                                 const IntegrandSpec &integrand, const CancellationToken &token) const
+    {
+        if (first >= last || last > QmcSampling::MAX_POINTS || !sampling.is_valid() ||
+            !Integrand::is_valid_box(sampling.lower, sampling.upper, integrand))
+        {
+            throw std::invalid_argument("Incorrect parameters");
+        }
+
+        const SobolSequence sequence(sampling.dimensions(), sampling.seed, sampling.replica);
+        const Integrand function(integrand);
+        const size_t dimensions = sampling.dimensions();
+
+        // Координаты блока по измерениям и значения функции в его точках
+        std::vector<double> points(dimensions * BLOCK_SIZE);
+        std::vector<double> values(BLOCK_SIZE);
+
+        QmcPartial result;
+        for (uint64_t i = first; i < last;)
+        {
+            // Контрольная точка отмены (в том числе до начала вычислений)
+            if ((i - first) % CANCELLATION_CHECK_INTERVAL == 0 && token.is_cancelled())
+            {
+                result.end = i;
+                return result;
+            }
+
+            size_t count = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, last - i));
+            sequence.generate(i, count, points.data(), BLOCK_SIZE);
+
+            // Единичный куб -> область интегрирования
+            for (size_t d = 0; d < dimensions; ++d)
+            {
+                const double lower = sampling.lower[d];
+                const double width = sampling.upper[d] - sampling.lower[d];
+                double *coordinates = points.data() + d * BLOCK_SIZE;
+                for (size_t j = 0; j < count; ++j)
+                {
+                    coordinates[j] = lower + width * coordinates[j];
+                }
+            }
+
+            function.evaluate_points(points.data(), BLOCK_SIZE, values.data(), count);
+
+            // Суммы блока складываются отдельно: ошибка округления растёт медленнее
+            double sum = 0.0;
+            double sum_squares = 0.0;
+            for (size_t j = 0; j < count; ++j)
+            {
+                sum += values[j];
+                sum_squares += values[j] * values[j];
+            }
+            result.sum += sum;
+            result.sum_squares += sum_squares;
+
+            i += count;
+        }
+
+        result.end = last;
+        result.complete = true;
+        return result;
+    }
+
+    /**
+     * @brief Возвращает название метода интегрирования
+     * @return "Quasi-Monte Carlo"
+     */
+    std::string get_method_name() const
+    {
+        return "Quasi-Monte Carlo";
+    }
+};
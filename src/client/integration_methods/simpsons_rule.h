@@ -1,8 +1,9 @@
 #pragma once
 
 #include "integration_strategy.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
-#include <vector>
 
 /**
  * @file simpsons_rule.h
@@ -10,27 +11,48 @@
  */
 
 /**
- * @class SimpsonsRule
- * @brief Метод Симпсона (парабол)
+ * @class BasicSimpsonsRule
+ * @brief Метод Симпсона (парабол) для функции Integrand
+ *
+ * @tparam Integrand Функция из реестра integrands.h
+ * @tparam Accumulator Накопитель суммы узлов из accumulators.h
  */
-class SimpsonsRule : public IntegrationStrategyBase
+template <class Integrand, class Accumulator = PlainAccumulator>
+class BasicSimpsonsRule : public IntegrationStrategyBase<Integrand>
 {
+    using Base = IntegrationStrategyBase<Integrand>;
+
 public:
+    using Base::integrate_partial;
+
     /**
-     * @brief Вычисляет определённый интеграл функции 1/ln(x) методом Симпсона
+     * @brief Вычисляет определённый интеграл функции методом Симпсона
+     *
+     * Значения функции вычисляются блоками по BLOCK_SIZE узлов.
+     * Флаг отмены проверяется каждые CANCELLATION_CHECK_INTERVAL узлов.
+     * Остановка происходит на чётном узле, поэтому пройденная часть
+     * отрезка - полноценная формула Симпсона
      *
      * @param lower Нижний предел интегрирования
      * @param upper Верхний предел интегрирования
      * @param step Шаг интегрирования (будет скорректирован для чётного числа интервалов)
-     * @return Значение определенного интеграла
+     * @param integrand Параметры функции
+     * @param token Флаг отмены
+     * @return Значение интеграла и пройденная часть отрезка
      *
      * @throws std::invalid_argument если параметры некорректны
-     * @throws std::runtime_error если возникла ошибка при вычислении
      */
-    double integrate(double lower, double upper, double step) const override
+    PartialIntegral integrate_partial(double lower, double upper, double step, const IntegrandSpec &integrand,
+                                      const CancellationToken &token) const override
     {
         // Валидация входных параметров
-        validate_parameters(lower, upper, step);
+        Base::validate_parameters(lower, upper, step, integrand);
+
+        // Отмена до начала вычислений - отрезок не пройден
+        if (token.is_cancelled())
+        {
+            return {0.0, lower, false};
+        }
 
         // Вычисляем количество интервалов
         uint64_t n = static_cast<uint64_t>(std::ceil((upper - lower) / step));
@@ -44,27 +66,52 @@ public:
         // Корректируем шаг для точного покрытия интервала
         double h = (upper - lower) / n;
 
-        // Начальное и конечное значения (коэффициент 1)
-        double sum = function(lower) + function(upper);
+        // Функция с параметрами задачи
+        const Integrand function(integrand);
 
-        // Промежуточные точки
-        for (uint64_t i = 1; i < n; i++)
+        // Начальное значение (коэффициент 1)
+        Accumulator sum;
+        sum.add(function.evaluate(lower));
+
+        std::array<double, Base::BLOCK_SIZE> xs;
+        std::array<double, Base::BLOCK_SIZE> ys;
+
+        // Промежуточные точки блоками [i, i + count)
+        for (uint64_t i = 1; i < n;)
         {
             double x = lower + i * h;
 
-            if (i % 2 == 0)
+            // Контрольная точка отмены (i чётно): узел x становится концом пройденной части
+            if (i % Base::CANCELLATION_CHECK_INTERVAL == 0 &&
+                n - i >= Base::MIN_REMAINING_INTERVALS &&
+                token.is_cancelled())
+            {
+                sum.add(function.evaluate(x));
+                return result(sum, h, x, false);
+            }
+
+            // Блок заканчивается на границе BLOCK_SIZE, чтобы контрольные точки попадали на его начало
+            size_t count = static_cast<size_t>(std::min(n, (i / Base::BLOCK_SIZE + 1) * Base::BLOCK_SIZE) - i);
+            for (size_t j = 0; j < count; ++j)
             {
-                // Для четных индексов коэффициент 2
-                sum += 2.0 * function(x);
+                xs[j] = lower + (i + j) * h;
             }
-            else
+            function.evaluate_block(xs.data(), ys.data(), count);
+
+            // Коэффициенты 2 для чётных и 4 для нечётных индексов (умножение точное)
+            for (size_t j = 0; j < count; ++j)
             {
-                // Для нечетных индексов коэффициент 4
-                sum += 4.0 * function(x);
+                ys[j] *= (i + j) % 2 == 0 ? 2.0 : 4.0;
             }
+            sum.add_block(ys.data(), count);
+
+            i += count;
         }
 
-        return sum * h / 3.0;
+        // Конечное значение (коэффициент 1)
+        sum.add(function.evaluate(upper));
+
+        return result(sum, h, upper, true);
     }
 
     /**
@@ -75,4 +122,19 @@ public:
     {
         return "Simpson's rule";
     }
+
+private:
+    /**
+     * @brief Интеграл по пройденной части: сумма узлов, умноженная на h / 3
+     */
+    static PartialIntegral result(const Accumulator &sum, double h, double end, bool complete)
+    {
+        DoubleDouble value = sum.scaled(h, 3.0);
+        return {value.hi, end, complete, value.lo};
+    }
 };
+
+/**
+ * @brief Метод Симпсона для функции 1/ln(x)
+ */
+using SimpsonsRule = BasicSimpsonsRule<integrands::InverseLog>;
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "messages.h"
+
+/**
+ * @file sobol_sequence.h
+ * @brief Скремблированная последовательность Соболя для метода квази-Монте-Карло
+ */
+
+/**
+ * @class SobolSequence
+ * @brief Последовательность Соболя с линейным скремблированием и случайным цифровым сдвигом
+ *
+ * Направляющие числа - таблица Джо и Куо (new-joe-kuo-6.21201) для первых
+ * MAX_DIMENSIONS измерений. Скремблирование (случайная нижнетреугольная
+ * матрица Матоушека и цифровой сдвиг) определяется зерном и номером
+ * реплики, поэтому клиенты получают одинаковые точки без обмена данными,
+ * а разные реплики дают независимые оценки интеграла.
+ *
+ * Точки перечисляются в порядке кода Грея: точка с номером n вычисляется
+ * сразу по номеру (пропуск вперёд), а следующие - одной операцией XOR на
+ * измерение. Поэтому любой отрезок номеров можно считать независимо
+ */
+class SobolSequence
+{
+public:
+    // Разрядность координат
+    static constexpr uint32_t BITS = 32;
+    // Наибольшее число измерений
+    static constexpr uint32_t MAX_DIMENSIONS = QmcSampling::MAX_DIMENSIONS;
+
+    /**
+     * @brief Конструктор
+     * @param dimensions Число измерений (1..MAX_DIMENSIONS)
+     * @param seed Зерно скремблирования
+     * @param replica Номер реплики
+     * @throws std::invalid_argument если число измерений некорректно
+     */
+    SobolSequence(uint32_t dimensions, uint64_t seed, uint32_t replica)
+    {
+        if (dimensions == 0 || dimensions > MAX_DIMENSIONS)
+        {
+            throw std::invalid_argument("Sobol sequence supports 1.." + std::to_string(MAX_DIMENSIONS) + " dimensions");
+        }
+
+        directions_.resize(dimensions);
+        shifts_.resize(dimensions);
+        for (uint32_t d = 0; d < dimensions; ++d)
+        {
+            // Своё случайное скремблирование для каждого измерения и каждой реплики
+            uint64_t state = seed ^ (0x9E3779B97F4A7C15ull * (static_cast<uint64_t>(replica) + 1)) ^
+                             (0xC2B2AE3D27D4EB4Full * (static_cast<uint64_t>(d) + 1));
+
+            std::array<uint32_t, BITS> scramble;
+            for (uint32_t i = 0; i < BITS; ++i)
+            {
+                // Строка i матрицы: единица на диагонали и случайные старшие разряды
+                uint32_t diagonal = 1u << (BITS - 1 - i);
+                uint32_t above = ~((diagonal << 1) - 1);
+                scramble[i] = diagonal | (static_cast<uint32_t>(next_random(state)) & above);
+            }
+
+            std::array<uint32_t, BITS> directions = unscrambled_directions(d);
+            for (uint32_t k = 0; k < BITS; ++k)
+            {
+                directions_[d][k] = multiply(scramble, directions[k]);
+            }
+            shifts_[d] = static_cast<uint32_t>(next_random(state));
+        }
+    }
+
+    uint32_t dimensions() const { return static_cast<uint32_t>(directions_.size()); }
+
+    /**
+     * @brief Вычисляет точки с номерами [first, first + count) в единичном кубе
+     *
+     * Координаты лежат в (0, 1) и записываются по измерениям:
+     * координата d точки first + i - points[d * stride + i]
+     *
+     * @param first Номер первой точки
+     * @param count Количество точек (first + count <= 2^BITS)
+     * @param points Координаты (не меньше dimensions() * stride элементов)
+     * @param stride Расстояние между координатами соседних измерений (>= count)
+     */
+    void generate(uint64_t first, size_t count, double *points, size_t stride) const
+    {
+        // Середина ячейки 2^-BITS: точка не попадает на границу куба
+        constexpr double SCALE = 1.0 / 4294967296.0;
+
+        const uint64_t gray = first ^ (first >> 1);
+        for (size_t d = 0; d < directions_.size(); ++d)
+        {
+            // Пропуск вперёд: координата точки first по её коду Грея
+            uint32_t x = shifts_[d];
+            for (uint32_t k = 0; k < BITS; ++k)
+            {
+                if ((gray >> k) & 1)
+                {
+                    x ^= directions_[d][k];
+                }
+            }
+
+            double *out = points + d * stride;
+            for (size_t i = 0; i < count; ++i)
+            {
+                out[i] = (static_cast<double>(x) + 0.5) * SCALE;
+                if (i + 1 < count)
+                {
+                    // Коды Грея соседних номеров отличаются младшим нулевым разрядом номера
+                    x ^= directions_[d][trailing_zeros(first + i + 1)];
+                }
+            }
+        }
+    }
+
+private:
+    /**
+     * @struct Primitive
+     * @brief Примитивный многочлен и начальные направляющие числа измерения
+     */
+    struct Primitive
+    {
+        // Степень многочлена
+        uint32_t degree;
+        // Коэффициенты многочлена между старшим и младшим
+        uint32_t coefficients;
+        // Начальные направляющие числа m_1..m_degree
+        std::array<uint32_t, 7> initial;
+    };
+
+    /**
+     * @brief Направляющие числа измерения d без скремблирования (старший разряд - первая цифра)
+     */
+    static std::array<uint32_t, BITS> unscrambled_directions(uint32_t d)
+    {
+        // Измерения 2..21 из таблицы new-joe-kuo-6.21201
+        static constexpr Primitive PRIMITIVES[MAX_DIMENSIONS - 1] = {
+            {1, 0, {1}},
+            {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}},
+            {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}},
+            {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}},
+            {5, 4, {1, 1, 5, 5, 5}},
+            {5, 7, {1, 1, 7, 11, 19}},
+            {5, 11, {1, 1, 5, 1, 1}},
+            {5, 13, {1, 1, 1, 3, 11}},
+            {5, 14, {1, 3, 5, 5, 31}},
+            {6, 1, {1, 3, 3, 9, 7, 49}},
+            {6, 13, {1, 1, 1, 15, 21, 21}},
+            {6, 16, {1, 3, 1, 13, 27, 49}},
+            {6, 19, {1, 1, 1, 15, 7, 5}},
+            {6, 22, {1, 3, 1, 15, 13, 25}},
+            {6, 25, {1, 1, 5, 5, 19, 61}},
+            {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+            {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+        };
+
+        std::array<uint32_t, BITS> v{};
+        if (d == 0)
+        {
+            // Первое измерение - последовательность ван дер Корпута
+            for (uint32_t k = 0; k < BITS; ++k)
+            {
+                v[k] = 1u << (BITS - 1 - k);
+            }
+            return v;
+        }
+
+        const Primitive &p = PRIMITIVES[d - 1];
+        for (uint32_t k = 0; k < BITS; ++k)
+        {
+            if (k < p.degree)
+            {
+                v[k] = p.initial[k] << (BITS - 1 - k);
+                continue;
+            }
+
+            // Рекуррентное соотношение по примитивному многочлену
+            v[k] = v[k - p.degree] ^ (v[k - p.degree] >> p.degree);
+            for (uint32_t j = 1; j < p.degree; ++j)
+            {
+                if ((p.coefficients >> (p.degree - 1 - j)) & 1)
+                {
+                    v[k] ^= v[k - j];
+                }
+            }
+        }
+        return v;
+    }
+
+    /**
+     * @brief Умножение матрицы скремблирования на вектор цифр
+     */
+    static uint32_t multiply(const std::array<uint32_t, BITS> &matrix, uint32_t digits)
+    {
+        uint32_t result = 0;
+        for (uint32_t i = 0; i < BITS; ++i)
+        {
+            uint32_t bits = matrix[i] & digits;
+            // Чётность числа единиц - цифра результата
+            bits ^= bits >> 16;
+            bits ^= bits >> 8;
+            bits ^= bits >> 4;
+            bits ^= bits >> 2;
+            bits ^= bits >> 1;
+            result |= (bits & 1u) << (BITS - 1 - i);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Генератор splitmix64
+     */
+    static uint64_t next_random(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Номер младшего единичного разряда (n > 0)
+     */
+    static uint32_t trailing_zeros(uint64_t n)
+    {
+        uint32_t count = 0;
+        while ((n & 1) == 0)
+        {
+            n >>= 1;
+            ++count;
+        }
+        return count;
+    }
+
+    // Скремблированные направляющие числа: измерение -> разряд номера -> число
+    std::vector<std::array<uint32_t, BITS>> directions_;
+    // Цифровой сдвиг каждого измерения
+    std::vector<uint32_t> shifts_;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "integration_strategy.h"
+#include <array>
 
 /**
  * @file trapezoidal_rule.h
@@ -8,59 +9,100 @@
  */
 
 /**
- * @class TrapezoidRule
- * @brief Метод трапеций
+ * @class BasicTrapezoidalRule
+ * @brief Метод трапеций для функции Integrand
+ *
+ * @tparam Integrand Функция из реестра integrands.h
+ * @tparam Accumulator Накопитель суммы площадей из accumulators.h
  */
-class TrapezoidalRule : public IntegrationStrategyBase
+template <class Integrand, class Accumulator = PlainAccumulator>
+class BasicTrapezoidalRule : public IntegrationStrategyBase<Integrand>
 {
+    using Base = IntegrationStrategyBase<Integrand>;
+
 public:
+    using Base::integrate_partial;
+
     /**
-     * @brief Вычисляет определённый интеграл функции 1/ln(x) методом трапеций
+     * @brief Вычисляет определённый интеграл функции методом трапеций
+     *
+     * Значения функции вычисляются блоками по BLOCK_SIZE узлов.
+     * Флаг отмены проверяется каждые CANCELLATION_CHECK_INTERVAL шагов
      *
      * @param lower Нижний предел интегрирования
      * @param upper Верхний предел интегрирования
      * @param step Шаг интегрирования
-     * @return Значение определенного интеграла
+     * @param integrand Параметры функции
+     * @param token Флаг отмены
+     * @return Значение интеграла и пройденная часть отрезка
      *
      * @throws std::invalid_argument если параметры некорректны
-     * @throws std::runtime_error если возникла ошибка при вычислении
      */
-    double integrate(double lower, double upper, double step) const override
+    PartialIntegral integrate_partial(double lower, double upper, double step, const IntegrandSpec &integrand,
+                                      const CancellationToken &token) const override
     {
         // Валидация входных параметров
-        validate_parameters(lower, upper, step);
+        Base::validate_parameters(lower, upper, step, integrand);
+
+        // Отмена до начала вычислений - отрезок не пройден
+        if (token.is_cancelled())
+        {
+            return {0.0, lower, false};
+        }
 
-        double sum = 0.0;
+        Accumulator sum;
         double x = lower;
+        uint64_t steps = 0;
+
+        // Функция с параметрами задачи
+        const Integrand function(integrand);
 
         // Значение функции в начальной точке
-        double f_prev = function(x);
+        double f_prev = function.evaluate(x);
+
+        std::array<double, Base::BLOCK_SIZE> xs;
+        std::array<double, Base::BLOCK_SIZE> ys;
+        std::array<double, Base::BLOCK_SIZE> areas;
 
-        // Основной цикл интегрирования
+        // Основной цикл интегрирования: блоками до BLOCK_SIZE шагов
         while (x < upper)
         {
-            // Следующая точка
-            double x_next = x + step;
+            // Контрольная точка отмены: остаток [x, upper] досчитывается отдельно
+            if (steps != 0 && steps % Base::CANCELLATION_CHECK_INTERVAL == 0 &&
+                upper - x >= Base::MIN_REMAINING_INTERVALS * step &&
+                token.is_cancelled())
+            {
+                return result(sum, x, false);
+            }
 
-            // Корректируем последний шаг, если выходим за границу
-            if (x_next > upper)
+            // Следующие точки блока (последний шаг корректируется по границе)
+            size_t count = 0;
+            for (double x_next = x; count < Base::BLOCK_SIZE && x_next < upper; ++count)
             {
-                x_next = upper;
+                x_next = x_next + step;
+                if (x_next > upper)
+                {
+                    x_next = upper;
+                }
+                xs[count] = x_next;
             }
+            function.evaluate_block(xs.data(), ys.data(), count);
 
-            // Значение функции в следующей точке
-            double f_next = function(x_next);
+            for (size_t j = 0; j < count; ++j)
+            {
+                // Площадь трапеции
+                areas[j] = (f_prev + ys[j]) * (xs[j] - x) / 2.0;
 
-            // Площадь трапеции
-            double trapezoid_area = (f_prev + f_next) * (x_next - x) / 2.0;
-            sum += trapezoid_area;
+                // Переход к следующему шагу
+                x = xs[j];
+                f_prev = ys[j];
+            }
+            sum.add_block(areas.data(), count);
 
-            // Переход к следующему шагу
-            x = x_next;
-            f_prev = f_next;
+            steps += count;
         }
 
-        return sum;
+        return result(sum, upper, true);
     }
 
     /**
@@ -71,4 +113,19 @@ public:
     {
         return "Trapezoidal rule";
     }
+
+private:
+    /**
+     * @brief Интеграл по пройденной части - сумма площадей трапеций
+     */
+    static PartialIntegral result(const Accumulator &sum, double end, bool complete)
+    {
+        DoubleDouble value = sum.scaled(1.0, 1.0);
+        return {value.hi, end, complete, value.lo};
+    }
 };
+
+/**
+ * @brief Метод трапеций для функции 1/ln(x)
+ */
+using TrapezoidalRule = BasicTrapezoidalRule<integrands::InverseLog>;
@@ -1,7 +1,16 @@
 #include "integrator.h"
+#include "integration_methods/quasi_monte_carlo.h"
+#include "integration_methods/simpsons_rule.h"
+#include "integration_methods/trapezoidal_rule.h"
+#include <algorithm>
 #include <stdexcept>
 #include <logger.h>
 
+Integrator::Integrator()
+{
+    register_builtin_strategies();
+}
+
 Integrator::Integrator(std::unique_ptr<IIntegrationStrategy> strategy)
 {
     if (!strategy)
@@ -10,6 +19,7 @@ Integrator::Integrator(std::unique_ptr<IIntegrationStrategy> strategy)
     }
 
     strategy_ = std::move(strategy);
+    register_builtin_strategies();
 
     LOG_INFO("Integrator initialized with strategy: {}", strategy_->get_method_name());
 }
@@ -37,18 +47,138 @@ std::string Integrator::get_current_method() const
     return strategy_->get_method_name();
 }
 
+const IIntegrationStrategy *Integrator::find_strategy(uint32_t kernel, uint32_t integrand, uint32_t reduction,
+                                                      uint32_t precision) const
+{
+    if (kernel == 0)
+    {
+        if (integrand == INTEGRAND_INV_LOG && reduction == REDUCTION_PLAIN && precision == PRECISION_DOUBLE)
+        {
+            return strategy_.get();
+        }
+        kernel = KERNEL_SIMPSON;
+    }
+
+    auto it = strategies_.find({kernel, integrand, reduction, precision});
+    return it != strategies_.end() ? it->second.get() : nullptr;
+}
+
+std::string Integrator::get_method_name(uint32_t kernel) const
+{
+    if (kernel == KERNEL_QMC)
+    {
+        return BasicQuasiMonteCarlo<integrands::InverseLog>().get_method_name();
+    }
+
+    const IIntegrationStrategy *strategy = find_strategy(kernel);
+    return strategy ? strategy->get_method_name() : "unknown";
+}
+
+uint32_t Integrator::get_supported_kernels() const
+{
+    uint32_t kernels = 0;
+    for (const auto &[key, strategy] : strategies_)
+    {
+        kernels |= std::get<0>(key);
+    }
+    // Квази-Монте-Карло доступен для всех функций реестра
+    return kernels | KERNEL_QMC;
+}
+
+uint32_t Integrator::get_supported_integrands() const
+{
+    uint32_t integrands = 0;
+    for (const auto &[key, strategy] : strategies_)
+    {
+        integrands |= integrand_bit(std::get<1>(key));
+    }
+    return integrands;
+}
+
+uint32_t Integrator::get_supported_reductions() const
+{
+    uint32_t reductions = 0;
+    for (const auto &[key, strategy] : strategies_)
+    {
+        reductions |= std::get<2>(key);
+    }
+    return reductions;
+}
+
+template <class Integrand, class Accumulator>
+void Integrator::register_accumulator(uint32_t precision)
+{
+    strategies_[{KERNEL_TRAPEZOIDAL, Integrand::ID, Accumulator::REDUCTION, precision}] =
+        std::make_unique<BasicTrapezoidalRule<Integrand, Accumulator>>();
+    strategies_[{KERNEL_SIMPSON, Integrand::ID, Accumulator::REDUCTION, precision}] =
+        std::make_unique<BasicSimpsonsRule<Integrand, Accumulator>>();
+}
+
+template <class Integrand>
+void Integrator::register_integrand()
+{
+    register_accumulator<Integrand, PlainAccumulator>();
+    register_accumulator<Integrand, CompensatedAccumulator>();
+    register_accumulator<Integrand, DoubleDoubleAccumulator>();
+}
+
+template <class Integrand>
+void Integrator::register_single_precision()
+{
+    using Single = integrands::SinglePrecision<Integrand>;
+    register_accumulator<Single, PlainAccumulator>(PRECISION_SINGLE);
+    register_accumulator<Single, CompensatedAccumulator>(PRECISION_SINGLE);
+    register_accumulator<Single, DoubleDoubleAccumulator>(PRECISION_SINGLE);
+}
+
+template <class... Integrands>
+void Integrator::register_integrands(integrands::IntegrandList<Integrands...>)
+{
+    (register_integrand<Integrands>(), ...);
+}
+
+template <class... Integrands>
+void Integrator::register_single_precision_integrands(integrands::IntegrandList<Integrands...>)
+{
+    (register_single_precision<Integrands>(), ...);
+}
+
+void Integrator::register_builtin_strategies()
+{
+    register_integrands(integrands::AllIntegrands{});
+    register_single_precision_integrands(integrands::SinglePrecisionIntegrands{});
+}
+
 Result Integrator::execute_task(const Task &task)
 {
+    return execute_task(task, CancellationToken::none());
+}
+
+Result Integrator::execute_task(const Task &task, const CancellationToken &token)
+{
+    if (task.kernel == KERNEL_QMC)
+    {
+        return execute_qmc_task(task, token);
+    }
+
     Result result;
     result.task_id = task.id;
+    result.job_id = task.job_id;
     result.success = true;
 
-    if (!strategy_)
+    const IIntegrationStrategy *strategy = find_strategy(task.kernel, task.integrand.id, task.reduction,
+                                                             task.precision);
+    if (!strategy)
     {
         result.success = false;
-        result.error_message = "Integration strategy is not set";
+        result.error_message = task.kernel == 0 && task.integrand.id == INTEGRAND_INV_LOG
+                                   ? "Integration strategy is not set"
+                                   : "Unsupported integration method " + std::to_string(task.kernel) +
+                                         " for integrand " + integrands::name(task.integrand.id) +
+                                         " with reduction " + std::to_string(task.reduction) +
+                                         " and precision " + std::to_string(task.precision);
         result.value = 0.0;
-        LOG_ERROR("Cannot execute task {}: strategy is not set", task.id);
+        LOG_ERROR("Cannot execute task {}: {}", task.id, result.error_message);
         return result;
     }
 
@@ -65,14 +195,28 @@ Result Integrator::execute_task(const Task &task)
             return result;
         }
 
-        LOG_DEBUG("Executing task {} with method '{}' (range: [{}, {}], step: {})",
-                  task.id, strategy_->get_method_name(),
+        LOG_DEBUG("Executing task {} with method '{}' for {} (range: [{}, {}], step: {})",
+                  task.id, strategy->get_method_name(), integrands::name(task.integrand.id),
                   task.begin, task.end, task.step);
 
         // Выполнение интегрирования
-        result.value = strategy_->integrate(task.begin, task.end, task.step);
+        PartialIntegral integral = task.grid.is_active()
+                                       ? integrate_table(*strategy, task, token, result.cumulative)
+                                       : strategy->integrate_partial(task.begin, task.end, task.step,
+                                                                     task.integrand, token);
+        result.value = integral.value;
+        result.value_low = integral.value_low;
+        result.end = integral.end;
+        result.partial = !integral.complete;
 
-        LOG_DEBUG("Task {} completed successfully, result: {}", task.id, result.value);
+        if (result.partial)
+        {
+            LOG_DEBUG("Task {} interrupted at {} of [{}, {}]", task.id, result.end, task.begin, task.end);
+        }
+        else
+        {
+            LOG_DEBUG("Task {} completed successfully, result: {}", task.id, result.value);
+        }
     }
     catch (const std::invalid_argument &e)
     {
@@ -102,6 +246,108 @@ Result Integrator::execute_task(const Task &task)
     return result;
 }
 
+PartialIntegral Integrator::integrate_table(const IIntegrationStrategy &strategy, const Task &task,
+                                            const CancellationToken &token, std::vector<double> &cumulative)
+{
+    const uint64_t first = task.grid.index(task.begin);
+    const uint64_t last = task.grid.index(task.end);
+    cumulative.reserve(last - first);
+
+    PartialIntegral result{0.0, task.begin, false};
+    for (uint64_t k = first; k < last; ++k)
+    {
+        // Границы задачи - точно точки таблицы, как их вычислил сервер
+        double lower = k == first ? task.begin : task.grid.point(k);
+        double upper = k + 1 == last ? task.end : task.grid.point(k + 1);
+
+        // На коротком отрезке шаг уменьшается, чтобы поместилось хотя бы два интервала
+        PartialIntegral segment = strategy.integrate_partial(lower, upper, std::min(task.step, (upper - lower) / 2.0),
+                                                             task.integrand, token);
+        if (!segment.complete)
+        {
+            return result;
+        }
+
+        result.value += segment.value + segment.value_low;
+        result.end = upper;
+        cumulative.push_back(result.value);
+    }
+
+    result.complete = true;
+    return result;
+}
+
+Result Integrator::execute_qmc_task(const Task &task, const CancellationToken &token)
+{
+    Result result;
+    result.task_id = task.id;
+    result.job_id = task.job_id;
+    result.success = true;
+
+    try
+    {
+        if (!task.is_valid())
+        {
+            result.success = false;
+            result.error_message = "Invalid task parameters";
+
+            LOG_ERROR("Task {} validation failed", task.id);
+            return result;
+        }
+
+        LOG_DEBUG("Executing task {} with quasi-Monte Carlo for {} (points: [{}, {}), {} dimensions, replica {})",
+                  task.id, integrands::name(task.integrand.id), task.begin, task.end,
+                  task.sampling.dimensions(), task.sampling.replica);
+
+        auto first = static_cast<uint64_t>(task.begin);
+        auto last = static_cast<uint64_t>(task.end);
+
+        QmcPartial partial;
+        bool known = integrands::visit(task.integrand.id, [&](auto tag)
+                                       { partial = BasicQuasiMonteCarlo<typename decltype(tag)::type>().integrate_partial(
+                                             first, last, task.sampling, task.integrand, token); });
+        if (!known)
+        {
+            result.success = false;
+            result.error_message = "Unsupported integrand " + std::to_string(task.integrand.id);
+            LOG_ERROR("Cannot execute task {}: {}", task.id, result.error_message);
+            return result;
+        }
+
+        result.value = partial.sum;
+        result.sum_squares = partial.sum_squares;
+        result.end = static_cast<double>(partial.end);
+        result.partial = !partial.complete;
+
+        if (result.partial)
+        {
+            LOG_DEBUG("Task {} interrupted at point {} of [{}, {})", task.id, partial.end, first, last);
+        }
+        else
+        {
+            LOG_DEBUG("Task {} completed successfully, sum: {}", task.id, result.value);
+        }
+    }
+    catch (const std::invalid_argument &e)
+    {
+        result.success = false;
+        result.error_message = std::string("Invalid argument: ") + e.what();
+        result.value = 0.0;
+
+        LOG_ERROR("Task {} failed with invalid argument: {}", task.id, e.what());
+    }
+    catch (const std::exception &e)
+    {
+        result.success = false;
+        result.error_message = std::string("Unexpected error: ") + e.what();
+        result.value = 0.0;
+
+        LOG_ERROR("Task {} failed with unexpected error: {}", task.id, e.what());
+    }
+
+    return result;
+}
+
 std::vector<Result> Integrator::execute_tasks(const std::vector<Task> &tasks)
 {
     std::vector<Result> results;
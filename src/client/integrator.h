@@ -2,7 +2,9 @@
 
 #include "integration_methods/integration_strategy.h"
 #include "messages.h"
+#include <map>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 /**
@@ -14,15 +16,26 @@
  * @class Integrator
  * @brief Выполняет численное интегрирование с использованием выбранной стратегии
  *
- * Данный класс реализует паттерн Strategy, для легкого выбора метода интегрирования
+ * Данный класс реализует паттерн Strategy, для легкого выбора метода интегрирования.
+ * Метод и функция могут задаваться для каждой задачи (Task::kernel, Task::integrand):
+ * встроенные стратегии создаются один раз в конструкторе для каждой пары метода и
+ * функции из реестра integrands.h и не меняются, поэтому рабочие потоки выбирают
+ * их без блокировок и без создания объектов на каждую задачу. Задачи без метода
+ * для функции 1/ln(x) выполняются стратегией по умолчанию. Задачи метода
+ * квази-Монте-Карло (KERNEL_QMC) выполняются BasicQuasiMonteCarlo для любой функции.
+ * Задачи с таблицей первообразной (Task::grid) возвращают и значения таблицы.
+ * Для каждой пары создаются стратегии со всеми накопителями из accumulators.h,
+ * накопитель выбирается режимом суммирования задачи (Task::reduction).
+ * Для функций из integrands::SinglePrecisionIntegrands создаются и стратегии,
+ * вычисляющие значения в float32 (Task::precision)
  */
 class Integrator
 {
 public:
     /**
-     * @brief Конструктор по умолчанию (без стратегии)
+     * @brief Конструктор по умолчанию (без стратегии по умолчанию)
      */
-    Integrator() = default;
+    Integrator();
 
     /**
      * @brief Конструктор с указанием стратегии
@@ -34,7 +47,7 @@ public:
     explicit Integrator(std::unique_ptr<IIntegrationStrategy> strategy);
 
     /**
-     * @brief Устанавливает новую стратегию интегрирования
+     * @brief Устанавливает новую стратегию интегрирования по умолчанию
      *
      * @param strategy Указатель на новую стратегию
      *
@@ -49,6 +62,44 @@ public:
      */
     std::string get_current_method() const;
 
+    /**
+     * @brief Возвращает стратегию метода и функции задачи
+     * @param kernel Бит IntegrationKernel (0 - стратегия по умолчанию)
+     * @param integrand ID функции (IntegrandId). Задачи с другими функциями
+     *        без метода выполняются методом Симпсона
+     * @param reduction Бит ReductionMode. Стратегия по умолчанию суммирует только обычным способом
+     * @param precision EvaluationPrecision. Стратегия по умолчанию вычисляет значения только в double
+     * @return Указатель на стратегию или nullptr, если метод, функция, режим или точность не поддерживаются
+     */
+    const IIntegrationStrategy *find_strategy(uint32_t kernel, uint32_t integrand = INTEGRAND_INV_LOG,
+                                              uint32_t reduction = REDUCTION_PLAIN,
+                                              uint32_t precision = PRECISION_DOUBLE) const;
+
+    /**
+     * @brief Возвращает название метода задачи
+     * @param kernel Бит IntegrationKernel (0 - стратегия по умолчанию)
+     * @return Название метода или "unknown"
+     */
+    std::string get_method_name(uint32_t kernel) const;
+
+    /**
+     * @brief Возвращает методы, которые можно задать задаче
+     * @return Биты IntegrationKernel
+     */
+    uint32_t get_supported_kernels() const;
+
+    /**
+     * @brief Возвращает функции, которые можно задать задаче
+     * @return Биты integrand_bit
+     */
+    uint32_t get_supported_integrands() const;
+
+    /**
+     * @brief Возвращает режимы суммирования, которые можно задать задаче
+     * @return Биты ReductionMode
+     */
+    uint32_t get_supported_reductions() const;
+
     /**
      * @brief Выполняет интегрирование одной задачи
      *
@@ -58,6 +109,18 @@ public:
      */
     Result execute_task(const Task &task);
 
+    /**
+     * @brief Выполняет интегрирование одной задачи с возможностью отмены
+     *
+     * При отмене возвращается частичный результат (partial = true)
+     * для вычисленной части [task.begin, result.end]
+     *
+     * @param task Задача для выполнения
+     * @param token Флаг отмены
+     * @return Результат выполнения задачи
+     */
+    Result execute_task(const Task &task, const CancellationToken &token);
+
     /**
      * @brief Выполняет интегрирование пакета задач
      *
@@ -68,6 +131,65 @@ public:
     std::vector<Result> execute_tasks(const std::vector<Task> &tasks);
 
 private:
-    // Текущая стратегия интегрирования
+    /**
+     * @brief Выполняет задачу метода квази-Монте-Карло
+     *
+     * value результата - сумма значений функции в точках задачи,
+     * sum_squares - сумма их квадратов, end - номер первой невычисленной точки
+     */
+    Result execute_qmc_task(const Task &task, const CancellationToken &token);
+
+    /**
+     * @brief Интегрирует задачу с таблицей первообразной
+     *
+     * Отрезки между соседними точками таблицы интегрируются по очереди,
+     * а накопленный интеграл записывается после каждого из них. При отмене
+     * вычисление останавливается на точке таблицы: недосчитанный отрезок
+     * отбрасывается, чтобы остаток задачи начинался с точки таблицы
+     *
+     * @param strategy Метод и функция задачи
+     * @param task Задача с активной grid
+     * @param token Флаг отмены
+     * @param cumulative Интегралы от начала задачи до каждой пройденной точки таблицы
+     * @return Интеграл по пройденной части задачи
+     */
+    static PartialIntegral integrate_table(const IIntegrationStrategy &strategy, const Task &task,
+                                           const CancellationToken &token, std::vector<double> &cumulative);
+
+    /**
+     * @brief Создаёт экземпляры встроенных стратегий для всех функций реестра
+     */
+    void register_builtin_strategies();
+
+    /**
+     * @brief Создаёт экземпляры встроенных методов для функции Integrand
+     */
+    template <class Integrand>
+    void register_integrand();
+
+    /**
+     * @brief Создаёт экземпляры встроенных методов для функции Integrand с накопителем Accumulator
+     * @param precision EvaluationPrecision, с которой Integrand вычисляет значения
+     */
+    template <class Integrand, class Accumulator>
+    void register_accumulator(uint32_t precision = PRECISION_DOUBLE);
+
+    /**
+     * @brief Создаёт экземпляры встроенных методов для функции Integrand, вычисляемой в float32
+     */
+    template <class Integrand>
+    void register_single_precision();
+
+    template <class... Integrands>
+    void register_integrands(integrands::IntegrandList<Integrands...>);
+
+    template <class... Integrands>
+    void register_single_precision_integrands(integrands::IntegrandList<Integrands...>);
+
+    // Стратегия для задач без метода
     std::unique_ptr<IIntegrationStrategy> strategy_;
+    // Встроенные стратегии: (бит IntegrationKernel, IntegrandId, бит ReductionMode, EvaluationPrecision) -> стратегия
+    // (не меняются после создания)
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>, std::unique_ptr<const IIntegrationStrategy>>
+        strategies_;
 };
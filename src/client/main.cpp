@@ -50,12 +50,14 @@ int main(int argc, char *argv[])
         LOG_INFO("  CPU cores: {}", info.cpu_cores);
         LOG_INFO("  RAM: {} MB", info.total_ram_mb);
 
-        Client client(server_address, server_port);
-        client.run();
+        {
+            Client client(server_address, server_port);
+            client.run();
+        }
 
-        logging::shutdown();
-        
+        // Клиент логирует своё завершение в деструкторе, поэтому логгер закрываем после него
         LOG_INFO("Client finished");
+        logging::shutdown();
         return 0;
     }
     catch (std::exception &e)
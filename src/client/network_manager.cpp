@@ -1,5 +1,6 @@
 #include "network_manager.h"
 #include "net_utils.h"
+#include "protocol.h"
 #include "logger.h"
 #include <stdexcept>
 
@@ -60,7 +61,10 @@ bool NetworkManager::is_connected() const
 
 HandshakeResponse NetworkManager::perform_handshake(
     const std::string &client_version,
-    const SystemInfo &system_info)
+    const SystemInfo &system_info,
+    const std::string &integration_method,
+    uint16_t peer_port,
+    const ProtocolCapabilities &capabilities)
 {
     if (!is_connected())
     {
@@ -75,6 +79,9 @@ HandshakeResponse NetworkManager::perform_handshake(
         HandshakeRequest request;
         request.client_version = client_version;
         request.system_info = system_info;
+        request.integration_method = integration_method;
+        request.peer_port = peer_port;
+        request.capabilities = capabilities;
 
         // Отправляем запрос
         net_utils::send_data(*socket_, request);
@@ -83,15 +90,28 @@ HandshakeResponse NetworkManager::perform_handshake(
         // Получаем ответ
         HandshakeResponse response = net_utils::receive_data<HandshakeResponse>(*socket_);
 
+        if (!response.accepted && response.retry_after_ms > 0)
+        {
+            LOG_WARN("Server is busy: {}", response.message);
+            return response;
+        }
+
         if (!response.accepted)
         {
             LOG_ERROR("Handshake rejected by server: {}", response.message);
             throw std::runtime_error("Handshake rejected: " + response.message);
         }
 
-        LOG_INFO("Handshake successful. Assigned client_id: {}, server version: {}",
+        if (response.protocol.protocol_version == 0)
+        {
+            // Старый сервер не согласует протокол: действуют возможности его версии
+            response.protocol = protocol::legacy_settings(capabilities);
+        }
+
+        LOG_INFO("Handshake successful. Assigned client_id: {}, server version: {}, protocol: {}",
                  response.assigned_client_id,
-                 response.server_version);
+                 response.server_version,
+                 protocol::describe(response.protocol));
 
         return response;
     }
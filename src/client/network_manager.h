@@ -56,12 +56,20 @@ public:
      * @brief Выполняет handshake с сервером
      * @param client_version Версия клиента
      * @param system_info Информация о системе клиента
-     * @return Ответ сервера с присвоенным client_id
+     * @param integration_method Название метода интегрирования клиента
+     * @param peer_port Порт для запросов кражи работы от других клиентов (0 - не принимаются)
+     * @param capabilities Возможности протокола клиента
+     * @return Ответ сервера с присвоенным client_id и параметрами протокола или, если
+     *         сервер перегружен подключениями, отказ с ненулевым retry_after_ms.
+     *         Для старого сервера параметры протокола заполняются параметрами старой версии
      * @throws std::runtime_error если handshake не удался
      */
     HandshakeResponse perform_handshake(
         const std::string &client_version,
-        const SystemInfo &system_info);
+        const SystemInfo &system_info,
+        const std::string &integration_method,
+        uint16_t peer_port,
+        const ProtocolCapabilities &capabilities);
 
     /**
      * @brief Получает пакет задач от сервера
@@ -0,0 +1,243 @@
+#include "peer_exchange.h"
+#include "net_utils.h"
+#include "logger.h"
+#include <sstream>
+#include <stdexcept>
+
+PeerExchange::PeerExchange(StealHandler on_steal)
+    : on_steal_(std::move(on_steal))
+{
+}
+
+PeerExchange::~PeerExchange()
+{
+    stop();
+}
+
+uint16_t PeerExchange::start()
+{
+    try
+    {
+        // Порт выбирает система: на одной машине может работать несколько клиентов
+        acceptor_ = std::make_unique<tcp::acceptor>(io_context_, tcp::endpoint(tcp::v4(), 0));
+    }
+    catch (const boost::system::system_error &e)
+    {
+        throw std::runtime_error(std::string("Failed to open peer port: ") + e.what());
+    }
+
+    uint16_t port = acceptor_->local_endpoint().port();
+
+    accept_next();
+    accept_thread_ = std::thread([this]()
+                                 { io_context_.run(); });
+
+    LOG_INFO("Accepting work stealing requests on port {}", port);
+    return port;
+}
+
+void PeerExchange::stop()
+{
+    if (accept_thread_.joinable())
+    {
+        // Приём отменяется в потоке io_context_, после чего run() возвращается
+        boost::asio::post(io_context_, [this]()
+                          {
+            boost::system::error_code ec;
+            acceptor_->close(ec); });
+        accept_thread_.join();
+    }
+
+    std::vector<Connection> connections;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        stopped_ = true;
+        connections.swap(connections_);
+    }
+
+    // Разрыв соединения прерывает ожидание результатов вора
+    for (auto &connection : connections)
+    {
+        boost::system::error_code ec;
+        connection.socket->shutdown(tcp::socket::shutdown_both, ec);
+    }
+    for (auto &connection : connections)
+    {
+        if (connection.thread.joinable())
+        {
+            connection.thread.join();
+        }
+    }
+}
+
+void PeerExchange::set_peers(std::vector<PeerInfo> peers)
+{
+    std::lock_guard<std::mutex> lock(peers_mutex_);
+    peers_ = std::move(peers);
+    next_peer_ = 0;
+    LOG_INFO("Known peers: {}", peers_.size());
+}
+
+bool PeerExchange::has_peers() const
+{
+    std::lock_guard<std::mutex> lock(peers_mutex_);
+    return !peers_.empty();
+}
+
+std::optional<StolenWork> PeerExchange::try_steal(uint64_t thief_id)
+{
+    std::vector<PeerInfo> peers;
+    size_t first = 0;
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        peers = peers_;
+        first = next_peer_;
+        next_peer_ = peers_.empty() ? 0 : (next_peer_ + 1) % peers_.size();
+    }
+
+    for (size_t i = 0; i < peers.size(); ++i)
+    {
+        const PeerInfo &peer = peers[(first + i) % peers.size()];
+
+        try
+        {
+            auto socket = std::make_shared<tcp::socket>(io_context_);
+            tcp::resolver resolver(io_context_);
+            boost::asio::connect(*socket, resolver.resolve(peer.address, std::to_string(peer.port)));
+
+            StealRequest request;
+            request.thief_id = thief_id;
+            net_utils::send_data(*socket, request);
+
+            TaskBatch batch = net_utils::receive_data<TaskBatch>(*socket);
+            if (batch.tasks.empty())
+            {
+                continue;
+            }
+
+            LOG_INFO("Stole {} tasks from client {}", batch.tasks.size(), peer.client_id);
+            return StolenWork{peer.client_id, std::move(batch), std::move(socket)};
+        }
+        catch (const std::exception &e)
+        {
+            LOG_DEBUG("Steal attempt at client {} ({}:{}) failed: {}",
+                      peer.client_id, peer.address, peer.port, e.what());
+        }
+    }
+
+    return std::nullopt;
+}
+
+void PeerExchange::return_results(const StolenWork &work, const ResultBatch &results)
+{
+    net_utils::send_data(*work.socket, results);
+
+    boost::system::error_code ec;
+    work.socket->shutdown(tcp::socket::shutdown_both, ec);
+    work.socket->close(ec);
+}
+
+std::vector<PeerInfo> PeerExchange::parse_peers(const std::string &message, uint64_t self_id)
+{
+    std::vector<PeerInfo> peers;
+    std::istringstream iss(message);
+    std::string entry;
+
+    while (std::getline(iss, entry, ';'))
+    {
+        auto at = entry.find('@');
+        auto colon = entry.rfind(':');
+        if (at == std::string::npos || colon == std::string::npos || colon < at)
+        {
+            continue;
+        }
+
+        try
+        {
+            PeerInfo peer;
+            peer.client_id = std::stoull(entry.substr(0, at));
+            peer.address = entry.substr(at + 1, colon - at - 1);
+            peer.port = static_cast<uint16_t>(std::stoul(entry.substr(colon + 1)));
+
+            if (peer.client_id != self_id && peer.port != 0)
+            {
+                peers.push_back(std::move(peer));
+            }
+        }
+        catch (const std::exception &)
+        {
+            LOG_WARN("Ignoring malformed peer entry: {}", entry);
+        }
+    }
+
+    return peers;
+}
+
+void PeerExchange::accept_next()
+{
+    auto socket = std::make_shared<tcp::socket>(io_context_);
+    acceptor_->async_accept(*socket, [this, socket](const boost::system::error_code &ec)
+                            {
+        if (ec)
+        {
+            // Acceptor закрыт при остановке
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            if (!stopped_)
+            {
+                // Присоединяем потоки завершившихся соединений
+                for (auto it = connections_.begin(); it != connections_.end();)
+                {
+                    if (it->finished->load())
+                    {
+                        it->thread.join();
+                        it = connections_.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+
+                auto finished = std::make_shared<std::atomic<bool>>(false);
+                std::thread thread([this, socket, finished]()
+                                   {
+                    serve_thief(socket);
+                    finished->store(true); });
+                connections_.push_back(Connection{socket, std::move(thread), std::move(finished)});
+            }
+        }
+
+        accept_next(); });
+}
+
+void PeerExchange::serve_thief(std::shared_ptr<tcp::socket> socket)
+{
+    StealOffer offer;
+    try
+    {
+        auto request = net_utils::receive_data<StealRequest>(*socket);
+        offer = on_steal_(request.thief_id);
+
+        net_utils::send_data(*socket, offer.batch);
+        if (offer.batch.tasks.empty())
+        {
+            return;
+        }
+
+        LOG_INFO("Gave {} tasks to client {}", offer.batch.tasks.size(), request.thief_id);
+        offer.results.set_value(net_utils::receive_data<ResultBatch>(*socket));
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN("Work stealing connection failed: {}", e.what());
+        if (!offer.batch.tasks.empty())
+        {
+            // Владелец выполнит отданные задачи сам
+            offer.results.set_exception(std::current_exception());
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "messages.h"
+
+using tcp = boost::asio::ip::tcp;
+
+/**
+ * @file peer_exchange.h
+ * @brief Модуль кражи работы между клиентами напрямую, без участия сервера
+ */
+
+/**
+ * @struct PeerInfo
+ * @brief Адрес другого клиента, полученный от сервера
+ */
+struct PeerInfo
+{
+    // ID клиента
+    uint64_t client_id = 0;
+    // Адрес клиента
+    std::string address;
+    // Порт, на котором клиент принимает запросы кражи
+    uint16_t port = 0;
+};
+
+/**
+ * @struct StealOffer
+ * @brief Задачи, отданные вору, и обещание их результатов
+ */
+struct StealOffer
+{
+    // Отданные задачи (пустой пакет - отдать нечего)
+    TaskBatch batch;
+    // Выполняется результатами вора или исключением при разрыве соединения
+    std::promise<ResultBatch> results;
+};
+
+/**
+ * @struct StolenWork
+ * @brief Украденные задачи и соединение, по которому вернуть результаты
+ */
+struct StolenWork
+{
+    // ID клиента-владельца задач
+    uint64_t owner_id = 0;
+    // Украденные задачи
+    TaskBatch batch;
+    // Соединение с владельцем
+    std::shared_ptr<tcp::socket> socket;
+};
+
+/**
+ * @class PeerExchange
+ * @brief Принимает запросы кражи от других клиентов и крадёт у них сам
+ *
+ * Простаивающий клиент подключается к другому клиенту и забирает половину
+ * его задач, ещё не начатых к выполнению. Результаты украденных задач
+ * возвращаются владельцу, и он отправляет их серверу вместе со своими,
+ * поэтому для сервера кража незаметна. Если вор отключился, не вернув
+ * результаты, владелец выполняет задачи сам
+ */
+class PeerExchange
+{
+public:
+    /**
+     * @brief Тип функции, выбирающей задачи для вора
+     *
+     * Вызывается в потоке соединения; результаты вора передаются через StealOffer::results
+     */
+    using StealHandler = std::function<StealOffer(uint64_t thief_id)>;
+
+    /**
+     * @brief Конструктор
+     * @param on_steal Выбирает задачи, которые можно отдать вору
+     */
+    explicit PeerExchange(StealHandler on_steal);
+
+    /**
+     * @brief Деструктор - останавливает приём запросов
+     */
+    ~PeerExchange();
+
+    // Запрет копирования и перемещения
+    PeerExchange(const PeerExchange &) = delete;
+    PeerExchange &operator=(const PeerExchange &) = delete;
+    PeerExchange(PeerExchange &&) = delete;
+    PeerExchange &operator=(PeerExchange &&) = delete;
+
+    /**
+     * @brief Начинает принимать запросы кражи на свободном порту
+     * @return Номер порта
+     * @throws std::runtime_error если не удалось открыть порт
+     */
+    uint16_t start();
+
+    /**
+     * @brief Прекращает приём запросов и разрывает соединения с ворами
+     *
+     * Ожидающие результатов владельцы получают исключение и выполняют задачи сами
+     */
+    void stop();
+
+    /**
+     * @brief Заменяет список других клиентов
+     * @param peers Клиенты, у которых можно красть
+     */
+    void set_peers(std::vector<PeerInfo> peers);
+
+    /**
+     * @brief Проверяет, известен ли хотя бы один другой клиент
+     */
+    bool has_peers() const;
+
+    /**
+     * @brief Пытается украсть задачи у других клиентов
+     *
+     * Клиенты опрашиваются по кругу, начиная со следующего после предыдущей попытки
+     *
+     * @param thief_id ID этого клиента
+     * @return Украденные задачи или std::nullopt, если красть не у кого
+     */
+    std::optional<StolenWork> try_steal(uint64_t thief_id);
+
+    /**
+     * @brief Возвращает владельцу результаты украденных задач
+     * @param work Украденные задачи
+     * @param results Результаты
+     * @throws std::runtime_error при ошибке отправки
+     */
+    static void return_results(const StolenWork &work, const ResultBatch &results);
+
+    /**
+     * @brief Разбирает список клиентов из команды PEERS
+     * @param message Строка "id@адрес:порт" через ';'
+     * @param self_id ID этого клиента (исключается из списка)
+     * @return Список клиентов
+     */
+    static std::vector<PeerInfo> parse_peers(const std::string &message, uint64_t self_id);
+
+private:
+    /**
+     * @brief Запускает асинхронный приём очередного соединения
+     */
+    void accept_next();
+
+    /**
+     * @brief Обслуживает одного вора: отдаёт задачи и ждёт их результаты
+     */
+    void serve_thief(std::shared_ptr<tcp::socket> socket);
+
+    StealHandler on_steal_;
+
+    boost::asio::io_context io_context_;
+    std::unique_ptr<tcp::acceptor> acceptor_;
+    // Поток, выполняющий io_context_ (только приём соединений)
+    std::thread accept_thread_;
+
+    /**
+     * @struct Connection
+     * @brief Соединение с вором и обслуживающий его поток
+     */
+    struct Connection
+    {
+        std::shared_ptr<tcp::socket> socket;
+        std::thread thread;
+        // Выставляется потоком соединения при завершении
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+
+    // Соединения с ворами
+    std::mutex connections_mutex_;
+    std::vector<Connection> connections_;
+    bool stopped_ = false;
+
+    // Известные клиенты
+    mutable std::mutex peers_mutex_;
+    std::vector<PeerInfo> peers_;
+    // Индекс клиента для следующей попытки кражи
+    size_t next_peer_ = 0;
+};
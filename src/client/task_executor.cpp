@@ -37,6 +37,7 @@ Result TaskExecutor::execute_single_task(const Task &task)
             LOG_ERROR("Task {} is invalid", task.id);
             Result result;
             result.task_id = task.id;
+            result.job_id = task.job_id;
             result.value = 0.0;
             result.success = false;
             result.error_message = "Invalid task parameters";
@@ -64,6 +65,7 @@ Result TaskExecutor::execute_single_task(const Task &task)
 
         Result result;
         result.task_id = task.id;
+        result.job_id = task.job_id;
         result.value = 0.0;
         result.success = false;
         result.error_message = std::string("Exception: ") + e.what();
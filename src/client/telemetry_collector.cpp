@@ -0,0 +1,147 @@
+#include "telemetry_collector.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cstdlib>
+#endif
+
+namespace
+{
+    /**
+     * @brief Средняя загрузка за минуту
+     */
+    double read_load_average()
+    {
+#if defined(__linux__) || defined(__APPLE__)
+        double load[1] = {0.0};
+        if (getloadavg(load, 1) == 1)
+        {
+            return load[0];
+        }
+#endif
+        return 0.0;
+    }
+
+    /**
+     * @brief Средняя текущая частота ядер, МГц
+     */
+    double read_cpu_mhz()
+    {
+#ifdef __linux__
+        // Поле "cpu MHz" отражает текущую частоту каждого ядра
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        double total = 0.0;
+        size_t count = 0;
+        while (std::getline(cpuinfo, line))
+        {
+            if (line.rfind("cpu MHz", 0) != 0)
+            {
+                continue;
+            }
+
+            auto colon = line.find(':');
+            if (colon != std::string::npos)
+            {
+                total += std::atof(line.c_str() + colon + 1);
+                count++;
+            }
+        }
+        return count > 0 ? total / static_cast<double>(count) : 0.0;
+#else
+        return 0.0;
+#endif
+    }
+} // namespace
+
+ClientTelemetry TelemetryCollector::collect(const std::vector<Task> &tasks,
+                                            const std::vector<Result> &results,
+                                            double elapsed_seconds,
+                                            uint32_t worker_threads)
+{
+    ClientTelemetry telemetry;
+
+    if (elapsed_seconds > 0.0)
+    {
+        telemetry.evals_per_second = static_cast<double>(count_evaluations(tasks, results)) / elapsed_seconds;
+    }
+    // Пакет из меньшего числа задач занимает меньше потоков
+    telemetry.worker_threads = std::min<uint32_t>(worker_threads, static_cast<uint32_t>(tasks.size()));
+    telemetry.steal_fraction = read_steal_fraction();
+    telemetry.load_average = read_load_average();
+    telemetry.cpu_mhz = read_cpu_mhz();
+
+    return telemetry;
+}
+
+uint64_t TelemetryCollector::count_evaluations(const std::vector<Task> &tasks,
+                                               const std::vector<Result> &results)
+{
+    uint64_t evaluations = 0;
+    size_t count = std::min(tasks.size(), results.size());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Task &task = tasks[i];
+        const Result &result = results[i];
+        if (!result.success || task.step <= 0.0)
+        {
+            continue;
+        }
+
+        double end = result.partial ? result.end : task.end;
+        if (end > task.begin)
+        {
+            evaluations += static_cast<uint64_t>(std::ceil((end - task.begin) / task.step)) + 1;
+        }
+    }
+
+    return evaluations;
+}
+
+double TelemetryCollector::read_steal_fraction()
+{
+#ifdef __linux__
+    // Первая строка: cpu user nice system idle iowait irq softirq steal ...
+    std::ifstream stat("/proc/stat");
+    std::string line;
+    if (!std::getline(stat, line) || line.rfind("cpu ", 0) != 0)
+    {
+        return 0.0;
+    }
+
+    std::istringstream iss(line.substr(4));
+    uint64_t ticks[8] = {};
+    for (auto &value : ticks)
+    {
+        if (!(iss >> value))
+        {
+            return 0.0;
+        }
+    }
+
+    uint64_t total = 0;
+    for (auto value : ticks)
+    {
+        total += value;
+    }
+    uint64_t steal = ticks[7];
+
+    double fraction = 0.0;
+    if (last_total_ticks_ > 0 && total > last_total_ticks_)
+    {
+        fraction = static_cast<double>(steal - last_steal_ticks_) /
+                   static_cast<double>(total - last_total_ticks_);
+    }
+
+    last_total_ticks_ = total;
+    last_steal_ticks_ = steal;
+    return std::clamp(fraction, 0.0, 1.0);
+#else
+    return 0.0;
+#endif
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "messages.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file telemetry_collector.h
+ * @brief Модуль сбора наблюдаемой производительности клиента
+ */
+
+/**
+ * @class TelemetryCollector
+ * @brief Формирует отчёт ClientTelemetry для очередного пакета результатов
+ *
+ * Скорость вычислений измеряется по фактически выполненным пакетам, поэтому
+ * учитывает и соседние нагрузки на машине, и снижение частоты при перегреве.
+ * Steal time считается как приращение счётчиков /proc/stat с прошлого отчёта.
+ * На платформах без /proc недоступные показатели остаются нулевыми
+ */
+class TelemetryCollector
+{
+public:
+    TelemetryCollector() = default;
+
+    /**
+     * @brief Формирует отчёт о выполненном пакете
+     * @param tasks Задачи пакета
+     * @param results Результаты задач (в том же порядке)
+     * @param elapsed_seconds Время выполнения пакета
+     * @param worker_threads Число рабочих потоков
+     * @return Отчёт для отправки серверу
+     */
+    ClientTelemetry collect(const std::vector<Task> &tasks,
+                            const std::vector<Result> &results,
+                            double elapsed_seconds,
+                            uint32_t worker_threads);
+
+    /**
+     * @brief Считает выполненные вычисления функции
+     *
+     * Для прерванной задачи учитывается только вычисленная часть отрезка
+     *
+     * @param tasks Задачи пакета
+     * @param results Результаты задач (в том же порядке)
+     * @return Число вычислений подынтегральной функции
+     */
+    static uint64_t count_evaluations(const std::vector<Task> &tasks,
+                                      const std::vector<Result> &results);
+
+private:
+    /**
+     * @brief Считает долю steal time с прошлого вызова
+     * @return Доля 0..1 (0 при первом вызове или недоступном /proc/stat)
+     */
+    double read_steal_fraction();
+
+    // Счётчики /proc/stat на момент прошлого отчёта
+    uint64_t last_total_ticks_ = 0;
+    uint64_t last_steal_ticks_ = 0;
+};
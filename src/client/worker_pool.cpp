@@ -18,10 +18,11 @@ WorkerPool::WorkerPool(uint32_t num_threads, std::shared_ptr<Integrator> integra
     }
 
     LOG_INFO("WorkerPool created with {} threads, method: {}",
-             num_threads_, integrator_->get_current_method());
+             num_threads, integrator_->get_current_method());
 }
 
-std::vector<Result> WorkerPool::execute_tasks_parallel(const std::vector<Task> &tasks)
+std::vector<Result> WorkerPool::execute_tasks_parallel(const std::vector<Task> &tasks,
+                                                       const BatchCancellation *cancellation)
 {
     if (tasks.empty())
     {
@@ -29,8 +30,11 @@ std::vector<Result> WorkerPool::execute_tasks_parallel(const std::vector<Task> &
         return {};
     }
 
+    // Число потоков фиксируется на время пакета
+    const uint32_t num_threads = num_threads_.load();
+
     LOG_INFO("Starting parallel execution of {} tasks on {} threads...",
-             tasks.size(), num_threads_);
+             tasks.size(), num_threads);
 
     // Подготовка результатов
     std::vector<Result> results(tasks.size());
@@ -41,9 +45,9 @@ std::vector<Result> WorkerPool::execute_tasks_parallel(const std::vector<Task> &
 
     // Создание и запуск потоков
     std::vector<std::thread> workers;
-    workers.reserve(num_threads_);
+    workers.reserve(num_threads);
 
-    for (uint32_t i = 0; i < num_threads_; ++i)
+    for (uint32_t i = 0; i < num_threads; ++i)
     {
         workers.emplace_back(
             &WorkerPool::worker_function,
@@ -51,7 +55,8 @@ std::vector<Result> WorkerPool::execute_tasks_parallel(const std::vector<Task> &
             std::cref(tasks),
             std::ref(results),
             std::ref(task_index),
-            std::ref(index_mutex));
+            std::ref(index_mutex),
+            cancellation);
     }
 
     // Ожидание завершения всех потоков
@@ -65,30 +70,50 @@ std::vector<Result> WorkerPool::execute_tasks_parallel(const std::vector<Task> &
 
     // Подсчёт статистики
     size_t successful = 0;
+    size_t interrupted = 0;
     for (const auto &result : results)
     {
         if (result.success)
         {
             successful++;
+            if (result.partial)
+            {
+                interrupted++;
+            }
         }
     }
 
-    LOG_INFO("Parallel execution completed: {} successful, {} failed",
-             successful, tasks.size() - successful);
+    LOG_INFO("Parallel execution completed: {} successful ({} interrupted), {} failed",
+             successful, interrupted, tasks.size() - successful);
 
     return results;
 }
 
 uint32_t WorkerPool::get_num_threads() const
 {
-    return num_threads_;
+    return num_threads_.load();
+}
+
+void WorkerPool::set_num_threads(uint32_t num_threads)
+{
+    if (num_threads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be > 0");
+    }
+
+    uint32_t previous = num_threads_.exchange(num_threads);
+    if (previous != num_threads)
+    {
+        LOG_INFO("WorkerPool resized: {} -> {} threads", previous, num_threads);
+    }
 }
 
 void WorkerPool::worker_function(
     const std::vector<Task> &tasks,
     std::vector<Result> &results,
     size_t &task_index,
-    std::mutex &mutex)
+    std::mutex &mutex,
+    const BatchCancellation *cancellation)
 {
     std::thread::id thread_id = std::this_thread::get_id();
     LOG_DEBUG("Worker thread {} started", 
@@ -122,6 +147,7 @@ void WorkerPool::worker_function(
             {
                 Result result;
                 result.task_id = task.id;
+                result.job_id = task.job_id;
                 result.value = 0.0;
                 result.success = false;
                 result.error_message = "Invalid task parameters";
@@ -130,7 +156,10 @@ void WorkerPool::worker_function(
             }
 
             // Выполнение интегрирования
-            Result result = integrator_->execute_task(task);
+            const CancellationToken &token = cancellation
+                                                 ? cancellation->token_for(task.job_id)
+                                                 : CancellationToken::none();
+            Result result = integrator_->execute_task(task, token);
             results[current_index] = result;
 
             if (result.success)
@@ -154,6 +183,7 @@ void WorkerPool::worker_function(
 
             Result result;
             result.task_id = task.id;
+            result.job_id = task.job_id;
             result.value = 0.0;
             result.success = false;
             result.error_message = std::string("Exception: ") + e.what();
@@ -2,6 +2,8 @@
 
 #include "messages.h"
 #include "integrator.h"
+#include "batch_cancellation.h"
+#include <atomic>
 #include <vector>
 #include <thread>
 #include <mutex>
@@ -44,9 +46,11 @@ public:
     /**
      * @brief Выполняет задачи параллельно на всех потоках
      * @param tasks Вектор задач для выполнения
+     * @param cancellation Флаги отмены заданий пакета (nullptr - без отмены)
      * @return Вектор результатов в том же порядке, что и задачи
      */
-    std::vector<Result> execute_tasks_parallel(const std::vector<Task> &tasks);
+    std::vector<Result> execute_tasks_parallel(const std::vector<Task> &tasks,
+                                               const BatchCancellation *cancellation = nullptr);
 
     /**
      * @brief Возвращает количество потоков в пуле
@@ -54,6 +58,17 @@ public:
      */
     uint32_t get_num_threads() const;
 
+    /**
+     * @brief Изменяет количество потоков
+     *
+     * Потоки создаются на время одного пакета, поэтому новое значение
+     * применяется со следующего вызова execute_tasks_parallel()
+     *
+     * @param num_threads Количество рабочих потоков
+     * @throws std::invalid_argument если num_threads == 0
+     */
+    void set_num_threads(uint32_t num_threads);
+
 private:
     /**
      * @brief Функция-работник для потока
@@ -61,15 +76,17 @@ private:
      * @param results Ссылка на вектор результатов
      * @param task_index Ссылка на текущий индекс задачи
      * @param mutex Мьютекс для синхронизации доступа
+     * @param cancellation Флаги отмены заданий пакета (может быть nullptr)
      */
     void worker_function(
         const std::vector<Task> &tasks,
         std::vector<Result> &results,
         size_t &task_index,
-        std::mutex &mutex);
+        std::mutex &mutex,
+        const BatchCancellation *cancellation);
 
     // Количество рабочих потоков
-    uint32_t num_threads_;
+    std::atomic<uint32_t> num_threads_;
     // Интегратор для вычислений
     std::shared_ptr<Integrator> integrator_;
 };
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/**
+ * @file exact_sum.h
+ * @brief Точное суммирование чисел с плавающей точкой
+ */
+
+/**
+ * @class ExactSum
+ * @brief Сумма без ошибок округления (алгоритм Шевчука)
+ *
+ * Сумма хранится как набор неперекрывающихся double, сумма которых
+ * точно равна сумме слагаемых. value() округляет её один раз, поэтому
+ * результат не зависит от порядка слагаемых: частичные суммы, пришедшие
+ * от клиентов в любом порядке, дают одно и то же значение.
+ *
+ * @note Требует строгой арифметики IEEE 754 (без -ffast-math)
+ */
+class ExactSum
+{
+public:
+    /**
+     * @brief Добавляет слагаемое
+     */
+    void add(double x)
+    {
+        if (!std::isfinite(x))
+        {
+            // Бесконечности и NaN не представимы частями: суммируются отдельно
+            non_finite_ += x;
+            return;
+        }
+
+        size_t count = 0;
+        for (double y : partials_)
+        {
+            if (std::abs(x) < std::abs(y))
+            {
+                std::swap(x, y);
+            }
+            double hi = x + y;
+            double lo = y - (hi - x);
+            if (lo != 0.0)
+            {
+                partials_[count++] = lo;
+            }
+            x = hi;
+        }
+        partials_.resize(count);
+        partials_.push_back(x);
+    }
+
+    /**
+     * @brief Добавляет другую сумму
+     */
+    void add(const ExactSum &other)
+    {
+        for (double partial : other.partials_)
+        {
+            add(partial);
+        }
+        non_finite_ += other.non_finite_;
+    }
+
+    /**
+     * @brief Сумма, округлённая до ближайшего double
+     */
+    double value() const
+    {
+        if (non_finite_ != 0.0)
+        {
+            return non_finite_;
+        }
+        if (partials_.empty())
+        {
+            return 0.0;
+        }
+
+        // Части упорядочены по возрастанию: складываем от старшей, пока сумма точна
+        size_t n = partials_.size() - 1;
+        double hi = partials_[n];
+        double lo = 0.0;
+        while (n > 0)
+        {
+            double x = hi;
+            double y = partials_[--n];
+            hi = x + y;
+            lo = y - (hi - x);
+            if (lo != 0.0)
+            {
+                break;
+            }
+        }
+
+        // Поправка округления к чётному, если остаток ровно половина младшего разряда
+        if (n > 0 && ((lo < 0.0 && partials_[n - 1] < 0.0) || (lo > 0.0 && partials_[n - 1] > 0.0)))
+        {
+            double y = lo * 2.0;
+            double x = hi + y;
+            if (y == x - hi)
+            {
+                hi = x;
+            }
+        }
+        return hi;
+    }
+
+private:
+    // Неперекрывающиеся части суммы по возрастанию модуля
+    std::vector<double> partials_;
+    // Сумма бесконечных и неопределённых слагаемых
+    double non_finite_ = 0.0;
+};
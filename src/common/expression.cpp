@@ -0,0 +1,844 @@
+#include "expression.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <initializer_list>
+#include <iterator>
+#include <locale>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    using namespace expression;
+
+    // Наибольшее число интервальных оценок при проверке области определения
+    constexpr size_t MAX_DOMAIN_EVALUATIONS = 4096;
+
+    /**
+     * @brief Число операндов инструкции
+     */
+    int operand_count(OpCode op)
+    {
+        switch (op)
+        {
+        case OP_X:
+        case OP_CONST:
+            return 0;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_POW:
+            return 2;
+        default:
+            return 1;
+        }
+    }
+
+    /**
+     * @brief a^n для целого n умножениями
+     */
+    inline double power_int(double a, int32_t n)
+    {
+        uint32_t m = static_cast<uint32_t>(n < 0 ? -n : n);
+        double result = 1.0;
+        while (m != 0)
+        {
+            if (m & 1)
+            {
+                result *= a;
+            }
+            a *= a;
+            m >>= 1;
+        }
+        return n < 0 ? 1.0 / result : result;
+    }
+
+    /**
+     * @brief Значение инструкции для скалярных операндов (свёртка констант)
+     */
+    double apply(OpCode op, int32_t arg, double a, double b)
+    {
+        switch (op)
+        {
+        case OP_ADD:
+            return a + b;
+        case OP_SUB:
+            return a - b;
+        case OP_MUL:
+            return a * b;
+        case OP_DIV:
+            return a / b;
+        case OP_POW:
+            return std::pow(a, b);
+        case OP_POWI:
+            return power_int(a, arg);
+        case OP_NEG:
+            return -a;
+        case OP_EXP:
+            return std::exp(a);
+        case OP_LOG:
+            return std::log(a);
+        case OP_SQRT:
+            return std::sqrt(a);
+        case OP_SIN:
+            return std::sin(a);
+        case OP_COS:
+            return std::cos(a);
+        case OP_ABS:
+            return std::abs(a);
+        default:
+            throw std::logic_error("Instruction has no scalar form");
+        }
+    }
+
+    /**
+     * @struct Node
+     * @brief Узел дерева разбора
+     */
+    struct Node
+    {
+        OpCode op = OP_CONST;
+        // Значение константы (OP_CONST)
+        double value = 0.0;
+        // Показатель (OP_POWI) или номер переменной (OP_X)
+        int32_t arg = 0;
+        std::unique_ptr<Node> left;
+        std::unique_ptr<Node> right;
+
+        bool is_constant() const { return op == OP_CONST; }
+    };
+
+    using NodePtr = std::unique_ptr<Node>;
+
+    NodePtr make_constant(double value)
+    {
+        auto node = std::make_unique<Node>();
+        node->op = OP_CONST;
+        node->value = value;
+        return node;
+    }
+
+    /**
+     * @brief Создаёт узел операции, сворачивая константные операнды
+     */
+    NodePtr make_operation(OpCode op, NodePtr left, NodePtr right = nullptr, int32_t arg = 0)
+    {
+        if (left->is_constant() && (!right || right->is_constant()))
+        {
+            double value = apply(op, arg, left->value, right ? right->value : 0.0);
+            if (std::isfinite(value))
+            {
+                return make_constant(value);
+            }
+        }
+
+        // Целая степень с константным показателем - умножениями
+        if (op == OP_POW && right->is_constant() && right->value == std::floor(right->value) &&
+            std::abs(right->value) <= MAX_INTEGER_POWER)
+        {
+            return make_operation(OP_POWI, std::move(left), nullptr, static_cast<int32_t>(right->value));
+        }
+
+        auto node = std::make_unique<Node>();
+        node->op = op;
+        node->arg = arg;
+        node->left = std::move(left);
+        node->right = std::move(right);
+        return node;
+    }
+
+    /**
+     * @class Parser
+     * @brief Разбор выражения рекурсивным спуском
+     *
+     * expr    := term (('+' | '-') term)*
+     * term    := unary (('*' | '/') unary)*
+     * unary   := ('-' | '+') unary | power
+     * power   := primary ('^' unary)?
+     * primary := number | variable | pi | e | name '(' expr ')' | '(' expr ')'
+     * variable := x | x1 | x2 | ...
+     */
+    class Parser
+    {
+    public:
+        explicit Parser(const std::string &source) : source_(source) {}
+
+        NodePtr parse()
+        {
+            NodePtr node = parse_expr();
+            skip_spaces();
+            if (position_ != source_.size())
+            {
+                fail("unexpected '" + std::string(1, source_[position_]) + "'");
+            }
+            return node;
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string &message) const
+        {
+            throw std::invalid_argument(message + " at position " + std::to_string(position_ + 1));
+        }
+
+        void skip_spaces()
+        {
+            while (position_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[position_])))
+            {
+                ++position_;
+            }
+        }
+
+        bool accept(char c)
+        {
+            skip_spaces();
+            if (position_ < source_.size() && source_[position_] == c)
+            {
+                ++position_;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if (!accept(c))
+            {
+                fail(std::string("expected '") + c + "'");
+            }
+        }
+
+        NodePtr parse_expr()
+        {
+            NodePtr node = parse_term();
+            while (true)
+            {
+                if (accept('+'))
+                {
+                    node = make_operation(OP_ADD, std::move(node), parse_term());
+                }
+                else if (accept('-'))
+                {
+                    node = make_operation(OP_SUB, std::move(node), parse_term());
+                }
+                else
+                {
+                    return node;
+                }
+            }
+        }
+
+        NodePtr parse_term()
+        {
+            NodePtr node = parse_unary();
+            while (true)
+            {
+                if (accept('*'))
+                {
+                    node = make_operation(OP_MUL, std::move(node), parse_unary());
+                }
+                else if (accept('/'))
+                {
+                    node = make_operation(OP_DIV, std::move(node), parse_unary());
+                }
+                else
+                {
+                    return node;
+                }
+            }
+        }
+
+        NodePtr parse_unary()
+        {
+            if (accept('-'))
+            {
+                return make_operation(OP_NEG, parse_unary());
+            }
+            if (accept('+'))
+            {
+                return parse_unary();
+            }
+            return parse_power();
+        }
+
+        NodePtr parse_power()
+        {
+            NodePtr node = parse_primary();
+            if (accept('^'))
+            {
+                node = make_operation(OP_POW, std::move(node), parse_unary());
+            }
+            return node;
+        }
+
+        NodePtr parse_primary()
+        {
+            skip_spaces();
+            if (position_ >= source_.size())
+            {
+                fail("unexpected end of expression");
+            }
+
+            char c = source_[position_];
+            if (accept('('))
+            {
+                NodePtr node = parse_expr();
+                expect(')');
+                return node;
+            }
+            if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+            {
+                return make_constant(parse_number());
+            }
+            if (std::isalpha(static_cast<unsigned char>(c)))
+            {
+                return parse_name();
+            }
+            fail("unexpected '" + std::string(1, c) + "'");
+        }
+
+        double parse_number()
+        {
+            // Разбор не зависит от локали процесса
+            std::istringstream iss(source_.substr(position_));
+            iss.imbue(std::locale::classic());
+            double value = 0.0;
+            if (!(iss >> value))
+            {
+                fail("invalid number");
+            }
+            position_ += iss.eof() ? source_.size() - position_ : static_cast<size_t>(iss.tellg());
+            return value;
+        }
+
+        NodePtr parse_name()
+        {
+            size_t start = position_;
+            while (position_ < source_.size() && std::isalnum(static_cast<unsigned char>(source_[position_])))
+            {
+                ++position_;
+            }
+            std::string name = source_.substr(start, position_ - start);
+
+            if (name[0] == 'x' && std::all_of(name.begin() + 1, name.end(), [](char c)
+                                               { return std::isdigit(static_cast<unsigned char>(c)); }))
+            {
+                // x - то же, что x1
+                unsigned long number = name.size() == 1 ? 1 : std::stoul(name.substr(1, 3));
+                if (number == 0 || number > MAX_VARIABLES || name.size() > 4)
+                {
+                    position_ = start;
+                    fail("variable '" + name + "' is out of range x1..x" + std::to_string(MAX_VARIABLES));
+                }
+
+                auto node = std::make_unique<Node>();
+                node->op = OP_X;
+                node->arg = static_cast<int32_t>(number - 1);
+                return node;
+            }
+            if (name == "pi")
+            {
+                return make_constant(3.14159265358979323846);
+            }
+            if (name == "e")
+            {
+                return make_constant(2.71828182845904523536);
+            }
+
+            OpCode op;
+            if (name == "exp")
+            {
+                op = OP_EXP;
+            }
+            else if (name == "log" || name == "ln")
+            {
+                op = OP_LOG;
+            }
+            else if (name == "sqrt")
+            {
+                op = OP_SQRT;
+            }
+            else if (name == "sin")
+            {
+                op = OP_SIN;
+            }
+            else if (name == "cos")
+            {
+                op = OP_COS;
+            }
+            else if (name == "abs")
+            {
+                op = OP_ABS;
+            }
+            else
+            {
+                position_ = start;
+                fail("unknown name '" + name + "'");
+            }
+
+            expect('(');
+            NodePtr argument = parse_expr();
+            expect(')');
+            return make_operation(op, std::move(argument));
+        }
+
+        const std::string &source_;
+        size_t position_ = 0;
+    };
+
+    /**
+     * @brief Записывает байткод узла (операнды, затем операция)
+     */
+    void emit(const Node &node, ExpressionTape &tape)
+    {
+        if (tape.code.size() >= MAX_TAPE_LENGTH)
+        {
+            throw std::invalid_argument("Expression is too long");
+        }
+
+        switch (node.op)
+        {
+        case OP_X:
+            tape.code.push_back(encode(OP_X, node.arg));
+            return;
+        case OP_CONST:
+            tape.code.push_back(encode(OP_CONST, static_cast<int32_t>(tape.constants.size())));
+            tape.constants.push_back(node.value);
+            return;
+        default:
+            emit(*node.left, tape);
+            if (node.right)
+            {
+                emit(*node.right, tape);
+            }
+            tape.code.push_back(encode(node.op, node.arg));
+            return;
+        }
+    }
+
+    /**
+     * @struct Interval
+     * @brief Отрезок значений подвыражения
+     */
+    struct Interval
+    {
+        double lo = 0.0;
+        double hi = 0.0;
+
+        bool contains_zero() const { return lo <= 0.0 && hi >= 0.0; }
+        bool is_finite() const { return std::isfinite(lo) && std::isfinite(hi); }
+    };
+
+    Interval span(std::initializer_list<double> values)
+    {
+        auto [lo, hi] = std::minmax(values);
+        return {lo, hi};
+    }
+
+    /**
+     * @brief Оценка степени с целым показателем
+     */
+    Interval power_int(const Interval &a, int32_t n)
+    {
+        if (n == 0)
+        {
+            return {1.0, 1.0};
+        }
+
+        uint32_t m = static_cast<uint32_t>(n < 0 ? -n : n);
+        Interval p = span({power_int(a.lo, static_cast<int32_t>(m)), power_int(a.hi, static_cast<int32_t>(m))});
+        if (m % 2 == 0 && a.contains_zero())
+        {
+            // Чётная степень отрезка, содержащего 0, достигает минимума в нуле
+            p.lo = 0.0;
+        }
+        if (n < 0)
+        {
+            p = {1.0 / p.hi, 1.0 / p.lo};
+        }
+        return p;
+    }
+
+    /**
+     * @brief Оценивает область значений выражения на параллелепипеде
+     * @param box Отрезки значений переменных
+     * @return false, если выражение может быть не определено или бесконечно
+     */
+    bool evaluate_interval(const ExpressionTape &tape, const std::vector<Interval> &box)
+    {
+        std::vector<Interval> stack;
+        stack.reserve(MAX_STACK_DEPTH);
+
+        for (uint32_t word : tape.code)
+        {
+            OpCode op = opcode(word);
+            Interval result;
+            Interval b = operand_count(op) == 2 ? stack.back() : Interval{};
+            if (operand_count(op) == 2)
+            {
+                stack.pop_back();
+            }
+            Interval a = operand_count(op) >= 1 ? stack.back() : Interval{};
+            if (operand_count(op) >= 1)
+            {
+                stack.pop_back();
+            }
+
+            switch (op)
+            {
+            case OP_X:
+                if (static_cast<size_t>(argument(word)) >= box.size())
+                {
+                    return false;
+                }
+                result = box[static_cast<size_t>(argument(word))];
+                break;
+            case OP_CONST:
+            {
+                double value = tape.constants[static_cast<size_t>(argument(word))];
+                result = {value, value};
+                break;
+            }
+            case OP_ADD:
+                result = {a.lo + b.lo, a.hi + b.hi};
+                break;
+            case OP_SUB:
+                result = {a.lo - b.hi, a.hi - b.lo};
+                break;
+            case OP_MUL:
+                result = span({a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi});
+                break;
+            case OP_DIV:
+                if (b.contains_zero())
+                {
+                    return false;
+                }
+                result = span({a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi});
+                break;
+            case OP_POW:
+                // Степень с нецелым показателем определена при положительном основании
+                // и монотонна по каждому аргументу
+                if (a.lo <= 0.0)
+                {
+                    return false;
+                }
+                result = span({std::pow(a.lo, b.lo), std::pow(a.lo, b.hi), std::pow(a.hi, b.lo), std::pow(a.hi, b.hi)});
+                break;
+            case OP_POWI:
+                if (argument(word) < 0 && a.contains_zero())
+                {
+                    return false;
+                }
+                result = power_int(a, argument(word));
+                break;
+            case OP_NEG:
+                result = {-a.hi, -a.lo};
+                break;
+            case OP_EXP:
+                result = {std::exp(a.lo), std::exp(a.hi)};
+                break;
+            case OP_LOG:
+                if (a.lo <= 0.0)
+                {
+                    return false;
+                }
+                result = {std::log(a.lo), std::log(a.hi)};
+                break;
+            case OP_SQRT:
+                if (a.lo < 0.0)
+                {
+                    return false;
+                }
+                result = {std::sqrt(a.lo), std::sqrt(a.hi)};
+                break;
+            case OP_SIN:
+            case OP_COS:
+                result = {-1.0, 1.0};
+                break;
+            case OP_ABS:
+                result = a.contains_zero() ? Interval{0.0, std::max(-a.lo, a.hi)}
+                                           : span({std::abs(a.lo), std::abs(a.hi)});
+                break;
+            default:
+                return false;
+            }
+
+            if (!result.is_finite())
+            {
+                return false;
+            }
+            stack.push_back(result);
+        }
+
+        return stack.size() == 1;
+    }
+} // namespace
+
+namespace expression
+{
+    ExpressionTape compile(const std::string &source)
+    {
+        if (source.size() > MAX_SOURCE_LENGTH)
+        {
+            throw std::invalid_argument("Expression is too long");
+        }
+
+        NodePtr root = Parser(source).parse();
+
+        ExpressionTape tape;
+        std::remove_copy_if(source.begin(), source.end(), std::back_inserter(tape.source),
+                            [](char c)
+                            { return std::isspace(static_cast<unsigned char>(c)); });
+        emit(*root, tape);
+        verify(tape);
+        return tape;
+    }
+
+    uint32_t verify(const ExpressionTape &tape)
+    {
+        if (tape.code.empty() || tape.code.size() > MAX_TAPE_LENGTH)
+        {
+            throw std::invalid_argument("Expression tape is empty or too long");
+        }
+
+        uint32_t depth = 0;
+        uint32_t max_depth = 0;
+        for (uint32_t word : tape.code)
+        {
+            OpCode op = opcode(word);
+            if (op >= OP_COUNT)
+            {
+                throw std::invalid_argument("Unknown instruction in expression tape");
+            }
+            if (op == OP_CONST && (argument(word) < 0 || static_cast<size_t>(argument(word)) >= tape.constants.size()))
+            {
+                throw std::invalid_argument("Constant index out of range in expression tape");
+            }
+            if (op == OP_X && (argument(word) < 0 || static_cast<uint32_t>(argument(word)) >= MAX_VARIABLES))
+            {
+                throw std::invalid_argument("Variable index out of range in expression tape");
+            }
+            if (op == OP_POWI && std::abs(argument(word)) > MAX_INTEGER_POWER)
+            {
+                throw std::invalid_argument("Integer power out of range in expression tape");
+            }
+
+            int operands = operand_count(op);
+            if (depth < static_cast<uint32_t>(operands))
+            {
+                throw std::invalid_argument("Stack underflow in expression tape");
+            }
+            depth = depth - operands + 1;
+            max_depth = std::max(max_depth, depth);
+            if (max_depth > MAX_STACK_DEPTH)
+            {
+                throw std::invalid_argument("Expression is too deeply nested");
+            }
+        }
+
+        if (depth != 1)
+        {
+            throw std::invalid_argument("Expression tape leaves " + std::to_string(depth) + " values");
+        }
+        return max_depth;
+    }
+
+    uint32_t variable_count(const ExpressionTape &tape)
+    {
+        uint32_t count = 0;
+        for (uint32_t word : tape.code)
+        {
+            if (opcode(word) == OP_X)
+            {
+                count = std::max(count, static_cast<uint32_t>(argument(word)) + 1);
+            }
+        }
+        return count;
+    }
+
+    bool is_valid_domain(const ExpressionTape &tape, double lower, double upper)
+    {
+        return is_valid_domain(tape, std::vector<double>{lower}, std::vector<double>{upper});
+    }
+
+    bool is_valid_domain(const ExpressionTape &tape, const std::vector<double> &lower, const std::vector<double> &upper)
+    {
+        try
+        {
+            verify(tape);
+        }
+        catch (const std::invalid_argument &)
+        {
+            return false;
+        }
+
+        if (lower.empty() || lower.size() != upper.size() || variable_count(tape) > lower.size())
+        {
+            return false;
+        }
+
+        std::vector<Interval> box;
+        for (size_t i = 0; i < lower.size(); ++i)
+        {
+            if (!std::isfinite(lower[i]) || !std::isfinite(upper[i]) || lower[i] >= upper[i])
+            {
+                return false;
+            }
+            box.push_back({lower[i], upper[i]});
+        }
+
+        // Части области, корректность на которых ещё не доказана
+        std::vector<std::vector<Interval>> boxes{box};
+        size_t evaluations = 0;
+        while (!boxes.empty())
+        {
+            std::vector<Interval> part = std::move(boxes.back());
+            boxes.pop_back();
+
+            if (evaluate_interval(tape, part))
+            {
+                continue;
+            }
+            if (++evaluations > MAX_DOMAIN_EVALUATIONS)
+            {
+                return false;
+            }
+
+            // Оценка на меньшей части точнее: делим пополам сторону, самую широкую относительно области
+            size_t widest = 0;
+            for (size_t i = 1; i < part.size(); ++i)
+            {
+                if ((part[i].hi - part[i].lo) * (box[widest].hi - box[widest].lo) >
+                    (part[widest].hi - part[widest].lo) * (box[i].hi - box[i].lo))
+                {
+                    widest = i;
+                }
+            }
+
+            double middle = part[widest].lo + (part[widest].hi - part[widest].lo) / 2.0;
+            std::vector<Interval> left = part;
+            left[widest].hi = middle;
+            part[widest].lo = middle;
+            boxes.push_back(std::move(left));
+            boxes.push_back(std::move(part));
+        }
+        return true;
+    }
+
+    Interpreter::Interpreter(const ExpressionTape &tape)
+        : code_(tape.code),
+          constants_(tape.constants),
+          stack_(static_cast<size_t>(verify(tape)) * BLOCK_SIZE)
+    {
+    }
+
+    double Interpreter::evaluate(double x) const
+    {
+        double y = 0.0;
+        evaluate_block(&x, &y, 1);
+        return y;
+    }
+
+    void Interpreter::evaluate_block(const double *x, double *y, size_t count) const
+    {
+        // Все переменные читаются из x: у выражения от x она одна
+        evaluate_points(x, 0, y, count);
+    }
+
+    void Interpreter::evaluate_points(const double *points, size_t stride, double *y, size_t count) const
+    {
+        for (size_t offset = 0; offset < count; offset += BLOCK_SIZE)
+        {
+            const size_t n = std::min(BLOCK_SIZE, count - offset);
+
+            // Уровень стека - блок из BLOCK_SIZE значений
+            double *stack = stack_.data();
+            size_t depth = 0;
+
+            for (uint32_t word : code_)
+            {
+                // Верхний уровень и уровень под ним (для бинарных операций)
+                double *top = depth > 0 ? stack + (depth - 1) * BLOCK_SIZE : stack;
+                double *a = depth > 1 ? top - BLOCK_SIZE : stack;
+                switch (opcode(word))
+                {
+                case OP_X:
+                {
+                    const double *xs = points + static_cast<size_t>(argument(word)) * stride + offset;
+                    std::copy(xs, xs + n, stack + depth++ * BLOCK_SIZE);
+                    break;
+                }
+                case OP_CONST:
+                    std::fill_n(stack + depth++ * BLOCK_SIZE, n, constants_[static_cast<size_t>(argument(word))]);
+                    break;
+                case OP_ADD:
+                    for (size_t j = 0; j < n; ++j)
+                        a[j] += top[j];
+                    --depth;
+                    break;
+                case OP_SUB:
+                    for (size_t j = 0; j < n; ++j)
+                        a[j] -= top[j];
+                    --depth;
+                    break;
+                case OP_MUL:
+                    for (size_t j = 0; j < n; ++j)
+                        a[j] *= top[j];
+                    --depth;
+                    break;
+                case OP_DIV:
+                    for (size_t j = 0; j < n; ++j)
+                        a[j] /= top[j];
+                    --depth;
+                    break;
+                case OP_POW:
+                    for (size_t j = 0; j < n; ++j)
+                        a[j] = std::pow(a[j], top[j]);
+                    --depth;
+                    break;
+                case OP_POWI:
+                {
+                    const int32_t power = argument(word);
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = power_int(top[j], power);
+                    break;
+                }
+                case OP_NEG:
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = -top[j];
+                    break;
+                case OP_EXP:
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = std::exp(top[j]);
+                    break;
+                case OP_LOG:
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = std::log(top[j]);
+                    break;
+                case OP_SQRT:
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = std::sqrt(top[j]);
+                    break;
+                case OP_SIN:
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = std::sin(top[j]);
+                    break;
+                case OP_COS:
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = std::cos(top[j]);
+                    break;
+                case OP_ABS:
+                    for (size_t j = 0; j < n; ++j)
+                        top[j] = std::abs(top[j]);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            std::copy(stack, stack + n, y + offset);
+        }
+    }
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+/**
+ * @file expression.h
+ * @brief Подынтегральные функции, заданные выражением: компиляция в байткод и его интерпретатор
+ *
+ * Сервер разбирает выражение от x (например, "exp(-x)/log(x)^2") или от
+ * нескольких переменных x1, x2, ... (для многомерных заданий), проверяет
+ * его область определения на области интегрирования и передаёт клиентам
+ * байткод стековой машины. Клиент выполняет каждую инструкцию сразу над
+ * блоком точек: разбор инструкции приходится на сотни значений функции,
+ * а внутренние циклы по блоку векторизуются компилятором
+ */
+
+namespace expression
+{
+    /**
+     * @enum OpCode
+     * @brief Инструкции стековой машины (младшие 8 бит слова байткода)
+     */
+    enum OpCode : uint8_t
+    {
+        // Положить переменную с номером arg (x и x1 - номер 0)
+        OP_X = 0,
+        // Положить constants[arg]
+        OP_CONST,
+        // Бинарные операции над двумя верхними значениями стека
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        // a^b с произвольным показателем
+        OP_POW,
+        // a^arg с целым показателем arg
+        OP_POWI,
+        // Унарные операции над верхним значением стека
+        OP_NEG,
+        OP_EXP,
+        OP_LOG,
+        OP_SQRT,
+        OP_SIN,
+        OP_COS,
+        OP_ABS,
+        // Количество инструкций
+        OP_COUNT
+    };
+
+    // Наибольшая длина исходного выражения
+    constexpr size_t MAX_SOURCE_LENGTH = 4096;
+    // Наибольшее число инструкций байткода
+    constexpr size_t MAX_TAPE_LENGTH = 1024;
+    // Наибольшая глубина стека
+    constexpr uint32_t MAX_STACK_DEPTH = 64;
+    // Наибольшее число переменных выражения
+    constexpr uint32_t MAX_VARIABLES = 32;
+    // Наибольший целый показатель, вычисляемый умножениями (OP_POWI)
+    constexpr int32_t MAX_INTEGER_POWER = 64;
+    // Количество точек, над которыми интерпретатор выполняет инструкцию за один проход
+    constexpr size_t BLOCK_SIZE = 256;
+
+    /**
+     * @brief Слово байткода: инструкция и её аргумент (24 бита со знаком)
+     */
+    constexpr uint32_t encode(OpCode op, int32_t arg = 0)
+    {
+        return static_cast<uint32_t>(op) | (static_cast<uint32_t>(arg) << 8);
+    }
+
+    constexpr OpCode opcode(uint32_t word)
+    {
+        return static_cast<OpCode>(word & 0xFF);
+    }
+
+    constexpr int32_t argument(uint32_t word)
+    {
+        // Арифметический сдвиг восстанавливает знак
+        return static_cast<int32_t>(word) >> 8;
+    }
+}
+
+/**
+ * @struct ExpressionTape
+ * @brief Скомпилированное выражение: байткод стековой машины и его константы
+ */
+struct ExpressionTape
+{
+    // Выражение без пробелов (для журнала и команды STATUS)
+    std::string source;
+    // Байткод (слова expression::encode)
+    std::vector<uint32_t> code;
+    // Константы, на которые ссылается OP_CONST
+    std::vector<double> constants;
+
+    bool empty() const { return code.empty(); }
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(
+            CEREAL_NVP(source),
+            CEREAL_NVP(code),
+            CEREAL_NVP(constants));
+    }
+};
+
+namespace expression
+{
+    /**
+     * @brief Компилирует выражение от x в байткод
+     *
+     * Поддерживаются числа, переменные x (то же, что x1), x1 ... x32, pi, e,
+     * операции + - * / ^ (^ правоассоциативна),
+     * унарный минус, скобки и функции exp, log (ln), sqrt, sin, cos, abs.
+     * Подвыражения из констант вычисляются при компиляции, а целые степени
+     * до MAX_INTEGER_POWER заменяются умножениями
+     *
+     * @param source Выражение, например "exp(-x)/log(x)^2"
+     * @return Байткод
+     * @throws std::invalid_argument если выражение некорректно или слишком велико
+     */
+    ExpressionTape compile(const std::string &source);
+
+    /**
+     * @brief Проверяет структуру байткода, полученного по сети
+     * @param tape Байткод
+     * @return Наибольшая глубина стека при выполнении
+     * @throws std::invalid_argument если байткод некорректен
+     */
+    uint32_t verify(const ExpressionTape &tape);
+
+    /**
+     * @brief Число переменных выражения (наибольший номер переменной + 1)
+     * @param tape Проверенный байткод
+     */
+    uint32_t variable_count(const ExpressionTape &tape);
+
+    /**
+     * @brief Проверяет, что выражение от x определено и конечно на всём отрезке
+     * @return true, если выражение определено на [lower, upper]
+     */
+    bool is_valid_domain(const ExpressionTape &tape, double lower, double upper);
+
+    /**
+     * @brief Проверяет, что выражение определено и конечно на всём параллелепипеде
+     *
+     * Область значений оценивается интервальной арифметикой: сначала на всей
+     * области, а если оценка не доказывает корректность - на её половинах,
+     * деля пополам самую широкую сторону. Проверка консервативна: выражение,
+     * корректность которого не удалось доказать за ограниченное число оценок,
+     * считается неопределённым
+     *
+     * @param tape Байткод
+     * @param lower Нижние границы по каждой переменной
+     * @param upper Верхние границы по каждой переменной
+     * @return true, если выражение определено на области, а все его переменные в ней заданы
+     */
+    bool is_valid_domain(const ExpressionTape &tape, const std::vector<double> &lower, const std::vector<double> &upper);
+
+    /**
+     * @class Interpreter
+     * @brief Выполняет байткод над блоками точек
+     *
+     * Каждая инструкция выполняется циклом по блоку из BLOCK_SIZE точек,
+     * стек хранит по блоку значений на уровень. Экземпляр содержит рабочий
+     * стек, поэтому каждому потоку нужен свой
+     */
+    class Interpreter
+    {
+    public:
+        /**
+         * @brief Конструктор
+         * @param tape Байткод (копируется)
+         * @throws std::invalid_argument если байткод некорректен
+         */
+        explicit Interpreter(const ExpressionTape &tape);
+
+        /**
+         * @brief Вычисляет значение выражения в точке
+         */
+        double evaluate(double x) const;
+
+        /**
+         * @brief Вычисляет y[i] = f(x[i]) для i в [0, count)
+         * @note Выражение должно зависеть только от x
+         */
+        void evaluate_block(const double *x, double *y, size_t count) const;
+
+        /**
+         * @brief Вычисляет значения в count точках многомерной области
+         *
+         * Координаты хранятся по переменным: переменная k точки i -
+         * points[k * stride + i]. Выражение не должно использовать переменных,
+         * которых в points нет
+         *
+         * @param points Координаты точек
+         * @param stride Расстояние между координатами соседних переменных
+         * @param y Значения функции (count элементов)
+         * @param count Количество точек
+         */
+        void evaluate_points(const double *points, size_t stride, double *y, size_t count) const;
+
+    private:
+        // Байткод
+        std::vector<uint32_t> code_;
+        // Константы
+        std::vector<double> constants_;
+        // Рабочий стек: глубина x BLOCK_SIZE значений
+        mutable std::vector<double> stack_;
+    };
+}
@@ -0,0 +1,548 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "expression.h"
+
+/**
+ * @file integrands.h
+ * @brief Реестр подынтегральных функций
+ *
+ * Все функции семейства содержат множитель 1/ln(x): они определены при
+ * x > 0 и имеют особенность в точке x = 1. Кроме них, функция может быть
+ * задана выражением, скомпилированным в байткод (expression.h), в том числе
+ * функцией нескольких переменных для многомерных заданий.
+ *
+ * Функция описывается структурой, которая создаётся из IntegrandSpec
+ * задачи и вычисляет значение в точке и значения в блоке точек, а её
+ * статический метод проверяет область определения. Методы интегрирования -
+ * шаблоны по такой структуре, поэтому для каждой функции компилятор создаёт
+ * свою версию цикла без косвенных вызовов и ветвлений по виду функции
+ */
+
+/**
+ * @enum IntegrandId
+ * @brief Идентификатор подынтегральной функции (передаётся в задании и задачах)
+ */
+enum IntegrandId : uint32_t
+{
+    // 1/ln(x)
+    INTEGRAND_INV_LOG = 0,
+    // 1/ln(x)^k
+    INTEGRAND_INV_LOG_POW = 1,
+    // x^s/ln(x)
+    INTEGRAND_POW_OVER_LOG = 2,
+    // e^{-x}/ln(x)
+    INTEGRAND_EXP_OVER_LOG = 3,
+    // Выражение, заданное пользователем (IntegrandSpec::expression)
+    INTEGRAND_EXPRESSION = 4
+};
+
+/**
+ * @brief Бит функции в наборе поддерживаемых функций (ProtocolCapabilities::integrands)
+ */
+constexpr uint32_t integrand_bit(uint32_t id)
+{
+    return id < 32 ? 1u << id : 0u;
+}
+
+/**
+ * @struct IntegrandSpec
+ * @brief Подынтегральная функция задания: ID из реестра и её параметры
+ */
+struct IntegrandSpec
+{
+    // ID функции (IntegrandId)
+    uint32_t id = INTEGRAND_INV_LOG;
+    // Параметр функции (k для 1/ln(x)^k, s для x^s/ln(x), у остальных не используется)
+    double parameter = 0.0;
+    // Байткод выражения (для INTEGRAND_EXPRESSION). Передаётся в TaskBatch отдельным списком
+    ExpressionTape expression;
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(
+            CEREAL_NVP(id),
+            CEREAL_NVP(parameter));
+    }
+};
+
+namespace integrands
+{
+    // Наименьшее допустимое расстояние от концов отрезка до особенности x = 1
+    constexpr double SINGULARITY_EPSILON = 1e-10;
+    // Допустимая относительная погрешность значения, вычисленного в float32 (PRECISION_SINGLE)
+    constexpr double SINGLE_PRECISION_TOLERANCE = 1e-6;
+
+    /**
+     * @brief Проверяет, что отрезок лежит в области x > 0 и не касается x = 1
+     */
+    inline bool avoids_singularity(double lower, double upper)
+    {
+        // Нижний предел должен быть положительным
+        bool result = lower > 0.0;
+
+        // Интервал не должен содержать x = 1
+        result &= !(lower < 1.0 && upper > 1.0);
+        result &= !(std::abs(lower - 1.0) < SINGULARITY_EPSILON || std::abs(upper - 1.0) < SINGULARITY_EPSILON);
+
+        return result;
+    }
+
+    /**
+     * @brief Натуральный логарифм положительного нормализованного float32 без ветвлений
+     *
+     * x = 2^e * m, m приводится к [sqrt(1/2), sqrt(2)), ln(m) вычисляется
+     * многочленом (Cephes logf, погрешность - несколько единиц младшего разряда).
+     * В отличие от std::log, цикл с этой функцией векторизуется компилятором
+     */
+    inline float log_single(float x)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        int32_t exponent = static_cast<int32_t>(bits >> 23) - 127;
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+
+        // m в [1, 2): при m > sqrt(2) берётся m / 2 и порядок на единицу больше
+        // (целочисленно, чтобы в цикле не было ветвлений)
+        const uint32_t high = static_cast<uint32_t>(bits > 0x3fb504f3u);
+        bits -= high << 23;
+        exponent += static_cast<int32_t>(high);
+
+        float m;
+        std::memcpy(&m, &bits, sizeof(m));
+        const float e = static_cast<float>(exponent);
+        const float f = m - 1.0f;
+        const float z = f * f;
+        float p = 7.0376836292e-2f;
+        p = p * f - 1.1514610310e-1f;
+        p = p * f + 1.1676998740e-1f;
+        p = p * f - 1.2420140846e-1f;
+        p = p * f + 1.4249322787e-1f;
+        p = p * f - 1.6668057665e-1f;
+        p = p * f + 2.0000714765e-1f;
+        p = p * f - 2.4999993993e-1f;
+        p = p * f + 3.3333331174e-1f;
+
+        // ln(2) = 0.693359375 - 2.12194440e-4 (старшая часть точна в float32)
+        float y = f * z * p - 2.12194440e-4f * e - 0.5f * z;
+        return f + y + 0.693359375f * e;
+    }
+
+    /**
+     * @struct BlockEvaluation
+     * @brief Вычисление функции в блоке точек
+     *
+     * Цикл без ветвлений и вызовов по указателю: компилятор раскрывает
+     * Derived::evaluate и векторизует цикл там, где это позволяют
+     * флаги сборки и математическая библиотека
+     */
+    template <class Derived>
+    struct BlockEvaluation
+    {
+        /**
+         * @brief Вычисляет y[i] = f(x[i]) для i в [0, count)
+         */
+        void evaluate_block(const double *x, double *y, size_t count) const
+        {
+            const Derived &self = static_cast<const Derived &>(*this);
+            for (size_t i = 0; i < count; ++i)
+            {
+                y[i] = self.evaluate(x[i]);
+            }
+        }
+
+        /**
+         * @brief Вычисляет значения в точках области (функция одной переменной - по первой координате)
+         */
+        void evaluate_points(const double *points, size_t, double *y, size_t count) const
+        {
+            static_cast<const Derived &>(*this).evaluate_block(points, y, count);
+        }
+
+        /**
+         * @brief Проверяет область определения на параллелепипеде (функция одной переменной - только на отрезке)
+         */
+        static bool is_valid_box(const std::vector<double> &lower, const std::vector<double> &upper,
+                                 const IntegrandSpec &spec)
+        {
+            return lower.size() == 1 && upper.size() == 1 && Derived::is_valid_domain(lower[0], upper[0], spec);
+        }
+    };
+
+    /**
+     * @struct InverseLog
+     * @brief 1/ln(x)
+     */
+    struct InverseLog : BlockEvaluation<InverseLog>
+    {
+        static constexpr IntegrandId ID = INTEGRAND_INV_LOG;
+        static constexpr const char *NAME = "inv_log";
+        static constexpr double DEFAULT_PARAMETER = 0.0;
+
+        explicit InverseLog(const IntegrandSpec &) {}
+
+        double evaluate(double x) const
+        {
+            return 1.0 / std::log(x);
+        }
+
+        float evaluate_single(float x) const
+        {
+            return 1.0f / log_single(x);
+        }
+
+        /**
+         * @brief Проверяет, что значение в float32 не хуже SINGLE_PRECISION_TOLERANCE
+         * @param x Точка, округлённая до float32 (вне диапазона float32 - бесконечность или 0)
+         *
+         * Округление x до float32 сдвигает ln(x) на величину до 2^-24, поэтому
+         * относительная погрешность 1/ln(x) - около 2^-24 * (3 + 1/|ln(x)|).
+         * Она не больше 1e-6 при |ln(x)| >= 0.073, что выполняется при |x - 1| >= 0.08
+         */
+        static bool is_single_accurate(float x)
+        {
+            // Без сокращённого вычисления: проверка векторизуется вместе с циклом блока
+            return (x >= std::numeric_limits<float>::min()) & (x <= std::numeric_limits<float>::max()) &
+                   (std::abs(x - 1.0f) >= 0.08f);
+        }
+
+        static bool is_valid_domain(double lower, double upper, const IntegrandSpec &)
+        {
+            return avoids_singularity(lower, upper);
+        }
+    };
+
+    /**
+     * @struct InverseLogPower
+     * @brief 1/ln(x)^k, параметр - показатель k
+     *
+     * При нецелом k степень отрицательного логарифма не определена,
+     * поэтому такие функции интегрируются только при x > 1
+     */
+    struct InverseLogPower : BlockEvaluation<InverseLogPower>
+    {
+        static constexpr IntegrandId ID = INTEGRAND_INV_LOG_POW;
+        static constexpr const char *NAME = "inv_log_pow";
+        static constexpr double DEFAULT_PARAMETER = 1.0;
+
+        explicit InverseLogPower(const IntegrandSpec &spec) : k_(spec.parameter) {}
+
+        double evaluate(double x) const
+        {
+            return 1.0 / std::pow(std::log(x), k_);
+        }
+
+        static bool is_valid_domain(double lower, double upper, const IntegrandSpec &spec)
+        {
+            double k = spec.parameter;
+            if (!std::isfinite(k) || !avoids_singularity(lower, upper))
+            {
+                return false;
+            }
+            return k == std::floor(k) || lower > 1.0;
+        }
+
+    private:
+        // Показатель степени
+        double k_;
+    };
+
+    /**
+     * @struct PowerOverLog
+     * @brief x^s/ln(x), параметр - показатель s
+     */
+    struct PowerOverLog : BlockEvaluation<PowerOverLog>
+    {
+        static constexpr IntegrandId ID = INTEGRAND_POW_OVER_LOG;
+        static constexpr const char *NAME = "pow_over_log";
+        static constexpr double DEFAULT_PARAMETER = 0.0;
+
+        explicit PowerOverLog(const IntegrandSpec &spec) : s_(spec.parameter) {}
+
+        double evaluate(double x) const
+        {
+            return std::pow(x, s_) / std::log(x);
+        }
+
+        static bool is_valid_domain(double lower, double upper, const IntegrandSpec &spec)
+        {
+            return std::isfinite(spec.parameter) && avoids_singularity(lower, upper);
+        }
+
+    private:
+        // Показатель степени
+        double s_;
+    };
+
+    /**
+     * @struct ExpOverLog
+     * @brief e^{-x}/ln(x)
+     */
+    struct ExpOverLog : BlockEvaluation<ExpOverLog>
+    {
+        static constexpr IntegrandId ID = INTEGRAND_EXP_OVER_LOG;
+        static constexpr const char *NAME = "exp_over_log";
+        static constexpr double DEFAULT_PARAMETER = 0.0;
+
+        explicit ExpOverLog(const IntegrandSpec &) {}
+
+        double evaluate(double x) const
+        {
+            return std::exp(-x) / std::log(x);
+        }
+
+        static bool is_valid_domain(double lower, double upper, const IntegrandSpec &)
+        {
+            return avoids_singularity(lower, upper);
+        }
+    };
+
+    /**
+     * @struct Expression
+     * @brief Выражение, заданное пользователем и скомпилированное в байткод
+     *
+     * Вычисляется интерпретатором над блоками точек, поэтому экземпляр
+     * нельзя использовать из нескольких потоков одновременно
+     */
+    struct Expression
+    {
+        static constexpr IntegrandId ID = INTEGRAND_EXPRESSION;
+        static constexpr const char *NAME = "expression";
+        static constexpr double DEFAULT_PARAMETER = 0.0;
+
+        /**
+         * @throws std::invalid_argument если байткод некорректен
+         */
+        explicit Expression(const IntegrandSpec &spec) : interpreter_(spec.expression) {}
+
+        double evaluate(double x) const
+        {
+            return interpreter_.evaluate(x);
+        }
+
+        void evaluate_block(const double *x, double *y, size_t count) const
+        {
+            interpreter_.evaluate_block(x, y, count);
+        }
+
+        void evaluate_points(const double *points, size_t stride, double *y, size_t count) const
+        {
+            interpreter_.evaluate_points(points, stride, y, count);
+        }
+
+        static bool is_valid_domain(double lower, double upper, const IntegrandSpec &spec)
+        {
+            return expression::is_valid_domain(spec.expression, lower, upper);
+        }
+
+        static bool is_valid_box(const std::vector<double> &lower, const std::vector<double> &upper,
+                                 const IntegrandSpec &spec)
+        {
+            return expression::is_valid_domain(spec.expression, lower, upper);
+        }
+
+    private:
+        // Интерпретатор байткода
+        expression::Interpreter interpreter_;
+    };
+
+    /**
+     * @struct SinglePrecision
+     * @brief Функция Integrand, вычисляемая в float32 (PRECISION_SINGLE)
+     *
+     * Значения блока вычисляются в float32 циклом без ветвлений, после чего
+     * точки, в которых погрешность float32 превышает SINGLE_PRECISION_TOLERANCE
+     * (для 1/ln(x) - окрестность x = 1), пересчитываются в double. Результат
+     * остаётся double, поэтому суммирует его тот же накопитель, что и обычно
+     *
+     * @tparam Integrand Функция с методами evaluate_single() и is_single_accurate()
+     */
+    template <class Integrand>
+    struct SinglePrecision : Integrand
+    {
+        using Integrand::Integrand;
+
+        double evaluate(double x) const
+        {
+            const float single = static_cast<float>(x);
+            return Integrand::is_single_accurate(single) ? Integrand::evaluate_single(single) : Integrand::evaluate(x);
+        }
+
+        void evaluate_block(const double *x, double *y, size_t count) const
+        {
+            uint32_t inaccurate = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float single = static_cast<float>(x[i]);
+                y[i] = Integrand::evaluate_single(single);
+                inaccurate |= static_cast<uint32_t>(!Integrand::is_single_accurate(single));
+            }
+            if (inaccurate == 0)
+            {
+                return;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!Integrand::is_single_accurate(static_cast<float>(x[i])))
+                {
+                    y[i] = Integrand::evaluate(x[i]);
+                }
+            }
+        }
+
+        void evaluate_points(const double *points, size_t, double *y, size_t count) const
+        {
+            evaluate_block(points, y, count);
+        }
+    };
+
+    /**
+     * @brief Тег типа функции для visit()
+     */
+    template <class Integrand>
+    struct Type
+    {
+        using type = Integrand;
+    };
+
+    /**
+     * @brief Список типов функций
+     */
+    template <class... Integrands>
+    struct IntegrandList
+    {
+    };
+
+    // Все функции реестра: для каждой создаются свои версии методов интегрирования
+    using AllIntegrands = IntegrandList<InverseLog, InverseLogPower, PowerOverLog, ExpOverLog, Expression>;
+
+    // Функции, которые можно вычислять в float32 (SinglePrecision)
+    using SinglePrecisionIntegrands = IntegrandList<InverseLog>;
+
+    /**
+     * @brief Вызывает visitor(Type<Integrand>{}) для функции с заданным ID
+     * @return false, если функция неизвестна
+     */
+    template <class Visitor, class... Integrands>
+    bool visit(uint32_t id, Visitor &&visitor, IntegrandList<Integrands...>)
+    {
+        return ((Integrands::ID == id ? (visitor(Type<Integrands>{}), true) : false) || ...);
+    }
+
+    template <class Visitor>
+    bool visit(uint32_t id, Visitor &&visitor)
+    {
+        return visit(id, std::forward<Visitor>(visitor), AllIntegrands{});
+    }
+
+    /**
+     * @brief Можно ли вычислять функцию в float32 (PRECISION_SINGLE)
+     */
+    inline bool supports_single_precision(uint32_t id)
+    {
+        return visit(id, [](auto) {}, SinglePrecisionIntegrands{});
+    }
+
+    /**
+     * @brief Набор всех функций реестра (биты integrand_bit)
+     */
+    template <class... Integrands>
+    constexpr uint32_t all_bits(IntegrandList<Integrands...>)
+    {
+        return (integrand_bit(Integrands::ID) | ...);
+    }
+
+    constexpr uint32_t all_bits()
+    {
+        return all_bits(AllIntegrands{});
+    }
+
+    /**
+     * @brief Название функции для команд управления и журнала
+     * @return Название или "unknown"
+     */
+    inline std::string name(uint32_t id)
+    {
+        std::string result = "unknown";
+        visit(id, [&result](auto tag)
+              { result = decltype(tag)::type::NAME; });
+        return result;
+    }
+
+    /**
+     * @brief Функция по названию
+     * @param name Название, как его возвращает name()
+     * @return ID функции или std::nullopt, если название неизвестно
+     */
+    inline std::optional<uint32_t> from_name(const std::string &name)
+    {
+        for (uint32_t id = 0; id < 32; ++id)
+        {
+            if ((all_bits() & integrand_bit(id)) != 0 && integrands::name(id) == name)
+            {
+                return id;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Значение параметра функции, если он не задан
+     */
+    inline double default_parameter(uint32_t id)
+    {
+        double result = 0.0;
+        visit(id, [&result](auto tag)
+              { result = decltype(tag)::type::DEFAULT_PARAMETER; });
+        return result;
+    }
+
+    /**
+     * @brief Проверяет, что функция известна и определена на всём отрезке
+     */
+    inline bool is_valid_domain(const IntegrandSpec &spec, double lower, double upper)
+    {
+        bool result = false;
+        visit(spec.id, [&](auto tag)
+              { result = decltype(tag)::type::is_valid_domain(lower, upper, spec); });
+        return result;
+    }
+
+    /**
+     * @brief Значение функции в одной точке (вне горячих циклов: экземпляр создаётся при каждом вызове)
+     */
+    inline double evaluate(const IntegrandSpec &spec, double x)
+    {
+        double result = std::numeric_limits<double>::quiet_NaN();
+        visit(spec.id, [&](auto tag)
+              { result = typename decltype(tag)::type(spec).evaluate(x); });
+        return result;
+    }
+
+    /**
+     * @brief Проверяет, что функция известна и определена на всём параллелепипеде
+     * @param spec Функция
+     * @param lower Нижние границы по измерениям
+     * @param upper Верхние границы по измерениям
+     */
+    inline bool is_valid_box(const IntegrandSpec &spec, const std::vector<double> &lower, const std::vector<double> &upper)
+    {
+        bool result = false;
+        visit(spec.id, [&](auto tag)
+              { result = decltype(tag)::type::is_valid_box(lower, upper, spec); });
+        return result;
+    }
+}
@@ -1,6 +1,7 @@
 #include "logger.h"
 #include <spdlog/async.h>
 #include <filesystem>
+#include <mutex>
 #include <stdexcept>
 
 namespace logging
@@ -8,6 +9,8 @@ namespace logging
 
     // Глобальный логгер
     static std::shared_ptr<spdlog::logger> g_logger = nullptr;
+    // Защищает создание логгера в ensure_initialized()
+    static std::mutex g_init_mutex;
 
     void init(const std::string &app_name, spdlog::level::level_enum log_level)
     {
@@ -66,6 +69,23 @@ namespace logging
         return g_logger;
     }
 
+    void ensure_initialized(const std::string &app_name, spdlog::level::level_enum log_level)
+    {
+        std::lock_guard<std::mutex> lock(g_init_mutex);
+        if (g_logger)
+        {
+            return;
+        }
+
+        auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        console_sink->set_level(log_level);
+        console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%n] %v");
+
+        g_logger = std::make_shared<spdlog::logger>(app_name, console_sink);
+        g_logger->set_level(log_level);
+        g_logger->flush_on(spdlog::level::warn);
+    }
+
     void shutdown()
     {
         if (g_logger)
@@ -36,6 +36,17 @@ namespace logging
      */
     std::shared_ptr<spdlog::logger> get();
 
+    /**
+     * @brief Создаёт логгер, если приложение его не инициализировало
+     *
+     * Используется встраиваемой библиотекой: логгер приложения сохраняется,
+     * а без него создаётся логгер с выводом только в консоль (без файла)
+     *
+     * @param app_name Имя логгера
+     * @param log_level Уровень логирования
+     */
+    void ensure_initialized(const std::string &app_name, spdlog::level::level_enum log_level = spdlog::level::warn);
+
     /**
      * @brief Завершает работу логгера (flush и shutdown)
      *
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <cmath>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 #include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
 #include <cereal/types/vector.hpp>
 #include <cereal/types/string.hpp>
+#include "integrands.h"
 #include "systeminfo.h"
 
 /**
@@ -14,20 +17,238 @@
  * @brief Определение структур для обмена сообщениями между клиентом и сервером
  */
 
+/**
+ * @brief Сериализует поле, добавленное в конец сообщения в новой версии протокола
+ *
+ * Сообщение старой версии заканчивается раньше: при его чтении поле
+ * остаётся со значением по умолчанию. Лишние байты в конце сообщения
+ * старая версия не читает, поэтому такие поля совместимы в обе стороны
+ */
+template <class Archive, class T>
+void serialize_trailing(Archive &archive, T &value)
+{
+    archive(value);
+}
+
+template <class T>
+void serialize_trailing(cereal::BinaryInputArchive &archive, T &value)
+{
+    try
+    {
+        archive(value);
+    }
+    catch (const cereal::Exception &)
+    {
+        value = T{};
+    }
+}
+
+/**
+ * @enum IntegrationKernel
+ * @brief Методы интегрирования (биты ProtocolCapabilities::kernels)
+ *
+ * Значение также служит идентификатором метода задачи (Task::kernel)
+ */
+enum IntegrationKernel : uint32_t
+{
+    KERNEL_TRAPEZOIDAL = 1u << 0,
+    KERNEL_SIMPSON = 1u << 1,
+    // Квази-Монте-Карло по скремблированной последовательности Соболя (многомерные задания)
+    KERNEL_QMC = 1u << 2
+};
+
+/**
+ * @enum ReductionMode
+ * @brief Режимы суммирования результатов (биты ProtocolCapabilities::reduction_modes)
+ *
+ * Значение также задаёт накопитель задачи (Task::reduction). Режимы упорядочены
+ * по точности, и сторона, поддерживающая режим, поддерживает все предыдущие:
+ * согласованный ProtocolSettings::reduction_mode определяет все режимы клиента
+ */
+enum ReductionMode : uint32_t
+{
+    // Обычное суммирование в double
+    REDUCTION_PLAIN = 1u << 0,
+    // Компенсированное суммирование узлов (ошибки округления копятся отдельно)
+    REDUCTION_COMPENSATED = 1u << 1,
+    // Суммирование узлов в double-double, значение передаётся двумя частями (Result::value_low)
+    REDUCTION_DOUBLE_DOUBLE = 1u << 2
+};
+
+/**
+ * @enum EvaluationPrecision
+ * @brief Точность вычисления значений функции в узлах (Task::precision)
+ */
+enum EvaluationPrecision : uint32_t
+{
+    // Значения вычисляются в double
+    PRECISION_DOUBLE = 0,
+    // Значения вычисляются в float32 (около 7 знаков), а суммируются в double
+    // выбранным накопителем. В точках, где погрешность float32 больше допустимой,
+    // значение вычисляется в double
+    PRECISION_SINGLE = 1
+};
+
+/**
+ * @struct QmcSampling
+ * @brief Область интегрирования и скремблирование задачи квази-Монте-Карло
+ *
+ * Задание KERNEL_QMC усредняет функцию по replicas независимо скремблированным
+ * копиям последовательности Соболя. Задача вычисляет сумму значений и сумму
+ * их квадратов в точках [begin, end) одной копии: каждая точка вычисляется
+ * по своему номеру, поэтому задачи не зависят друг от друга
+ */
+struct QmcSampling
+{
+    // Наибольшее число измерений
+    static constexpr uint32_t MAX_DIMENSIONS = 21;
+    // Наибольшее число точек в одной реплике (разрядность последовательности - 32 бита)
+    static constexpr uint64_t MAX_POINTS = 1ull << 32;
+    // Наибольшее число реплик задания
+    static constexpr uint32_t MAX_REPLICAS = 64;
+
+    // Нижние границы области по измерениям
+    std::vector<double> lower;
+    // Верхние границы области по измерениям
+    std::vector<double> upper;
+    // Зерно скремблирования
+    uint64_t seed = 0;
+    // Номер реплики (у каждой реплики своё скремблирование)
+    uint32_t replica = 0;
+
+    uint32_t dimensions() const { return static_cast<uint32_t>(lower.size()); }
+
+    /**
+     * @brief Объём области интегрирования
+     */
+    double volume() const
+    {
+        double result = 1.0;
+        for (size_t i = 0; i < lower.size(); ++i)
+        {
+            result *= upper[i] - lower[i];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Проверяет размерность и границы области
+     */
+    bool is_valid() const
+    {
+        bool result = !lower.empty() && lower.size() <= MAX_DIMENSIONS && lower.size() == upper.size();
+        for (size_t i = 0; result && i < lower.size(); ++i)
+        {
+            result &= std::isfinite(lower[i]) && std::isfinite(upper[i]) && lower[i] < upper[i];
+        }
+        return result && std::isfinite(volume());
+    }
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(
+            CEREAL_NVP(lower),
+            CEREAL_NVP(upper),
+            CEREAL_NVP(seed),
+            CEREAL_NVP(replica));
+    }
+};
+
+/**
+ * @struct ScanGrid
+ * @brief Точки таблицы первообразной задания с префиксной суммой
+ *
+ * Точки таблицы - origin + k * interval. Границы задачи с таблицей совпадают
+ * с точками таблицы, а клиент возвращает интегралы от начала задачи до каждой
+ * следующей точки таблицы внутри задачи (Result::cumulative)
+ */
+struct ScanGrid
+{
+    // Наибольшее количество отрезков таблицы задания (8 ГиБ значений)
+    static constexpr uint64_t MAX_INTERVALS = 1ull << 30;
+    // Наибольшее количество точек таблицы в одной задаче
+    static constexpr uint64_t MAX_TASK_POINTS = 1ull << 20;
+
+    // Первая точка таблицы
+    double origin = 0.0;
+    // Расстояние между соседними точками таблицы (0 - задача без таблицы)
+    double interval = 0.0;
+
+    bool is_active() const { return interval > 0.0; }
+
+    /**
+     * @brief Точка таблицы с номером k
+     */
+    double point(uint64_t k) const
+    {
+        return origin + static_cast<double>(k) * interval;
+    }
+
+    /**
+     * @brief Номер ближайшей к x точки таблицы
+     */
+    uint64_t index(double x) const
+    {
+        return static_cast<uint64_t>(std::llround((x - origin) / interval));
+    }
+
+    /**
+     * @brief Проверяет, что x - точка таблицы
+     */
+    bool is_point(double x) const
+    {
+        return x >= origin && point(index(x)) == x;
+    }
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(
+            CEREAL_NVP(origin),
+            CEREAL_NVP(interval));
+    }
+};
+
 /**
  * @struct Task
  * @brief Задача численного интегрирования для клиента
+ *
+ * В задаче KERNEL_QMC begin и end - номера первой и следующей за последней
+ * точек последовательности Соболя, step = 1, а область задаёт sampling.
+ * У задачи с активной grid begin и end - точки таблицы первообразной
  */
 struct Task
 {
     // Уникальный ID задачи
     uint64_t id = 0;
+    // ID задания, к которому относится задача
+    uint64_t job_id = 0;
     // Нижний предел интегрирования
     double begin = 0.0;
     // Верхний предел интегрирования
     double end = 0.0;
     // Шаг интегрирования
     double step = 0.0;
+    // Метод интегрирования (IntegrationKernel, 0 - метод клиента по умолчанию).
+    // Передаётся в TaskBatch отдельным списком
+    uint32_t kernel = 0;
+    // Подынтегральная функция. Передаётся в TaskBatch отдельными списками
+    IntegrandSpec integrand{};
+    // Область и скремблирование (для KERNEL_QMC). Передаётся в TaskBatch отдельным списком
+    QmcSampling sampling{};
+    // Точки таблицы первообразной (для заданий с префиксной суммой). Передаётся в TaskBatch отдельным списком
+    ScanGrid grid{};
+    // Режим суммирования узлов (ReductionMode). Передаётся в TaskBatch отдельным списком
+    uint32_t reduction = REDUCTION_PLAIN;
+    // Точность вычисления значений функции (EvaluationPrecision). Передаётся в TaskBatch отдельным списком
+    uint32_t precision = PRECISION_DOUBLE;
 
     /**
      * @brief Проверяет корректность параметров задачи
@@ -35,19 +256,39 @@ struct Task
      */
     bool is_valid() const
     {
-        // ограничения для интегрирования 1/ln(x)
         bool result = true;
+
+        if (kernel == KERNEL_QMC)
+        {
+            // Номера точек - целые числа в пределах последовательности
+            result &= begin >= 0.0 && begin < end && end <= static_cast<double>(QmcSampling::MAX_POINTS);
+            result &= begin == std::floor(begin) && end == std::floor(end) && step == 1.0;
+
+            // Функция должна быть определена во всей области
+            result &= sampling.is_valid() && integrands::is_valid_box(integrand, sampling.lower, sampling.upper);
+
+            return result;
+        }
+
+        if (grid.is_active())
+        {
+            // Границы - точки таблицы, шаг может быть больше расстояния между точками
+            result &= std::isfinite(grid.origin) && std::isfinite(grid.interval);
+            result &= begin < end && step > 0.0 && grid.is_point(begin) && grid.is_point(end);
+            result &= grid.index(end) - grid.index(begin) <= ScanGrid::MAX_TASK_POINTS;
+
+            // Функция должна быть определена на всём отрезке
+            result &= integrands::is_valid_domain(integrand, begin, end);
+
+            return result;
+        }
         
         // Начало не может быть больше конца, шаг должен быть положительным
         // и быть меньше длины интегрируемого интервала
         result &= !(begin >= end || step <= 0.0 || step >= (end - begin));
 
-        // Нижний предел должен быть положительным
-        result &= !(begin <= 0.0);
-
-        // Интервал не должен содержать x = 1
-        result &= !(begin < 1.0 && end > 1.0);
-        result &= !(std::abs(begin - 1.0) < 1e-10 || std::abs(end - 1.0) < 1e-10);
+        // Функция должна быть определена на всём отрезке
+        result &= integrands::is_valid_domain(integrand, begin, end);
 
         return result;
     }
@@ -60,6 +301,7 @@ struct Task
     {
         archive(
             CEREAL_NVP(id),
+            CEREAL_NVP(job_id),
             CEREAL_NVP(begin),
             CEREAL_NVP(end),
             CEREAL_NVP(step));
@@ -74,12 +316,27 @@ struct Result
 {
     // ID задачи, к которой относится результат
     uint64_t task_id = 0;
+    // ID задания, к которому относится задача
+    uint64_t job_id = 0;
     // Вычисленное значение интеграла
     double value = 0.0;
     // Флаг успешного выполнения
     bool success = true;
     // Сообщение об ошибке, если !success
     std::string error_message;
+    // Задача прервана: value - интеграл только по [begin, end] задачи
+    bool partial = false;
+    // Правая граница вычисленной части (для частичного результата)
+    double end = 0.0;
+    // Сумма квадратов значений функции (для KERNEL_QMC, value - сумма значений).
+    // Передаётся в ResultBatch отдельным списком
+    double sum_squares = 0.0;
+    // Интегралы от начала задачи до каждой точки таблицы в (begin, end] вычисленной части
+    // (для задач с ScanGrid). Передаётся в ResultBatch отдельным списком
+    std::vector<double> cumulative;
+    // Младшая часть значения (для REDUCTION_DOUBLE_DOUBLE: интеграл равен value + value_low).
+    // Передаётся в ResultBatch отдельным списком
+    double value_low = 0.0;
 
     /**
      * @brief Метод сериализации для Cereal
@@ -89,9 +346,12 @@ struct Result
     {
         archive(
             CEREAL_NVP(task_id),
+            CEREAL_NVP(job_id),
             CEREAL_NVP(value),
             CEREAL_NVP(success),
-            CEREAL_NVP(error_message));
+            CEREAL_NVP(error_message),
+            CEREAL_NVP(partial),
+            CEREAL_NVP(end));
     }
 };
 
@@ -106,11 +366,165 @@ struct TaskBatch
 
     /**
      * @brief Метод сериализации для Cereal
+     *
+     * Методы, функции, выражения, области, таблицы, режимы суммирования и точности задач идут отдельными списками
+     * после задач: клиенты, которые их не поддерживают, списки не читают, а
+     * пакет без списков оставляет задачам метод по умолчанию и функцию 1/ln(x)
      */
     template <class Archive>
     void serialize(Archive &archive)
     {
         archive(CEREAL_NVP(tasks));
+
+        std::vector<uint32_t> kernels;
+        kernels.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            kernels.push_back(task.kernel);
+        }
+
+        serialize_trailing(archive, kernels);
+        if (kernels.size() == tasks.size())
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                tasks[i].kernel = kernels[i];
+            }
+        }
+
+        std::vector<IntegrandSpec> integrands;
+        integrands.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            integrands.push_back({task.integrand.id, task.integrand.parameter, {}});
+        }
+
+        serialize_trailing(archive, integrands);
+        if (integrands.size() == tasks.size())
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                tasks[i].integrand.id = integrands[i].id;
+                tasks[i].integrand.parameter = integrands[i].parameter;
+            }
+        }
+
+        std::vector<ExpressionTape> expressions;
+        expressions.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            expressions.push_back(task.integrand.expression);
+        }
+
+        serialize_trailing(archive, expressions);
+        if (expressions.size() == tasks.size())
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                tasks[i].integrand.expression = std::move(expressions[i]);
+            }
+        }
+
+        std::vector<QmcSampling> samplings;
+        samplings.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            samplings.push_back(task.sampling);
+        }
+
+        serialize_trailing(archive, samplings);
+        if (samplings.size() == tasks.size())
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                tasks[i].sampling = std::move(samplings[i]);
+            }
+        }
+
+        std::vector<ScanGrid> grids;
+        grids.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            grids.push_back(task.grid);
+        }
+
+        serialize_trailing(archive, grids);
+        if (grids.size() == tasks.size())
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                tasks[i].grid = grids[i];
+            }
+        }
+
+        std::vector<uint32_t> reductions;
+        reductions.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            reductions.push_back(task.reduction);
+        }
+
+        serialize_trailing(archive, reductions);
+        if (reductions.size() == tasks.size())
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                tasks[i].reduction = reductions[i];
+            }
+        }
+
+        std::vector<uint32_t> precisions;
+        precisions.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            precisions.push_back(task.precision);
+        }
+
+        serialize_trailing(archive, precisions);
+        if (precisions.size() == tasks.size())
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                tasks[i].precision = precisions[i];
+            }
+        }
+    }
+};
+
+/**
+ * @struct ClientTelemetry
+ * @brief Наблюдаемая производительность и загрузка машины клиента
+ *
+ * Отправляется с каждым пакетом результатов
+ */
+struct ClientTelemetry
+{
+    // Вычислений подынтегральной функции в секунду (за пакет, по всем потокам)
+    double evals_per_second = 0.0;
+    // Число рабочих потоков, выполнявших пакет
+    uint32_t worker_threads = 0;
+    // Доля времени CPU, отобранная гипервизором (steal) с прошлого отчёта, 0..1
+    double steal_fraction = 0.0;
+    // Средняя загрузка за минуту (load average)
+    double load_average = 0.0;
+    // Текущая частота CPU, МГц (0, если неизвестна)
+    double cpu_mhz = 0.0;
+    // Название метода интегрирования, которым выполнен пакет
+    std::string method;
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(
+            CEREAL_NVP(evals_per_second),
+            CEREAL_NVP(worker_threads),
+            CEREAL_NVP(steal_fraction),
+            CEREAL_NVP(load_average),
+            CEREAL_NVP(cpu_mhz),
+            CEREAL_NVP(method));
     }
 };
 
@@ -126,9 +540,13 @@ struct ResultBatch
     std::vector<Result> results;
     // Общее время выполнения всех задач
     double total_time_seconds = 0.0;
+    // Производительность и загрузка клиента во время выполнения пакета
+    ClientTelemetry telemetry;
 
     /**
      * @brief Метод сериализации для Cereal
+     *
+     * Суммы квадратов, значения таблиц и младшие части значений идут отдельными списками после телеметрии
      */
     template <class Archive>
     void serialize(Archive &archive)
@@ -136,7 +554,56 @@ struct ResultBatch
         archive(
             CEREAL_NVP(client_id),
             CEREAL_NVP(results),
-            CEREAL_NVP(total_time_seconds));
+            CEREAL_NVP(total_time_seconds),
+            CEREAL_NVP(telemetry));
+
+        std::vector<double> sum_squares;
+        sum_squares.reserve(results.size());
+        for (const auto &result : results)
+        {
+            sum_squares.push_back(result.sum_squares);
+        }
+
+        serialize_trailing(archive, sum_squares);
+        if (sum_squares.size() == results.size())
+        {
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                results[i].sum_squares = sum_squares[i];
+            }
+        }
+
+        std::vector<std::vector<double>> cumulative;
+        cumulative.reserve(results.size());
+        for (const auto &result : results)
+        {
+            cumulative.push_back(result.cumulative);
+        }
+
+        serialize_trailing(archive, cumulative);
+        if (cumulative.size() == results.size())
+        {
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                results[i].cumulative = std::move(cumulative[i]);
+            }
+        }
+
+        std::vector<double> value_lows;
+        value_lows.reserve(results.size());
+        for (const auto &result : results)
+        {
+            value_lows.push_back(result.value_low);
+        }
+
+        serialize_trailing(archive, value_lows);
+        if (value_lows.size() == results.size())
+        {
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                results[i].value_low = value_lows[i];
+            }
+        }
     }
 };
 
@@ -153,7 +620,13 @@ enum class CommandType : uint8_t
     // Проверка связи
     PING = 3,
     // Команда подтверждения
-    ACK = 4
+    ACK = 4,
+    // Прервать задачи задания (message - ID задания); клиент вернёт частичные результаты
+    CANCEL_JOB = 5,
+    // Изменить число рабочих потоков (message - число потоков); клиент делит машину с другими клиентами
+    SET_WORKERS = 6,
+    // Список других клиентов для кражи работы (message - "id@адрес:порт" через ';')
+    PEERS = 7
 };
 
 /**
@@ -200,6 +673,144 @@ struct ClientInfo
     }
 };
 
+/**
+ * @struct StealRequest
+ * @brief Запрос кражи работы, который простаивающий клиент отправляет другому клиенту
+ *
+ * В ответ приходит TaskBatch с частью невыполненных задач (возможно, пустой),
+ * а после их выполнения вор возвращает владельцу ResultBatch
+ */
+struct StealRequest
+{
+    // ID клиента-вора
+    uint64_t thief_id = 0;
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(CEREAL_NVP(thief_id));
+    }
+};
+
+/**
+ * @enum Capability
+ * @brief Флаги возможностей протокола (биты ProtocolCapabilities::features)
+ */
+enum Capability : uint64_t
+{
+    // Прерывание заданий командой CANCEL_JOB с частичными результатами
+    CAP_CANCEL_JOB = 1ull << 0,
+    // Изменение числа рабочих потоков командой SET_WORKERS
+    CAP_SET_WORKERS = 1ull << 1,
+    // Кража работы у других клиентов по списку из команды PEERS
+    CAP_WORK_STEALING = 1ull << 2,
+    // Метод интегрирования задаётся для каждой задачи (Task::kernel)
+    CAP_TASK_KERNEL = 1ull << 3,
+    // Задачи с таблицей первообразной (Task::grid, Result::cumulative)
+    CAP_PREFIX_SCAN = 1ull << 4,
+    // Вычисление значений функции в float32 (Task::precision)
+    CAP_SINGLE_PRECISION = 1ull << 5
+};
+
+/**
+ * @enum WireFormat
+ * @brief Форматы передачи пакетов задач и результатов (биты ProtocolCapabilities::wire_formats)
+ */
+enum WireFormat : uint32_t
+{
+    // Бинарный архив Cereal
+    WIRE_CEREAL_BINARY = 1u << 0
+};
+
+/**
+ * @struct ProtocolCapabilities
+ * @brief Возможности протокола, которые поддерживает сторона соединения
+ */
+struct ProtocolCapabilities
+{
+    // Версия набора возможностей (0 - сторона их не сообщила)
+    uint32_t protocol_version = 0;
+    // Биты Capability
+    uint64_t features = 0;
+    // Биты WireFormat
+    uint32_t wire_formats = 0;
+    // Биты ReductionMode
+    uint32_t reduction_modes = 0;
+    // Биты IntegrationKernel
+    uint32_t kernels = 0;
+    // Наибольшее число задач в пакете (0 - без ограничения)
+    uint32_t max_batch_tasks = 0;
+    // Наибольшее число пакетов, одновременно выданных клиенту (0 - без ограничения)
+    uint32_t max_in_flight = 0;
+    // Подынтегральные функции (биты integrand_bit, 0 - сторона их не сообщила)
+    uint32_t integrands = 0;
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(
+            CEREAL_NVP(protocol_version),
+            CEREAL_NVP(features),
+            CEREAL_NVP(wire_formats),
+            CEREAL_NVP(reduction_modes),
+            CEREAL_NVP(kernels),
+            CEREAL_NVP(max_batch_tasks),
+            CEREAL_NVP(max_in_flight));
+
+        // Поля ниже добавлены после версии 1: структура всегда стоит в конце сообщения
+        serialize_trailing(archive, integrands);
+    }
+};
+
+/**
+ * @struct ProtocolSettings
+ * @brief Параметры соединения, выбранные сервером из возможностей обеих сторон
+ */
+struct ProtocolSettings
+{
+    // Согласованная версия набора возможностей (0 - параметры не согласованы)
+    uint32_t protocol_version = 0;
+    // Включённые флаги Capability
+    uint64_t features = 0;
+    // Формат передачи (один бит WireFormat)
+    uint32_t wire_format = WIRE_CEREAL_BINARY;
+    // Режим суммирования (один бит ReductionMode)
+    uint32_t reduction_mode = REDUCTION_PLAIN;
+    // Методы интегрирования, доступные обеим сторонам
+    uint32_t kernels = 0;
+    // Наибольшее число задач в пакете (0 - без ограничения)
+    uint32_t max_batch_tasks = 0;
+    // Наибольшее число пакетов, одновременно выданных клиенту
+    uint32_t max_in_flight = 1;
+    // Подынтегральные функции, доступные обеим сторонам (биты integrand_bit)
+    uint32_t integrands = integrand_bit(INTEGRAND_INV_LOG);
+
+    /**
+     * @brief Метод сериализации для Cereal
+     */
+    template <class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(
+            CEREAL_NVP(protocol_version),
+            CEREAL_NVP(features),
+            CEREAL_NVP(wire_format),
+            CEREAL_NVP(reduction_mode),
+            CEREAL_NVP(kernels),
+            CEREAL_NVP(max_batch_tasks),
+            CEREAL_NVP(max_in_flight));
+
+        // Поля ниже добавлены после версии 1: структура всегда стоит в конце сообщения
+        serialize_trailing(archive, integrands);
+    }
+};
+
 /**
  * @struct HandshakeRequest
  * @brief Запрос на подключение от клиента
@@ -209,6 +820,12 @@ struct HandshakeRequest
     // Версия клиента
     std::string client_version;
     SystemInfo system_info;
+    // Название метода интегрирования клиента
+    std::string integration_method;
+    // Порт, на котором клиент принимает запросы кражи работы от других клиентов (0 - не принимает)
+    uint16_t peer_port = 0;
+    // Возможности протокола клиента (у старых клиентов отсутствуют)
+    ProtocolCapabilities capabilities;
 
     /**
      * @brief Метод сериализации для Cereal
@@ -218,7 +835,10 @@ struct HandshakeRequest
     {
         archive(
             CEREAL_NVP(client_version),
-            CEREAL_NVP(system_info));
+            CEREAL_NVP(system_info),
+            CEREAL_NVP(integration_method),
+            CEREAL_NVP(peer_port));
+        serialize_trailing(archive, capabilities);
     }
 };
 
@@ -236,6 +856,10 @@ struct HandshakeResponse
     bool accepted = true;
     // Сообщение
     std::string message;
+    // Сервер перегружен подключениями: повторить handshake через столько миллисекунд (0 - не повторять)
+    uint32_t retry_after_ms = 0;
+    // Параметры соединения, выбранные сервером (у старых серверов отсутствуют)
+    ProtocolSettings protocol;
 
     /**
      * @brief Метод сериализации для Cereal
@@ -248,6 +872,8 @@ struct HandshakeResponse
             CEREAL_NVP(server_version),
             CEREAL_NVP(accepted),
             CEREAL_NVP(message));
+        serialize_trailing(archive, retry_after_ms);
+        serialize_trailing(archive, protocol);
     }
 };
 
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <vector>
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
 #include "logger.h"
 
@@ -32,6 +33,57 @@ namespace net_utils
     std::string get_remote_address(tcp::socket &socket);
     uint16_t get_port(tcp::socket &socket);
 
+    // Максимальный размер одного сообщения
+    constexpr uint32_t MAX_PACKET_SIZE = 100 * 1024 * 1024; // 100 MB
+
+    /**
+     * @brief Сериализует данные в кадр для отправки: размер (4 байта) и данные
+     *
+     * Используется для асинхронной отправки, когда send_data неприменима
+     *
+     * @tparam T Тип данных (должен поддерживать сериализацию Cereal)
+     * @param data Данные
+     * @return Кадр, готовый к записи в сокет
+     * @throws cereal::Exception при ошибке сериализации
+     */
+    template <typename T>
+    std::string make_frame(const T &data)
+    {
+        // Место под размер резервируется заранее, чтобы отправить кадр одной записью
+        std::ostringstream oss;
+        oss.write("\0\0\0\0", sizeof(uint32_t));
+        {
+            cereal::BinaryOutputArchive archive(oss);
+            archive(data);
+        }
+        std::string frame = oss.str();
+
+        // Размер данных в сетевом порядке байт
+        uint32_t network_size = htonl(static_cast<uint32_t>(frame.size() - sizeof(uint32_t)));
+        std::memcpy(frame.data(), &network_size, sizeof(network_size));
+        return frame;
+    }
+
+    /**
+     * @brief Десериализует данные кадра, полученные без receive_data
+     *
+     * @tparam T Тип данных
+     * @param payload Данные кадра без размера
+     * @return Десериализованные данные
+     * @throws cereal::Exception при ошибке десериализации
+     */
+    template <typename T>
+    T parse_payload(std::string payload)
+    {
+        std::istringstream iss(std::move(payload));
+        T data;
+        {
+            cereal::BinaryInputArchive archive(iss);
+            archive(data);
+        }
+        return data;
+    }
+
     /**
      * @brief Отправляет сериализованные данные через TCP сокет
      *
@@ -53,30 +105,16 @@ namespace net_utils
     {
         try
         {
-            // Сериализация данных в строку
-            std::ostringstream oss;
-            {
-                cereal::BinaryOutputArchive archive(oss);
-                archive(data);
-            }
-            std::string serialized = oss.str();
-
-            // Отправка размера данных в сетевом порядке байт
-            uint32_t size = static_cast<uint32_t>(serialized.size());
-            uint32_t network_size = htonl(size); // Host to network byte order
+            std::string frame = make_frame(data);
 
             LOG_DEBUG("Sending data: {} bytes to {}",
-                      size,
+                      frame.size() - sizeof(uint32_t),
                       get_remote_address(socket));
 
+            // Размер и данные уходят одной записью
             boost::asio::write(
                 socket,
-                boost::asio::buffer(&network_size, sizeof(network_size)));
-
-            // Отправка самих данных
-            boost::asio::write(
-                socket,
-                boost::asio::buffer(serialized.data(), serialized.size()));
+                boost::asio::buffer(frame.data(), frame.size()));
 
             LOG_TRACE("Data sent successfully");
         }
@@ -129,7 +167,6 @@ namespace net_utils
             LOG_DEBUG("Receiving data: {} bytes from {}", size, remote_addr);
 
             // Валидация размера
-            constexpr uint32_t MAX_PACKET_SIZE = 100 * 1024 * 1024; // 100 MB
             if (size == 0 || size > MAX_PACKET_SIZE)
             {
                 LOG_ERROR("Invalid packet size: {} bytes", size);
@@ -144,12 +181,7 @@ namespace net_utils
                 boost::asio::buffer(buffer.data(), size));
 
             // Десериализация напрямую
-            std::istringstream iss(std::move(buffer));
-            T data;
-            {
-                cereal::BinaryInputArchive archive(iss);
-                archive(data);
-            }
+            T data = parse_payload<T>(std::move(buffer));
 
             LOG_TRACE("Data received and deserialized successfully");
             return data;
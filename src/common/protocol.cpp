@@ -0,0 +1,183 @@
+#include "protocol.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * @brief Старший установленный бит (0, если битов нет)
+     */
+    uint32_t highest_bit(uint32_t bits)
+    {
+        // Сбрасываем младшие биты, пока не останется один
+        while ((bits & (bits - 1)) != 0)
+        {
+            bits &= bits - 1;
+        }
+        return bits;
+    }
+
+    /**
+     * @brief Наименьшее из ограничений, где 0 означает отсутствие ограничения
+     */
+    uint32_t min_limit(uint32_t a, uint32_t b)
+    {
+        if (a == 0)
+        {
+            return b;
+        }
+        if (b == 0)
+        {
+            return a;
+        }
+        return std::min(a, b);
+    }
+} // namespace
+
+namespace protocol
+{
+    ProtocolCapabilities legacy_capabilities()
+    {
+        ProtocolCapabilities capabilities;
+        capabilities.protocol_version = 0;
+        capabilities.features = CAP_CANCEL_JOB | CAP_SET_WORKERS | CAP_WORK_STEALING;
+        capabilities.wire_formats = WIRE_CEREAL_BINARY;
+        capabilities.reduction_modes = REDUCTION_PLAIN;
+        capabilities.kernels = KERNEL_SIMPSON;
+        capabilities.max_in_flight = 2;
+        capabilities.integrands = integrand_bit(INTEGRAND_INV_LOG);
+        return capabilities;
+    }
+
+    ProtocolCapabilities local_capabilities()
+    {
+        ProtocolCapabilities capabilities;
+        capabilities.protocol_version = CURRENT_VERSION;
+        capabilities.features = CAP_CANCEL_JOB | CAP_SET_WORKERS | CAP_WORK_STEALING | CAP_TASK_KERNEL | CAP_PREFIX_SCAN |
+                                CAP_SINGLE_PRECISION;
+        capabilities.wire_formats = WIRE_CEREAL_BINARY;
+        capabilities.reduction_modes = REDUCTION_PLAIN | REDUCTION_COMPENSATED | REDUCTION_DOUBLE_DOUBLE;
+        capabilities.kernels = KERNEL_TRAPEZOIDAL | KERNEL_SIMPSON | KERNEL_QMC;
+        capabilities.integrands = integrands::all_bits();
+        return capabilities;
+    }
+
+    ProtocolSettings negotiate(const ProtocolCapabilities &local, const ProtocolCapabilities &remote)
+    {
+        const ProtocolCapabilities &peer = remote.protocol_version == 0 ? legacy_capabilities() : remote;
+
+        ProtocolSettings settings;
+        settings.protocol_version = std::min(local.protocol_version, peer.protocol_version);
+        settings.features = local.features & peer.features;
+        settings.wire_format = highest_bit(local.wire_formats & peer.wire_formats);
+        settings.reduction_mode = highest_bit(local.reduction_modes & peer.reduction_modes);
+        settings.kernels = local.kernels & peer.kernels;
+        if ((settings.features & CAP_TASK_KERNEL) == 0)
+        {
+            // Без выбора метода по задаче клиент считает встроенным методом Симпсона
+            settings.kernels &= KERNEL_SIMPSON;
+        }
+        // Сторона, не сообщившая функции, считает только 1/ln(x)
+        settings.integrands = (local.integrands != 0 ? local.integrands : integrand_bit(INTEGRAND_INV_LOG)) &
+                              (peer.integrands != 0 ? peer.integrands : integrand_bit(INTEGRAND_INV_LOG));
+        settings.max_batch_tasks = min_limit(local.max_batch_tasks, peer.max_batch_tasks);
+        settings.max_in_flight = std::max<uint32_t>(min_limit(local.max_in_flight, peer.max_in_flight), 1);
+
+        if (settings.wire_format == 0)
+        {
+            throw std::runtime_error("No common wire format");
+        }
+        if (settings.reduction_mode == 0)
+        {
+            settings.reduction_mode = REDUCTION_PLAIN;
+        }
+
+        return settings;
+    }
+
+    ProtocolSettings legacy_settings(const ProtocolCapabilities &local)
+    {
+        return negotiate(local, legacy_capabilities());
+    }
+
+    std::string kernel_name(uint32_t kernel)
+    {
+        switch (kernel)
+        {
+        case KERNEL_TRAPEZOIDAL:
+            return "trapezoidal";
+        case KERNEL_SIMPSON:
+            return "simpson";
+        case KERNEL_QMC:
+            return "qmc";
+        default:
+            return "unknown";
+        }
+    }
+
+    uint32_t kernel_from_name(const std::string &name)
+    {
+        if (name == "trapezoidal")
+        {
+            return KERNEL_TRAPEZOIDAL;
+        }
+        if (name == "simpson")
+        {
+            return KERNEL_SIMPSON;
+        }
+        if (name == "qmc")
+        {
+            return KERNEL_QMC;
+        }
+        return 0;
+    }
+
+    std::string reduction_name(uint32_t reduction)
+    {
+        switch (reduction)
+        {
+        case REDUCTION_PLAIN:
+            return "plain";
+        case REDUCTION_COMPENSATED:
+            return "compensated";
+        case REDUCTION_DOUBLE_DOUBLE:
+            return "double_double";
+        default:
+            return "unknown";
+        }
+    }
+
+    uint32_t reduction_from_name(const std::string &name)
+    {
+        if (name == "plain")
+        {
+            return REDUCTION_PLAIN;
+        }
+        if (name == "compensated")
+        {
+            return REDUCTION_COMPENSATED;
+        }
+        if (name == "double_double")
+        {
+            return REDUCTION_DOUBLE_DOUBLE;
+        }
+        return 0;
+    }
+
+    std::string describe(const ProtocolSettings &settings)
+    {
+        std::ostringstream oss;
+        oss << "v" << settings.protocol_version
+            << std::hex
+            << " features=0x" << settings.features
+            << " wire=0x" << settings.wire_format
+            << " reduction=0x" << settings.reduction_mode
+            << " kernels=0x" << settings.kernels
+            << " integrands=0x" << settings.integrands
+            << std::dec
+            << " batch=" << settings.max_batch_tasks
+            << " in_flight=" << settings.max_in_flight;
+        return oss.str();
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "messages.h"
+
+/**
+ * @file protocol.h
+ * @brief Согласование возможностей протокола между клиентом и сервером
+ *
+ * Каждая сторона сообщает при handshake набор поддерживаемых возможностей
+ * (ProtocolCapabilities), сервер выбирает лучший общий вариант и
+ * возвращает его клиенту (ProtocolSettings). Новые возможности
+ * включаются только на соединениях, где их поддерживают обе стороны,
+ * поэтому клиенты и серверы разных версий работают вместе
+ */
+
+namespace protocol
+{
+    // Версия набора возможностей, которую сообщает эта сборка
+    constexpr uint32_t CURRENT_VERSION = 1;
+
+    /**
+     * @brief Возможности, подразумеваемые у стороны, не сообщившей их при handshake
+     *
+     * Такие клиенты и серверы уже поддерживали отмену заданий, изменение
+     * числа потоков, кражу работы и два пакета задач в пути, а задачи
+     * считали методом Симпсона для функции 1/ln(x)
+     *
+     * @return Набор возможностей старой версии протокола
+     */
+    ProtocolCapabilities legacy_capabilities();
+
+    /**
+     * @brief Возможности, которые поддерживает эта сборка
+     *
+     * Ограничения max_batch_tasks и max_in_flight не заданы:
+     * их выставляет сторона, которой они нужны
+     *
+     * @return Набор возможностей текущей версии протокола
+     */
+    ProtocolCapabilities local_capabilities();
+
+    /**
+     * @brief Выбирает параметры соединения, поддерживаемые обеими сторонами
+     *
+     * Флаги, методы интегрирования и функции - пересечение наборов сторон, из общих
+     * форматов передачи выбирается самый быстрый, из режимов суммирования - самый
+     * точный (старший бит), ограничения - наименьшие из заданных
+     *
+     * @param local Возможности сервера
+     * @param remote Возможности клиента (protocol_version == 0 - старый клиент)
+     * @return Согласованные параметры
+     * @throws std::runtime_error если у сторон нет общего формата передачи
+     */
+    ProtocolSettings negotiate(const ProtocolCapabilities &local, const ProtocolCapabilities &remote);
+
+    /**
+     * @brief Параметры соединения со старым сервером, не приславшим их при handshake
+     * @param local Возможности клиента
+     * @return Параметры старой версии протокола, ограниченные возможностями клиента
+     */
+    ProtocolSettings legacy_settings(const ProtocolCapabilities &local);
+
+    /**
+     * @brief Проверяет, включена ли возможность на соединении
+     */
+    inline bool has_feature(const ProtocolSettings &settings, Capability feature)
+    {
+        return (settings.features & feature) != 0;
+    }
+
+    /**
+     * @brief Название метода интегрирования для команд управления и журнала
+     * @param kernel Один бит IntegrationKernel
+     * @return "trapezoidal", "simpson", "qmc" или "unknown"
+     */
+    std::string kernel_name(uint32_t kernel);
+
+    /**
+     * @brief Метод интегрирования по названию
+     * @param name Название, как его возвращает kernel_name()
+     * @return Бит IntegrationKernel или 0, если название неизвестно
+     */
+    uint32_t kernel_from_name(const std::string &name);
+
+    /**
+     * @brief Название режима суммирования для команд управления и журнала
+     * @param reduction Один бит ReductionMode
+     * @return "plain", "compensated", "double_double" или "unknown"
+     */
+    std::string reduction_name(uint32_t reduction);
+
+    /**
+     * @brief Режим суммирования по названию
+     * @param name Название, как его возвращает reduction_name()
+     * @return Бит ReductionMode или 0, если название неизвестно
+     */
+    uint32_t reduction_from_name(const std::string &name);
+
+    /**
+     * @brief Описание параметров соединения для журнала
+     * @return Строка вида "v1 features=0xf wire=0x1 reduction=0x1 kernels=0x3 integrands=0xf batch=0 in_flight=2"
+     */
+    std::string describe(const ProtocolSettings &settings);
+}
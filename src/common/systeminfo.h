@@ -42,6 +42,9 @@ struct SystemInfo
     // ==== ОЗУ ====
     uint64_t total_ram_mb = 0;
 
+    // ==== Идентификатор машины (одинаковый у клиентов на одном хосте) ====
+    std::string host_fingerprint;
+
     /**
      * @brief Преобразует информацию о системе в строку для вывода
      * @return Строка с форматированной информацией
@@ -59,7 +62,8 @@ struct SystemInfo
             CEREAL_NVP(os_type),
             CEREAL_NVP(architecture),
             CEREAL_NVP(cpu_cores),
-            CEREAL_NVP(total_ram_mb)
+            CEREAL_NVP(total_ram_mb),
+            CEREAL_NVP(host_fingerprint)
         );
     }
 };
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include <fstream>
 #include <thread>
 
 #ifdef _WIN32
@@ -9,7 +10,7 @@
     #include <sys/utsname.h>
     #include <sys/sysinfo.h>
     #include <sys/types.h>
-#elif defined(__APPLE___)
+#elif defined(__APPLE__)
     #include <unistd.h>
     #include <sys/utsname.h>
     #include <sys/types.h>
@@ -46,9 +47,32 @@ namespace sys_utils
         // Переводим в МБайт
         info.total_ram_mb = memory_status.ullTotalPhys / (1024 * 1024);
 
+        info.host_fingerprint = collect_host_fingerprint();
+
         return info;
     }
 
+    std::string collect_host_fingerprint()
+    {
+        // MachineGuid создаётся при установке системы и не меняется между загрузками
+        char guid[64] = {};
+        DWORD size = sizeof(guid);
+        if (RegGetValueA(HKEY_LOCAL_MACHINE,
+                         "SOFTWARE\\Microsoft\\Cryptography",
+                         "MachineGuid",
+                         RRF_RT_REG_SZ,
+                         nullptr,
+                         guid,
+                         &size) == ERROR_SUCCESS)
+        {
+            return guid;
+        }
+
+        char name[MAX_COMPUTERNAME_LENGTH + 1] = {};
+        size = sizeof(name);
+        return GetComputerNameA(name, &size) ? std::string(name) : std::string();
+    }
+
 #elif defined(__linux__)
     // Linux-специфичные реализации
     SystemInfo collect_system_info()
@@ -104,9 +128,43 @@ namespace sys_utils
         {
             info.total_ram_mb = 0;
         }
+
+        info.host_fingerprint = collect_host_fingerprint();
+
         return info;
     }
 
+    /**
+     * @brief Читает первую строку файла
+     * @return Строка или пустая строка, если файл недоступен
+     */
+    static std::string read_first_line(const char *path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    std::string collect_host_fingerprint()
+    {
+        std::string machine_id = read_first_line("/etc/machine-id");
+        if (machine_id.empty())
+        {
+            machine_id = read_first_line("/var/lib/dbus/machine-id");
+        }
+
+        // boot_id общий для всех контейнеров на одном ядре и меняется при перезагрузке
+        std::string boot_id = read_first_line("/proc/sys/kernel/random/boot_id");
+
+        if (machine_id.empty() && boot_id.empty())
+        {
+            char hostname[256] = {};
+            return gethostname(hostname, sizeof(hostname) - 1) == 0 ? std::string(hostname) : std::string();
+        }
+        return machine_id + ":" + boot_id;
+    }
+
 #elif defined(__APPLE__)
     // macOS-специфичные реализации
     SystemInfo collect_system_info()
@@ -137,9 +195,33 @@ namespace sys_utils
         // Переводим в МБайт
         info.total_ram_mb = mem_size / (1024 * 1024);
 
+        info.host_fingerprint = collect_host_fingerprint();
+
         return info;
     }
 
+    std::string collect_host_fingerprint()
+    {
+        std::string fingerprint;
+
+        char uuid[64] = {};
+        size_t len = sizeof(uuid);
+        if (sysctlbyname("kern.uuid", uuid, &len, NULL, 0) == 0)
+        {
+            fingerprint = uuid;
+        }
+
+        // Время загрузки отличает перезагрузки одной машины
+        struct timeval boot_time = {};
+        len = sizeof(boot_time);
+        if (sysctlbyname("kern.boottime", &boot_time, &len, NULL, 0) == 0)
+        {
+            fingerprint += ":" + std::to_string(boot_time.tv_sec);
+        }
+
+        return fingerprint;
+    }
+
 #endif
 } // namespace sys_utils
 
@@ -183,5 +265,6 @@ std::string SystemInfo::to_string() const
     result += "Architecture: " + ::to_string(architecture) + " " + "\n";
     result += "CPU Cores: " + std::to_string(cpu_cores) + "\n";
     result += "RAM: " + std::to_string(total_ram_mb) + " MB\n";
+    result += "Host: " + host_fingerprint + "\n";
     return result;
 }
@@ -4,4 +4,13 @@
 // Системные утилиты
 namespace sys_utils {
     SystemInfo collect_system_info();
+
+    /**
+     * @brief Стабильный идентификатор машины (machine-id и boot id на Linux)
+     *
+     * Клиенты, запущенные на одной машине, получают одинаковый идентификатор
+     *
+     * @return Строка-идентификатор или пустая строка, если определить не удалось
+     */
+    std::string collect_host_fingerprint();
 }
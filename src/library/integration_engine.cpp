@@ -0,0 +1,152 @@
+#include "integration_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    /**
+     * @struct Refinement
+     * @brief Состояние вызова integrate(): уточнения выполняются цепочкой заданий
+     */
+    struct Refinement
+    {
+        IntegrationEngine *engine = nullptr;
+        IntegrationParameters params{};
+        double tolerance = 0.0;
+        IntegrationEngine::Callback callback;
+        // Значение с предыдущим шагом
+        double previous = 0.0;
+        // Количество выполненных заданий
+        size_t levels = 0;
+        // Суммарное время заданий
+        double elapsed_seconds = 0.0;
+    };
+
+    void refine(const std::shared_ptr<Refinement> &state);
+
+    void on_level_finished(const std::shared_ptr<Refinement> &state, IntegrationResult result)
+    {
+        state->elapsed_seconds += result.elapsed_seconds;
+        result.elapsed_seconds = state->elapsed_seconds;
+        if (!result.success)
+        {
+            state->callback(result);
+            return;
+        }
+
+        ++state->levels;
+        if (state->levels > 1)
+        {
+            result.error_estimate = std::abs(result.value - state->previous) / IntegrationEngine::runge_denominator(state->params.kernel);
+            if (result.error_estimate <= state->tolerance)
+            {
+                state->callback(result);
+                return;
+            }
+            if (state->levels > IntegrationEngine::MAX_REFINEMENTS)
+            {
+                result.success = false;
+                result.error_message = "Tolerance not reached with step " + std::to_string(result.step);
+                state->callback(result);
+                return;
+            }
+        }
+
+        state->previous = result.value;
+        state->params.step /= 2.0;
+        refine(state);
+    }
+
+    void refine(const std::shared_ptr<Refinement> &state)
+    {
+        try
+        {
+            state->engine->submit(state->params, [state](const IntegrationResult &result)
+                                  { on_level_finished(state, result); });
+        }
+        catch (const std::exception &e)
+        {
+            // Первое задание проверено до начала цепочки: ошибка означает остановку исполнителя
+            IntegrationResult result;
+            result.error_message = e.what();
+            result.elapsed_seconds = state->elapsed_seconds;
+            state->callback(result);
+        }
+    }
+} // namespace
+
+double IntegrationEngine::runge_denominator(uint32_t kernel)
+{
+    return kernel == KERNEL_TRAPEZOIDAL ? 3.0 : 15.0;
+}
+
+void IntegrationEngine::submit(const IntegrationParameters &params, Callback callback)
+{
+    if (!callback)
+    {
+        throw std::invalid_argument("Callback cannot be empty");
+    }
+
+    // Пределы пакетного задания - границы объединения запросов, как в команде BATCH
+    IntegrationParameters job = params;
+    for (size_t i = 0; i < job.queries.size(); ++i)
+    {
+        job.lower_limit = i == 0 ? job.queries[i].lower : std::min(job.lower_limit, job.queries[i].lower);
+        job.upper_limit = i == 0 ? job.queries[i].upper : std::max(job.upper_limit, job.queries[i].upper);
+    }
+    if (!job.is_valid())
+    {
+        throw std::invalid_argument("Invalid integration parameters");
+    }
+
+    execute(job, std::move(callback));
+}
+
+std::future<IntegrationResult> IntegrationEngine::submit(const IntegrationParameters &params)
+{
+    auto promise = std::make_shared<std::promise<IntegrationResult>>();
+    std::future<IntegrationResult> future = promise->get_future();
+    submit(params, [promise](const IntegrationResult &result)
+           { promise->set_value(result); });
+    return future;
+}
+
+void IntegrationEngine::integrate(double lower, double upper, double tolerance, Callback callback,
+                                  const IntegrationParameters &method)
+{
+    if (!callback)
+    {
+        throw std::invalid_argument("Callback cannot be empty");
+    }
+    if (!(tolerance > 0.0) || method.kernel == KERNEL_QMC || !method.queries.empty() ||
+        method.output_intervals > 0 || method.inverse)
+    {
+        throw std::invalid_argument("Expected a positive tolerance and a one-dimensional integral");
+    }
+
+    auto state = std::make_shared<Refinement>();
+    state->engine = this;
+    state->params = method;
+    state->params.lower_limit = lower;
+    state->params.upper_limit = upper;
+    state->params.step = (upper - lower) / static_cast<double>(INITIAL_INTERVALS);
+    state->tolerance = tolerance;
+    state->callback = std::move(callback);
+
+    // Некорректные пределы сообщаются исключением, как в submit()
+    submit(state->params, [state](const IntegrationResult &result)
+           { on_level_finished(state, result); });
+}
+
+std::future<IntegrationResult> IntegrationEngine::integrate(double lower, double upper, double tolerance,
+                                                            const IntegrationParameters &method)
+{
+    auto promise = std::make_shared<std::promise<IntegrationResult>>();
+    std::future<IntegrationResult> future = promise->get_future();
+    integrate(lower, upper, tolerance, [promise](const IntegrationResult &result)
+              { promise->set_value(result); }, method);
+    return future;
+}
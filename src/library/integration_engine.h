@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+#include "job_queue.h"
+
+/**
+ * @file integration_engine.h
+ * @brief Встраиваемый интерфейс интегрирования: асинхронные вызовы с future или callback
+ */
+
+/**
+ * @struct IntegrationResult
+ * @brief Итог одного асинхронного вызова
+ */
+struct IntegrationResult
+{
+    // Успешно ли выполнено интегрирование
+    bool success = false;
+    // Значение интеграла (при успехе)
+    double value = 0.0;
+    // Оценка погрешности по правилу Рунге (для integrate() с заданной точностью)
+    double error_estimate = 0.0;
+    // Стандартная ошибка значения (для заданий KERNEL_QMC)
+    double standard_error = 0.0;
+    // Ответы на запросы пакетного задания (при успехе)
+    std::vector<double> query_results;
+    // Шаг, с которым получено значение
+    double step = 0.0;
+    // Время вычисления в секундах (для integrate() - всех уточнений)
+    double elapsed_seconds = 0.0;
+    // Описание ошибки (при неуспехе)
+    std::string error_message;
+};
+
+/**
+ * @class IntegrationEngine
+ * @brief Общий интерфейс локального (LocalEngine) и удалённого (RemoteEngine) исполнителя
+ *
+ * Все методы потокобезопасны и не блокируют вызывающий поток: задание
+ * выполняется в фоне, а результат передаётся в callback или через future.
+ * Одновременные вызовы выполняются параллельно и делят ресурсы исполнителя.
+ *
+ * Callback вызывается ровно один раз из потока исполнителя, поэтому он
+ * должен быть коротким; из него можно отправлять новые вызовы
+ */
+class IntegrationEngine
+{
+public:
+    /**
+     * @brief Функция, получающая итог вызова
+     */
+    using Callback = std::function<void(const IntegrationResult &)>;
+
+    // Начальное число отрезков разбиения в integrate() с заданной точностью
+    static constexpr uint64_t INITIAL_INTERVALS = 1024;
+    // Наибольшее число уточнений (каждое уменьшает шаг вдвое)
+    static constexpr size_t MAX_REFINEMENTS = 24;
+
+    virtual ~IntegrationEngine() = default;
+
+    /**
+     * @brief Знаменатель оценки погрешности по правилу Рунге 2^p - 1 для порядка метода p
+     * @param kernel Метод (KERNEL_TRAPEZOIDAL или KERNEL_SIMPSON)
+     */
+    static double runge_denominator(uint32_t kernel);
+
+    /**
+     * @brief Выполняет задание с заданным шагом
+     *
+     * Пределы пакетного задания (непустой queries) вычисляются по запросам
+     *
+     * @param params Параметры интегрирования
+     * @param callback Получает итог задания
+     * @throws std::invalid_argument если параметры некорректны или не поддерживаются исполнителем
+     */
+    void submit(const IntegrationParameters &params, Callback callback);
+
+    /**
+     * @brief Выполняет задание с заданным шагом
+     * @param params Параметры интегрирования
+     * @return Итог задания
+     * @throws std::invalid_argument если параметры некорректны или не поддерживаются исполнителем
+     */
+    std::future<IntegrationResult> submit(const IntegrationParameters &params);
+
+    /**
+     * @brief Интегрирует функцию с заданной абсолютной точностью
+     *
+     * Шаг уменьшается вдвое, начиная с (upper - lower) / INITIAL_INTERVALS,
+     * пока оценка погрешности по правилу Рунге |I(h/2) - I(h)| / (2^p - 1)
+     * не станет меньше tolerance (p = 4 для метода Симпсона, 2 для трапеций).
+     * Каждое уточнение - отдельное задание, поэтому общая стоимость не больше
+     * удвоенной стоимости последнего
+     *
+     * @param lower Нижний предел
+     * @param upper Верхний предел
+     * @param tolerance Допустимая абсолютная погрешность (> 0)
+     * @param callback Получает итог вычисления
+     * @param method Метод, функция, накопитель и точность значений (пределы и шаг не используются)
+     * @throws std::invalid_argument если параметры некорректны
+     */
+    void integrate(double lower, double upper, double tolerance, Callback callback,
+                   const IntegrationParameters &method = {});
+
+    /**
+     * @brief Интегрирует функцию с заданной абсолютной точностью
+     * @return Итог вычисления
+     * @see integrate(double, double, double, Callback, const IntegrationParameters &)
+     */
+    std::future<IntegrationResult> integrate(double lower, double upper, double tolerance,
+                                             const IntegrationParameters &method = {});
+
+protected:
+    /**
+     * @brief Запускает выполнение задания
+     * @param params Корректные параметры интегрирования
+     * @param callback Получает итог задания ровно один раз
+     * @throws std::invalid_argument если задание не поддерживается исполнителем
+     */
+    virtual void execute(const IntegrationParameters &params, Callback callback) = 0;
+};
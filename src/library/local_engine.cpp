@@ -0,0 +1,144 @@
+#include "local_engine.h"
+#include "logger.h"
+#include "query_batch.h"
+#include "integration_methods/simpsons_rule.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // ID, под которым пул потоков забирает фрагменты из планировщика
+    constexpr uint64_t LOCAL_CLIENT_ID = 1;
+
+    /**
+     * @brief Создаёт интегратор (логгер нужен уже его конструктору)
+     */
+    std::shared_ptr<Integrator> make_integrator()
+    {
+        logging::ensure_initialized("integration");
+        return std::make_shared<Integrator>(std::make_unique<SimpsonsRule>());
+    }
+
+    /**
+     * @brief Количество потоков: заданное или по числу ядер
+     */
+    uint32_t resolve_threads(uint32_t num_threads)
+    {
+        return num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+} // namespace
+
+LocalEngine::LocalEngine(uint32_t num_threads)
+    : integrator_(make_integrator()),
+      worker_pool_(std::make_unique<WorkerPool>(resolve_threads(num_threads), integrator_)),
+      scheduler_([this](const JobOutcome &outcome)
+                 { on_job_finished(outcome); },
+                 [this]()
+                 { return distributor_.allocate_task_id(); })
+{
+    dispatcher_ = std::thread(&LocalEngine::dispatch_loop, this);
+
+    LOG_INFO("LocalEngine started with {} threads", worker_pool_->get_num_threads());
+}
+
+LocalEngine::~LocalEngine()
+{
+    // Незавершённые задания получают ошибку, диспетчер выходит из ожидания
+    scheduler_.stop();
+    if (dispatcher_.joinable())
+    {
+        dispatcher_.join();
+    }
+}
+
+void LocalEngine::execute(const IntegrationParameters &params, Callback callback)
+{
+    if (params.output_intervals > 0 || params.inverse)
+    {
+        throw std::invalid_argument("Prefix scans and inverse queries are supported by the server only");
+    }
+
+    const uint32_t threads = worker_pool_->get_num_threads();
+    uint64_t job_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_id = next_job_id_++;
+        pending_[job_id] = {std::move(callback), std::chrono::steady_clock::now()};
+    }
+
+    try
+    {
+        std::vector<Task> chunks;
+        if (params.kernel == KERNEL_QMC)
+        {
+            chunks = distributor_.split_qmc_job(job_id, params.sampling, params.points, params.replicas, threads);
+        }
+        else if (!params.queries.empty())
+        {
+            QueryBatch batch(params.queries);
+            chunks = distributor_.split_batch_job(job_id, batch.get_segments(), params.step, threads);
+        }
+        else
+        {
+            chunks = distributor_.split_job(job_id, params.lower_limit, params.upper_limit, params.step, threads);
+        }
+        scheduler_.add_job(job_id, params, 1, 0, std::move(chunks));
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.erase(job_id);
+        throw;
+    }
+}
+
+void LocalEngine::dispatch_loop()
+{
+    while (scheduler_.wait_for_work())
+    {
+        TaskBatch batch = scheduler_.take_batch(LOCAL_CLIENT_ID, worker_pool_->get_num_threads() * TASKS_PER_THREAD);
+        if (batch.tasks.empty())
+        {
+            continue;
+        }
+
+        ResultBatch results;
+        results.client_id = LOCAL_CLIENT_ID;
+        results.results = worker_pool_->execute_tasks_parallel(batch.tasks);
+        scheduler_.complete(results);
+    }
+}
+
+void LocalEngine::on_job_finished(const JobOutcome &outcome)
+{
+    PendingCall call;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(outcome.job_id);
+        if (it == pending_.end())
+        {
+            return;
+        }
+        call = std::move(it->second);
+        pending_.erase(it);
+    }
+
+    IntegrationResult result;
+    result.success = outcome.success;
+    result.value = outcome.value;
+    result.standard_error = outcome.standard_error;
+    result.query_results = outcome.query_results;
+    result.step = outcome.params.step;
+    result.error_message = outcome.error_message;
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - call.started_at).count();
+
+    try
+    {
+        call.callback(result);
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Callback of job {} threw: {}", outcome.job_id, e.what());
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "integration_engine.h"
+#include "integrator.h"
+#include "job_scheduler.h"
+#include "task_distributor.h"
+#include "worker_pool.h"
+
+/**
+ * @file local_engine.h
+ * @brief Модуль встраиваемого исполнителя на ядрах текущего процесса
+ */
+
+/**
+ * @class LocalEngine
+ * @brief Выполняет задания в текущем процессе без сервера и клиентов
+ *
+ * Задание делится TaskDistributor на фрагменты и добавляется в JobScheduler,
+ * как на сервере. Поток-диспетчер забирает из планировщика пакеты фрагментов
+ * всех выполняющихся заданий и выполняет их на общем WorkerPool, поэтому
+ * одновременные вызовы делят ядра поровну, а небольшое задание не ждёт
+ * окончания большого. Результаты фрагментов собираются ResultAggregator
+ * (QmcEstimator, QueryBatch) задания.
+ *
+ * Поддерживаются обычные задания, задания квази-Монте-Карло и пакетные
+ * задания; задания с таблицей первообразной и обратные запросы выполняет
+ * только сервер
+ */
+class LocalEngine : public IntegrationEngine
+{
+public:
+    // Количество фрагментов в пакете диспетчера на один поток
+    static constexpr size_t TASKS_PER_THREAD = 2;
+
+    /**
+     * @brief Конструктор: запускает поток-диспетчер
+     * @param num_threads Количество рабочих потоков (0 - по числу ядер)
+     */
+    explicit LocalEngine(uint32_t num_threads = 0);
+
+    /**
+     * @brief Деструктор: невыполненные вызовы завершаются с ошибкой
+     */
+    ~LocalEngine() override;
+
+    // Запрет копирования и перемещения
+    LocalEngine(const LocalEngine &) = delete;
+    LocalEngine &operator=(const LocalEngine &) = delete;
+    LocalEngine(LocalEngine &&) = delete;
+    LocalEngine &operator=(LocalEngine &&) = delete;
+
+    /**
+     * @brief Возвращает количество рабочих потоков
+     */
+    uint32_t get_num_threads() const { return worker_pool_->get_num_threads(); }
+
+protected:
+    void execute(const IntegrationParameters &params, Callback callback) override;
+
+private:
+    /**
+     * @struct PendingCall
+     * @brief Вызов, ожидающий завершения задания
+     */
+    struct PendingCall
+    {
+        Callback callback;
+        std::chrono::steady_clock::time_point started_at;
+    };
+
+    /**
+     * @brief Цикл потока-диспетчера: выполняет пакеты фрагментов до остановки планировщика
+     */
+    void dispatch_loop();
+
+    /**
+     * @brief Передаёт итог задания в callback вызова
+     */
+    void on_job_finished(const JobOutcome &outcome);
+
+    // Интегратор со стратегиями всех методов и функций
+    std::shared_ptr<Integrator> integrator_;
+    // Пул потоков, общий для всех вызовов
+    std::unique_ptr<WorkerPool> worker_pool_;
+    // Разбиение заданий на фрагменты (выдаёт и ID задач)
+    TaskDistributor distributor_;
+    // Планировщик фрагментов одновременно выполняющихся заданий
+    JobScheduler scheduler_;
+
+    // Вызовы, ожидающие завершения: ID задания -> вызов
+    std::unordered_map<uint64_t, PendingCall> pending_;
+    // ID следующего задания
+    uint64_t next_job_id_ = 1;
+    // Защищает pending_ и next_job_id_
+    std::mutex mutex_;
+
+    // Поток-диспетчер
+    std::thread dispatcher_;
+};
@@ -0,0 +1,315 @@
+#include "remote_engine.h"
+#include "integrands.h"
+#include "logger.h"
+#include "protocol.h"
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    /**
+     * @brief Метод задания в записи управляющих команд: "simpson", "simpson:compensated:single"
+     */
+    std::string format_method(const IntegrationParameters &params)
+    {
+        std::string method = protocol::kernel_name(params.kernel);
+        if (params.reduction != REDUCTION_PLAIN)
+        {
+            method += ":" + protocol::reduction_name(params.reduction);
+        }
+        if (params.precision == PRECISION_SINGLE)
+        {
+            method += ":single";
+        }
+        return method;
+    }
+
+    /**
+     * @brief Функция в записи управляющих команд: "inv_log 0", "expression sin(x)/x"
+     */
+    std::string format_integrand(const IntegrandSpec &spec)
+    {
+        if (spec.id == INTEGRAND_EXPRESSION)
+        {
+            return integrands::name(spec.id) + " " + spec.expression.source;
+        }
+        return fmt::format("{} {}", integrands::name(spec.id), spec.parameter);
+    }
+
+    /**
+     * @brief Составляет команду, добавляющую задание в очередь сервера
+     */
+    std::string format_submit(const IntegrationParameters &params)
+    {
+        if (params.kernel == KERNEL_QMC)
+        {
+            std::string box;
+            for (size_t i = 0; i < params.sampling.lower.size(); ++i)
+            {
+                box += fmt::format("{}{}:{}", i == 0 ? "" : ",", params.sampling.lower[i], params.sampling.upper[i]);
+            }
+            return fmt::format("QMC {} {} {} {} 1 0 {}", box, params.points, params.replicas, params.sampling.seed,
+                               format_integrand(params.integrand));
+        }
+        if (!params.queries.empty())
+        {
+            std::string ranges;
+            for (size_t i = 0; i < params.queries.size(); ++i)
+            {
+                ranges += fmt::format("{}{}:{}", i == 0 ? "" : ",", params.queries[i].lower, params.queries[i].upper);
+            }
+            return fmt::format("BATCH {} {} 1 0 {} {}", params.step, ranges, format_method(params),
+                               format_integrand(params.integrand));
+        }
+        return fmt::format("SUBMIT {} {} {} 1 0 {} {}", params.lower_limit, params.upper_limit, params.step,
+                           format_method(params), format_integrand(params.integrand));
+    }
+
+    /**
+     * @brief Разбирает ответ на WAIT: "OK <value> <seconds> [...]", "ERROR <message>" или "CANCELLED"
+     */
+    IntegrationResult parse_result(const std::string &reply, const IntegrationParameters &params)
+    {
+        IntegrationResult result;
+        result.step = params.step;
+
+        std::istringstream iss(reply);
+        std::string status;
+        iss >> status;
+        if (status == "CANCELLED")
+        {
+            result.error_message = "Cancelled";
+            return result;
+        }
+        if (status != "OK" || !(iss >> result.value >> result.elapsed_seconds))
+        {
+            result.error_message = reply.rfind("ERROR ", 0) == 0 ? reply.substr(6) : "Unexpected reply: " + reply;
+            return result;
+        }
+
+        // QMC сообщает стандартную ошибку, пакетное задание - ответы на запросы
+        if (params.kernel == KERNEL_QMC)
+        {
+            iss >> result.standard_error;
+        }
+        double value = 0.0;
+        while (!params.queries.empty() && iss >> value)
+        {
+            result.query_results.push_back(value);
+        }
+        result.success = true;
+        return result;
+    }
+} // namespace
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+/**
+ * @class RemoteEngine::Call
+ * @brief Один вызов: соединение, SUBMIT, WAIT и передача итога в callback
+ *
+ * Все методы выполняются в потоке io_context исполнителя
+ */
+class RemoteEngine::Call : public std::enable_shared_from_this<RemoteEngine::Call>
+{
+public:
+    Call(RemoteEngine &engine, uint64_t id, IntegrationParameters params, Callback callback)
+        : engine_(engine),
+          id_(id),
+          params_(std::move(params)),
+          callback_(std::move(callback)),
+          socket_(engine.io_context_),
+          started_at_(std::chrono::steady_clock::now())
+    {
+    }
+
+    void start()
+    {
+        auto self = shared_from_this();
+        socket_.async_connect(
+            boost::asio::local::stream_protocol::endpoint(engine_.control_socket_),
+            [self](const boost::system::error_code &ec)
+            {
+                if (ec)
+                {
+                    self->fail("Failed to connect to " + self->engine_.control_socket_ + ": " + ec.message());
+                    return;
+                }
+                self->request(format_submit(self->params_), [self](const std::string &reply)
+                              { self->on_submitted(reply); });
+            });
+    }
+
+    /**
+     * @brief Прерывает ожидание: вызов завершается с ошибкой
+     */
+    void abort()
+    {
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+    }
+
+private:
+    /**
+     * @brief Отправляет команду и читает строку ответа
+     */
+    void request(const std::string &command, std::function<void(const std::string &)> on_reply)
+    {
+        auto self = shared_from_this();
+        auto data = std::make_shared<std::string>(command + "\n");
+        boost::asio::async_write(
+            socket_, boost::asio::buffer(*data),
+            [self, data, on_reply](const boost::system::error_code &ec, size_t)
+            {
+                if (ec)
+                {
+                    self->fail("Control connection lost: " + ec.message());
+                    return;
+                }
+                boost::asio::async_read_until(
+                    self->socket_, self->buffer_, '\n',
+                    [self, on_reply](const boost::system::error_code &ec, size_t)
+                    {
+                        if (ec)
+                        {
+                            self->fail("Control connection lost: " + ec.message());
+                            return;
+                        }
+                        std::istream stream(&self->buffer_);
+                        std::string reply;
+                        std::getline(stream, reply);
+                        on_reply(reply);
+                    });
+            });
+    }
+
+    void on_submitted(const std::string &reply)
+    {
+        std::istringstream iss(reply);
+        std::string status;
+        uint64_t job_id = 0;
+        if (!(iss >> status >> job_id) || status != "OK")
+        {
+            fail(reply.rfind("ERROR ", 0) == 0 ? reply.substr(6) : "Unexpected reply: " + reply);
+            return;
+        }
+
+        auto self = shared_from_this();
+        request("WAIT " + std::to_string(job_id), [self](const std::string &reply)
+                { self->finish(parse_result(reply, self->params_)); });
+    }
+
+    void fail(const std::string &message)
+    {
+        IntegrationResult result;
+        result.step = params_.step;
+        result.error_message = message;
+        result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_at_).count();
+        finish(result);
+    }
+
+    void finish(const IntegrationResult &result)
+    {
+        if (finished_)
+        {
+            return;
+        }
+        finished_ = true;
+
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+        engine_.on_call_finished(id_);
+
+        try
+        {
+            callback_(result);
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Callback of remote call {} threw: {}", id_, e.what());
+        }
+    }
+
+    RemoteEngine &engine_;
+    uint64_t id_;
+    IntegrationParameters params_;
+    Callback callback_;
+    boost::asio::local::stream_protocol::socket socket_;
+    boost::asio::streambuf buffer_;
+    std::chrono::steady_clock::time_point started_at_;
+    // Передан ли итог в callback
+    bool finished_ = false;
+};
+
+#endif
+
+RemoteEngine::RemoteEngine(const std::string &control_socket)
+    : control_socket_(control_socket),
+      work_guard_(boost::asio::make_work_guard(io_context_))
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    logging::ensure_initialized("integration");
+    io_thread_ = std::thread([this]()
+                             { io_context_.run(); });
+#else
+    throw std::runtime_error("Local control sockets are not supported on this platform");
+#endif
+}
+
+RemoteEngine::~RemoteEngine()
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto &[id, call] : calls_)
+        {
+            boost::asio::post(io_context_, [call = call]()
+                              { call->abort(); });
+        }
+    }
+#endif
+
+    // Поток завершится, когда прерванные вызовы передадут итог
+    work_guard_.reset();
+    if (io_thread_.joinable())
+    {
+        io_thread_.join();
+    }
+}
+
+void RemoteEngine::execute(const IntegrationParameters &params, Callback callback)
+{
+    if (params.output_intervals > 0 || params.inverse)
+    {
+        throw std::invalid_argument("Prefix scans and inverse queries cannot be run through RemoteEngine");
+    }
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_)
+        {
+            throw std::runtime_error("RemoteEngine is stopping");
+        }
+        uint64_t id = next_call_id_++;
+        auto call = std::make_shared<Call>(*this, id, params, std::move(callback));
+        calls_[id] = call;
+
+        // Под блокировкой: деструктор должен поставить abort() после start()
+        boost::asio::post(io_context_, [call]()
+                          { call->start(); });
+    }
+#else
+    (void)callback;
+#endif
+}
+
+void RemoteEngine::on_call_finished(uint64_t call_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    calls_.erase(call_id);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "integration_engine.h"
+
+/**
+ * @file remote_engine.h
+ * @brief Модуль исполнителя, передающего задания запущенному серверу
+ */
+
+/**
+ * @class RemoteEngine
+ * @brief Выполняет задания на сервере через его управляющий сокет
+ *
+ * Каждый вызов открывает своё управляющее соединение, отправляет SUBMIT,
+ * BATCH или QMC и ждёт итог командой WAIT, поэтому одновременные вызовы
+ * выполняются сервером параллельно и делят его клиентов. Все соединения
+ * обслуживает один поток ввода/вывода.
+ *
+ * Задания с таблицей первообразной и обратные запросы не поддерживаются:
+ * их итог - файл на сервере или предел, а не значение интеграла
+ *
+ * @code
+ * RemoteEngine engine("/tmp/integration.sock");
+ * IntegrationResult result = engine.integrate(2.0, 1000.0, 1e-9).get();
+ * @endcode
+ */
+class RemoteEngine : public IntegrationEngine
+{
+public:
+    /**
+     * @brief Конструктор: запускает поток ввода/вывода (соединений пока нет)
+     * @param control_socket Путь к управляющему сокету сервера (--control)
+     * @throws std::runtime_error если платформа не поддерживает локальные сокеты
+     */
+    explicit RemoteEngine(const std::string &control_socket);
+
+    /**
+     * @brief Деструктор: невыполненные вызовы завершаются с ошибкой (задания на сервере продолжаются)
+     */
+    ~RemoteEngine() override;
+
+    // Запрет копирования и перемещения
+    RemoteEngine(const RemoteEngine &) = delete;
+    RemoteEngine &operator=(const RemoteEngine &) = delete;
+    RemoteEngine(RemoteEngine &&) = delete;
+    RemoteEngine &operator=(RemoteEngine &&) = delete;
+
+protected:
+    void execute(const IntegrationParameters &params, Callback callback) override;
+
+private:
+    class Call;
+
+    /**
+     * @brief Убирает завершённый вызов из списка выполняющихся
+     */
+    void on_call_finished(uint64_t call_id);
+
+    // Путь к управляющему сокету сервера
+    std::string control_socket_;
+    // Контекст ввода/вывода соединений
+    boost::asio::io_context io_context_;
+    // Не даёт io_context_ завершиться без соединений
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+    // Поток, обслуживающий io_context_
+    std::thread io_thread_;
+
+    // Выполняющиеся вызовы: ID -> вызов
+    std::unordered_map<uint64_t, std::shared_ptr<Call>> calls_;
+    // ID следующего вызова
+    uint64_t next_call_id_ = 1;
+    // Флаг остановки (новые вызовы отклоняются)
+    bool stopping_ = false;
+    // Защищает calls_, next_call_id_ и stopping_
+    std::mutex mutex_;
+};
@@ -0,0 +1,432 @@
+#include "batch_runner.h"
+#include "integration_engine.h"
+#include "logger.h"
+#include "protocol.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    // Команды, допустимые в файле заданий
+    const std::vector<std::string> JOB_COMMANDS = {"SUBMIT", "BATCH", "QMC", "SCAN", "INVERT"};
+    // Префикс точности вместо шага в SUBMIT
+    const std::string TOLERANCE_PREFIX = "tol=";
+
+    // Типы колонок двоичного файла
+    constexpr uint8_t COLUMN_UINT64 = 0;
+    constexpr uint8_t COLUMN_DOUBLE = 1;
+
+    /**
+     * @brief Удаляет пробельные символы в начале и в конце строки
+     */
+    std::string trim(const std::string &text)
+    {
+        const char *spaces = " \t\r\n";
+        size_t begin = text.find_first_not_of(spaces);
+        if (begin == std::string::npos)
+        {
+            return "";
+        }
+        return text.substr(begin, text.find_last_not_of(spaces) - begin + 1);
+    }
+
+    /**
+     * @brief Возвращает имя команды в верхнем регистре
+     */
+    std::string command_name(const std::string &command)
+    {
+        std::istringstream iss(command);
+        std::string name;
+        iss >> name;
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        return name;
+    }
+
+    /**
+     * @brief Аргумент команды с номером index (0 - имя команды) или пустая строка
+     */
+    std::string token_at(const std::string &command, size_t index)
+    {
+        std::istringstream iss(command);
+        std::string token;
+        for (size_t i = 0; i <= index; ++i)
+        {
+            if (!(iss >> token))
+            {
+                return "";
+            }
+        }
+        return token;
+    }
+
+    /**
+     * @brief Шаг задания из команды (0, если команда его не содержит)
+     */
+    double command_step(const std::string &command)
+    {
+        std::string name = command_name(command);
+        if (name == "QMC")
+        {
+            return 0.0;
+        }
+
+        // SUBMIT, SCAN и INVERT: шаг - третий аргумент, BATCH - первый
+        std::istringstream iss(token_at(command, name == "BATCH" ? 1 : 3));
+        double step = 0.0;
+        return iss >> step ? step : 0.0;
+    }
+
+    /**
+     * @brief Текст ошибки из ответа "ERROR <message>"
+     */
+    std::string error_text(const std::string &reply)
+    {
+        return reply.rfind("ERROR ", 0) == 0 ? reply.substr(6) : "Unexpected reply: " + reply;
+    }
+
+    /**
+     * @brief Экранирует поле CSV
+     */
+    std::string csv_quote(const std::string &text)
+    {
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+        }
+        return quoted + "\"";
+    }
+
+    /**
+     * @brief Записывает колонку двоичного файла
+     */
+    template <class T>
+    void write_column(std::ofstream &out, uint8_t type, const std::string &name, const std::vector<T> &values)
+    {
+        uint8_t name_length = static_cast<uint8_t>(name.size());
+        uint64_t count = values.size();
+        out.write(reinterpret_cast<const char *>(&type), sizeof(type));
+        out.write(reinterpret_cast<const char *>(&name_length), sizeof(name_length));
+        out.write(name.data(), name_length);
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    /**
+     * @brief Собирает колонку из поля итогов
+     */
+    template <class T, class Getter>
+    std::vector<T> column(const std::vector<BatchRow> &rows, Getter getter)
+    {
+        std::vector<T> values;
+        values.reserve(rows.size());
+        for (const auto &row : rows)
+        {
+            values.push_back(static_cast<T>(getter(row)));
+        }
+        return values;
+    }
+} // namespace
+
+BatchRunner::BatchRunner(CommandHandler handler)
+    : handler_(std::move(handler))
+{
+    if (!handler_)
+    {
+        throw std::invalid_argument("Command handler cannot be empty");
+    }
+}
+
+std::vector<BatchEntry> BatchRunner::parse_file(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open job file " + path);
+    }
+    return parse(file);
+}
+
+std::vector<BatchEntry> BatchRunner::parse(std::istream &input)
+{
+    std::vector<BatchEntry> entries;
+    std::string text;
+    uint64_t line = 0;
+    while (std::getline(input, text))
+    {
+        ++line;
+        text = trim(text);
+        if (text.empty() || text[0] == '#')
+        {
+            continue;
+        }
+
+        BatchEntry entry;
+        entry.line = line;
+        entry.command = text;
+
+        std::string name = command_name(text);
+        if (std::find(JOB_COMMANDS.begin(), JOB_COMMANDS.end(), name) == JOB_COMMANDS.end())
+        {
+            throw std::runtime_error("Line " + std::to_string(line) + ": unsupported command " + name +
+                                     " (expected SUBMIT, BATCH, QMC, SCAN or INVERT)");
+        }
+
+        // Точность вместо шага: SUBMIT <lower> <upper> tol=<value> ...
+        std::string token = token_at(text, 3);
+        if (token.rfind(TOLERANCE_PREFIX, 0) == 0)
+        {
+            std::istringstream value(token.substr(TOLERANCE_PREFIX.size()));
+            if (name != "SUBMIT" || !(value >> entry.tolerance) || !(entry.tolerance > 0.0))
+            {
+                throw std::runtime_error("Line " + std::to_string(line) +
+                                         ": expected SUBMIT <lower> <upper> tol=<positive value>");
+            }
+        }
+
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+std::vector<BatchRow> BatchRunner::run(const std::vector<BatchEntry> &entries)
+{
+    std::vector<BatchRow> rows;
+    rows.reserve(entries.size());
+
+    for (const auto &entry : entries)
+    {
+        BatchRow row;
+        row.line = entry.line;
+        row.command = entry.command;
+
+        auto started = std::chrono::steady_clock::now();
+        if (entry.tolerance > 0.0)
+        {
+            run_with_tolerance(entry, row);
+        }
+        else
+        {
+            row.step = command_step(entry.command);
+            row.success = execute(entry.command, row);
+            row.refinements = row.job_id != 0 ? 1 : 0;
+        }
+        row.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        if (row.success)
+        {
+            LOG_INFO("Line {}: {:.15f} in {:.3f} s", row.line, row.value, row.wall_seconds);
+        }
+        else
+        {
+            LOG_ERROR("Line {}: {}", row.line, row.error_message);
+        }
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+std::string BatchRunner::request(const std::string &command)
+{
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    try
+    {
+        handler_(command, [promise](const std::string &response)
+                 { promise->set_value(response); });
+    }
+    catch (const std::exception &e)
+    {
+        return std::string("ERROR ") + e.what();
+    }
+    return future.get();
+}
+
+bool BatchRunner::execute(const std::string &command, BatchRow &row)
+{
+    std::string reply = request(command);
+    std::istringstream submitted(reply);
+    std::string status;
+    uint64_t job_id = 0;
+    if (!(submitted >> status >> job_id) || status != "OK")
+    {
+        row.error_message = error_text(reply);
+        return false;
+    }
+    row.job_id = job_id;
+
+    // Ответ WAIT: "OK <value> <seconds> [...]", "ERROR <message>" или "CANCELLED"
+    reply = request("WAIT " + std::to_string(job_id));
+    std::istringstream result(reply);
+    result >> status;
+    if (status == "CANCELLED")
+    {
+        row.error_message = "Cancelled";
+        return false;
+    }
+    if (status != "OK" || !(result >> row.value >> row.elapsed_seconds))
+    {
+        row.error_message = error_text(reply);
+        return false;
+    }
+
+    row.extra.clear();
+    double value = 0.0;
+    while (result >> value)
+    {
+        row.extra.push_back(value);
+    }
+    return true;
+}
+
+void BatchRunner::run_with_tolerance(const BatchEntry &entry, BatchRow &row)
+{
+    // SUBMIT <lower> <upper> tol=<value> [weight [priority [method ...]]]
+    std::istringstream iss(entry.command);
+    std::string name;
+    std::string lower_text;
+    std::string upper_text;
+    std::string tolerance_text;
+    std::string rest;
+    iss >> name >> lower_text >> upper_text >> tolerance_text;
+    std::getline(iss, rest);
+
+    double lower = 0.0;
+    double upper = 0.0;
+    std::istringstream limits(lower_text + " " + upper_text);
+    if (!(limits >> lower >> upper) || !(upper > lower))
+    {
+        row.error_message = "Expected lower < upper";
+        return;
+    }
+
+    // Порядок метода определяет знаменатель оценки Рунге
+    std::istringstream options(rest);
+    std::string weight;
+    std::string priority;
+    std::string method;
+    options >> weight >> priority >> method;
+    uint32_t kernel = protocol::kernel_from_name(method.substr(0, method.find(':')));
+
+    double step = (upper - lower) / static_cast<double>(IntegrationEngine::INITIAL_INTERVALS);
+    double previous = 0.0;
+    double elapsed = 0.0;
+    while (true)
+    {
+        std::ostringstream command;
+        command.precision(17);
+        command << "SUBMIT " << lower_text << " " << upper_text << " " << step << rest;
+
+        row.step = step;
+        row.elapsed_seconds = 0.0;
+        bool success = execute(command.str(), row);
+        elapsed += row.elapsed_seconds;
+        row.elapsed_seconds = elapsed;
+        if (!success)
+        {
+            return;
+        }
+
+        ++row.refinements;
+        if (row.refinements > 1)
+        {
+            row.error_estimate = std::abs(row.value - previous) / IntegrationEngine::runge_denominator(kernel);
+            if (row.error_estimate <= entry.tolerance)
+            {
+                row.success = true;
+                return;
+            }
+            if (row.refinements > IntegrationEngine::MAX_REFINEMENTS)
+            {
+                row.error_message = "Tolerance not reached with step " + std::to_string(step);
+                return;
+            }
+        }
+
+        previous = row.value;
+        step /= 2.0;
+    }
+}
+
+void BatchRunner::write_csv(const std::string &path, const std::vector<BatchRow> &rows)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot write " + path);
+    }
+
+    out << "line,command,job_id,success,value,elapsed_seconds,wall_seconds,step,refinements,error_estimate,extra,error\n";
+    for (const auto &row : rows)
+    {
+        std::string extra;
+        for (size_t i = 0; i < row.extra.size(); ++i)
+        {
+            extra += fmt::format("{}{:.17g}", i == 0 ? "" : ";", row.extra[i]);
+        }
+
+        out << fmt::format("{},{},{},{},{:.17g},{:.6f},{:.6f},{:.17g},{},{:.6e},{},{}\n",
+                           row.line, csv_quote(row.command), row.job_id, row.success ? 1 : 0, row.value,
+                           row.elapsed_seconds, row.wall_seconds, row.step, row.refinements, row.error_estimate,
+                           extra, csv_quote(row.error_message));
+    }
+
+    if (!out.flush())
+    {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+void BatchRunner::write_columnar(const std::string &path, const std::vector<BatchRow> &rows)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot write " + path);
+    }
+
+    std::vector<uint64_t> extra_offset = {0};
+    std::vector<double> extra;
+    for (const auto &row : rows)
+    {
+        extra.insert(extra.end(), row.extra.begin(), row.extra.end());
+        extra_offset.push_back(extra.size());
+    }
+
+    const char magic[8] = {'D', 'I', 'R', 'E', 'S', 'U', 'L', 'T'};
+    const uint32_t columns = 11;
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char *>(&columns), sizeof(columns));
+
+    write_column(out, COLUMN_UINT64, "line", column<uint64_t>(rows, [](const BatchRow &r)
+                                                                { return r.line; }));
+    write_column(out, COLUMN_UINT64, "job_id", column<uint64_t>(rows, [](const BatchRow &r)
+                                                                  { return r.job_id; }));
+    write_column(out, COLUMN_UINT64, "success", column<uint64_t>(rows, [](const BatchRow &r)
+                                                                   { return r.success ? 1 : 0; }));
+    write_column(out, COLUMN_DOUBLE, "value", column<double>(rows, [](const BatchRow &r)
+                                                               { return r.value; }));
+    write_column(out, COLUMN_DOUBLE, "elapsed_seconds", column<double>(rows, [](const BatchRow &r)
+                                                                         { return r.elapsed_seconds; }));
+    write_column(out, COLUMN_DOUBLE, "wall_seconds", column<double>(rows, [](const BatchRow &r)
+                                                                      { return r.wall_seconds; }));
+    write_column(out, COLUMN_DOUBLE, "step", column<double>(rows, [](const BatchRow &r)
+                                                              { return r.step; }));
+    write_column(out, COLUMN_UINT64, "refinements", column<uint64_t>(rows, [](const BatchRow &r)
+                                                                       { return r.refinements; }));
+    write_column(out, COLUMN_DOUBLE, "error_estimate", column<double>(rows, [](const BatchRow &r)
+                                                                        { return r.error_estimate; }));
+    write_column(out, COLUMN_UINT64, "extra_offset", extra_offset);
+    write_column(out, COLUMN_DOUBLE, "extra", extra);
+
+    if (!out.flush())
+    {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @file batch_runner.h
+ * @brief Модуль пакетного выполнения заданий из файла без участия пользователя
+ */
+
+/**
+ * @struct BatchEntry
+ * @brief Одно задание файла заданий
+ */
+struct BatchEntry
+{
+    // Номер строки в файле
+    uint64_t line = 0;
+    // Команда управления (SUBMIT, BATCH, QMC, SCAN или INVERT)
+    std::string command;
+    // Требуемая абсолютная точность (только SUBMIT с "tol=<value>" вместо шага, иначе 0)
+    double tolerance = 0.0;
+};
+
+/**
+ * @struct BatchRow
+ * @brief Итог одного задания файла
+ */
+struct BatchRow
+{
+    // Номер строки в файле
+    uint64_t line = 0;
+    // Команда из файла
+    std::string command;
+    // ID последнего задания на сервере (0 - задание не принято)
+    uint64_t job_id = 0;
+    // Успешно ли выполнено задание
+    bool success = false;
+    // Значение: интеграл (INVERT - найденный предел)
+    double value = 0.0;
+    // Время вычисления на сервере, секунды (при заданной точности - всех уточнений)
+    double elapsed_seconds = 0.0;
+    // Время от отправки до результата, секунды
+    double wall_seconds = 0.0;
+    // Шаг последнего задания (0 - шаг не задаётся, например QMC)
+    double step = 0.0;
+    // Количество выполненных заданий (больше 1 при заданной точности)
+    uint64_t refinements = 0;
+    // Оценка погрешности по правилу Рунге (при заданной точности)
+    double error_estimate = 0.0;
+    // Остальные числа ответа: стандартная ошибка QMC или ответы на запросы BATCH
+    std::vector<double> extra;
+    // Описание ошибки
+    std::string error_message;
+};
+
+/**
+ * @class BatchRunner
+ * @brief Выполняет задания файла по очереди через обработчик команд управления
+ *
+ * Файл заданий - команды управляющего сокета по одной на строку, строки
+ * с '#' и пустые пропускаются. В SUBMIT вместо шага можно указать
+ * "tol=<value>": шаг уменьшается вдвое, начиная с (upper - lower) / 1024,
+ * пока оценка погрешности по правилу Рунге не станет меньше value.
+ *
+ * @code
+ * # lower upper step weight priority method integrand
+ * SUBMIT 2 1000 0.001
+ * SUBMIT 2 1000000 tol=1e-9 1 0 simpson:compensated
+ * BATCH 0.001 2:10,10:100
+ * @endcode
+ *
+ * Каждое задание отправляется после завершения предыдущего, поэтому
+ * оно занимает весь кластер, а время задания не зависит от соседних
+ */
+class BatchRunner
+{
+public:
+    /**
+     * @brief Функция отправки ответа на команду
+     */
+    using Reply = std::function<void(const std::string &response)>;
+
+    /**
+     * @brief Обработчик команды управления (ответ может прийти из другого потока)
+     */
+    using CommandHandler = std::function<void(const std::string &request, Reply reply)>;
+
+    /**
+     * @brief Конструктор
+     * @param handler Обработчик команд (Server::handle_control_command)
+     */
+    explicit BatchRunner(CommandHandler handler);
+
+    /**
+     * @brief Разбирает файл заданий
+     * @param path Путь к файлу
+     * @return Задания в порядке следования
+     * @throws std::runtime_error если файл не открывается или строка некорректна (с номером строки)
+     */
+    static std::vector<BatchEntry> parse_file(const std::string &path);
+
+    /**
+     * @brief Разбирает задания из потока
+     * @see parse_file()
+     */
+    static std::vector<BatchEntry> parse(std::istream &input);
+
+    /**
+     * @brief Выполняет задания по очереди
+     * @param entries Задания
+     * @return Итоги в том же порядке (ошибка одного задания не прерывает остальные)
+     */
+    std::vector<BatchRow> run(const std::vector<BatchEntry> &entries);
+
+    /**
+     * @brief Записывает итоги в CSV (разделитель ',', первая строка - заголовок)
+     * @throws std::runtime_error если файл не удалось записать
+     */
+    static void write_csv(const std::string &path, const std::vector<BatchRow> &rows);
+
+    /**
+     * @brief Записывает итоги в двоичный поколоночный файл
+     *
+     * Формат (числа в порядке байтов сервера):
+     * - 8 байт "DIRESULT", uint32 число колонок;
+     * - для каждой колонки: uint8 тип (0 - uint64, 1 - double), uint8 длина
+     *   названия, название, uint64 число значений, значения подряд.
+     *
+     * Колонки line, job_id, success, refinements (uint64), value, elapsed_seconds,
+     * wall_seconds, step, error_estimate (double) содержат по значению на задание.
+     * Колонка extra (double) - числа extra всех заданий подряд, extra_offset
+     * (uint64, заданий + 1 значение) - начало чисел каждого задания в extra
+     *
+     * @throws std::runtime_error если файл не удалось записать
+     */
+    static void write_columnar(const std::string &path, const std::vector<BatchRow> &rows);
+
+private:
+    /**
+     * @brief Отправляет команду и ждёт ответ
+     */
+    std::string request(const std::string &command);
+
+    /**
+     * @brief Отправляет команду с заданием, ждёт его завершения и заполняет итог
+     * @return false, если задание не принято или завершилось неуспешно
+     */
+    bool execute(const std::string &command, BatchRow &row);
+
+    /**
+     * @brief Выполняет SUBMIT с заданной точностью, уменьшая шаг
+     */
+    void run_with_tolerance(const BatchEntry &entry, BatchRow &row);
+
+    // Обработчик команд управления
+    CommandHandler handler_;
+};
@@ -6,13 +6,25 @@ ClientConnection::ClientConnection(
     tcp::socket socket,
     uint64_t client_id,
     const SystemInfo &system_info)
-    : socket_(std::move(socket)), client_id_(client_id), system_info_(system_info)
+    : socket_(std::move(socket)), client_id_(client_id), system_info_(system_info),
+      effective_cores_(system_info.cpu_cores), worker_threads_(system_info.cpu_cores)
 {
     // Не вызываем get_ip_address() здесь - сокет может быть в переходном состоянии
     LOG_DEBUG("ClientConnection created: ID={}, Cores={}",
               client_id_, system_info_.cpu_cores);
 }
 
+ClientConnection::ClientConnection(
+    boost::asio::io_context &io_context,
+    uint64_t client_id,
+    const SystemInfo &system_info)
+    : socket_(io_context), client_id_(client_id), system_info_(system_info),
+      effective_cores_(system_info.cpu_cores), worker_threads_(system_info.cpu_cores), local_(true)
+{
+    LOG_DEBUG("Local ClientConnection created: ID={}, Cores={}",
+              client_id_, system_info_.cpu_cores);
+}
+
 ClientConnection::~ClientConnection()
 {
     close();
@@ -21,6 +33,9 @@ ClientConnection::~ClientConnection()
 
 std::string ClientConnection::get_ip_address()
 {
+    if (local_)
+        return "local";
+
     std::string result = net_utils::get_remote_address(socket_);
     if (result == "unknown")
         LOG_WARN("Failed to get IP address for client ID={}", client_id_);
@@ -29,6 +44,9 @@ std::string ClientConnection::get_ip_address()
 
 uint16_t ClientConnection::get_port()
 {
+    if (local_)
+        return 0;
+
     uint16_t result = net_utils::get_port(socket_);
     if (result == 0)
         LOG_WARN("Failed to get port for client ID={}", client_id_);
@@ -37,7 +55,7 @@ uint16_t ClientConnection::get_port()
 
 bool ClientConnection::is_connected() const
 {
-    return socket_.is_open();
+    return local_ || socket_.is_open();
 }
 
 void ClientConnection::close()
@@ -3,6 +3,7 @@
 #include <boost/asio.hpp>
 #include <memory>
 #include <atomic>
+#include <mutex>
 #include "messages.h"
 #include "systeminfo.h"
 
@@ -34,6 +35,17 @@ public:
         uint64_t client_id,
         const SystemInfo &system_info);
 
+    /**
+     * @brief Конструктор локального (внутрипроцессного) клиента без сетевого подключения
+     * @param io_context Контекст ввода/вывода для неоткрытого сокета
+     * @param client_id Уникальный ID клиента
+     * @param system_info Информация о вычислительных ресурсах локального исполнителя
+     */
+    ClientConnection(
+        boost::asio::io_context &io_context,
+        uint64_t client_id,
+        const SystemInfo &system_info);
+
     /**
      * @brief Деструктор - закрывает сокет
      */
@@ -65,6 +77,85 @@ public:
      */
     uint32_t get_cpu_cores() const { return system_info_.cpu_cores; }
 
+    /**
+     * @brief Геттер числа ядер, выделенных клиенту на его машине
+     *
+     * Клиенты на одной машине делят её ядра между собой, поэтому
+     * значение может быть меньше get_cpu_cores()
+     *
+     * @return Количество выделенных ядер
+     */
+    uint32_t get_effective_cores() const { return effective_cores_.load(); }
+
+    /**
+     * @brief Сеттер числа выделенных клиенту ядер
+     * @param cores Количество ядер
+     */
+    void set_effective_cores(uint32_t cores) { effective_cores_.store(cores); }
+
+    /**
+     * @brief Геттер числа рабочих потоков, установленного клиенту
+     * @note Вызывать под get_send_mutex()
+     */
+    uint32_t get_worker_threads() const { return worker_threads_; }
+
+    /**
+     * @brief Запоминает число рабочих потоков, отправленное клиенту командой SET_WORKERS
+     * @note Вызывать под get_send_mutex()
+     */
+    void set_worker_threads(uint32_t threads) { worker_threads_ = threads; }
+
+    /**
+     * @brief Геттер идентификатора машины клиента
+     * @return Строка-идентификатор (пустая, если клиент его не сообщил)
+     */
+    const std::string &get_host_fingerprint() const { return system_info_.host_fingerprint; }
+
+    /**
+     * @brief Запоминает адрес, по которому клиент принимает запросы кражи работы
+     * @param address IP адрес клиента
+     * @param port Порт (0 - клиент не принимает запросы)
+     * @note Вызывать до регистрации клиента в ClientManager
+     */
+    void set_peer_endpoint(std::string address, uint16_t port)
+    {
+        peer_address_ = std::move(address);
+        peer_port_ = port;
+    }
+
+    /**
+     * @brief Геттер адреса для запросов кражи работы
+     */
+    const std::string &get_peer_address() const { return peer_address_; }
+
+    /**
+     * @brief Геттер порта для запросов кражи работы
+     * @return Номер порта (0 - клиент не принимает запросы)
+     */
+    uint16_t get_peer_port() const { return peer_port_; }
+
+    /**
+     * @brief Запоминает параметры протокола, согласованные при handshake
+     * @note Вызывать до регистрации клиента в ClientManager
+     */
+    void set_protocol(const ProtocolSettings &settings) { protocol_ = settings; }
+
+    /**
+     * @brief Геттер согласованных параметров протокола
+     */
+    const ProtocolSettings &get_protocol() const { return protocol_; }
+
+    /**
+     * @brief Проверяет, поддерживает ли клиент возможность протокола
+     */
+    bool supports(Capability feature) const { return (protocol_.features & feature) != 0; }
+
+    /**
+     * @brief Проверяет, является ли клиент локальным исполнителем сервера
+     * @return true, если задачи выполняются внутри процесса сервера
+     */
+    bool is_local() const { return local_; }
+
     /**
      * @brief Геттер IP адреса клиента
      * @return Строка с IP адресом
@@ -83,6 +174,16 @@ public:
      */
     tcp::socket &get_socket() { return socket_; }
 
+    /**
+     * @brief Геттер мьютекса отправки
+     *
+     * Сообщения клиенту отправляют поток сессии и управляющие команды (отмена),
+     * поэтому каждая отправка (включая пару START_WORK + TaskBatch) выполняется под ним
+     *
+     * @return Ссылка на мьютекс
+     */
+    std::mutex &get_send_mutex() { return send_mutex_; }
+
     /**
      * @brief Проверяет, открыто ли соединение
      * @return true, если сокет открыт
@@ -123,8 +224,29 @@ private:
     uint64_t client_id_;
     // Информация о системе клиента
     SystemInfo system_info_;
+    // Число ядер, выделенных клиенту на его машине
+    std::atomic<uint32_t> effective_cores_{0};
+    // Число рабочих потоков клиента (изначально - все его ядра)
+    uint32_t worker_threads_ = 0;
     // Флаг отправки задачи
     std::atomic<bool> task_sent_{false};
     // Флаг получения результата
     std::atomic<bool> result_received_{false};
+    // Флаг локального исполнителя (без сокета)
+    bool local_ = false;
+    // Адрес и порт клиента для запросов кражи работы от других клиентов
+    std::string peer_address_;
+    uint16_t peer_port_ = 0;
+    // Параметры протокола, согласованные при handshake
+    ProtocolSettings protocol_;
+    // Сериализует отправку сообщений клиенту
+    std::mutex send_mutex_;
 };
+
+/**
+ * @brief Стабильный дескриптор клиента
+ *
+ * Владение разделяется между реестром ClientManager и всеми, кто получил
+ * дескриптор, поэтому объект остаётся валидным даже после удаления клиента из реестра
+ */
+using ClientHandle = std::shared_ptr<ClientConnection>;
@@ -2,7 +2,24 @@
 #include "logger.h"
 #include <algorithm>
 
+namespace
+{
+    /**
+     * @brief Порядок клиентов машины при делении ядер
+     *
+     * Клиенты с меньшим числом ядер обслуживаются первыми, чтобы
+     * не доставшиеся им ядра поровну разошлись по остальным
+     */
+    bool fewer_cores_first(const ClientHandle &a, const ClientHandle &b)
+    {
+        return a->get_cpu_cores() != b->get_cpu_cores()
+                   ? a->get_cpu_cores() < b->get_cpu_cores()
+                   : a->get_client_id() < b->get_client_id();
+    }
+} // namespace
+
 ClientManager::ClientManager()
+    : snapshot_(std::make_shared<const std::vector<ClientHandle>>())
 {
     LOG_INFO("ClientManager initialized");
 }
@@ -15,105 +32,142 @@ uint64_t ClientManager::add_client(std::unique_ptr<ClientConnection> connection)
         return 0;
     }
 
-    // Получаем данные до перемещения в вектор
-    uint64_t client_id = connection->get_client_id();
-    std::string ip_address = connection->get_ip_address();
-    uint32_t cpu_cores = connection->get_cpu_cores();
+    // Получаем данные до перемещения в реестр
+    ClientHandle client(std::move(connection));
+    uint64_t client_id = client->get_client_id();
+    std::string ip_address = client->get_ip_address();
+    uint32_t cpu_cores = client->get_cpu_cores();
 
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
 
     LOG_INFO("Adding client: ID={}, IP={}, Cores={}",
              client_id,
              ip_address,
              cpu_cores);
 
-    // Перемещаем в вектор
-    clients_.push_back(std::move(connection));
+    {
+        Shard &shard = shard_for(client_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.clients.emplace(client_id, client).second)
+        {
+            LOG_WARN("Client ID={} is already registered", client_id);
+            return 0;
+        }
+    }
+
+    // Публикуем новый снимок
+    std::vector<ClientHandle> clients(*std::atomic_load(&snapshot_));
+    clients.push_back(client);
+    publish_snapshot(std::move(clients));
+
+    client_count_++;
+    total_cpu_cores_ += client->get_effective_cores();
+    total_ram_mb_ += client->get_system_info().total_ram_mb;
+
+    const std::string &fingerprint = client->get_host_fingerprint();
+    if (!fingerprint.empty())
+    {
+        // Список машины хранится упорядоченным: при массовом подключении
+        // пересортировка на каждого клиента обходилась бы квадратично
+        auto &host_clients = hosts_[fingerprint];
+        host_clients.insert(std::upper_bound(host_clients.begin(), host_clients.end(), client, fewer_cores_first), client);
+        rebalance_host(fingerprint);
+    }
 
     LOG_INFO("Total clients: {}, Total CPU cores: {}",
-             clients_.size(),
-             get_total_cpu_cores_unlocked());
+             client_count_.load(),
+             total_cpu_cores_.load());
 
     return client_id;
 }
 
-size_t ClientManager::get_client_count() const
+ClientHandle ClientManager::get_client(uint64_t client_id) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return clients_.size();
+    const Shard &shard = shard_for(client_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.clients.find(client_id);
+    if (it != shard.clients.end())
+    {
+        return it->second;
+    }
+    return nullptr;
 }
 
-uint32_t ClientManager::get_total_cpu_cores() const
+ClientSnapshot ClientManager::get_all_clients() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return get_total_cpu_cores_unlocked();
+    return std::atomic_load(&snapshot_);
 }
 
-uint32_t ClientManager::get_total_cpu_cores_unlocked() const
+bool ClientManager::remove_client(uint64_t client_id)
 {
-    uint32_t total = 0;
-    for (const auto &client : clients_)
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+
+    ClientHandle removed;
     {
-        total += client->get_cpu_cores();
+        Shard &shard = shard_for(client_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.clients.find(client_id);
+        if (it != shard.clients.end())
+        {
+            removed = std::move(it->second);
+            shard.clients.erase(it);
+        }
     }
-    return total;
-}
 
-ClientConnection *ClientManager::get_client(uint64_t client_id)
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = std::find_if(clients_.begin(), clients_.end(),
-                           [client_id](const std::unique_ptr<ClientConnection> &client)
-                           {
-                               return client->get_client_id() == client_id;
-                           });
-
-    if (it != clients_.end())
+    if (!removed)
     {
-        return it->get();
+        LOG_WARN("Client ID={} not found for removal", client_id);
+        return false;
     }
-    return nullptr;
-}
 
-std::vector<ClientConnection *> ClientManager::get_all_clients()
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<ClientConnection *> result;
-    result.reserve(clients_.size());
+    LOG_INFO("Removing client: ID={}", client_id);
 
-    for (auto &client : clients_)
-    {
-        result.push_back(client.get());
-    }
+    std::vector<ClientHandle> clients(*std::atomic_load(&snapshot_));
+    clients.erase(std::remove(clients.begin(), clients.end(), removed), clients.end());
+    publish_snapshot(std::move(clients));
 
-    return result;
-}
+    client_count_--;
+    total_cpu_cores_ -= removed->get_effective_cores();
+    total_ram_mb_ -= removed->get_system_info().total_ram_mb;
 
-bool ClientManager::remove_client(uint64_t client_id)
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = std::find_if(clients_.begin(), clients_.end(),
-                           [client_id](const std::unique_ptr<ClientConnection> &client)
-                           {
-                               return client->get_client_id() == client_id;
-                           });
-
-    if (it != clients_.end())
+    const std::string &fingerprint = removed->get_host_fingerprint();
+    auto host = hosts_.find(fingerprint);
+    if (host != hosts_.end())
     {
-        LOG_INFO("Removing client: ID={}", client_id);
-        clients_.erase(it);
-        return true;
+        auto &host_clients = host->second;
+        host_clients.erase(std::remove(host_clients.begin(), host_clients.end(), removed), host_clients.end());
+        if (host_clients.empty())
+        {
+            hosts_.erase(host);
+        }
+        else
+        {
+            // Освободившиеся ядра достаются остальным клиентам машины
+            rebalance_host(fingerprint);
+        }
     }
 
-    LOG_WARN("Client ID={} not found for removal", client_id);
-    return false;
+    return true;
 }
 
 void ClientManager::clear()
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    LOG_INFO("Clearing all clients (count: {})", clients_.size());
-    clients_.clear();
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    LOG_INFO("Clearing all clients (count: {})", client_count_.load());
+
+    for (auto &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.clients.clear();
+    }
+    publish_snapshot({});
+    hosts_.clear();
+    resized_.clear();
+
+    client_count_.store(0);
+    total_cpu_cores_.store(0);
+    total_ram_mb_.store(0);
 }
 
 void ClientManager::stop_accepting()
@@ -122,23 +176,78 @@ void ClientManager::stop_accepting()
     LOG_INFO("Stopped accepting new clients");
 }
 
+void ClientManager::publish_snapshot(std::vector<ClientHandle> clients)
+{
+    std::atomic_store(&snapshot_,
+                      ClientSnapshot(std::make_shared<const std::vector<ClientHandle>>(std::move(clients))));
+}
+
+size_t ClientManager::get_host_count() const
+{
+    ClientSnapshot clients = get_all_clients();
+
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    size_t standalone = std::count_if(clients->begin(), clients->end(), [](const ClientHandle &client)
+                                      { return client->get_host_fingerprint().empty(); });
+    return hosts_.size() + standalone;
+}
+
+std::vector<ClientHandle> ClientManager::take_resized_clients()
+{
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    std::vector<ClientHandle> resized;
+    resized.swap(resized_);
+    return resized;
+}
+
+void ClientManager::rebalance_host(const std::string &fingerprint)
+{
+    // Клиенты уже упорядочены по fewer_cores_first, поэтому у последнего больше всего ядер
+    const std::vector<ClientHandle> &clients = hosts_[fingerprint];
+    uint32_t host_cores = clients.empty() ? 0 : clients.back()->get_cpu_cores();
+
+    uint32_t remaining = host_cores;
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        uint32_t fair_share = remaining / static_cast<uint32_t>(clients.size() - i);
+        uint32_t cores = std::max<uint32_t>(1, std::min(clients[i]->get_cpu_cores(), fair_share));
+        remaining -= std::min(cores, remaining);
+
+        uint32_t previous = clients[i]->get_effective_cores();
+        if (cores != previous)
+        {
+            clients[i]->set_effective_cores(cores);
+            total_cpu_cores_ += cores;
+            total_cpu_cores_ -= previous;
+            resized_.push_back(clients[i]);
+        }
+    }
+
+    if (clients.size() > 1)
+    {
+        LOG_INFO("Host {}: {} clients share {} cores", fingerprint, clients.size(), host_cores);
+    }
+}
+
 void ClientManager::log_clients_info() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    ClientSnapshot clients = get_all_clients();
 
     LOG_INFO("=== Connected Clients ===");
-    LOG_INFO("Total clients: {}", clients_.size());
-    LOG_INFO("Total CPU cores: {}", get_total_cpu_cores_unlocked());
+    LOG_INFO("Total clients: {}", clients->size());
+    LOG_INFO("Total CPU cores: {} on {} host(s)", get_total_cpu_cores(), get_host_count());
+    LOG_INFO("Total RAM: {} MB", get_total_ram_mb());
 
-    for (size_t i = 0; i < clients_.size(); ++i)
+    for (size_t i = 0; i < clients->size(); ++i)
     {
-        const auto &client = clients_[i];
-        LOG_INFO("  [{}] ID={}, IP={}:{}, OS={}, Cores={}",
+        const auto &client = (*clients)[i];
+        LOG_INFO("  [{}] ID={}, IP={}:{}, OS={}, Cores={}/{}",
                  i + 1,
                  client->get_client_id(),
                  client->get_ip_address(),
                  client->get_port(),
                  to_string(client->get_system_info().os_type),
+                 client->get_effective_cores(),
                  client->get_cpu_cores());
     }
     LOG_INFO("========================");
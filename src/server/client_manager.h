@@ -1,21 +1,40 @@
 #pragma once
 
 #include "client_connection.h"
+#include <array>
 #include <vector>
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <string>
+#include <unordered_map>
 
 /**
  * @file client_manager.h
  * @brief Модуль управления списком подключенных клиентов
  */
 
+/**
+ * @brief Неизменяемый снимок списка клиентов
+ *
+ * Снимок публикуется целиком при каждом изменении реестра (copy-on-write),
+ * поэтому читатели обходят его без блокировок и без риска инвалидации
+ */
+using ClientSnapshot = std::shared_ptr<const std::vector<ClientHandle>>;
+
 /**
  * @class ClientManager
  * @brief Управляет всеми подключенными клиентами
  *
- * Обеспечивает потокобезопасное добавление, удаление и доступ к клиентам
+ * Обеспечивает потокобезопасное добавление, удаление и доступ к клиентам.
+ *
+ * Поиск по ID выполняется за O(1) в одном из шардов (у каждого свой mutex),
+ * суммарные характеристики поддерживаются инкрементально, а перечисление
+ * клиентов выполняется по RCU-снимку без захвата блокировок.
+ *
+ * Клиенты с одинаковым идентификатором машины группируются: каждый сообщает
+ * все ядра машины, поэтому ядра делятся между ними и суммарно не превышают
+ * ядер машины (см. ClientConnection::get_effective_cores())
  */
 class ClientManager
 {
@@ -36,30 +55,61 @@ public:
      */
     uint64_t add_client(std::unique_ptr<ClientConnection> connection);
 
+    /**
+     * @brief Выдаёт новый уникальный ID клиента
+     * @return ID клиента
+     */
+    uint64_t generate_client_id() { return next_client_id_++; }
+
     /**
      * @brief Геттер числа подключенных клиентов
      * @return Количество клиентов
      */
-    size_t get_client_count() const;
+    size_t get_client_count() const { return client_count_.load(); }
 
     /**
      * @brief Геттер суммарного числа ядер CPU всех клиентов
-     * @return Суммарное количество ядер
+     *
+     * Ядра машины, на которой запущено несколько клиентов, учитываются один раз
+     *
+     * @return Суммарное количество выделенных клиентам ядер
+     */
+    uint32_t get_total_cpu_cores() const { return total_cpu_cores_.load(); }
+
+    /**
+     * @brief Геттер суммарного объёма ОЗУ всех клиентов
+     * @return Суммарный объём ОЗУ в МБайт
+     */
+    uint64_t get_total_ram_mb() const { return total_ram_mb_.load(); }
+
+    /**
+     * @brief Геттер числа различных машин среди клиентов
+     * @return Количество машин
+     */
+    size_t get_host_count() const;
+
+    /**
+     * @brief Забирает клиентов, доля ядер которых изменилась с предыдущего вызова
+     *
+     * При подключении клиента к машине с множеством клиентов обычно меняется
+     * доля только у него самого, поэтому перебирать всю машину не нужно
+     *
+     * @return Клиенты с изменившейся долей ядер (возможны повторы)
      */
-    uint32_t get_total_cpu_cores() const;
+    std::vector<ClientHandle> take_resized_clients();
 
     /**
      * @brief Геттер клиента по ID
      * @param client_id ID клиента
-     * @return Указатель на ClientConnection или nullptr, если не найден
+     * @return Дескриптор клиента или nullptr, если не найден
      */
-    ClientConnection *get_client(uint64_t client_id);
+    ClientHandle get_client(uint64_t client_id) const;
 
     /**
      * @brief Геттер всех клиентов
-     * @return Вектор указателей на всех клиентов
+     * @return Снимок списка клиентов на момент вызова
      */
-    std::vector<ClientConnection *> get_all_clients();
+    ClientSnapshot get_all_clients() const;
 
     /**
      * @brief Удаляет клиента по ID
@@ -90,16 +140,57 @@ public:
     void log_clients_info() const;
 
 private:
+    // Количество шардов реестра (степень двойки)
+    static constexpr size_t SHARD_COUNT = 16;
+
+    /**
+     * @struct Shard
+     * @brief Часть реестра со своим мьютексом
+     */
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, ClientHandle> clients;
+    };
+
+    /**
+     * @brief Возвращает шард, в котором хранится клиент с данным ID
+     */
+    Shard &shard_for(uint64_t client_id) { return shards_[client_id & (SHARD_COUNT - 1)]; }
+    const Shard &shard_for(uint64_t client_id) const { return shards_[client_id & (SHARD_COUNT - 1)]; }
+
+    /**
+     * @brief Публикует новый снимок списка клиентов
+     * @note Вызывать только под writer_mutex_
+     */
+    void publish_snapshot(std::vector<ClientHandle> clients);
+
     /**
-     * @brief Возвращает суммарное количество CPU ядер без блокировки mutex
-     * @note Использовать только внутри методов, где mutex уже захвачен
+     * @brief Заново делит ядра машины между её клиентами
+     *
+     * Ядра машины - наибольшее число ядер, сообщённое её клиентами. Каждый клиент
+     * получает поровну, но не больше собственных ядер и не меньше одного ядра
+     *
+     * @note Вызывать только под writer_mutex_
      */
-    uint32_t get_total_cpu_cores_unlocked() const;
+    void rebalance_host(const std::string &fingerprint);
+
+    // Шарды реестра: client_id -> клиент
+    std::array<Shard, SHARD_COUNT> shards_;
+    // Сериализует изменения реестра (добавление/удаление/очистка)
+    mutable std::mutex writer_mutex_;
+    // Клиенты, сгруппированные по машинам: идентификатор машины -> клиенты по возрастанию числа ядер
+    std::unordered_map<std::string, std::vector<ClientHandle>> hosts_;
+    // Клиенты с изменившейся долей ядер, ещё не забранные take_resized_clients()
+    std::vector<ClientHandle> resized_;
+    // Текущий снимок списка клиентов (читается через std::atomic_load)
+    ClientSnapshot snapshot_;
+
+    // Инкрементально поддерживаемые агрегаты
+    std::atomic<size_t> client_count_{0};
+    std::atomic<uint32_t> total_cpu_cores_{0};
+    std::atomic<uint64_t> total_ram_mb_{0};
 
-    // Список подключенных клиентов
-    std::vector<std::unique_ptr<ClientConnection>> clients_;
-    // Мьютекс для thread-safe доступа
-    mutable std::mutex mutex_;
     // Флаг приёма новых клиентов
     std::atomic<bool> accepting_{true};
     // Счётчик ID для новых клиентов
@@ -0,0 +1,79 @@
+#include "client_performance.h"
+#include "logger.h"
+#include <cmath>
+
+void ClientPerformance::update(uint64_t client_id, const ClientTelemetry &telemetry, double elapsed_seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClientEstimate &estimate = estimates_[client_id];
+
+    double previous_steal = estimate.last_report.steal_fraction;
+    estimate.last_report = telemetry;
+    estimate.reports++;
+
+    if (elapsed_seconds > 0.0 && telemetry.worker_threads > 0)
+    {
+        estimate.pending_thread_evals += telemetry.evals_per_second * elapsed_seconds / telemetry.worker_threads;
+        estimate.pending_seconds += elapsed_seconds;
+    }
+
+    if (estimate.pending_seconds >= MIN_SAMPLE_SECONDS && estimate.pending_thread_evals > 0.0)
+    {
+        double sample = estimate.pending_thread_evals / estimate.pending_seconds;
+        estimate.thread_evals_per_second = estimate.thread_evals_per_second > 0.0
+                                               ? EWMA_ALPHA * sample + (1.0 - EWMA_ALPHA) * estimate.thread_evals_per_second
+                                               : sample;
+        estimate.pending_thread_evals = 0.0;
+        estimate.pending_seconds = 0.0;
+    }
+
+    if (telemetry.steal_fraction >= 0.1 && previous_steal < 0.1)
+    {
+        LOG_WARN("Client {}: {:.0f}% CPU steal time, load average {:.2f}",
+                 client_id, 100.0 * telemetry.steal_fraction, telemetry.load_average);
+    }
+
+    LOG_DEBUG("Client {}: {:.3g} evals/s per thread ({:.3g} on {} threads in last batch), steal {:.1f}%, load {:.2f}, {:.0f} MHz",
+              client_id,
+              estimate.thread_evals_per_second,
+              telemetry.evals_per_second,
+              telemetry.worker_threads,
+              100.0 * telemetry.steal_fraction,
+              telemetry.load_average,
+              telemetry.cpu_mhz);
+}
+
+void ClientPerformance::seed(uint64_t client_id, double thread_evals_per_second)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    estimates_[client_id].thread_evals_per_second = thread_evals_per_second;
+}
+
+uint64_t ClientPerformance::get_max_task_steps(uint64_t client_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = estimates_.find(client_id);
+    if (it == estimates_.end() || it->second.thread_evals_per_second <= 0.0)
+    {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(std::ceil(it->second.thread_evals_per_second * TARGET_TASK_SECONDS));
+}
+
+std::optional<ClientEstimate> ClientPerformance::get_estimate(uint64_t client_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = estimates_.find(client_id);
+    if (it == estimates_.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void ClientPerformance::forget(uint64_t client_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    estimates_.erase(client_id);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include "messages.h"
+
+/**
+ * @file client_performance.h
+ * @brief Модуль оценки производительности клиентов по их отчётам
+ */
+
+/**
+ * @struct ClientEstimate
+ * @brief Текущая оценка производительности клиента
+ */
+struct ClientEstimate
+{
+    // Сглаженная скорость одного потока, вычислений функции в секунду
+    double thread_evals_per_second = 0.0;
+    // Последний отчёт клиента
+    ClientTelemetry last_report{};
+    // Количество учтённых отчётов
+    uint64_t reports = 0;
+    // Короткие пакеты копятся до MIN_SAMPLE_SECONDS и дают одно измерение
+    double pending_thread_evals = 0.0;
+    double pending_seconds = 0.0;
+};
+
+/**
+ * @class ClientPerformance
+ * @brief Экспоненциально сглаженная (EWMA) оценка скорости каждого клиента
+ *
+ * Оценка обновляется по каждому пакету результатов, поэтому клиент, машина
+ * которого занята другими задачами или снизила частоту, быстро получает
+ * фрагменты меньшего размера и не задерживает окончание задания
+ */
+class ClientPerformance
+{
+public:
+    // Вес нового измерения в сглаженной оценке
+    static constexpr double EWMA_ALPHA = 0.3;
+    // Желаемое время выполнения одной задачи на одном потоке клиента
+    static constexpr double TARGET_TASK_SECONDS = 1.0;
+    // Минимальная длительность одного измерения скорости
+    static constexpr double MIN_SAMPLE_SECONDS = 0.05;
+
+    ClientPerformance() = default;
+
+    // Запрет копирования
+    ClientPerformance(const ClientPerformance &) = delete;
+    ClientPerformance &operator=(const ClientPerformance &) = delete;
+
+    /**
+     * @brief Учитывает отчёт клиента о выполненном пакете
+     * @param client_id ID клиента
+     * @param telemetry Отчёт клиента
+     * @param elapsed_seconds Время выполнения пакета
+     */
+    void update(uint64_t client_id, const ClientTelemetry &telemetry, double elapsed_seconds);
+
+    /**
+     * @brief Задаёт начальную оценку клиента до его первых отчётов
+     *
+     * Последующие отчёты уточняют оценку как обычно
+     *
+     * @param client_id ID клиента
+     * @param thread_evals_per_second Ожидаемая скорость одного потока
+     */
+    void seed(uint64_t client_id, double thread_evals_per_second);
+
+    /**
+     * @brief Максимальный размер задачи для клиента
+     * @param client_id ID клиента
+     * @return Количество шагов интегрирования на TARGET_TASK_SECONDS работы одного потока
+     *         (0, если скорость клиента ещё неизвестна)
+     */
+    uint64_t get_max_task_steps(uint64_t client_id) const;
+
+    /**
+     * @brief Геттер оценки клиента
+     * @param client_id ID клиента
+     * @return Оценка или std::nullopt, если отчётов не было
+     */
+    std::optional<ClientEstimate> get_estimate(uint64_t client_id) const;
+
+    /**
+     * @brief Удаляет оценку отключившегося клиента
+     * @param client_id ID клиента
+     */
+    void forget(uint64_t client_id);
+
+private:
+    mutable std::mutex mutex_;
+    // Оценки клиентов: client_id -> оценка
+    std::unordered_map<uint64_t, ClientEstimate> estimates_;
+};
@@ -0,0 +1,206 @@
+#include "control_server.h"
+#include "logger.h"
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+namespace
+{
+    using local_stream = boost::asio::local::stream_protocol;
+
+    // Максимальная длина одной команды
+    constexpr size_t MAX_REQUEST_LENGTH = 64 * 1024;
+
+    /**
+     * @class ControlSession
+     * @brief Одно управляющее соединение
+     *
+     * Команды выполняются строго по очереди: следующая строка читается
+     * только после отправки ответа на предыдущую
+     */
+    class ControlSession : public std::enable_shared_from_this<ControlSession>
+    {
+    public:
+        ControlSession(local_stream::socket socket, ControlServer::CommandHandler &handler)
+            : socket_(std::move(socket)), buffer_(MAX_REQUEST_LENGTH), handler_(handler)
+        {
+        }
+
+        void start() { read_next(); }
+
+    private:
+        void read_next()
+        {
+            auto self = shared_from_this();
+            boost::asio::async_read_until(
+                socket_, buffer_, '\n',
+                [self](const boost::system::error_code &ec, size_t)
+                {
+                    if (ec)
+                    {
+                        // Клиент закрыл соединение или сервер останавливается
+                        return;
+                    }
+
+                    std::istream stream(&self->buffer_);
+                    std::string request;
+                    std::getline(stream, request);
+                    if (!request.empty() && request.back() == '\r')
+                    {
+                        request.pop_back();
+                    }
+
+                    self->dispatch(request);
+                });
+        }
+
+        void dispatch(const std::string &request)
+        {
+            auto self = shared_from_this();
+            auto executor = socket_.get_executor();
+
+            // Ответ может прийти из любого потока - переносим запись в поток io_context
+            ControlServer::Reply reply = [self, executor](const std::string &response)
+            {
+                boost::asio::post(executor, [self, response]()
+                                  { self->write(response); });
+            };
+
+            try
+            {
+                handler_(request, reply);
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("Control command '{}' failed: {}", request, e.what());
+                reply(std::string("ERROR ") + e.what());
+            }
+        }
+
+        void write(const std::string &response)
+        {
+            auto self = shared_from_this();
+            auto data = std::make_shared<std::string>(response + "\n");
+            boost::asio::async_write(
+                socket_, boost::asio::buffer(*data),
+                [self, data](const boost::system::error_code &ec, size_t)
+                {
+                    if (!ec)
+                    {
+                        self->read_next();
+                    }
+                });
+        }
+
+        local_stream::socket socket_;
+        boost::asio::streambuf buffer_;
+        ControlServer::CommandHandler &handler_;
+    };
+} // namespace
+
+#endif
+
+ControlServer::ControlServer(CommandHandler handler)
+    : handler_(std::move(handler))
+{
+}
+
+ControlServer::~ControlServer()
+{
+    stop();
+}
+
+void ControlServer::start(const std::string &socket_path)
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    if (running_.load())
+    {
+        LOG_WARN("ControlServer already running");
+        return;
+    }
+
+    socket_path_ = socket_path;
+
+    // Удаляем файл сокета, оставшийся от предыдущего запуска
+    std::remove(socket_path_.c_str());
+
+    try
+    {
+        acceptor_ = std::make_unique<local_stream::acceptor>(
+            io_context_, local_stream::endpoint(socket_path_));
+    }
+    catch (const boost::system::system_error &e)
+    {
+        LOG_ERROR("Failed to open control socket {}: {}", socket_path_, e.what());
+        throw std::runtime_error(
+            std::string("Failed to open control socket: ") + e.what());
+    }
+
+    running_.store(true);
+    do_accept();
+
+    io_thread_ = std::thread([this]()
+                             { io_context_.run(); });
+
+    LOG_INFO("Control socket listening on {}", socket_path_);
+#else
+    (void)socket_path;
+    throw std::runtime_error("Local control sockets are not supported on this platform");
+#endif
+}
+
+void ControlServer::stop()
+{
+    if (!running_.exchange(false))
+    {
+        return;
+    }
+
+    // Даём выполниться уже поставленным в очередь ответам (например, на SHUTDOWN)
+    if (std::this_thread::get_id() != io_thread_.get_id())
+    {
+        std::promise<void> drained;
+        boost::asio::post(io_context_, [&drained]()
+                          { drained.set_value(); });
+        drained.get_future().wait_for(std::chrono::milliseconds(100));
+    }
+
+    // Остановка io_context прерывает приём и все незавершённые операции сессий
+    io_context_.stop();
+    if (io_thread_.joinable())
+    {
+        io_thread_.join();
+    }
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    acceptor_.reset();
+    std::remove(socket_path_.c_str());
+#endif
+
+    LOG_INFO("Control socket closed");
+}
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+void ControlServer::do_accept()
+{
+    acceptor_->async_accept(
+        [this](const boost::system::error_code &ec, local_stream::socket socket)
+        {
+            if (ec)
+            {
+                if (ec != boost::asio::error::operation_aborted)
+                {
+                    LOG_ERROR("Control socket accept error: {}", ec.message());
+                }
+                return;
+            }
+
+            LOG_DEBUG("Control connection accepted");
+            std::make_shared<ControlSession>(std::move(socket), handler_)->start();
+
+            do_accept();
+        });
+}
+#endif
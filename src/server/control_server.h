@@ -0,0 +1,94 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+/**
+ * @file control_server.h
+ * @brief Модуль локального управляющего сокета сервера
+ */
+
+/**
+ * @class ControlServer
+ * @brief Принимает текстовые команды через локальный (Unix) сокет
+ *
+ * Протокол построчный: клиент отправляет одну команду на строку и получает
+ * одну строку ответа. Разбор и выполнение команд делегируются обработчику,
+ * который может ответить асинхронно (например, после завершения задания)
+ *
+ * @code
+ * $ echo "SUBMIT 2 1000 0.001" | socat - UNIX-CONNECT:/tmp/integration.sock
+ * OK 1
+ * @endcode
+ */
+class ControlServer
+{
+public:
+    /**
+     * @brief Функция отправки ответа на команду (потокобезопасна, вызывается ровно один раз)
+     */
+    using Reply = std::function<void(const std::string &response)>;
+
+    /**
+     * @brief Обработчик одной команды
+     */
+    using CommandHandler = std::function<void(const std::string &request, Reply reply)>;
+
+    /**
+     * @brief Конструктор
+     * @param handler Обработчик команд
+     */
+    explicit ControlServer(CommandHandler handler);
+
+    /**
+     * @brief Деструктор - останавливает сервер
+     */
+    ~ControlServer();
+
+    // Запрет копирования
+    ControlServer(const ControlServer &) = delete;
+    ControlServer &operator=(const ControlServer &) = delete;
+
+    /**
+     * @brief Начинает прослушивание локального сокета
+     * @param socket_path Путь к файлу сокета (существующий файл будет заменён)
+     * @throws std::runtime_error если сокет не удалось открыть или платформа не поддерживает локальные сокеты
+     */
+    void start(const std::string &socket_path);
+
+    /**
+     * @brief Останавливает прослушивание и закрывает все управляющие соединения
+     */
+    void stop();
+
+    /**
+     * @brief Проверяет, запущен ли сервер
+     */
+    bool is_running() const { return running_.load(); }
+
+private:
+    // Обработчик команд
+    CommandHandler handler_;
+    // Контекст ввода/вывода управляющих соединений
+    boost::asio::io_context io_context_;
+    // Поток, обслуживающий io_context_
+    std::thread io_thread_;
+    // Путь к файлу сокета
+    std::string socket_path_;
+    // Флаг работы
+    std::atomic<bool> running_{false};
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    /**
+     * @brief Запускает асинхронный приём следующего соединения
+     */
+    void do_accept();
+
+    // Аксептор локального сокета
+    std::unique_ptr<boost::asio::local::stream_protocol::acceptor> acceptor_;
+#endif
+};
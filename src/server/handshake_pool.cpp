@@ -0,0 +1,120 @@
+#include "handshake_pool.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+
+HandshakePool::HandshakePool(Handler handler)
+    : handler_(std::move(handler))
+{
+}
+
+HandshakePool::~HandshakePool()
+{
+    stop();
+}
+
+void HandshakePool::start(size_t workers, size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = std::max<size_t>(capacity, 1);
+    stopped_ = false;
+
+    for (size_t i = 0; i < std::max<size_t>(workers, 1); ++i)
+    {
+        workers_.emplace_back(&HandshakePool::worker_loop, this);
+    }
+
+    LOG_INFO("Handshake pool started: {} worker(s), queue of {}", workers_.size(), capacity_);
+}
+
+bool HandshakePool::try_submit(PendingClient client)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_ || queue_.size() >= capacity_)
+        {
+            return false;
+        }
+        queue_.push_back(std::move(client));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+std::chrono::milliseconds HandshakePool::retry_after() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Время, за которое потоки разберут текущую очередь
+    double seconds = registration_seconds_ * static_cast<double>(queue_.size()) /
+                     static_cast<double>(std::max<size_t>(workers_.size(), 1));
+
+    auto hint = std::chrono::milliseconds(static_cast<int64_t>(std::ceil(seconds * 1000.0)));
+    return std::clamp(hint, MIN_RETRY_AFTER, MAX_RETRY_AFTER);
+}
+
+void HandshakePool::stop()
+{
+    std::deque<PendingClient> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_ && workers_.empty())
+        {
+            return;
+        }
+        stopped_ = true;
+        abandoned.swap(queue_);
+    }
+    cv_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    workers_.clear();
+
+    // Не дождавшиеся регистрации клиенты узнают об остановке по разрыву соединения
+    for (auto &client : abandoned)
+    {
+        boost::system::error_code ec;
+        client.socket->close(ec);
+    }
+}
+
+void HandshakePool::worker_loop()
+{
+    while (true)
+    {
+        PendingClient client;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]
+                     { return stopped_ || !queue_.empty(); });
+            if (stopped_)
+            {
+                return;
+            }
+            client = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            handler_(client);
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Failed to register client {}:{}: {}", client.ip, client.port, e.what());
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        registration_seconds_ = registration_seconds_ > 0.0
+                                    ? EWMA_ALPHA * elapsed.count() + (1.0 - EWMA_ALPHA) * registration_seconds_
+                                    : elapsed.count();
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "messages.h"
+
+using tcp = boost::asio::ip::tcp;
+
+/**
+ * @file handshake_pool.h
+ * @brief Модуль ограниченного пула регистрации подключившихся клиентов
+ */
+
+/**
+ * @struct PendingClient
+ * @brief Клиент, приславший запрос handshake и ожидающий регистрации
+ */
+struct PendingClient
+{
+    // Сокет клиента
+    std::shared_ptr<tcp::socket> socket;
+    // Полученный запрос
+    HandshakeRequest request;
+    // Адрес клиента
+    std::string ip;
+    // Порт клиента
+    uint16_t port = 0;
+};
+
+/**
+ * @class HandshakePool
+ * @brief Регистрирует клиентов фиксированным числом потоков с ограниченной очередью
+ *
+ * При массовом подключении клиентов очередь ограничивает число
+ * ожидающих регистрации, а вместо нового потока на каждое подключение
+ * работают несколько постоянных. Если очередь заполнена, клиенту
+ * отказывают с подсказкой, через сколько повторить попытку
+ */
+class HandshakePool
+{
+public:
+    /**
+     * @brief Функция регистрации одного клиента
+     */
+    using Handler = std::function<void(PendingClient &client)>;
+
+    // Границы подсказки о повторе подключения
+    static constexpr std::chrono::milliseconds MIN_RETRY_AFTER{100};
+    static constexpr std::chrono::milliseconds MAX_RETRY_AFTER{30000};
+    // Вес нового измерения в сглаженном времени регистрации
+    static constexpr double EWMA_ALPHA = 0.1;
+
+    /**
+     * @brief Конструктор
+     * @param handler Функция регистрации клиента
+     */
+    explicit HandshakePool(Handler handler);
+
+    /**
+     * @brief Деструктор - останавливает пул
+     */
+    ~HandshakePool();
+
+    // Запрет копирования
+    HandshakePool(const HandshakePool &) = delete;
+    HandshakePool &operator=(const HandshakePool &) = delete;
+
+    /**
+     * @brief Запускает потоки регистрации
+     * @param workers Количество потоков
+     * @param capacity Наибольшее число клиентов в очереди
+     */
+    void start(size_t workers, size_t capacity);
+
+    /**
+     * @brief Ставит клиента в очередь регистрации
+     * @param client Клиент
+     * @return false, если очередь заполнена или пул остановлен
+     */
+    bool try_submit(PendingClient client);
+
+    /**
+     * @brief Оценивает, через сколько освободится место в очереди
+     * @return Время до повтора подключения
+     */
+    std::chrono::milliseconds retry_after() const;
+
+    /**
+     * @brief Останавливает пул: ожидающие в очереди отключаются, потоки присоединяются
+     */
+    void stop();
+
+private:
+    /**
+     * @brief Функция потока регистрации
+     */
+    void worker_loop();
+
+    Handler handler_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<PendingClient> queue_;
+    size_t capacity_ = 0;
+    bool stopped_ = false;
+    // Сглаженное время регистрации одного клиента, секунды
+    double registration_seconds_ = 0.0;
+
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,194 @@
+#include "host_profiles.h"
+#include "logger.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Первая строка файла профилей
+    const char *PROFILES_HEADER = "# host profiles v1";
+
+    /**
+     * @brief Делит строку по символу табуляции
+     */
+    std::vector<std::string> split_fields(const std::string &line)
+    {
+        std::vector<std::string> fields;
+        std::istringstream iss(line);
+        std::string field;
+        while (std::getline(iss, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+        return fields;
+    }
+
+    /**
+     * @brief Сглаживает значение, первое измерение принимается как есть
+     */
+    double smooth(double current, double sample, double alpha)
+    {
+        return current > 0.0 ? alpha * sample + (1.0 - alpha) * current : sample;
+    }
+} // namespace
+
+HostProfileStore::HostProfileStore(std::string path)
+    : path_(std::move(path))
+{
+}
+
+void HostProfileStore::load()
+{
+    if (path_.empty())
+    {
+        return;
+    }
+
+    std::ifstream file(path_);
+    if (!file)
+    {
+        LOG_INFO("No host profiles at {}, starting with empty profiles", path_);
+        return;
+    }
+
+    // Формат строки: fingerprint \t tasks \t failures \t rtt [\t method=evals_per_second ...]
+    std::unordered_map<std::string, HostProfile> profiles;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        auto fields = split_fields(line);
+        if (fields.size() < 4 || fields[0].empty())
+        {
+            LOG_WARN("Skipping malformed host profile line: {}", line);
+            continue;
+        }
+
+        try
+        {
+            HostProfile profile;
+            profile.tasks = std::stoull(fields[1]);
+            profile.failures = std::stoull(fields[2]);
+            profile.rtt_seconds = std::stod(fields[3]);
+
+            for (size_t i = 4; i < fields.size(); ++i)
+            {
+                auto separator = fields[i].rfind('=');
+                if (separator == std::string::npos)
+                {
+                    continue;
+                }
+                profile.thread_evals_per_second[fields[i].substr(0, separator)] = std::stod(fields[i].substr(separator + 1));
+            }
+
+            profiles[fields[0]] = std::move(profile);
+        }
+        catch (const std::exception &)
+        {
+            LOG_WARN("Skipping malformed host profile line: {}", line);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    profiles_ = std::move(profiles);
+    dirty_ = false;
+
+    LOG_INFO("Loaded {} host profile(s) from {}", profiles_.size(), path_);
+}
+
+void HostProfileStore::save()
+{
+    if (path_.empty())
+    {
+        return;
+    }
+
+    std::ostringstream out;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_)
+        {
+            return;
+        }
+
+        out << PROFILES_HEADER << '\n';
+        for (const auto &[fingerprint, profile] : profiles_)
+        {
+            out << fingerprint << '\t' << profile.tasks << '\t' << profile.failures << '\t' << profile.rtt_seconds;
+            for (const auto &[method, evals] : profile.thread_evals_per_second)
+            {
+                out << '\t' << method << '=' << evals;
+            }
+            out << '\n';
+        }
+        dirty_ = false;
+    }
+
+    // Запись во временный файл и переименование: прерванная запись не портит профили
+    std::string temp_path = path_ + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        file << out.str();
+        if (!file)
+        {
+            LOG_WARN("Failed to write host profiles to {}", temp_path);
+            return;
+        }
+    }
+
+    if (std::rename(temp_path.c_str(), path_.c_str()) != 0)
+    {
+        LOG_WARN("Failed to replace host profiles file {}", path_);
+        return;
+    }
+
+    LOG_DEBUG("Host profiles saved to {}", path_);
+}
+
+std::optional<HostProfile> HostProfileStore::get(const std::string &fingerprint) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = profiles_.find(fingerprint);
+    if (it == profiles_.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void HostProfileStore::record(const std::string &fingerprint,
+                              const std::string &method,
+                              double thread_evals_per_second,
+                              uint64_t tasks,
+                              uint64_t failures,
+                              double rtt_seconds)
+{
+    if (fingerprint.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    HostProfile &profile = profiles_[fingerprint];
+
+    profile.tasks += tasks;
+    profile.failures += failures;
+
+    if (thread_evals_per_second > 0.0 && !method.empty())
+    {
+        double &evals = profile.thread_evals_per_second[method];
+        evals = smooth(evals, thread_evals_per_second, EWMA_ALPHA);
+    }
+    if (rtt_seconds >= 0.0)
+    {
+        profile.rtt_seconds = smooth(profile.rtt_seconds, rtt_seconds, EWMA_ALPHA);
+    }
+
+    dirty_ = true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @file host_profiles.h
+ * @brief Модуль сохраняемых между запусками профилей производительности машин
+ */
+
+/**
+ * @struct HostProfile
+ * @brief Накопленная производительность одной машины
+ */
+struct HostProfile
+{
+    // Скорость одного потока по методам: название метода -> вычислений функции в секунду
+    std::map<std::string, double> thread_evals_per_second;
+    // Выполнено задач
+    uint64_t tasks = 0;
+    // Из них с ошибкой
+    uint64_t failures = 0;
+    // Сглаженное время доставки пакета и результатов без учёта вычислений, секунды
+    double rtt_seconds = 0.0;
+
+    /**
+     * @brief Доля задач, завершившихся ошибкой
+     * @return Значение 0..1
+     */
+    double failure_rate() const
+    {
+        return tasks > 0 ? static_cast<double>(failures) / static_cast<double>(tasks) : 0.0;
+    }
+};
+
+/**
+ * @class HostProfileStore
+ * @brief Профили машин клиентов, ключ - идентификатор машины
+ *
+ * Профили загружаются из текстового файла при запуске сервера и сохраняются
+ * после каждого задания и при остановке. Новый клиент знакомой машины сразу
+ * получает оценку скорости из профиля, поэтому первые же пакеты заданий
+ * распределяются с учётом производительности клиентов
+ */
+class HostProfileStore
+{
+public:
+    // Вес нового измерения в сглаженных значениях профиля
+    static constexpr double EWMA_ALPHA = 0.2;
+
+    /**
+     * @brief Конструктор
+     * @param path Путь к файлу профилей (пустой - профили не сохраняются)
+     */
+    explicit HostProfileStore(std::string path);
+
+    // Запрет копирования
+    HostProfileStore(const HostProfileStore &) = delete;
+    HostProfileStore &operator=(const HostProfileStore &) = delete;
+
+    /**
+     * @brief Загружает профили из файла
+     *
+     * Отсутствующий файл не является ошибкой, повреждённые строки пропускаются
+     */
+    void load();
+
+    /**
+     * @brief Сохраняет профили в файл, если они изменились
+     */
+    void save();
+
+    /**
+     * @brief Геттер профиля машины
+     * @param fingerprint Идентификатор машины
+     * @return Профиль или std::nullopt, если машина не встречалась
+     */
+    std::optional<HostProfile> get(const std::string &fingerprint) const;
+
+    /**
+     * @brief Учитывает выполненный клиентом пакет
+     * @param fingerprint Идентификатор машины
+     * @param method Название метода интегрирования
+     * @param thread_evals_per_second Текущая оценка скорости одного потока (0 - неизвестна)
+     * @param tasks Количество задач в пакете
+     * @param failures Количество задач с ошибкой
+     * @param rtt_seconds Время доставки без учёта вычислений (< 0 - не измерено)
+     */
+    void record(const std::string &fingerprint,
+                const std::string &method,
+                double thread_evals_per_second,
+                uint64_t tasks,
+                uint64_t failures,
+                double rtt_seconds);
+
+private:
+    // Путь к файлу профилей
+    std::string path_;
+    mutable std::mutex mutex_;
+    // Профили: идентификатор машины -> профиль
+    std::unordered_map<std::string, HostProfile> profiles_;
+    // Есть несохранённые изменения
+    bool dirty_ = false;
+};
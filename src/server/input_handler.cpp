@@ -11,37 +11,55 @@ InputHandler::~InputHandler()
 
 void InputHandler::start(StartCallback on_start)
 {
-    if (running_.load())
+    if (is_running())
     {
         LOG_WARN("InputHandler already running");
         return;
     }
 
-    on_start_callback_ = std::move(on_start);
-    stop_requested_.store(false);
-    running_.store(true);
+    // Предыдущий поток мог завершиться сам после команды START
+    if (input_thread_.joinable())
+    {
+        input_thread_.join();
+    }
 
-    input_thread_ = std::thread(&InputHandler::input_thread_func, this);
+    state_ = std::make_shared<State>();
+    state_->on_start_callback = std::move(on_start);
+
+    input_thread_ = std::thread(&InputHandler::input_thread_func, state_);
 
     LOG_INFO("InputHandler started, waiting for 'START' command...");
 }
 
 void InputHandler::stop()
 {
-    if (!running_.load())
+    if (!state_)
     {
         return;
     }
 
     LOG_INFO("Stopping InputHandler...");
 
-    stop_requested_.store(true);
-    running_.store(false);
+    state_->stop_requested.store(true);
+
+    if (input_thread_.joinable())
+    {
+        if (state_->finished.load())
+        {
+            input_thread_.join();
+        }
+        else
+        {
+            // Поток заблокирован в чтении консоли и завершится на следующей строке или EOF
+            input_thread_.detach();
+        }
+    }
+    state_.reset();
 
     LOG_INFO("InputHandler stopped");
 }
 
-void InputHandler::input_thread_func()
+void InputHandler::input_thread_func(std::shared_ptr<State> state)
 {
     LOG_DEBUG("Input thread started");
 
@@ -50,12 +68,16 @@ void InputHandler::input_thread_func()
     LOG_INFO("Type 'START' and press Enter to begin integration\n");
     LOG_INFO("========================================\n\n");
 
-    while (!stop_requested_.load())
+    while (!state->stop_requested.load())
     {
         std::string input;
-        std::getline(std::cin, input);
+        if (!std::getline(std::cin, input))
+        {
+            // Консоль закрыта: команда START больше не поступит
+            break;
+        }
 
-        if (stop_requested_.load())
+        if (state->stop_requested.load())
         {
             break;
         }
@@ -68,9 +90,9 @@ void InputHandler::input_thread_func()
         {
             LOG_INFO("START command received");
 
-            if (on_start_callback_)
+            if (state->on_start_callback)
             {
-                on_start_callback_();
+                state->on_start_callback();
             }
 
             // После команды START прекращаем ожидание
@@ -82,6 +104,10 @@ void InputHandler::input_thread_func()
         }
     }
 
-    running_.store(false);
-    LOG_DEBUG("Input thread finished");
+    // Отсоединённый поток может завершиться уже после остановки логгера
+    if (!state->stop_requested.load())
+    {
+        LOG_DEBUG("Input thread finished");
+    }
+    state->finished.store(true);
 }
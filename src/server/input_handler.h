@@ -2,6 +2,7 @@
 
 #include <string>
 #include <functional>
+#include <memory>
 #include <thread>
 #include <atomic>
 
@@ -13,6 +14,10 @@
 /**
  * @class InputHandler
  * @brief Читает команды пользователя из консоли в отдельном потоке
+ *
+ * Чтение из консоли нельзя прервать переносимо, поэтому поток, ещё
+ * ожидающий ввода при остановке, отсоединяется. Всё нужное ему состояние
+ * хранится отдельно от объекта и переживает его
  */
 class InputHandler
 {
@@ -41,7 +46,8 @@ public:
     /**
      * @brief Остановить обработчик ввода
      *
-     * Останавливает поток чтения и дожидается его завершения
+     * Завершившийся поток чтения присоединяется, а ожидающий ввода - отсоединяется:
+     * callback после остановки не вызывается
      */
     void stop();
 
@@ -49,20 +55,31 @@ public:
      * @brief Проверить, запущен ли обработчик
      * @return true, если обработчик активен
      */
-    bool is_running() const { return running_.load(); }
+    bool is_running() const { return state_ && !state_->finished.load(); }
 
 private:
+    /**
+     * @struct State
+     * @brief Состояние, разделяемое с потоком чтения
+     */
+    struct State
+    {
+        // Флаг запроса остановки
+        std::atomic<bool> stop_requested{false};
+        // Выставляется потоком при завершении
+        std::atomic<bool> finished{false};
+        // Callback для команды START
+        StartCallback on_start_callback;
+    };
+
     /**
      * @brief Функция потока обработки ввода
+     * @param state Состояние обработчика
      */
-    void input_thread_func();
+    static void input_thread_func(std::shared_ptr<State> state);
 
     // Поток обработки ввода
     std::thread input_thread_;
-    // Флаг работы потока
-    std::atomic<bool> running_{false};
-    // Флаг запроса остановки
-    std::atomic<bool> stop_requested_{false};
-    // Callback для команды START
-    StartCallback on_start_callback_;
+    // Состояние текущего потока чтения
+    std::shared_ptr<State> state_;
 };
@@ -0,0 +1,136 @@
+#include "inverse_solver.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    // Наибольшее число делений шага пополам, если он выходит из области определения функции
+    constexpr int MAX_STEP_HALVINGS = 60;
+} // namespace
+
+InverseSolver::InverseSolver(const IntegrationParameters &params)
+    : integrand_(params.integrand),
+      target_(params.target)
+{
+    if (!params.inverse || !std::isfinite(params.lower_limit) || !std::isfinite(params.target))
+    {
+        throw std::invalid_argument("Invalid inverse query parameters");
+    }
+
+    known_[params.lower_limit] = 0.0;
+    advance(params.lower_limit, 0.0);
+}
+
+IntegrationParameters InverseSolver::get_step_parameters(const IntegrationParameters &params) const
+{
+    // Отрезки вблизи решения короче шага задания
+    IntegrationParameters step = params;
+    step.lower_limit = interval_.lower;
+    step.upper_limit = interval_.upper;
+    step.step = std::min(params.step, 0.5 * (interval_.upper - interval_.lower));
+    return step;
+}
+
+void InverseSolver::add(double value)
+{
+    if (!std::isfinite(value))
+    {
+        throw std::runtime_error("Integral over [" + std::to_string(interval_.lower) + ", " +
+                                 std::to_string(interval_.upper) + "] is not finite");
+    }
+
+    // Отрезок идёт от известной точки вправо или влево
+    const double integral = known_.at(origin_) + (next_ > origin_ ? value : -value);
+    known_[next_] = integral;
+    ++iterations_;
+
+    advance(next_, integral);
+    if (!converged_ && iterations_ >= MAX_ITERATIONS)
+    {
+        throw std::runtime_error("No solution found after " + std::to_string(iterations_) + " iterations");
+    }
+}
+
+void InverseSolver::advance(double x, double integral)
+{
+    result_ = x;
+    residual_ = integral - target_;
+    if (std::abs(residual_) <= TOLERANCE * std::max(1.0, std::abs(target_)))
+    {
+        converged_ = true;
+        return;
+    }
+
+    // Соседние известные точки, между которыми I(x) - N меняет знак
+    auto hi = std::adjacent_find(known_.begin(), known_.end(),
+                                 [this](const auto &left, const auto &right)
+                                 { return (left.second < target_) != (right.second < target_); });
+    const bool bracketed = hi != known_.end();
+    auto lo = hi;
+    if (bracketed)
+    {
+        ++hi;
+        if (hi->first - lo->first <= TOLERANCE * std::max(1.0, std::abs(x)))
+        {
+            // Вилка не шире точности: ответ - её конец с меньшей невязкой
+            const auto &best = std::abs(lo->second - target_) <= std::abs(hi->second - target_) ? *lo : *hi;
+            result_ = best.first;
+            residual_ = best.second - target_;
+            converged_ = true;
+            return;
+        }
+    }
+
+    // Шаг Ньютона: производная интеграла - сама функция
+    double candidate = x - residual_ / integrands::evaluate(integrand_, x);
+    if (bracketed && !(candidate > lo->first && candidate < hi->first))
+    {
+        candidate = 0.5 * (lo->first + hi->first);
+    }
+    else if (!std::isfinite(candidate))
+    {
+        throw std::runtime_error("Integrand vanishes or is undefined at x = " + std::to_string(x));
+    }
+
+    if (std::abs(candidate - x) <= TOLERANCE * std::max(1.0, std::abs(x)))
+    {
+        converged_ = true;
+        return;
+    }
+
+    // Ближайшая известная точка: интегрировать нужно только от неё
+    auto right = known_.lower_bound(candidate);
+    auto nearest = right;
+    if (right == known_.end() ||
+        (right != known_.begin() && candidate - std::prev(right)->first < right->first - candidate))
+    {
+        nearest = std::prev(right);
+    }
+    if (nearest->first == candidate)
+    {
+        result_ = nearest->first;
+        residual_ = nearest->second - target_;
+        converged_ = true;
+        return;
+    }
+    origin_ = nearest->first;
+
+    // Шаг, выходящий из области определения, укорачивается к известной точке
+    for (int halving = 0;
+         !integrands::is_valid_domain(integrand_, std::min(origin_, candidate), std::max(origin_, candidate));
+         ++halving)
+    {
+        if (halving == MAX_STEP_HALVINGS)
+        {
+            throw std::runtime_error("Step from x = " + std::to_string(origin_) +
+                                     " leaves the domain of the integrand");
+        }
+        candidate = origin_ + 0.5 * (candidate - origin_);
+    }
+
+    next_ = candidate;
+    interval_ = {std::min(origin_, next_), std::max(origin_, next_)};
+}
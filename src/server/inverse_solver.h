@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include "job_queue.h"
+#include "query_batch.h"
+
+/**
+ * @file inverse_solver.h
+ * @brief Модуль обратного запроса: поиск x, при котором интеграл от a до x равен заданному значению
+ */
+
+/**
+ * @class InverseSolver
+ * @brief Решает уравнение I(x) = N, где I(x) - интеграл функции от lower_limit до x
+ *
+ * Производная I(x) - сама подынтегральная функция, она вычисляется на сервере
+ * в одной точке, поэтому следующая точка - шаг Ньютона x + (N - I(x)) / f(x).
+ * Как только среди известных точек есть пара с разными знаками I(x) - N,
+ * точка Ньютона, выходящая из этой вилки, заменяется её серединой.
+ *
+ * Значения I во всех вычисленных точках сохраняются, и каждая новая точка
+ * требует интеграла только от ближайшей известной точки до неё: это отрезок,
+ * который интегрируется кластером как небольшое отдельное задание. Ближе
+ * к решению отрезки быстро укорачиваются, а уже вычисленные отрезки
+ * не пересчитываются.
+ *
+ * @note Не потокобезопасен: вызывается под мьютексом сервера
+ */
+class InverseSolver
+{
+public:
+    // Наибольшее число отрезков (итераций), после которого поиск считается неудачным
+    static constexpr size_t MAX_ITERATIONS = 64;
+    // Относительная точность по значению интеграла и по x
+    static constexpr double TOLERANCE = 1e-12;
+
+    /**
+     * @brief Начинает поиск от нижнего предела (I(lower_limit) = 0)
+     * @param params Параметры обратного запроса
+     * @throws std::invalid_argument если параметры не описывают обратный запрос
+     * @throws std::runtime_error если первый шаг не удалось выбрать
+     */
+    explicit InverseSolver(const IntegrationParameters &params);
+
+    /**
+     * @brief Найдено ли решение
+     */
+    bool is_converged() const { return converged_; }
+
+    /**
+     * @brief Отрезок, интеграл по которому нужен для следующей точки
+     * @note Имеет смысл, пока решение не найдено
+     */
+    const QueryRange &get_interval() const { return interval_; }
+
+    /**
+     * @brief Параметры задания очередного шага
+     * @param params Параметры обратного запроса
+     * @return Те же параметры с пределами get_interval() и шагом не больше половины отрезка
+     */
+    IntegrationParameters get_step_parameters(const IntegrationParameters &params) const;
+
+    /**
+     * @brief Принимает интеграл по отрезку get_interval() и выбирает следующую точку
+     * @param value Интеграл по отрезку
+     * @throws std::runtime_error если значение некорректно, шаг выходит из области
+     *         определения функции или решение не найдено за MAX_ITERATIONS отрезков
+     */
+    void add(double value);
+
+    /**
+     * @brief Найденный x (до сходимости - последняя вычисленная точка)
+     */
+    double get_result() const { return result_; }
+
+    /**
+     * @brief Значение I(x) - N в найденной точке
+     */
+    double get_residual() const { return residual_; }
+
+    /**
+     * @brief Количество вычисленных отрезков
+     */
+    size_t get_iterations() const { return iterations_; }
+
+private:
+    /**
+     * @brief Выбирает следующую точку после точки x со значением I(x) или фиксирует сходимость
+     */
+    void advance(double x, double integral);
+
+    // Подынтегральная функция
+    IntegrandSpec integrand_;
+    // Требуемое значение интеграла
+    double target_;
+    // Вычисленные точки: x -> I(x)
+    std::map<double, double> known_;
+    // Точка, в которой вычисляется I
+    double next_ = 0.0;
+    // Известная точка, от которой интегрируется отрезок до next_
+    double origin_ = 0.0;
+    // Отрезок между origin_ и next_
+    QueryRange interval_;
+    // Последняя вычисленная точка или решение
+    double result_ = 0.0;
+    // I(result_) - N
+    double residual_ = 0.0;
+    // Количество вычисленных отрезков
+    size_t iterations_ = 0;
+    // Решение найдено
+    bool converged_ = false;
+};
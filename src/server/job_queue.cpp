@@ -0,0 +1,272 @@
+#include "job_queue.h"
+#include "logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+std::string to_string(JobState state)
+{
+    switch (state)
+    {
+    case JobState::QUEUED:
+        return "QUEUED";
+    case JobState::RUNNING:
+        return "RUNNING";
+    case JobState::COMPLETED:
+        return "COMPLETED";
+    case JobState::FAILED:
+        return "FAILED";
+    case JobState::CANCELLED:
+        return "CANCELLED";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+uint64_t JobQueue::submit(const IntegrationParameters &params, uint32_t weight, uint32_t priority)
+{
+    if (!params.is_valid())
+    {
+        throw std::invalid_argument("Invalid integration parameters");
+    }
+    if (weight == 0)
+    {
+        throw std::invalid_argument("Job weight must be > 0");
+    }
+
+    uint64_t job_id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_)
+        {
+            throw std::runtime_error("Server is shutting down");
+        }
+
+        job_id = next_job_id_++;
+
+        JobStatus status;
+        status.id = job_id;
+        status.params = params;
+        status.weight = weight;
+        status.priority = priority;
+        status.state = JobState::QUEUED;
+
+        jobs_[job_id] = status;
+        queue_.push_back(job_id);
+
+        if (!params.queries.empty())
+        {
+            LOG_INFO("Job {} queued: {} queries in [{}, {}], step={}, weight={}, priority={}",
+                     job_id, params.queries.size(), params.lower_limit, params.upper_limit, params.step, weight, priority);
+        }
+        else if (params.output_intervals > 0)
+        {
+            LOG_INFO("Job {} queued: table of {} intervals, lower={}, upper={}, step={}, output={}, weight={}, priority={}",
+                     job_id, params.output_intervals, params.lower_limit, params.upper_limit, params.step,
+                     params.output_path, weight, priority);
+        }
+        else if (params.inverse)
+        {
+            LOG_INFO("Job {} queued: inverse query, lower={}, target={}, step={}, weight={}, priority={}",
+                     job_id, params.lower_limit, params.target, params.step, weight, priority);
+        }
+        else if (params.kernel == KERNEL_QMC)
+        {
+            LOG_INFO("Job {} queued: quasi-Monte Carlo, {} dimensions, {} points x {} replicas, weight={}, priority={}",
+                     job_id, params.sampling.dimensions(), params.points, params.replicas, weight, priority);
+        }
+        else
+        {
+            LOG_INFO("Job {} queued: lower={}, upper={}, step={}, weight={}, priority={}",
+                     job_id, params.lower_limit, params.upper_limit, params.step, weight, priority);
+        }
+    }
+    cv_.notify_one();
+
+    return job_id;
+}
+
+std::optional<JobStatus> JobQueue::wait_next()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]
+             { return stopped_ || !queue_.empty(); });
+
+    if (stopped_)
+    {
+        return std::nullopt;
+    }
+
+    uint64_t job_id = queue_.front();
+    queue_.pop_front();
+
+    JobStatus &status = jobs_[job_id];
+    status.state = JobState::RUNNING;
+    started_at_[job_id] = std::chrono::steady_clock::now();
+    running_count_++;
+
+    LOG_INFO("Job {} started", job_id);
+
+    return status;
+}
+
+void JobQueue::complete(uint64_t job_id, double result, double standard_error, std::vector<double> query_results)
+{
+    finish(job_id, JobState::COMPLETED, result, standard_error, std::move(query_results), "");
+}
+
+void JobQueue::fail(uint64_t job_id, const std::string &error_message)
+{
+    finish(job_id, JobState::FAILED, 0.0, 0.0, {}, error_message);
+}
+
+void JobQueue::cancel(uint64_t job_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.erase(std::remove(queue_.begin(), queue_.end(), job_id), queue_.end());
+    }
+
+    finish(job_id, JobState::CANCELLED, 0.0, 0.0, {}, "Job cancelled");
+}
+
+void JobQueue::finish(uint64_t job_id, JobState state, double result, double standard_error,
+                      std::vector<double> query_results, const std::string &error_message)
+{
+    JobStatus final_status;
+    std::vector<FinishedCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = jobs_.find(job_id);
+        if (it == jobs_.end() || it->second.is_finished())
+        {
+            LOG_WARN("Job {} cannot be finished: unknown or already finished", job_id);
+            return;
+        }
+
+        JobStatus &status = it->second;
+        if (status.state == JobState::RUNNING)
+        {
+            running_count_--;
+        }
+
+        auto started = started_at_.find(job_id);
+        if (started != started_at_.end())
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started->second;
+            status.elapsed_seconds = elapsed.count();
+            started_at_.erase(started);
+        }
+
+        status.state = state;
+        status.result = result;
+        status.standard_error = standard_error;
+        status.query_results = std::move(query_results);
+        status.error_message = error_message;
+        final_status = status;
+
+        auto waiters = waiters_.find(job_id);
+        if (waiters != waiters_.end())
+        {
+            callbacks = std::move(waiters->second);
+            waiters_.erase(waiters);
+        }
+
+        // Ограничиваем историю завершённых заданий
+        finished_.push_back(job_id);
+        if (finished_.size() > MAX_FINISHED_JOBS)
+        {
+            jobs_.erase(finished_.front());
+            finished_.pop_front();
+        }
+    }
+
+    if (state == JobState::COMPLETED)
+    {
+        LOG_INFO("Job {} completed in {:.3f}s: result = {:.15f}",
+                 job_id, final_status.elapsed_seconds, result);
+    }
+    else if (state == JobState::CANCELLED)
+    {
+        LOG_INFO("Job {} cancelled", job_id);
+    }
+    else
+    {
+        LOG_ERROR("Job {} failed: {}", job_id, error_message);
+    }
+
+    // Вызываем подписчиков вне критической секции
+    for (auto &callback : callbacks)
+    {
+        callback(final_status);
+    }
+}
+
+std::optional<JobStatus> JobQueue::get_status(uint64_t job_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(job_id);
+    if (it == jobs_.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool JobQueue::when_finished(uint64_t job_id, FinishedCallback callback)
+{
+    JobStatus final_status;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(job_id);
+        if (it == jobs_.end())
+        {
+            return false;
+        }
+
+        if (!it->second.is_finished())
+        {
+            waiters_[job_id].push_back(std::move(callback));
+            return true;
+        }
+        final_status = it->second;
+    }
+
+    callback(final_status);
+    return true;
+}
+
+size_t JobQueue::get_queued_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+size_t JobQueue::get_running_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_count_;
+}
+
+void JobQueue::stop()
+{
+    std::deque<uint64_t> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_)
+        {
+            return;
+        }
+        stopped_ = true;
+        pending.swap(queue_);
+    }
+    cv_.notify_all();
+
+    // Невыполненные задания завершаем с ошибкой, чтобы не держать ожидающих
+    for (uint64_t job_id : pending)
+    {
+        fail(job_id, "Server stopped before the job started");
+    }
+
+    LOG_INFO("JobQueue stopped");
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "messages.h"
+#include "query_batch.h"
+
+/**
+ * @file job_queue.h
+ * @brief Модуль очереди заданий интегрирования для долгоживущего сервера
+ */
+
+/**
+ * @struct IntegrationParameters
+ * @brief Параметры задачи интегрирования
+ */
+struct IntegrationParameters
+{
+    // Нижний предел интегрирования
+    double lower_limit;
+    // Верхний предел интегрирования
+    double upper_limit;
+    // Шаг интегрирования
+    double step;
+    // Метод интегрирования (бит IntegrationKernel)
+    uint32_t kernel = KERNEL_SIMPSON;
+    // Подынтегральная функция
+    IntegrandSpec integrand{};
+    // Режим суммирования узлов на клиентах и результатов на сервере (бит ReductionMode)
+    uint32_t reduction = REDUCTION_PLAIN;
+    // Точность вычисления значений функции на клиентах (EvaluationPrecision)
+    uint32_t precision = PRECISION_DOUBLE;
+    // Область интегрирования и зерно скремблирования (для KERNEL_QMC, пределы и шаг не используются)
+    QmcSampling sampling{};
+    // Количество точек в каждой реплике (для KERNEL_QMC)
+    uint64_t points = 0;
+    // Количество независимо скремблированных реплик (для KERNEL_QMC)
+    uint32_t replicas = 0;
+    // Отрезки запросов пакетного задания (пусто - обычное задание; пределы - границы их объединения)
+    std::vector<QueryRange> queries;
+    // Количество отрезков таблицы первообразной (0 - задание без таблицы)
+    uint64_t output_intervals = 0;
+    // Файл таблицы первообразной
+    std::string output_path;
+    // Обратный запрос: найти x, при котором интеграл от lower_limit до x равен target (upper_limit не используется)
+    bool inverse = false;
+    // Требуемое значение интеграла (для обратного запроса)
+    double target = 0.0;
+
+    /**
+     * @brief Проверка корректности параметров
+     */
+    bool is_valid() const
+    {
+        bool result = reduction == REDUCTION_PLAIN || reduction == REDUCTION_COMPENSATED ||
+                      reduction == REDUCTION_DOUBLE_DOUBLE;
+
+        // В float32 вычисляются только функции, для которых известна граница погрешности
+        result &= precision == PRECISION_DOUBLE ||
+                  (precision == PRECISION_SINGLE && kernel != KERNEL_QMC &&
+                   integrands::supports_single_precision(integrand.id));
+
+        if (kernel == KERNEL_QMC)
+        {
+            result &= points > 0 && points <= QmcSampling::MAX_POINTS;
+            result &= replicas > 0 && replicas <= QmcSampling::MAX_REPLICAS;
+
+            // Суммы значений в точках и так складываются точно (QmcEstimator)
+            result &= reduction == REDUCTION_PLAIN;
+
+            // Функция должна быть определена во всей области
+            result &= sampling.is_valid() && integrands::is_valid_box(integrand, sampling.lower, sampling.upper);
+
+            return result;
+        }
+
+        if (!queries.empty())
+        {
+            result &= queries.size() <= QueryBatch::MAX_QUERIES && step > 0.0;
+
+            // Отрезки запросов могут быть короче шага, функция должна быть определена на каждом
+            for (const auto &query : queries)
+            {
+                result &= query.lower < query.upper && query.lower >= lower_limit && query.upper <= upper_limit &&
+                          integrands::is_valid_domain(integrand, query.lower, query.upper);
+            }
+
+            return result;
+        }
+
+        if (inverse)
+        {
+            // При нулевом значении ответ - нижний предел, решать нечего
+            result &= step > 0.0 && std::isfinite(lower_limit) && std::isfinite(target) && target != 0.0;
+
+            // Функция должна быть определена хотя бы на одном шаге от нижнего предела
+            result &= integrands::is_valid_domain(integrand, lower_limit, lower_limit + step) ||
+                      integrands::is_valid_domain(integrand, lower_limit - step, lower_limit);
+
+            return result;
+        }
+
+        if (output_intervals > 0)
+        {
+            // Таблица записывается в файл сервера, её размер ограничен
+            result &= !output_path.empty() && output_intervals <= ScanGrid::MAX_INTERVALS;
+        }
+
+        // Начало не может быть больше конца, шаг должен быть положительным
+        // и быть меньше длины интегрируемого интервала
+        result &= !(lower_limit >= upper_limit || step <= 0.0 || step >= (upper_limit - lower_limit));
+
+        // Функция должна быть определена на всём отрезке
+        result &= integrands::is_valid_domain(integrand, lower_limit, upper_limit);
+
+        return result;
+    }
+};
+
+/**
+ * @enum JobState
+ * @brief Состояние задания
+ */
+enum class JobState : uint8_t
+{
+    // Ожидает в очереди
+    QUEUED,
+    // Передано планировщику и выполняется на кластере
+    RUNNING,
+    // Успешно завершено
+    COMPLETED,
+    // Завершено с ошибкой
+    FAILED,
+    // Отменено по запросу
+    CANCELLED
+};
+
+// Преобразование состояния задания в строку
+std::string to_string(JobState state);
+
+/**
+ * @struct JobStatus
+ * @brief Текущее состояние и результат одного задания
+ */
+struct JobStatus
+{
+    // Уникальный ID задания
+    uint64_t id = 0;
+    // Параметры интегрирования
+    IntegrationParameters params{};
+    // Вес задания в справедливом разделении кластера
+    uint32_t weight = 1;
+    // Приоритет задания (задания с большим приоритетом вытесняют остальные)
+    uint32_t priority = 0;
+    // Состояние задания
+    JobState state = JobState::QUEUED;
+    // Значение интеграла (для COMPLETED)
+    double result = 0.0;
+    // Стандартная ошибка значения (для COMPLETED заданий KERNEL_QMC)
+    double standard_error = 0.0;
+    // Ответы на запросы пакетного задания (для COMPLETED)
+    std::vector<double> query_results;
+    // Сообщение об ошибке (для FAILED и CANCELLED)
+    std::string error_message;
+    // Время выполнения на кластере в секундах
+    double elapsed_seconds = 0.0;
+
+    /**
+     * @brief Проверяет, завершено ли задание (успешно или с ошибкой)
+     */
+    bool is_finished() const
+    {
+        return state == JobState::COMPLETED || state == JobState::FAILED || state == JobState::CANCELLED;
+    }
+};
+
+/**
+ * @class JobQueue
+ * @brief Потокобезопасная очередь заданий с хранением их результатов
+ *
+ * Задания ставятся в очередь из управляющего интерфейса и в порядке
+ * поступления передаются циклом сервера планировщику, где выполняются
+ * одновременно. Итоговое состояние хранится для последующих запросов
+ * статуса и результата
+ */
+class JobQueue
+{
+public:
+    /**
+     * @brief Тип callback-функции, вызываемой при завершении задания
+     */
+    using FinishedCallback = std::function<void(const JobStatus &)>;
+
+    JobQueue() = default;
+
+    // Запрет копирования
+    JobQueue(const JobQueue &) = delete;
+    JobQueue &operator=(const JobQueue &) = delete;
+
+    /**
+     * @brief Ставит задание в очередь
+     * @param params Параметры интегрирования
+     * @param weight Вес задания в справедливом разделении кластера
+     * @param priority Приоритет задания
+     * @return ID задания
+     * @throws std::invalid_argument если параметры или вес некорректны
+     * @throws std::runtime_error если очередь остановлена
+     */
+    uint64_t submit(const IntegrationParameters &params, uint32_t weight = 1, uint32_t priority = 0);
+
+    /**
+     * @brief Ожидает следующее задание и помечает его как выполняющееся
+     * @return Задание или std::nullopt, если очередь остановлена
+     */
+    std::optional<JobStatus> wait_next();
+
+    /**
+     * @brief Отмечает успешное завершение задания
+     * @param job_id ID задания
+     * @param result Значение интеграла
+     * @param standard_error Стандартная ошибка значения (для заданий KERNEL_QMC)
+     * @param query_results Ответы на запросы пакетного задания
+     */
+    void complete(uint64_t job_id, double result, double standard_error = 0.0,
+                  std::vector<double> query_results = {});
+
+    /**
+     * @brief Отмечает завершение задания с ошибкой
+     * @param job_id ID задания
+     * @param error_message Описание ошибки
+     */
+    void fail(uint64_t job_id, const std::string &error_message);
+
+    /**
+     * @brief Отмечает отмену задания
+     *
+     * Задание, ещё не забранное из очереди, удаляется из неё
+     *
+     * @param job_id ID задания
+     */
+    void cancel(uint64_t job_id);
+
+    /**
+     * @brief Геттер состояния задания
+     * @param job_id ID задания
+     * @return Состояние задания или std::nullopt, если задание неизвестно
+     */
+    std::optional<JobStatus> get_status(uint64_t job_id) const;
+
+    /**
+     * @brief Регистрирует callback на завершение задания
+     *
+     * Если задание уже завершено, callback вызывается сразу в текущем потоке
+     *
+     * @param job_id ID задания
+     * @param callback Функция, получающая итоговое состояние
+     * @return false, если задание неизвестно
+     */
+    bool when_finished(uint64_t job_id, FinishedCallback callback);
+
+    /**
+     * @brief Геттер числа заданий в очереди
+     */
+    size_t get_queued_count() const;
+
+    /**
+     * @brief Геттер числа выполняющихся заданий
+     */
+    size_t get_running_count() const;
+
+    /**
+     * @brief Останавливает очередь
+     *
+     * Пробуждает ожидающих в wait_next(), а все невыполненные задания
+     * завершает с ошибкой
+     */
+    void stop();
+
+private:
+    /**
+     * @brief Переводит задание в конечное состояние и вызывает подписчиков
+     * @note Захватывает mutex_ самостоятельно
+     */
+    void finish(uint64_t job_id, JobState state, double result, double standard_error,
+                std::vector<double> query_results, const std::string &error_message);
+
+    // Максимальное число хранимых завершённых заданий
+    static constexpr size_t MAX_FINISHED_JOBS = 1024;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    // Все известные задания: job_id -> состояние
+    std::map<uint64_t, JobStatus> jobs_;
+    // Очередь ожидающих заданий
+    std::deque<uint64_t> queue_;
+    // Завершённые задания в порядке завершения (для ограничения истории)
+    std::deque<uint64_t> finished_;
+    // Время начала выполнения заданий
+    std::map<uint64_t, std::chrono::steady_clock::time_point> started_at_;
+    // Подписчики на завершение заданий
+    std::map<uint64_t, std::vector<FinishedCallback>> waiters_;
+
+    // Счётчик ID заданий
+    uint64_t next_job_id_{1};
+    // Количество выполняющихся заданий
+    size_t running_count_{0};
+    // Флаг остановки очереди
+    bool stopped_{false};
+};
@@ -0,0 +1,498 @@
+#include "job_scheduler.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * @brief Стоимость фрагмента - количество шагов интегрирования
+     */
+    double chunk_cost(const Task &task)
+    {
+        return std::max(1.0, (task.end - task.begin) / task.step);
+    }
+
+    /**
+     * @brief Находит конец начала фрагмента, выдаваемого медленному клиенту
+     *
+     * Остаток после деления должен быть не меньше половины ограничения.
+     * Фрагмент с таблицей первообразной делится на точке таблицы
+     *
+     * @return Конец первой части или std::nullopt, если фрагмент делить не нужно
+     */
+    std::optional<double> split_point(const Task &task, uint64_t max_task_steps)
+    {
+        if (max_task_steps == 0)
+        {
+            return std::nullopt;
+        }
+
+        if (task.grid.is_active())
+        {
+            uint64_t first = task.grid.index(task.begin);
+            uint64_t points = task.grid.index(task.end) - first;
+            auto max_points = static_cast<uint64_t>(
+                std::max(1.0, static_cast<double>(max_task_steps) * task.step / task.grid.interval));
+            if (points <= max_points + max_points / 2)
+            {
+                return std::nullopt;
+            }
+            return task.grid.point(first + max_points);
+        }
+
+        auto steps = static_cast<uint64_t>(std::llround((task.end - task.begin) / task.step));
+        if (steps <= max_task_steps + max_task_steps / 2)
+        {
+            return std::nullopt;
+        }
+        return task.begin + static_cast<double>(max_task_steps) * task.step;
+    }
+} // namespace
+
+JobScheduler::JobScheduler(FinishedCallback on_finished, TaskIdAllocator allocate_task_id)
+    : on_finished_(std::move(on_finished)),
+      allocate_task_id_(std::move(allocate_task_id))
+{
+}
+
+void JobScheduler::add_job(uint64_t job_id,
+                           const IntegrationParameters &params,
+                           uint32_t weight,
+                           uint32_t priority,
+                           std::vector<Task> chunks)
+{
+    if (chunks.empty())
+    {
+        throw std::invalid_argument("Job has no chunks");
+    }
+    if (weight == 0)
+    {
+        throw std::invalid_argument("Job weight must be > 0");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_)
+        {
+            throw std::runtime_error("Scheduler is stopped");
+        }
+
+        // Все фрагменты задания считаются методом, функцией, накопителем и точностью, выбранными для задания
+        for (auto &chunk : chunks)
+        {
+            chunk.kernel = params.kernel;
+            chunk.integrand = params.integrand;
+            chunk.reduction = params.reduction;
+            chunk.precision = params.precision;
+        }
+
+        ActiveJob job;
+        job.params = params;
+        job.weight = weight;
+        job.priority = priority;
+        // Новое задание не получает "кредита" за время, когда его не было
+        job.virtual_time = virtual_clock_;
+        job.total_chunks = chunks.size();
+        job.pending.assign(chunks.begin(), chunks.end());
+        job.aggregator = std::make_unique<ResultAggregator>(chunks.size(), params.reduction);
+        if (params.kernel == KERNEL_QMC)
+        {
+            job.qmc = std::make_unique<QmcEstimator>(params.replicas, params.points, params.sampling.volume());
+        }
+        if (params.output_intervals > 0)
+        {
+            job.scan = std::make_shared<ScanOutput>(params.output_path, params.output_intervals);
+        }
+        if (!params.queries.empty())
+        {
+            job.queries = std::make_unique<QueryBatch>(params.queries);
+        }
+
+        jobs_[job_id] = std::move(job);
+    }
+    cv_.notify_all();
+
+    LOG_INFO("Job {} scheduled: {} chunks, weight {}, priority {}",
+             job_id, chunks.size(), weight, priority);
+}
+
+TaskBatch JobScheduler::take_batch(uint64_t client_id, size_t max_tasks, uint64_t max_task_steps, const WorkerAbilities &abilities)
+{
+    TaskBatch batch;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (batch.tasks.size() < max_tasks)
+    {
+        auto it = pick_job(abilities);
+        if (it == jobs_.end())
+        {
+            break;
+        }
+
+        ActiveJob &job = it->second;
+        Task task = job.pending.front();
+
+        auto head_end = split_point(task, max_task_steps);
+        if (head_end)
+        {
+            task.id = allocate_task_id_();
+            task.end = *head_end;
+
+            job.pending.front().begin = task.end;
+            job.total_chunks++;
+            job.aggregator->add_expected(1);
+        }
+        else
+        {
+            job.pending.pop_front();
+        }
+
+        virtual_clock_ = std::max(virtual_clock_, job.virtual_time);
+        job.virtual_time += chunk_cost(task) / job.weight;
+
+        job.in_flight[task.id] = InFlightChunk{task, client_id};
+        batch.tasks.push_back(task);
+    }
+
+    return batch;
+}
+
+bool JobScheduler::wait_for_work(const WorkerAbilities &abilities)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, &abilities]
+             { return stopped_ || has_pending_work(abilities); });
+    return !stopped_;
+}
+
+void JobScheduler::complete(const ResultBatch &batch)
+{
+    std::vector<JobOutcome> finished;
+    bool requeued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Раскладываем результаты по заданиям
+        std::map<uint64_t, ResultBatch> per_job;
+        for (const auto &result : batch.results)
+        {
+            ResultBatch &job_batch = per_job[result.job_id];
+            job_batch.client_id = batch.client_id;
+            job_batch.results.push_back(result);
+        }
+
+        for (auto &[job_id, job_batch] : per_job)
+        {
+            auto it = jobs_.find(job_id);
+            if (it == jobs_.end())
+            {
+                LOG_DEBUG("Ignoring {} results of finished job {}", job_batch.results.size(), job_id);
+                continue;
+            }
+
+            ActiveJob &job = it->second;
+            std::string error_message;
+            ResultBatch accepted;
+            accepted.client_id = batch.client_id;
+
+            for (const auto &result : job_batch.results)
+            {
+                auto chunk = job.in_flight.find(result.task_id);
+                if (chunk == job.in_flight.end())
+                {
+                    LOG_WARN("Ignoring result of unknown task {} (job {})", result.task_id, job_id);
+                    continue;
+                }
+
+                Task task = chunk->second.task;
+                job.in_flight.erase(chunk);
+                // Отрезок пакетного задания, к которому относится результат
+                const double chunk_begin = task.begin;
+
+                if (!result.success)
+                {
+                    if (error_message.empty())
+                    {
+                        error_message = "Task " + std::to_string(result.task_id) + " failed: " + result.error_message;
+                    }
+                }
+                else if (job.qmc && result.partial && result.end != std::floor(result.end))
+                {
+                    error_message = "Task " + std::to_string(result.task_id) + " returned invalid partial range";
+                    continue;
+                }
+                else if (job.scan && result.partial && !task.grid.is_point(result.end))
+                {
+                    error_message = "Task " + std::to_string(result.task_id) + " returned invalid partial range";
+                    continue;
+                }
+                else if (result.partial)
+                {
+                    if (result.end < task.begin || result.end >= task.end)
+                    {
+                        error_message = "Task " + std::to_string(result.task_id) + " returned invalid partial range";
+                        continue;
+                    }
+
+                    // Остаток прерванного фрагмента выполняется первым под тем же ID
+                    job.client_ranges[batch.client_id] += result.end - task.begin;
+                    task.begin = result.end;
+                    job.pending.push_front(task);
+                    requeued = true;
+                }
+                else
+                {
+                    job.client_ranges[batch.client_id] += task.end - task.begin;
+                }
+
+                if (job.qmc && result.success)
+                {
+                    job.qmc->add(task.sampling.replica, result.value, result.sum_squares);
+                }
+                if (job.queries && result.success && !job.queries->add(chunk_begin, result.value, result.value_low))
+                {
+                    error_message = "Task " + std::to_string(result.task_id) + " lies outside the batch segments";
+                }
+                if (job.scan && result.success)
+                {
+                    // Локальные префиксные суммы вычисленной части записываются сразу
+                    uint64_t first = task.grid.index(chunk_begin);
+                    uint64_t last = task.grid.index(result.partial ? result.end : task.end);
+                    if (result.cumulative.size() != last - first || !job.scan->write(first, result.cumulative))
+                    {
+                        error_message = "Task " + std::to_string(result.task_id) + " returned an invalid table";
+                    }
+                }
+
+                accepted.results.push_back(result);
+            }
+
+            if (accepted.results.empty())
+            {
+                continue;
+            }
+            job_batch = std::move(accepted);
+
+            // Время пакета делится между заданиями пропорционально числу задач
+            job_batch.total_time_seconds = batch.total_time_seconds *
+                                           static_cast<double>(job_batch.results.size()) /
+                                           static_cast<double>(batch.results.size());
+            job.aggregator->add_result(job_batch);
+
+            if (!error_message.empty())
+            {
+                finished.push_back(finish_job(it, false, error_message));
+            }
+            else if (job.aggregator->get_received_count() >= job.total_chunks)
+            {
+                finished.push_back(finish_job(it, true, ""));
+            }
+        }
+    }
+
+    if (requeued)
+    {
+        cv_.notify_all();
+    }
+
+    // Вызываем подписчиков вне критической секции
+    for (const auto &outcome : finished)
+    {
+        on_finished_(outcome);
+    }
+}
+
+void JobScheduler::requeue(const TaskBatch &batch)
+{
+    size_t requeued = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Обратный порядок сохраняет исходный порядок фрагментов в начале очереди
+        for (auto task = batch.tasks.rbegin(); task != batch.tasks.rend(); ++task)
+        {
+            auto it = jobs_.find(task->job_id);
+            if (it == jobs_.end() || it->second.in_flight.erase(task->id) == 0)
+            {
+                continue;
+            }
+
+            it->second.pending.push_front(*task);
+            requeued++;
+        }
+    }
+
+    if (requeued > 0)
+    {
+        LOG_WARN("{} chunks returned to the scheduler", requeued);
+        cv_.notify_all();
+    }
+}
+
+std::optional<std::set<uint64_t>> JobScheduler::cancel_job(uint64_t job_id)
+{
+    std::set<uint64_t> holders;
+    JobOutcome outcome;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(job_id);
+        if (it == jobs_.end())
+        {
+            return std::nullopt;
+        }
+
+        for (const auto &[task_id, chunk] : it->second.in_flight)
+        {
+            holders.insert(chunk.client_id);
+        }
+
+        outcome = finish_job(it, false, "Job cancelled", true);
+    }
+
+    LOG_INFO("Job {} removed from the scheduler, {} client(s) interrupted", job_id, holders.size());
+
+    on_finished_(outcome);
+    return holders;
+}
+
+std::map<uint64_t, std::set<uint64_t>> JobScheduler::get_preemption_targets(uint32_t priority) const
+{
+    std::map<uint64_t, std::set<uint64_t>> targets;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &[job_id, job] : jobs_)
+    {
+        if (job.priority >= priority)
+        {
+            continue;
+        }
+
+        for (const auto &[task_id, chunk] : job.in_flight)
+        {
+            targets[chunk.client_id].insert(job_id);
+        }
+    }
+
+    return targets;
+}
+
+size_t JobScheduler::get_active_jobs_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+void JobScheduler::stop()
+{
+    std::vector<JobOutcome> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_)
+        {
+            return;
+        }
+        stopped_ = true;
+
+        while (!jobs_.empty())
+        {
+            finished.push_back(finish_job(jobs_.begin(), false, "Server stopped before the job finished"));
+        }
+    }
+    cv_.notify_all();
+
+    for (const auto &outcome : finished)
+    {
+        on_finished_(outcome);
+    }
+
+    LOG_INFO("JobScheduler stopped");
+}
+
+std::map<uint64_t, JobScheduler::ActiveJob>::iterator JobScheduler::pick_job(const WorkerAbilities &abilities)
+{
+    auto best = jobs_.end();
+    for (auto it = jobs_.begin(); it != jobs_.end(); ++it)
+    {
+        if (it->second.pending.empty() || !abilities.can_run(it->second.params))
+        {
+            continue;
+        }
+        if (best == jobs_.end() ||
+            it->second.priority > best->second.priority ||
+            (it->second.priority == best->second.priority &&
+             it->second.virtual_time < best->second.virtual_time))
+        {
+            best = it;
+        }
+    }
+    return best;
+}
+
+bool JobScheduler::has_pending_work(const WorkerAbilities &abilities) const
+{
+    return std::any_of(jobs_.begin(), jobs_.end(), [&abilities](const auto &entry)
+                       { return !entry.second.pending.empty() && abilities.can_run(entry.second.params); });
+}
+
+JobOutcome JobScheduler::finish_job(std::map<uint64_t, ActiveJob>::iterator it,
+                                    bool success,
+                                    const std::string &error_message,
+                                    bool cancelled)
+{
+    ActiveJob &job = it->second;
+
+    JobOutcome outcome;
+    outcome.job_id = it->first;
+    outcome.params = job.params;
+    outcome.success = success;
+    outcome.cancelled = cancelled;
+    outcome.value = job.aggregator->get_final_result();
+    if (job.qmc)
+    {
+        // Суммы значений в точках - не интеграл: оценку даёт среднее по репликам
+        outcome.value = job.qmc->get_estimate();
+        outcome.standard_error = job.qmc->get_standard_error();
+    }
+    if (job.queries)
+    {
+        // Сумма отрезков без ошибок округления и ответы на запросы
+        outcome.value = job.queries->get_total();
+        outcome.query_results = job.queries->get_answers();
+    }
+    if (job.scan)
+    {
+        // Интеграл по всему отрезку - сумма итогов фрагментов таблицы
+        outcome.value = job.scan->get_total();
+        outcome.scan = job.scan;
+    }
+    outcome.error_message = error_message;
+    outcome.chunks = job.total_chunks;
+    outcome.contributions = job.aggregator->get_client_contributions();
+    outcome.client_ranges = std::move(job.client_ranges);
+
+    if (success && job.qmc)
+    {
+        LOG_INFO("Job {}: {} replica estimates, standard error {:.3e}",
+                 it->first, job.params.replicas, outcome.standard_error);
+        for (double estimate : job.qmc->get_replica_estimates())
+        {
+            LOG_DEBUG("  replica estimate: {:.15f}", estimate);
+        }
+    }
+    else if (success && job.queries)
+    {
+        LOG_INFO("Job {}: {} queries answered from {} segments of total length {}",
+                 it->first, job.params.queries.size(), job.queries->get_segments().size(),
+                 job.queries->get_covered_length());
+    }
+    else if (success)
+    {
+        job.aggregator->log_results_info();
+    }
+
+    jobs_.erase(it);
+    return outcome;
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "messages.h"
+#include "job_queue.h"
+#include "qmc_estimator.h"
+#include "query_batch.h"
+#include "scan_output.h"
+#include "result_aggregator.h"
+
+/**
+ * @file job_scheduler.h
+ * @brief Модуль планировщика фрагментов одновременно выполняющихся заданий
+ */
+
+/**
+ * @struct JobOutcome
+ * @brief Итог выполнения задания в планировщике
+ */
+struct JobOutcome
+{
+    // ID задания
+    uint64_t job_id = 0;
+    // Параметры интегрирования
+    IntegrationParameters params{};
+    // Успешно ли выполнено задание
+    bool success = false;
+    // Задание отменено по запросу
+    bool cancelled = false;
+    // Значение интеграла (при успехе)
+    double value = 0.0;
+    // Стандартная ошибка значения (для заданий KERNEL_QMC)
+    double standard_error = 0.0;
+    // Ответы на запросы пакетного задания (при успехе)
+    std::vector<double> query_results;
+    // Таблица первообразной (для заданий с таблицей): смещения фрагментов применяются после завершения
+    std::shared_ptr<ScanOutput> scan;
+    // Описание ошибки (при неуспехе)
+    std::string error_message;
+    // Количество фрагментов задания
+    size_t chunks = 0;
+    // Вклад каждого клиента: client_id -> ClientContribution
+    std::map<uint64_t, ClientContribution> contributions;
+    // Длина диапазона, вычисленного каждым клиентом: client_id -> длина
+    std::map<uint64_t, double> client_ranges;
+};
+
+/**
+ * @struct WorkerAbilities
+ * @brief Задания, которые может выполнять клиент
+ */
+struct WorkerAbilities
+{
+    // Методы интегрирования (биты IntegrationKernel)
+    uint32_t kernels = ~0u;
+    // Подынтегральные функции (биты integrand_bit)
+    uint32_t integrands = ~0u;
+    // Возможности протокола (биты Capability)
+    uint64_t features = ~0ull;
+    // Режимы суммирования (биты ReductionMode)
+    uint32_t reductions = ~0u;
+
+    /**
+     * @brief Проверяет, может ли клиент выполнять фрагменты задания
+     */
+    bool can_run(const IntegrationParameters &params) const
+    {
+        return (params.kernel & kernels) != 0 && (integrand_bit(params.integrand.id) & integrands) != 0 &&
+               (params.reduction & reductions) != 0 &&
+               (params.output_intervals == 0 || (features & CAP_PREFIX_SCAN) != 0) &&
+               (params.precision == PRECISION_DOUBLE || (features & CAP_SINGLE_PRECISION) != 0);
+    }
+};
+
+/**
+ * @class JobScheduler
+ * @brief Чередует фрагменты нескольких заданий на общем пуле клиентов
+ *
+ * Клиенты сами забирают пакеты фрагментов по мере освобождения. Очередной
+ * фрагмент берётся у задания с наибольшим приоритетом, а среди заданий
+ * одного приоритета - с наименьшим виртуальным временем, которое растёт
+ * на стоимость фрагмента (число шагов), делённую на вес задания. Поэтому
+ * задания с равным весом получают равные доли кластера, небольшое задание
+ * не ждёт окончания большого, а свободный клиент получает работу, пока
+ * у планировщика есть хотя бы один невыданный фрагмент.
+ *
+ * Прерванный клиентом фрагмент возвращает частичный результат: его значение
+ * учитывается сразу, а остаток отрезка возвращается в начало очереди задания.
+ *
+ * Клиент получает только фрагменты заданий, метод интегрирования и
+ * подынтегральную функцию которых он поддерживает.
+ *
+ * Фрагмент задания квази-Монте-Карло - отрезок номеров точек одной реплики
+ * с шагом 1, поэтому он делится и прерывается так же, как отрезок интегрирования,
+ * а его суммы собирает QmcEstimator задания.
+ *
+ * Фрагменты пакетного задания не пересекают отрезки его QueryBatch, поэтому
+ * результат фрагмента (и частичный тоже) добавляется к интегралу одного отрезка.
+ *
+ * Фрагменты задания с таблицей первообразной начинаются и заканчиваются
+ * (в том числе при делении и прерывании) на точках таблицы, а их локальные
+ * префиксные суммы сразу записываются в ScanOutput задания.
+ *
+ * Медленному клиенту фрагменты выдаются частями (см. take_batch()), чтобы
+ * последний фрагмент задания не задерживал его завершение
+ */
+class JobScheduler
+{
+public:
+    /**
+     * @brief Тип callback-функции, вызываемой при завершении задания
+     */
+    using FinishedCallback = std::function<void(const JobOutcome &)>;
+
+    /**
+     * @brief Тип функции, выдающей новый уникальный ID задачи
+     */
+    using TaskIdAllocator = std::function<uint64_t()>;
+
+    /**
+     * @brief Конструктор
+     * @param on_finished Вызывается вне блокировок при завершении каждого задания
+     * @param allocate_task_id Выдаёт ID частям фрагментов, разделённых под медленных клиентов
+     */
+    JobScheduler(FinishedCallback on_finished, TaskIdAllocator allocate_task_id);
+
+    // Запрет копирования
+    JobScheduler(const JobScheduler &) = delete;
+    JobScheduler &operator=(const JobScheduler &) = delete;
+
+    /**
+     * @brief Добавляет задание в планировщик
+     * @param job_id ID задания
+     * @param params Параметры интегрирования
+     * @param weight Вес задания в справедливом разделении кластера (>= 1)
+     * @param priority Приоритет задания
+     * @param chunks Фрагменты задания
+     * @throws std::invalid_argument если фрагментов нет или вес равен 0
+     * @throws std::runtime_error если планировщик остановлен
+     */
+    void add_job(uint64_t job_id,
+                 const IntegrationParameters &params,
+                 uint32_t weight,
+                 uint32_t priority,
+                 std::vector<Task> chunks);
+
+    /**
+     * @brief Выдаёт пакет фрагментов без ожидания
+     *
+     * Фрагмент, который заметно больше max_task_steps, делится: клиент получает
+     * начало фрагмента под новым ID, а остаток остаётся первым в очереди задания
+     *
+     * @param client_id ID клиента, получающего пакет
+     * @param max_tasks Максимальный размер пакета
+     * @param max_task_steps Максимальное число шагов в одной задаче (0 - без ограничения)
+     * @param abilities Методы и функции, доступные клиенту
+     * @return Пакет фрагментов (пустой, если работы нет)
+     */
+    TaskBatch take_batch(uint64_t client_id, size_t max_tasks, uint64_t max_task_steps = 0,
+                         const WorkerAbilities &abilities = {});
+
+    /**
+     * @brief Ожидает появления невыданных фрагментов
+     * @param abilities Методы и функции, доступные клиенту: фрагменты
+     *        заданий, которые он не может выполнить, не учитываются
+     * @return false, если планировщик остановлен
+     */
+    bool wait_for_work(const WorkerAbilities &abilities = {});
+
+    /**
+     * @brief Принимает результаты выполненных фрагментов
+     *
+     * Результаты могут относиться к разным заданиям. Результаты неизвестных
+     * (уже завершённых) заданий игнорируются
+     *
+     * @param batch Пакет результатов от клиента
+     */
+    void complete(const ResultBatch &batch);
+
+    /**
+     * @brief Возвращает в очередь фрагменты, выданные отключившемуся клиенту
+     * @param batch Невыполненный пакет фрагментов
+     */
+    void requeue(const TaskBatch &batch);
+
+    /**
+     * @brief Отменяет задание
+     *
+     * Задание сразу удаляется из планировщика (callback вызывается с cancelled = true),
+     * а поздние результаты его фрагментов игнорируются
+     *
+     * @param job_id ID задания
+     * @return ID клиентов, выполняющих фрагменты задания, или std::nullopt, если задание неизвестно
+     */
+    std::optional<std::set<uint64_t>> cancel_job(uint64_t job_id);
+
+    /**
+     * @brief Находит фрагменты, которые нужно вытеснить ради задания с данным приоритетом
+     * @param priority Приоритет нового задания
+     * @return client_id -> ID заданий с меньшим приоритетом, чьи фрагменты выполняет клиент
+     */
+    std::map<uint64_t, std::set<uint64_t>> get_preemption_targets(uint32_t priority) const;
+
+    /**
+     * @brief Геттер числа выполняющихся заданий
+     */
+    size_t get_active_jobs_count() const;
+
+    /**
+     * @brief Останавливает планировщик
+     *
+     * Все выполняющиеся задания завершаются с ошибкой, ожидающие
+     * в wait_for_work() пробуждаются
+     */
+    void stop();
+
+private:
+    /**
+     * @struct InFlightChunk
+     * @brief Выданный клиенту фрагмент
+     */
+    struct InFlightChunk
+    {
+        Task task;
+        // ID клиента, выполняющего фрагмент
+        uint64_t client_id = 0;
+    };
+
+    /**
+     * @struct ActiveJob
+     * @brief Состояние выполняющегося задания
+     */
+    struct ActiveJob
+    {
+        // Параметры интегрирования
+        IntegrationParameters params{};
+        // Вес задания
+        uint32_t weight = 1;
+        // Приоритет задания
+        uint32_t priority = 0;
+        // Виртуальное время задания
+        double virtual_time = 0.0;
+        // Количество фрагментов задания
+        size_t total_chunks = 0;
+        // Невыданные фрагменты
+        std::deque<Task> pending;
+        // Выданные и ещё не выполненные фрагменты: task_id -> фрагмент
+        std::unordered_map<uint64_t, InFlightChunk> in_flight;
+        // Агрегатор результатов задания
+        std::unique_ptr<ResultAggregator> aggregator;
+        // Суммы по репликам (для заданий KERNEL_QMC)
+        std::unique_ptr<QmcEstimator> qmc;
+        // Интегралы отрезков (для пакетных заданий)
+        std::unique_ptr<QueryBatch> queries;
+        // Таблица первообразной (для заданий с таблицей)
+        std::shared_ptr<ScanOutput> scan;
+        // Длина диапазона, вычисленного каждым клиентом
+        std::map<uint64_t, double> client_ranges;
+    };
+
+    /**
+     * @brief Выбирает задание, которому принадлежит следующий фрагмент
+     * @param abilities Методы и функции, доступные клиенту
+     * @return Итератор на задание или jobs_.end(), если невыданных фрагментов нет
+     * @note Вызывать только под mutex_
+     */
+    std::map<uint64_t, ActiveJob>::iterator pick_job(const WorkerAbilities &abilities);
+
+    /**
+     * @brief Проверяет наличие невыданных фрагментов
+     * @param abilities Методы и функции, доступные клиенту
+     * @note Вызывать только под mutex_
+     */
+    bool has_pending_work(const WorkerAbilities &abilities) const;
+
+    /**
+     * @brief Формирует итог задания и удаляет его из планировщика
+     * @note Вызывать только под mutex_
+     */
+    JobOutcome finish_job(std::map<uint64_t, ActiveJob>::iterator it,
+                          bool success,
+                          const std::string &error_message,
+                          bool cancelled = false);
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    // Выполняющиеся задания: job_id -> состояние
+    std::map<uint64_t, ActiveJob> jobs_;
+    // Виртуальное время планировщика (время последнего выбранного задания)
+    double virtual_clock_{0.0};
+    // Флаг остановки
+    bool stopped_{false};
+    // Callback завершения задания
+    FinishedCallback on_finished_;
+    // Источник ID для частей разделённых фрагментов
+    TaskIdAllocator allocate_task_id_;
+};
@@ -0,0 +1,294 @@
+#include "local_launcher.h"
+#include "logger.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace
+{
+    // Интервал проверки завершения процессов
+    constexpr auto REAP_INTERVAL = std::chrono::milliseconds(20);
+
+#if defined(__linux__) || defined(__APPLE__)
+    /**
+     * @brief Проверяет, завершился ли процесс, и забирает его код возврата
+     */
+    bool try_reap(pid_t pid)
+    {
+        int status = 0;
+        pid_t result = waitpid(pid, &status, WNOHANG);
+        return result == pid || result < 0;
+    }
+#endif
+} // namespace
+
+LocalLauncher::LocalLauncher(std::string client_path, uint16_t port, size_t count)
+    : client_path_(std::move(client_path)), port_(port), count_(count)
+{
+    if (count_ == 0)
+    {
+        throw std::invalid_argument("Number of local clients must be positive");
+    }
+}
+
+LocalLauncher::~LocalLauncher()
+{
+    stop();
+}
+
+void LocalLauncher::start()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    auto groups = split_cpus(read_numa_nodes(), count_);
+    const std::string port = std::to_string(port_);
+
+    for (size_t i = 0; i < count_; ++i)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            throw std::runtime_error("Failed to start local client " + std::to_string(i));
+        }
+
+        if (pid == 0)
+        {
+            // Дочерний процесс: до exec допустимы только async-signal-safe вызовы
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : groups[i])
+            {
+                CPU_SET(cpu, &set);
+            }
+            sched_setaffinity(0, sizeof(set), &set);
+#endif
+            // Вывод клиента остаётся в его файле журнала, консоль сервера не засоряется
+            int null_fd = open("/dev/null", O_WRONLY);
+            if (null_fd >= 0)
+            {
+                dup2(null_fd, STDOUT_FILENO);
+                close(null_fd);
+            }
+
+            execl(client_path_.c_str(), client_path_.c_str(), "127.0.0.1", port.c_str(), static_cast<char *>(nullptr));
+            _exit(127);
+        }
+
+        pids_.push_back(pid);
+
+        std::string cpus;
+        for (int cpu : groups[i])
+        {
+            cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+        }
+        LOG_INFO("Local client {} started (pid {}, cpus {})", i + 1, pid, cpus);
+    }
+#else
+    throw std::runtime_error("Local clients are supported on Linux and macOS only");
+#endif
+}
+
+void LocalLauncher::stop(std::chrono::milliseconds timeout)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if (pids_.empty())
+    {
+        return;
+    }
+
+    // Клиенты завершаются сами после STOP_WORK или разрыва соединения
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        pids_.erase(std::remove_if(pids_.begin(), pids_.end(), [](long pid)
+                                   { return try_reap(static_cast<pid_t>(pid)); }),
+                    pids_.end());
+        if (pids_.empty() || std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(REAP_INTERVAL);
+    }
+
+    for (long pid : pids_)
+    {
+        LOG_WARN("Local client (pid {}) did not exit, terminating it", pid);
+        kill(static_cast<pid_t>(pid), SIGTERM);
+        waitpid(static_cast<pid_t>(pid), nullptr, 0);
+    }
+    pids_.clear();
+
+    LOG_INFO("Local clients stopped");
+#else
+    (void)timeout;
+#endif
+}
+
+std::vector<std::vector<int>> LocalLauncher::split_cpus(const std::vector<std::vector<int>> &nodes, size_t count)
+{
+    std::vector<std::vector<int>> groups(count);
+    if (count == 0 || nodes.empty())
+    {
+        return groups;
+    }
+
+    if (count <= nodes.size())
+    {
+        // Группа g - узлы [g * n / count, (g + 1) * n / count)
+        for (size_t node = 0; node < nodes.size(); ++node)
+        {
+            auto &group = groups[node * count / nodes.size()];
+            group.insert(group.end(), nodes[node].begin(), nodes[node].end());
+        }
+        return groups;
+    }
+
+    std::vector<int> cpus;
+    for (const auto &node : nodes)
+    {
+        cpus.insert(cpus.end(), node.begin(), node.end());
+    }
+    if (cpus.empty())
+    {
+        return groups;
+    }
+
+    if (cpus.size() < count)
+    {
+        // Ядер меньше, чем процессов: процессы делят ядра по кругу
+        for (size_t i = 0; i < count; ++i)
+        {
+            groups[i].push_back(cpus[i % cpus.size()]);
+        }
+        return groups;
+    }
+
+    // Процесс i получает ядра [i * m / count, (i + 1) * m / count)
+    for (size_t i = 0; i < count; ++i)
+    {
+        groups[i].assign(cpus.begin() + static_cast<std::ptrdiff_t>(i * cpus.size() / count),
+                         cpus.begin() + static_cast<std::ptrdiff_t>((i + 1) * cpus.size() / count));
+    }
+    return groups;
+}
+
+std::vector<int> LocalLauncher::parse_cpu_list(const std::string &text)
+{
+    std::vector<int> cpus;
+    std::istringstream iss(text);
+    std::string range;
+    while (std::getline(iss, range, ','))
+    {
+        if (range.empty())
+        {
+            continue;
+        }
+
+        int first = 0;
+        int last = 0;
+        char dash = 0;
+        std::istringstream range_stream(range);
+        if (!(range_stream >> first))
+        {
+            return {};
+        }
+        last = first;
+        if (range_stream >> dash && (dash != '-' || !(range_stream >> last) || last < first))
+        {
+            return {};
+        }
+
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<std::vector<int>> LocalLauncher::read_numa_nodes()
+{
+    std::vector<std::vector<int>> nodes;
+
+#ifdef __linux__
+    // Ядра, на которых разрешено работать серверу (taskset, cgroup)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool has_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    const std::filesystem::path root = "/sys/devices/system/node";
+    std::error_code ec;
+    std::vector<std::pair<int, std::filesystem::path>> node_dirs;
+    for (const auto &entry : std::filesystem::directory_iterator(root, ec))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) == 0 && name.size() > 4 &&
+            std::all_of(name.begin() + 4, name.end(), [](char c)
+                        { return std::isdigit(static_cast<unsigned char>(c)); }))
+        {
+            node_dirs.emplace_back(std::stoi(name.substr(4)), entry.path());
+        }
+    }
+    std::sort(node_dirs.begin(), node_dirs.end());
+
+    for (const auto &[id, dir] : node_dirs)
+    {
+        std::ifstream file(dir / "cpulist");
+        std::string text;
+        std::getline(file, text);
+
+        std::vector<int> cpus;
+        for (int cpu : parse_cpu_list(text))
+        {
+            if (!has_mask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty())
+        {
+            nodes.push_back(std::move(cpus));
+        }
+    }
+
+    if (nodes.empty() && has_mask)
+    {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        nodes.push_back(std::move(cpus));
+    }
+#endif
+
+    if (nodes.empty())
+    {
+        std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t i = 0; i < cpus.size(); ++i)
+        {
+            cpus[i] = static_cast<int>(i);
+        }
+        nodes.push_back(std::move(cpus));
+    }
+    return nodes;
+}
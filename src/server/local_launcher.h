@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file local_launcher.h
+ * @brief Модуль запуска клиентских процессов на машине сервера
+ */
+
+/**
+ * @class LocalLauncher
+ * @brief Запускает процессы клиента, подключающиеся к серверу через loopback
+ *
+ * Каждый процесс привязывается к своей группе ядер: при числе процессов,
+ * равном числу узлов NUMA, - к ядрам одного узла, поэтому потоки клиента
+ * работают с локальной памятью. Клиенты - обычные процессы client,
+ * поэтому результат совпадает с запуском на кластере.
+ *
+ * Привязка к ядрам поддерживается только в Linux, запуск процессов -
+ * в Linux и macOS
+ */
+class LocalLauncher
+{
+public:
+    /**
+     * @brief Конструктор (процессы ещё не запущены)
+     * @param client_path Путь к исполняемому файлу клиента
+     * @param port Порт сервера
+     * @param count Количество процессов
+     * @throws std::invalid_argument если count == 0
+     */
+    LocalLauncher(std::string client_path, uint16_t port, size_t count);
+
+    /**
+     * @brief Деструктор - дожидается завершения процессов
+     */
+    ~LocalLauncher();
+
+    // Запрет копирования
+    LocalLauncher(const LocalLauncher &) = delete;
+    LocalLauncher &operator=(const LocalLauncher &) = delete;
+
+    /**
+     * @brief Запускает процессы клиента
+     * @throws std::runtime_error если процесс не удалось создать или платформа не поддерживается
+     */
+    void start();
+
+    /**
+     * @brief Дожидается завершения процессов, не завершившиеся за timeout получают SIGTERM
+     *
+     * Сервер вызывает метод после отправки клиентам STOP_WORK
+     *
+     * @param timeout Время ожидания добровольного завершения
+     */
+    void stop(std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+    /**
+     * @brief Делит ядра узлов NUMA на группы для count процессов
+     *
+     * Если процессов не больше, чем узлов, каждая группа - несколько соседних
+     * узлов целиком. Иначе ядра всех узлов по порядку делятся на count
+     * непрерывных частей почти равного размера (при числе процессов, кратном
+     * числу одинаковых узлов, каждая часть лежит в одном узле). Если ядер
+     * меньше, чем процессов, группы повторяются
+     *
+     * @param nodes Ядра каждого узла NUMA
+     * @param count Количество процессов
+     * @return Ядра каждого процесса
+     */
+    static std::vector<std::vector<int>> split_cpus(const std::vector<std::vector<int>> &nodes, size_t count);
+
+    /**
+     * @brief Разбирает список ядер в формате sysfs ("0-3,8-11")
+     * @return Номера ядер или пустой список, если запись некорректна
+     */
+    static std::vector<int> parse_cpu_list(const std::string &text);
+
+    /**
+     * @brief Возвращает ядра узлов NUMA, доступные процессу сервера
+     *
+     * Без сведений о NUMA (не Linux, ядро без NUMA) все ядра образуют один узел
+     */
+    static std::vector<std::vector<int>> read_numa_nodes();
+
+private:
+    // Путь к исполняемому файлу клиента
+    std::string client_path_;
+    // Порт сервера
+    uint16_t port_;
+    // Количество процессов
+    size_t count_;
+    // ID запущенных процессов
+    std::vector<long> pids_;
+};
@@ -0,0 +1,60 @@
+#include "local_worker.h"
+#include "logger.h"
+#include "integration_methods/simpsons_rule.h"
+#include <chrono>
+
+LocalWorker::LocalWorker(uint32_t num_threads)
+{
+    // Тот же метод, что используют удалённые клиенты
+    integrator_ = std::make_shared<Integrator>(std::make_unique<SimpsonsRule>());
+    worker_pool_ = std::make_unique<WorkerPool>(num_threads, integrator_);
+
+    LOG_INFO("LocalWorker created with {} threads, method: {}",
+             num_threads, integrator_->get_current_method());
+}
+
+ResultBatch LocalWorker::execute(uint64_t client_id, const TaskBatch &batch)
+{
+    LOG_INFO("Local worker executing {} tasks...", batch.tasks.size());
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    auto cancellation = std::make_shared<BatchCancellation>(batch.tasks);
+    {
+        std::lock_guard<std::mutex> lock(cancellation_mutex_);
+        cancellation_ = cancellation;
+    }
+
+    ResultBatch result_batch;
+    result_batch.client_id = client_id;
+    result_batch.results = worker_pool_->execute_tasks_parallel(batch.tasks, cancellation.get());
+
+    {
+        std::lock_guard<std::mutex> lock(cancellation_mutex_);
+        cancellation_.reset();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end_time - start_time;
+    result_batch.total_time_seconds = elapsed.count();
+    result_batch.telemetry = telemetry_collector_.collect(batch.tasks,
+                                                          result_batch.results,
+                                                          elapsed.count(),
+                                                          worker_pool_->get_num_threads());
+    result_batch.telemetry.method = integrator_->get_method_name(
+        batch.tasks.empty() ? 0 : batch.tasks.front().kernel);
+
+    LOG_INFO("Local worker completed {} tasks in {:.3f} seconds",
+             batch.tasks.size(), elapsed.count());
+
+    return result_batch;
+}
+
+void LocalWorker::cancel_job(uint64_t job_id)
+{
+    std::lock_guard<std::mutex> lock(cancellation_mutex_);
+    if (cancellation_ && cancellation_->cancel_job(job_id))
+    {
+        LOG_INFO("Local worker: job {} interrupted", job_id);
+    }
+}
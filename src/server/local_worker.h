@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include "messages.h"
+#include "integrator.h"
+#include "worker_pool.h"
+#include "telemetry_collector.h"
+
+/**
+ * @file local_worker.h
+ * @brief Модуль локального исполнителя задач на ядрах сервера
+ */
+
+/**
+ * @class LocalWorker
+ * @brief Выполняет задачи внутри процесса сервера как псевдо-клиент
+ *
+ * Использует те же WorkerPool и Integrator, что и клиентское приложение,
+ * но получает пакет задач напрямую, без сериализации и сетевого обмена
+ */
+class LocalWorker
+{
+public:
+    /**
+     * @brief Конструктор
+     * @param num_threads Количество рабочих потоков
+     * @throws std::invalid_argument если num_threads == 0
+     */
+    explicit LocalWorker(uint32_t num_threads);
+
+    // Запрет копирования и перемещения
+    LocalWorker(const LocalWorker &) = delete;
+    LocalWorker &operator=(const LocalWorker &) = delete;
+    LocalWorker(LocalWorker &&) = delete;
+    LocalWorker &operator=(LocalWorker &&) = delete;
+
+    /**
+     * @brief Выполняет пакет задач на локальных ядрах
+     * @param client_id ID, под которым локальный исполнитель зарегистрирован в ClientManager
+     * @param batch Пакет задач
+     * @return Пакет результатов в том же формате, что присылают удалённые клиенты
+     */
+    ResultBatch execute(uint64_t client_id, const TaskBatch &batch);
+
+    /**
+     * @brief Прерывает задачи задания в выполняющемся пакете
+     *
+     * Прерванные задачи возвращаются из execute() как частичные результаты
+     *
+     * @param job_id ID задания
+     */
+    void cancel_job(uint64_t job_id);
+
+    /**
+     * @brief Возвращает количество рабочих потоков
+     * @return Количество потоков
+     */
+    uint32_t get_num_threads() const { return worker_pool_->get_num_threads(); }
+
+    /**
+     * @brief Изменяет количество рабочих потоков (со следующего пакета)
+     * @param num_threads Количество потоков
+     */
+    void set_num_threads(uint32_t num_threads) { worker_pool_->set_num_threads(num_threads); }
+
+    /**
+     * @brief Геттер названия метода интегрирования
+     */
+    std::string get_method() const { return integrator_->get_current_method(); }
+
+    /**
+     * @brief Методы интегрирования, которые можно задать задачам исполнителя
+     * @return Биты IntegrationKernel
+     */
+    uint32_t get_supported_kernels() const { return integrator_->get_supported_kernels(); }
+
+    /**
+     * @brief Функции, которые можно задать задачам исполнителя
+     * @return Биты integrand_bit
+     */
+    uint32_t get_supported_integrands() const { return integrator_->get_supported_integrands(); }
+
+    /**
+     * @brief Режимы суммирования, которые можно задать задачам исполнителя
+     * @return Биты ReductionMode
+     */
+    uint32_t get_supported_reductions() const { return integrator_->get_supported_reductions(); }
+
+private:
+    // Интегратор с выбранной стратегией
+    std::shared_ptr<Integrator> integrator_;
+    // Пул потоков для параллельных вычислений
+    std::unique_ptr<WorkerPool> worker_pool_;
+    // Флаги отмены выполняющегося пакета
+    std::shared_ptr<BatchCancellation> cancellation_;
+    // Защищает cancellation_
+    std::mutex cancellation_mutex_;
+    // Сбор производительности (пакеты выполняются по одному)
+    TelemetryCollector telemetry_collector_;
+};
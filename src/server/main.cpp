@@ -1,4 +1,7 @@
 #include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
 #include "utils.h"
 #include "net_utils.h"
 #include "about.h"
@@ -41,7 +44,43 @@ double askFor(const std::string &prompt)
     }
 }
 
-int main()
+/**
+ * @brief Выводит справку по аргументам командной строки
+ * @param program Имя исполняемого файла
+ */
+void printUsage(const char *program)
+{
+    LOG_INFO("Usage: {} [--port <port>] [--control <socket_path>] [--local-worker [reserved_cores]] [--profiles <path>]", program);
+    LOG_INFO("          [--local <n>] [--client-path <path>] [--batch <job_file> --clients <n> [--output <prefix>]]");
+    LOG_INFO("          [--start-clients <n>] [--start-cores <n>] [--start-timeout <seconds>] [--elastic]");
+    LOG_INFO("          [--backlog <n>] [--handshake-workers <n>] [--handshake-queue <n>]");
+    LOG_INFO("  --port            TCP port for client connections (default 5555)");
+    LOG_INFO("  --control         run as a long-lived service and accept jobs on a local");
+    LOG_INFO("                    control socket instead of reading them from the console");
+    LOG_INFO("  --local-worker    use server cores as an in-process worker,");
+    LOG_INFO("                    keeping reserved_cores (default 1) for networking");
+    LOG_INFO("  --local           spawn n client processes on this machine, one per group of");
+    LOG_INFO("                    NUMA nodes, connected over loopback; integration starts once");
+    LOG_INFO("                    all of them have connected (unless a start option is given)");
+    LOG_INFO("  --client-path     client executable for --local (default: next to the server)");
+    LOG_INFO("  --batch           run the jobs of a file (control commands, one per line) one after");
+    LOG_INFO("                    another without prompts, then write <prefix>.csv and <prefix>.bin");
+    LOG_INFO("  --clients         number of clients to wait for before the first batch job");
+    LOG_INFO("  --output          prefix of the batch result files (default results)");
+    LOG_INFO("  --profiles        file with per-host performance profiles kept between runs");
+    LOG_INFO("                    (default host_profiles.txt, empty string disables them)");
+    LOG_INFO("  --start-clients   start integration once n clients have connected");
+    LOG_INFO("  --start-cores     start integration once clients provide n cores in total");
+    LOG_INFO("  --start-timeout   start with the connected clients after the given time");
+    LOG_INFO("  --elastic         start immediately and keep accepting clients during integration");
+    LOG_INFO("                    (without these options integration starts on a typed START)");
+    LOG_INFO("  --backlog         length of the kernel queue of pending connections");
+    LOG_INFO("  --handshake-workers  threads registering connected clients (default 4)");
+    LOG_INFO("  --handshake-queue    clients waiting for registration before new ones are");
+    LOG_INFO("                    asked to retry later (default 1024)");
+}
+
+int main(int argc, char *argv[])
 {
     // Инициализация логгера
     try
@@ -57,6 +96,160 @@ int main()
 
     printWelcomeMessage();
 
+    ServerConfig config;
+    uint16_t port = 5555;
+    std::string control_socket_path;
+    std::string batch_path;
+    std::string output_prefix = "results";
+
+    // По умолчанию клиент лежит рядом с сервером (так их раскладывает сборка)
+    config.client_path = (std::filesystem::path(argv[0]).parent_path() / "client").string();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc)
+        {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--control" && i + 1 < argc)
+        {
+            control_socket_path = argv[++i];
+        }
+        else if (arg == "--local" && i + 1 < argc)
+        {
+            config.local_clients = static_cast<size_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--client-path" && i + 1 < argc)
+        {
+            config.client_path = argv[++i];
+        }
+        else if (arg == "--batch" && i + 1 < argc)
+        {
+            batch_path = argv[++i];
+        }
+        else if (arg == "--clients" && i + 1 < argc)
+        {
+            config.start_policy.min_clients = static_cast<size_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--output" && i + 1 < argc)
+        {
+            output_prefix = argv[++i];
+        }
+        else if (arg == "--profiles" && i + 1 < argc)
+        {
+            config.profiles_path = argv[++i];
+        }
+        else if (arg == "--start-clients" && i + 1 < argc)
+        {
+            config.start_policy.min_clients = static_cast<size_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--start-cores" && i + 1 < argc)
+        {
+            config.start_policy.min_cores = static_cast<uint32_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--start-timeout" && i + 1 < argc)
+        {
+            config.start_policy.quorum_timeout = std::chrono::seconds(std::atoi(argv[++i]));
+        }
+        else if (arg == "--backlog" && i + 1 < argc)
+        {
+            config.listen_backlog = std::atoi(argv[++i]);
+        }
+        else if (arg == "--handshake-workers" && i + 1 < argc)
+        {
+            config.handshake_workers = static_cast<size_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--handshake-queue" && i + 1 < argc)
+        {
+            config.handshake_queue = static_cast<size_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--elastic")
+        {
+            config.start_policy.elastic = true;
+        }
+        else if (arg == "--local-worker")
+        {
+            config.local_worker = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                config.local_worker_reserved_cores = static_cast<uint32_t>(std::atoi(argv[++i]));
+            }
+        }
+        else
+        {
+            LOG_ERROR("Unknown argument: {}", arg);
+            printUsage(argv[0]);
+            logging::shutdown();
+            return 1;
+        }
+    }
+
+    // Запущенные сервером клиенты заменяют команду START
+    if (config.local_clients > 0 && !config.start_policy.is_automatic())
+    {
+        config.start_policy.min_clients = config.local_clients + (config.local_worker ? 1 : 0);
+    }
+
+    // Пакетный режим: задания из файла, итоги в CSV и двоичный файл
+    if (!batch_path.empty())
+    {
+        if (!config.start_policy.is_automatic())
+        {
+            LOG_ERROR("--batch requires --clients <n> (or --local <n>)");
+            logging::shutdown();
+            return 1;
+        }
+
+        try
+        {
+            auto entries = BatchRunner::parse_file(batch_path);
+
+            std::vector<BatchRow> rows;
+            {
+                Server server(port, config);
+                rows = server.run_batch(entries);
+            }
+
+            BatchRunner::write_csv(output_prefix + ".csv", rows);
+            BatchRunner::write_columnar(output_prefix + ".bin", rows);
+
+            size_t failed = static_cast<size_t>(std::count_if(rows.begin(), rows.end(), [](const BatchRow &row)
+                                                              { return !row.success; }));
+            failed += entries.size() - rows.size();
+            LOG_INFO("Batch finished: {} of {} job(s) succeeded, results in {}.csv and {}.bin",
+                     entries.size() - failed, entries.size(), output_prefix, output_prefix);
+
+            logging::shutdown();
+            return failed == 0 ? 0 : 1;
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Batch error: {}", e.what());
+            logging::shutdown();
+            return 1;
+        }
+    }
+
+    // Режим сервиса: задания поступают через управляющий сокет
+    if (!control_socket_path.empty())
+    {
+        try
+        {
+            Server server(port, config);
+            server.serve(control_socket_path);
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Server error: {}", e.what());
+            logging::shutdown();
+            return 1;
+        }
+
+        logging::shutdown();
+        return 0;
+    }
+
     IntegrationParameters params;
     params.lower_limit = askFor("  Lower limit (x > 0, x != 1): ");
     params.upper_limit = askFor("  Upper limit (x > lower): ");
@@ -71,8 +264,7 @@ int main()
 
     try
     {
-        const uint16_t PORT = 5555;
-        Server server(PORT);
+        Server server(port, config);
         server.run(params);
 
         logging::shutdown();
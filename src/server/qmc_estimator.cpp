@@ -0,0 +1,78 @@
+#include "qmc_estimator.h"
+#include <algorithm>
+#include <cmath>
+
+QmcEstimator::QmcEstimator(uint32_t replicas, uint64_t points, double volume)
+    : points_(std::max<uint64_t>(points, 1)),
+      volume_(volume),
+      sums_(replicas),
+      sum_squares_(replicas)
+{
+}
+
+bool QmcEstimator::add(uint32_t replica, double sum, double sum_squares)
+{
+    if (replica >= sums_.size())
+    {
+        return false;
+    }
+
+    sums_[replica].add(sum);
+    sum_squares_[replica].add(sum_squares);
+    return true;
+}
+
+std::vector<double> QmcEstimator::get_replica_estimates() const
+{
+    std::vector<double> estimates;
+    estimates.reserve(sums_.size());
+    for (const auto &sum : sums_)
+    {
+        estimates.push_back(volume_ * (sum.value() / static_cast<double>(points_)));
+    }
+    return estimates;
+}
+
+double QmcEstimator::get_estimate() const
+{
+    if (sums_.empty())
+    {
+        return 0.0;
+    }
+
+    ExactSum total;
+    for (double estimate : get_replica_estimates())
+    {
+        total.add(estimate);
+    }
+    return total.value() / static_cast<double>(sums_.size());
+}
+
+double QmcEstimator::get_standard_error() const
+{
+    const double n = static_cast<double>(points_);
+
+    if (sums_.size() == 1)
+    {
+        // Дисперсия значений функции: оценка погрешности метода Монте-Карло
+        double mean = sums_[0].value() / n;
+        double variance = std::max(0.0, sum_squares_[0].value() / n - mean * mean);
+        return std::abs(volume_) * std::sqrt(variance / n);
+    }
+    if (sums_.empty())
+    {
+        return 0.0;
+    }
+
+    // Разброс оценок независимых реплик
+    std::vector<double> estimates = get_replica_estimates();
+    double mean = get_estimate();
+    double squares = 0.0;
+    for (double estimate : estimates)
+    {
+        squares += (estimate - mean) * (estimate - mean);
+    }
+
+    const double replicas = static_cast<double>(estimates.size());
+    return std::sqrt(squares / (replicas - 1.0) / replicas);
+}
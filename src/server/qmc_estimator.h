@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "exact_sum.h"
+
+/**
+ * @file qmc_estimator.h
+ * @brief Модуль оценки интеграла и её погрешности по результатам задач квази-Монте-Карло
+ */
+
+/**
+ * @class QmcEstimator
+ * @brief Складывает суммы задач задания KERNEL_QMC по репликам
+ *
+ * Суммы значений и их квадратов складываются точно (ExactSum), поэтому
+ * оценка не зависит от того, как задание разделено на задачи и в каком
+ * порядке пришли результаты. Оценка интеграла - среднее оценок реплик,
+ * погрешность - стандартная ошибка этого среднего. У задания с одной
+ * репликой погрешность оценивается по дисперсии значений функции, как
+ * для метода Монте-Карло: для квази-Монте-Карло такая оценка завышена
+ *
+ * @note Не потокобезопасен: вызывается под мьютексом планировщика
+ */
+class QmcEstimator
+{
+public:
+    /**
+     * @brief Конструктор
+     * @param replicas Количество реплик задания
+     * @param points Количество точек в каждой реплике
+     * @param volume Объём области интегрирования
+     */
+    QmcEstimator(uint32_t replicas, uint64_t points, double volume);
+
+    /**
+     * @brief Добавляет результат задачи (в том числе частичный)
+     * @param replica Номер реплики задачи
+     * @param sum Сумма значений функции в точках задачи
+     * @param sum_squares Сумма квадратов значений
+     * @return false, если реплики с таким номером нет
+     */
+    bool add(uint32_t replica, double sum, double sum_squares);
+
+    /**
+     * @brief Оценки интеграла по каждой реплике
+     */
+    std::vector<double> get_replica_estimates() const;
+
+    /**
+     * @brief Оценка интеграла (среднее оценок реплик)
+     */
+    double get_estimate() const;
+
+    /**
+     * @brief Стандартная ошибка оценки интеграла
+     */
+    double get_standard_error() const;
+
+private:
+    // Количество точек в реплике
+    uint64_t points_;
+    // Объём области
+    double volume_;
+    // Суммы значений функции по репликам
+    std::vector<ExactSum> sums_;
+    // Суммы квадратов значений по репликам
+    std::vector<ExactSum> sum_squares_;
+};
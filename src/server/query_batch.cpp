@@ -0,0 +1,117 @@
+#include "query_batch.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+QueryBatch::QueryBatch(const std::vector<QueryRange> &queries)
+    : queries_(queries)
+{
+    if (queries_.empty() || queries_.size() > MAX_QUERIES)
+    {
+        throw std::invalid_argument("Invalid number of queries");
+    }
+
+    // Точки разбиения - концы всех запросов без повторов
+    std::vector<double> points;
+    points.reserve(queries_.size() * 2);
+    for (const auto &query : queries_)
+    {
+        if (!(query.lower < query.upper) || !std::isfinite(query.lower) || !std::isfinite(query.upper))
+        {
+            throw std::invalid_argument("Invalid query range");
+        }
+        points.push_back(query.lower);
+        points.push_back(query.upper);
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    auto index_of = [&points](double x)
+    {
+        return static_cast<size_t>(std::lower_bound(points.begin(), points.end(), x) - points.begin());
+    };
+
+    // Сколько запросов покрывает каждый отрезок [points[i], points[i + 1])
+    std::vector<int> coverage(points.size(), 0);
+    for (const auto &query : queries_)
+    {
+        coverage[index_of(query.lower)]++;
+        coverage[index_of(query.upper)]--;
+    }
+
+    // Номер отрезка объединения для каждого покрытого отрезка разбиения
+    std::vector<size_t> segment_of(points.size(), 0);
+    int covered = 0;
+    for (size_t i = 0; i + 1 < points.size(); ++i)
+    {
+        covered += coverage[i];
+        segment_of[i] = segments_.size();
+        if (covered > 0)
+        {
+            segments_.push_back({points[i], points[i + 1]});
+        }
+    }
+    segment_of.back() = segments_.size();
+
+    // Отрезки запроса покрыты им самим, поэтому идут в объединении подряд
+    spans_.reserve(queries_.size());
+    for (const auto &query : queries_)
+    {
+        spans_.emplace_back(segment_of[index_of(query.lower)], segment_of[index_of(query.upper)]);
+    }
+
+    sums_.resize(segments_.size());
+}
+
+double QueryBatch::get_covered_length() const
+{
+    double length = 0.0;
+    for (const auto &segment : segments_)
+    {
+        length += segment.upper - segment.lower;
+    }
+    return length;
+}
+
+bool QueryBatch::add(double begin, double value, double value_low)
+{
+    // Последний отрезок, начинающийся не правее begin
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), begin,
+                               [](double x, const QueryRange &segment)
+                               { return x < segment.lower; });
+    if (it == segments_.begin() || begin >= std::prev(it)->upper)
+    {
+        return false;
+    }
+
+    ExactSum &sum = sums_[static_cast<size_t>(std::prev(it) - segments_.begin())];
+    sum.add(value);
+    sum.add(value_low);
+    return true;
+}
+
+double QueryBatch::get_total() const
+{
+    ExactSum total;
+    for (const auto &sum : sums_)
+    {
+        total.add(sum);
+    }
+    return total.value();
+}
+
+std::vector<double> QueryBatch::get_answers() const
+{
+    std::vector<double> answers;
+    answers.reserve(spans_.size());
+    for (const auto &[first, last] : spans_)
+    {
+        ExactSum answer;
+        for (size_t i = first; i < last; ++i)
+        {
+            answer.add(sums_[i]);
+        }
+        answers.push_back(answer.value());
+    }
+    return answers;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "exact_sum.h"
+
+/**
+ * @file query_batch.h
+ * @brief Модуль пакетных заданий: интегралы по многим отрезкам за один проход
+ */
+
+/**
+ * @struct QueryRange
+ * @brief Отрезок интегрирования одного запроса пакетного задания
+ */
+struct QueryRange
+{
+    // Нижний предел интегрирования
+    double lower = 0.0;
+    // Верхний предел интегрирования
+    double upper = 0.0;
+};
+
+/**
+ * @class QueryBatch
+ * @brief Разбивает объединение отрезков запросов на отрезки между соседними концами
+ *
+ * Концы всех запросов сортируются и образуют точки разбиения. Отрезки между
+ * соседними точками, покрытые хотя бы одним запросом, вычисляются один раз:
+ * фрагменты задания не пересекают точки разбиения, поэтому результат каждого
+ * фрагмента относится ровно к одному отрезку. Ответ на запрос - сумма
+ * интегралов его отрезков, а стоимость задания - длина объединения,
+ * а не сумма длин запросов.
+ *
+ * Интегралы отрезков складываются точно (ExactSum), поэтому ответы
+ * не зависят от разбиения на фрагменты и порядка прихода результатов
+ *
+ * @note Не потокобезопасен: вызывается под мьютексом планировщика
+ */
+class QueryBatch
+{
+public:
+    // Максимальное количество запросов в задании
+    static constexpr size_t MAX_QUERIES = 4096;
+
+    /**
+     * @brief Конструктор
+     * @param queries Отрезки запросов (lower < upper)
+     * @throws std::invalid_argument если запросов нет, их слишком много или отрезок пуст
+     */
+    explicit QueryBatch(const std::vector<QueryRange> &queries);
+
+    /**
+     * @brief Отрезки объединения между соседними точками разбиения по возрастанию
+     */
+    const std::vector<QueryRange> &get_segments() const { return segments_; }
+
+    /**
+     * @brief Суммарная длина отрезков (длина объединения запросов)
+     */
+    double get_covered_length() const;
+
+    /**
+     * @brief Добавляет результат фрагмента (в том числе частичный)
+     * @param begin Начало фрагмента
+     * @param value Интеграл по вычисленной части фрагмента
+     * @param value_low Младшая часть значения (для REDUCTION_DOUBLE_DOUBLE)
+     * @return false, если начало фрагмента не лежит ни в одном отрезке
+     */
+    bool add(double begin, double value, double value_low = 0.0);
+
+    /**
+     * @brief Интеграл по объединению запросов
+     */
+    double get_total() const;
+
+    /**
+     * @brief Ответы на запросы в порядке их задания
+     */
+    std::vector<double> get_answers() const;
+
+private:
+    // Отрезки запросов
+    std::vector<QueryRange> queries_;
+    // Отрезки объединения между соседними точками разбиения
+    std::vector<QueryRange> segments_;
+    // Отрезки каждого запроса: [первый, следующий за последним)
+    std::vector<std::pair<size_t, size_t>> spans_;
+    // Интегралы отрезков
+    std::vector<ExactSum> sums_;
+};
@@ -2,8 +2,9 @@
 #include "logger.h"
 #include <chrono>
 
-ResultAggregator::ResultAggregator(size_t expected_results_count)
-    : expected_count_(expected_results_count)
+ResultAggregator::ResultAggregator(size_t expected_results_count, uint32_t reduction)
+    : expected_count_(expected_results_count),
+      reduction_(reduction)
 {
     all_results_.reserve(expected_results_count);
     LOG_INFO("ResultAggregator initialized, expecting {} results", expected_count_);
@@ -18,11 +19,26 @@ void ResultAggregator::add_result(const ResultBatch &batch)
               batch.results.size(),
               batch.total_time_seconds);
 
+    ClientContribution &contribution = contributions_[batch.client_id];
+    contribution.time_seconds += batch.total_time_seconds;
+
+    size_t completed = 0;
     for (const auto &result : batch.results)
     {
+        if (result.success && result.partial)
+        {
+            // Прерванная задача: значение учитывается, но задача ещё не выполнена
+            accumulate(result);
+            contribution.value += result.value;
+            LOG_TRACE("Task {}: partial value={} up to {}", result.task_id, result.value, result.end);
+            continue;
+        }
+
+        completed++;
         if (result.success)
         {
-            total_sum_ += result.value;
+            accumulate(result);
+            contribution.value += result.value;
             successful_count_++;
             LOG_TRACE("Task {}: value={}", result.task_id, result.value);
         }
@@ -35,7 +51,8 @@ void ResultAggregator::add_result(const ResultBatch &batch)
         all_results_.push_back(result);
     }
 
-    received_count_ += batch.results.size();
+    contribution.tasks += completed;
+    received_count_ += completed;
 
     LOG_INFO("Progress: {}/{} results received ({:.1f}%)",
              received_count_.load(),
@@ -46,6 +63,12 @@ void ResultAggregator::add_result(const ResultBatch &batch)
     cv_.notify_all();
 }
 
+void ResultAggregator::add_expected(size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    expected_count_ += count;
+}
+
 bool ResultAggregator::wait_for_all_results(uint32_t timeout_seconds)
 {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -76,10 +99,28 @@ bool ResultAggregator::wait_for_all_results(uint32_t timeout_seconds)
     }
 }
 
+void ResultAggregator::accumulate(const Result &result)
+{
+    if (reduction_ == REDUCTION_PLAIN)
+    {
+        total_sum_ += result.value;
+        return;
+    }
+
+    exact_sum_.add(result.value);
+    exact_sum_.add(result.value_low);
+}
+
 double ResultAggregator::get_final_result() const
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    return total_sum_;
+    return reduction_ == REDUCTION_PLAIN ? total_sum_ : exact_sum_.value();
+}
+
+std::map<uint64_t, ClientContribution> ResultAggregator::get_client_contributions() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return contributions_;
 }
 
 void ResultAggregator::log_results_info() const
@@ -91,6 +132,6 @@ void ResultAggregator::log_results_info() const
     LOG_INFO("Received: {}", received_count_.load());
     LOG_INFO("Successful: {}", successful_count_.load());
     LOG_INFO("Errors: {}", error_count_.load());
-    LOG_INFO("Final result: {:.15f}", total_sum_);
+    LOG_INFO("Final result: {:.15f}", reduction_ == REDUCTION_PLAIN ? total_sum_ : exact_sum_.value());
     LOG_INFO("===========================");
 }
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include "exact_sum.h"
 #include "messages.h"
 
 /**
@@ -11,11 +13,28 @@
  * @brief Модуль сбора и агрегации результатов от клиентов
  */
 
+/**
+ * @struct ClientContribution
+ * @brief Вклад одного клиента в итоговый результат
+ */
+struct ClientContribution
+{
+    // Количество выполненных задач
+    size_t tasks = 0;
+    // Время вычислений на стороне клиента
+    double time_seconds = 0.0;
+    // Сумма успешно вычисленных клиентом значений
+    double value = 0.0;
+};
+
 /**
  * @class ResultAggregator
  * @brief Собирает результаты от всех клиентов и вычисляет итоговый результат
  *
- * Обеспечивает потокобезопасный сбор результатов и ожидание получения всех данных
+ * Обеспечивает потокобезопасный сбор результатов и ожидание получения всех данных.
+ * В режимах REDUCTION_COMPENSATED и REDUCTION_DOUBLE_DOUBLE значения фрагментов
+ * (обе части для double-double) складываются точно, поэтому итог не теряет
+ * знаков, сохранённых накопителями клиентов, и не зависит от порядка результатов
  */
 class ResultAggregator
 {
@@ -23,15 +42,29 @@ public:
     /**
      * @brief Конструктор
      * @param expected_results_count Ожидаемое количество результатов
+     * @param reduction Режим суммирования задания (бит ReductionMode)
      */
-    explicit ResultAggregator(size_t expected_results_count);
+    explicit ResultAggregator(size_t expected_results_count, uint32_t reduction = REDUCTION_PLAIN);
 
     /**
      * @brief Добавляет результат от клиента
+     *
+     * Частичные результаты прерванных задач добавляются к сумме,
+     * но не учитываются как полученные: задача будет досчитана позже
+     *
      * @param batch Пакет результатов от клиента
      */
     void add_result(const ResultBatch &batch);
 
+    /**
+     * @brief Увеличивает ожидаемое количество результатов
+     *
+     * Вызывается, когда планировщик делит задачу на части
+     *
+     * @param count На сколько результатов больше ожидается
+     */
+    void add_expected(size_t count);
+
     /**
      * @brief Ожидает получения всех результатов
      * @param timeout_seconds Таймаут в секундах (0 = бесконечно)
@@ -63,6 +96,12 @@ public:
      */
     size_t get_error_count() const { return error_count_.load(); }
 
+    /**
+     * @brief Получает вклад каждого клиента
+     * @return Карта: client_id -> ClientContribution
+     */
+    std::map<uint64_t, ClientContribution> get_client_contributions() const;
+
     /**
      * @brief Выводит детальную информацию о результатах в лог
      */
@@ -81,8 +120,20 @@ private:
     // Количество ошибок
     std::atomic<size_t> error_count_{0};
 
-    // Сумма всех результатов
+    // Режим суммирования (бит ReductionMode)
+    uint32_t reduction_;
+    // Сумма всех результатов (REDUCTION_PLAIN)
     double total_sum_{0.0};
+    // Точная сумма всех результатов (остальные режимы)
+    ExactSum exact_sum_;
     // Все полученные результаты
     std::vector<Result> all_results_;
+    // Вклад каждого клиента
+    std::map<uint64_t, ClientContribution> contributions_;
+
+    /**
+     * @brief Добавляет значение результата к сумме
+     * @note Вызывать под mutex_
+     */
+    void accumulate(const Result &result);
 };
@@ -0,0 +1,99 @@
+#include "scan_output.h"
+#include "exact_sum.h"
+#include "logger.h"
+#include "messages.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+ScanOutput::ScanOutput(const std::string &path, uint64_t intervals)
+    : path_(path),
+      intervals_(intervals)
+{
+    if (intervals_ == 0 || intervals_ > ScanGrid::MAX_INTERVALS)
+    {
+        throw std::invalid_argument("Invalid number of output intervals");
+    }
+
+    try
+    {
+        // Файл создаётся нужного размера до отображения
+        {
+            std::ofstream create(path_, std::ios::binary | std::ios::trunc);
+            if (!create)
+            {
+                throw std::runtime_error("cannot create file");
+            }
+        }
+        std::filesystem::resize_file(path_, (intervals_ + 1) * sizeof(double));
+
+        mapping_ = boost::interprocess::file_mapping(path_.c_str(), boost::interprocess::read_write);
+        region_ = boost::interprocess::mapped_region(mapping_, boost::interprocess::read_write);
+    }
+    catch (const std::exception &e)
+    {
+        throw std::runtime_error("Cannot open output file " + path_ + ": " + e.what());
+    }
+
+    values_ = static_cast<double *>(region_.get_address());
+    values_[0] = 0.0;
+}
+
+bool ScanOutput::write(uint64_t first, const std::vector<double> &cumulative)
+{
+    if (first >= intervals_ || cumulative.size() > intervals_ - first)
+    {
+        return false;
+    }
+    if (cumulative.empty())
+    {
+        return true;
+    }
+
+    std::copy(cumulative.begin(), cumulative.end(), values_ + first + 1);
+    pieces_[first] = Piece{cumulative.size(), cumulative.back()};
+    return true;
+}
+
+double ScanOutput::get_total() const
+{
+    ExactSum total;
+    for (const auto &[first, piece] : pieces_)
+    {
+        total.add(piece.total);
+    }
+    return total.value();
+}
+
+void ScanOutput::finish()
+{
+    // Исключающая префиксная сумма итогов фрагментов в порядке таблицы
+    ExactSum offset;
+    uint64_t next = 0;
+    for (const auto &[first, piece] : pieces_)
+    {
+        if (first != next)
+        {
+            throw std::runtime_error("Output table has a gap at point " + std::to_string(next));
+        }
+
+        const double shift = offset.value();
+        double *values = values_ + first + 1;
+        for (uint64_t i = 0; i < piece.count; ++i)
+        {
+            values[i] += shift;
+        }
+
+        offset.add(piece.total);
+        next = first + piece.count;
+    }
+    if (next != intervals_)
+    {
+        throw std::runtime_error("Output table has a gap at point " + std::to_string(next));
+    }
+
+    region_.flush();
+
+    LOG_INFO("Output table {}: {} points from {} pieces", path_, intervals_ + 1, pieces_.size());
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/**
+ * @file scan_output.h
+ * @brief Модуль записи таблицы первообразной в отображаемый в память файл
+ */
+
+/**
+ * @class ScanOutput
+ * @brief Собирает таблицу F(x_k) = ∫ от x_0 до x_k из локальных префиксных сумм фрагментов
+ *
+ * Файл - intervals + 1 чисел double в порядке байтов сервера, F(x_0) = 0.
+ * Каждый результат фрагмента (в том числе частичный) содержит интегралы от
+ * начала фрагмента до его точек таблицы: они сразу записываются на своё место
+ * в файле, а в памяти остаётся только итог фрагмента. После получения всех
+ * фрагментов finish() вычисляет исключающую префиксную сумму итогов и
+ * прибавляет её к значениям каждого фрагмента (второй проход по файлу)
+ *
+ * @note Не потокобезопасен: write() вызывается под мьютексом планировщика,
+ *       finish() - после удаления задания из планировщика
+ */
+class ScanOutput
+{
+public:
+    /**
+     * @brief Создаёт (или перезаписывает) файл таблицы и отображает его в память
+     * @param path Путь к файлу
+     * @param intervals Количество отрезков таблицы
+     * @throws std::invalid_argument если количество отрезков 0 или больше ScanGrid::MAX_INTERVALS
+     * @throws std::runtime_error если файл не удалось создать или отобразить
+     */
+    ScanOutput(const std::string &path, uint64_t intervals);
+
+    // Запрет копирования
+    ScanOutput(const ScanOutput &) = delete;
+    ScanOutput &operator=(const ScanOutput &) = delete;
+
+    /**
+     * @brief Записывает локальные префиксные суммы фрагмента
+     * @param first Номер точки таблицы, с которой начинается фрагмент
+     * @param cumulative Интегралы от начала фрагмента до точек first + 1, first + 2, ...
+     * @return false, если значения выходят за пределы таблицы
+     */
+    bool write(uint64_t first, const std::vector<double> &cumulative);
+
+    /**
+     * @brief Интеграл по всей записанной части таблицы
+     */
+    double get_total() const;
+
+    /**
+     * @brief Применяет смещения фрагментов и сбрасывает файл на диск
+     * @throws std::runtime_error если таблица заполнена не полностью
+     */
+    void finish();
+
+    /**
+     * @brief Путь к файлу таблицы
+     */
+    const std::string &get_path() const { return path_; }
+
+private:
+    /**
+     * @struct Piece
+     * @brief Записанный фрагмент таблицы
+     */
+    struct Piece
+    {
+        // Количество записанных точек
+        uint64_t count = 0;
+        // Интеграл по фрагменту (последнее значение фрагмента)
+        double total = 0.0;
+    };
+
+    // Путь к файлу
+    std::string path_;
+    // Количество отрезков таблицы
+    uint64_t intervals_;
+    // Отображение файла в память
+    boost::interprocess::file_mapping mapping_;
+    boost::interprocess::mapped_region region_;
+    // Значения таблицы в отображённой памяти
+    double *values_ = nullptr;
+    // Записанные фрагменты: номер первой точки -> фрагмент
+    std::map<uint64_t, Piece> pieces_;
+};
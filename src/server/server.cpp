@@ -1,12 +1,32 @@
 #include "server.h"
+#include "about.h"
 #include "logger.h"
 #include "net_utils.h"
+#include "utils.h"
+#include <algorithm>
+#include <cctype>
 #include <iomanip>
 #include <chrono>
-
-Server::Server(uint16_t port)
-    : port_(port)
+#include <deque>
+#include <future>
+#include <sstream>
+
+Server::Server(uint16_t port, const ServerConfig &config)
+    : port_(port),
+      config_(config),
+      host_profiles_(config.profiles_path),
+      scheduler_([this](const JobOutcome &outcome)
+                 { on_job_finished(outcome); },
+                 [this]()
+                 { return task_distributor_.allocate_task_id(); }),
+      handshake_pool_([this](PendingClient &client)
+                      { handle_client_connection(client); })
 {
+    host_profiles_.load();
+
+    capabilities_ = protocol::local_capabilities();
+    capabilities_.max_in_flight = static_cast<uint32_t>(PIPELINE_DEPTH);
+
     LOG_INFO("Server initialized on port {}", port_);
 }
 
@@ -39,89 +59,291 @@ void Server::run(const IntegrationParameters &params)
     // Запускаем приём клиентов
     start_accepting_clients();
 
+    // Ядра самого сервера участвуют в вычислениях наравне с клиентами
+    if (config_.local_worker)
+    {
+        register_local_worker();
+    }
+    if (config_.local_clients > 0)
+    {
+        launch_local_clients();
+    }
+
     // Запускаем обработчик команды START
     input_handler_.start([this]()
                          {
-        start_received_.store(true);
+        {
+            std::lock_guard<std::mutex> lock(start_mutex_);
+            start_received_ = true;
+        }
+        start_cv_.notify_all();
         LOG_INFO("START command triggered"); });
 
-    // Ожидаем команды START
+    if (!wait_for_start())
+    {
+        LOG_INFO("Server stopped before START command");
+        return;
+    }
+
+    const bool elastic = config_.start_policy.elastic;
+
+    if (!elastic)
+    {
+        // Останавливаем приём новых клиентов
+        stop_accepting_clients();
+
+        // Проверяем наличие клиентов
+        if (client_manager_.get_client_count() == 0)
+        {
+            LOG_ERROR("No clients connected. Cannot start integration.");
+            stop();
+            return;
+        }
+    }
+
+    // Единственное задание проходит через ту же очередь и планировщик, что и в режиме сервиса
+    uint64_t job_id = job_queue_.submit(params);
+
+    std::promise<void> finished;
+    job_queue_.when_finished(job_id, [&finished](const JobStatus &)
+                             { finished.set_value(); });
+
+    if (auto job = job_queue_.wait_next())
+    {
+        admit_job(*job);
+    }
+
+    auto future = finished.get_future();
+    while (future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+    {
+        // Новые клиенты не принимаются, поэтому без клиентов задание не завершится
+        if (!elastic && client_manager_.get_client_count() == 0)
+        {
+            LOG_ERROR("All clients disconnected. Cannot finish integration.");
+            break;
+        }
+    }
+
+    // Завершаем работу: сессии отправят клиентам команду STOP_WORK
+    stop();
+}
+
+bool Server::wait_for_start()
+{
+    const StartPolicy &policy = config_.start_policy;
+
     LOG_INFO("Waiting for clients to connect...");
     LOG_INFO("Type 'START' and press Enter to begin integration");
+    if (policy.min_clients > 0)
+    {
+        LOG_INFO("Integration starts automatically when {} client(s) connect", policy.min_clients);
+    }
+    if (policy.min_cores > 0)
+    {
+        LOG_INFO("Integration starts automatically when clients provide {} core(s)", policy.min_cores);
+    }
+    if (policy.quorum_timeout.count() > 0)
+    {
+        LOG_INFO("Integration starts with connected clients after {} s", policy.quorum_timeout.count());
+    }
+    if (policy.elastic)
+    {
+        LOG_INFO("Elastic mode: integration starts immediately, clients may join at any time");
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + policy.quorum_timeout;
 
-    while (!start_received_.load() && running_.load())
+    std::unique_lock<std::mutex> lock(start_mutex_);
+    while (true)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (!running_.load())
+        {
+            return false;
+        }
+
+        bool quorum_expired = policy.quorum_timeout.count() > 0 && std::chrono::steady_clock::now() >= deadline;
+        if (start_received_ || start_conditions_met(quorum_expired))
+        {
+            break;
+        }
+
+        // Ожидание прерывают START, подключение клиента и остановка сервера
+        if (policy.quorum_timeout.count() > 0 && !quorum_expired)
+        {
+            start_cv_.wait_until(lock, deadline);
+        }
+        else
+        {
+            start_cv_.wait(lock);
+        }
     }
 
-    if (!running_.load())
+    LOG_INFO("Starting integration: {} client(s), {} core(s)",
+             client_manager_.get_client_count(),
+             client_manager_.get_total_cpu_cores());
+    return true;
+}
+
+bool Server::start_conditions_met(bool quorum_expired) const
+{
+    const StartPolicy &policy = config_.start_policy;
+
+    if (policy.elastic)
     {
-        LOG_INFO("Server stopped before START command");
-        return;
+        return true;
     }
 
-    // Останавливаем приём новых клиентов
-    stop_accepting_clients();
+    size_t clients = client_manager_.get_client_count();
+    if (policy.min_clients > 0 && clients >= policy.min_clients)
+    {
+        return true;
+    }
+    if (policy.min_cores > 0 && client_manager_.get_total_cpu_cores() >= policy.min_cores)
+    {
+        return true;
+    }
+
+    // По истечении времени достаточно хотя бы одного клиента
+    return quorum_expired && clients > 0;
+}
 
-    // Проверяем наличие клиентов
-    if (client_manager_.get_client_count() == 0)
+void Server::notify_start_waiter()
+{
+    // Захват мьютекса не даёт уведомлению проскочить между проверкой условий и ожиданием
     {
-        LOG_ERROR("No clients connected. Cannot start integration.");
-        stop();
-        return;
+        std::lock_guard<std::mutex> lock(start_mutex_);
     }
+    start_cv_.notify_all();
+}
 
-    client_manager_.log_clients_info();
+void Server::serve(const std::string &control_socket_path)
+{
+    LOG_INFO("=== Distributed Integration Server (service mode) ===");
+
+    running_.store(true);
 
-    LOG_INFO("=== Starting Integration ===");
+    // Запускаем приём клиентов: в режиме сервиса он не прекращается между заданиями
+    start_accepting_clients();
 
-    // Распределяем и отправляем задачи
-    if (!distribute_and_send_tasks(params))
+    if (config_.local_worker)
     {
-        LOG_ERROR("Failed to distribute tasks to clients");
-        stop();
-        return;
+        register_local_worker();
+    }
+    if (config_.local_clients > 0)
+    {
+        launch_local_clients();
     }
 
-    // Создаём агрегатор результатов
-    size_t total_tasks = task_distributor_.get_total_tasks_count();
-    ResultAggregator aggregator(total_tasks);
+    control_server_ = std::make_unique<ControlServer>(
+        [this](const std::string &request, ControlServer::Reply reply)
+        { handle_control_command(request, std::move(reply)); });
 
-    // Собираем результаты
-    if (!collect_results(aggregator))
+    try
+    {
+        control_server_->start(control_socket_path);
+    }
+    catch (const std::exception &e)
     {
-        LOG_ERROR("Failed to collect results from all clients");
+        LOG_ERROR("Failed to start control socket: {}", e.what());
         stop();
-        return;
+        throw;
+    }
+
+    LOG_INFO("Ready to accept jobs on {}", control_socket_path);
+
+    // Задания передаются планировщику сразу и выполняются одновременно
+    while (running_.load())
+    {
+        auto job = job_queue_.wait_next();
+        if (!job)
+        {
+            break;
+        }
+
+        admit_job(*job);
+    }
+
+    stop();
+}
+
+std::vector<BatchRow> Server::run_batch(const std::vector<BatchEntry> &entries)
+{
+    LOG_INFO("=== Distributed Integration Server (batch mode, {} job(s)) ===", entries.size());
+
+    running_.store(true);
+    start_accepting_clients();
+
+    if (config_.local_worker)
+    {
+        register_local_worker();
+    }
+    if (config_.local_clients > 0)
+    {
+        launch_local_clients();
     }
 
-    // Получаем итоговый результат
-    double final_result = aggregator.get_final_result();
-    aggregator.log_results_info();
+    if (!wait_for_start())
+    {
+        LOG_INFO("Server stopped before clients connected");
+        return {};
+    }
 
-    // Выводим результат
-    print_final_result(final_result, params);
+    // Задания передаются планировщику так же, как в режиме сервиса
+    std::thread admitter([this]()
+                         {
+        while (auto job = job_queue_.wait_next())
+        {
+            admit_job(*job);
+        } });
 
-    // Отправляем команду завершения работы клиентам
-    send_stop_command_to_all_clients();
+    BatchRunner runner([this](const std::string &request, BatchRunner::Reply reply)
+                       { handle_control_command(request, std::move(reply)); });
+    std::vector<BatchRow> rows = runner.run(entries);
 
-    // Завершаем работу
     stop();
+    admitter.join();
+    return rows;
 }
 
 void Server::stop()
 {
-    if (!running_.load())
+    // Остановку выполняет только первый вызвавший поток
+    if (!running_.exchange(false))
     {
         return;
     }
 
     LOG_INFO("Stopping server...");
-    running_.store(false);
+    notify_start_waiter();
 
     input_handler_.stop();
+    job_queue_.stop();
+    scheduler_.stop();
     stop_accepting_clients();
+    if (control_server_)
+    {
+        control_server_->stop();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        peers_stopped_ = true;
+    }
+    peers_cv_.notify_all();
+    if (peers_thread_.joinable())
+    {
+        peers_thread_.join();
+    }
+
+    join_sessions();
+
+    // Сессии отправили STOP_WORK: запущенные сервером клиенты завершаются
+    if (local_launcher_)
+    {
+        local_launcher_->stop();
+    }
     client_manager_.clear();
+    host_profiles_.save();
 
     LOG_INFO("Server stopped");
 }
@@ -130,13 +352,27 @@ void Server::start_accepting_clients()
 {
     try
     {
-        acceptor_ = std::make_unique<tcp::acceptor>(
-            io_context_,
-            tcp::endpoint(tcp::v4(), port_));
+        acceptor_ = std::make_unique<tcp::acceptor>(io_context_);
 
-        LOG_INFO("Server listening on port {}", port_);
+        tcp::endpoint endpoint(tcp::v4(), port_);
+        acceptor_->open(endpoint.protocol());
+        acceptor_->set_option(tcp::acceptor::reuse_address(true));
+        acceptor_->bind(endpoint);
+        // При массовом подключении клиенты ждут в очереди ядра, а не получают отказ
+        acceptor_->listen(config_.listen_backlog);
+
+        LOG_INFO("Server listening on port {} (backlog {})", port_, config_.listen_backlog);
         LOG_INFO("Waiting for clients...");
 
+        handshake_pool_.start(config_.handshake_workers, config_.handshake_queue);
+
+        {
+            std::lock_guard<std::mutex> lock(peers_mutex_);
+            peers_stopped_ = false;
+        }
+        peers_thread_ = std::thread(&Server::peers_loop, this);
+
+        accept_next();
         accept_thread_ = std::thread(&Server::accept_thread_func, this);
     }
     catch (const boost::system::system_error &e)
@@ -150,105 +386,263 @@ void Server::accept_thread_func()
 {
     LOG_DEBUG("Accept thread started");
 
-    while (running_.load() && client_manager_.is_accepting())
+    // Возвращается, когда acceptor закрыт и ожидающий приём отменён
+    try
     {
-        try
-        {
-            auto socket_ptr = std::make_shared<tcp::socket>(io_context_);
+        io_context_.run();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Error in accept thread: {}", e.what());
+    }
 
-            // Синхронный accept
-            acceptor_->accept(*socket_ptr);
+    LOG_DEBUG("Accept thread finished");
+}
 
-            if (running_.load() && client_manager_.is_accepting())
-            {
-                // Получаем endpoint ЗДЕСЬ, пока сокет гарантированно валиден
-                std::string client_ip = "unknown";
-                uint16_t client_port = 0;
+void Server::accept_next()
+{
+    auto socket_ptr = std::make_shared<tcp::socket>(io_context_);
 
-                try
-                {
-                    if (socket_ptr->is_open())
-                    {
-                        auto endpoint = socket_ptr->remote_endpoint();
-                        client_ip = endpoint.address().to_string();
-                        client_port = endpoint.port();
-                    }
-                }
-                catch (const std::exception &e)
-                {
-                    LOG_WARN("Failed to get remote endpoint: {}", e.what());
-                }
+    acceptor_->async_accept(*socket_ptr, [this, socket_ptr](const boost::system::error_code &ec)
+                            {
+        if (ec == boost::asio::error::operation_aborted || !acceptor_->is_open())
+        {
+            // Acceptor закрыт - это нормально при остановке
+            LOG_DEBUG("Accept operation aborted (normal shutdown)");
+            return;
+        }
 
-                // Запускаем обработку в отдельном потоке
-                std::thread([this, socket_ptr, client_ip, client_port]()
-                            { handle_client_connection(std::move(*socket_ptr), client_ip, client_port); })
-                    .detach();
-            }
+        if (ec)
+        {
+            LOG_ERROR("Error in accept: {}", ec.message());
         }
-        catch (const boost::system::system_error &e)
+        else if (running_.load() && client_manager_.is_accepting())
         {
-            if (e.code() == boost::asio::error::operation_aborted ||
-                e.code().value() == 10004) // WSA_INTERRUPTED
+            // Получаем endpoint ЗДЕСЬ, пока сокет гарантированно валиден
+            std::string client_ip = "unknown";
+            uint16_t client_port = 0;
+
+            boost::system::error_code endpoint_ec;
+            auto endpoint = socket_ptr->remote_endpoint(endpoint_ec);
+            if (!endpoint_ec)
             {
-                // Acceptor был закрыт - это нормально при остановке
-                LOG_DEBUG("Accept operation aborted (normal shutdown)");
-                break;
+                client_ip = endpoint.address().to_string();
+                client_port = endpoint.port();
+            }
+            else
+            {
+                LOG_WARN("Failed to get remote endpoint: {}", endpoint_ec.message());
             }
-            LOG_ERROR("Error in accept: {}", e.what());
+
+            // Запрос читается асинхронно: поток приёма не блокируется медленными клиентами
+            read_handshake(socket_ptr, client_ip, client_port);
         }
-        catch (const std::exception &e)
+
+        accept_next(); });
+}
+
+void Server::read_handshake(std::shared_ptr<tcp::socket> socket,
+                            const std::string &client_ip,
+                            uint16_t client_port)
+{
+    /**
+     * @brief Состояние чтения одного запроса
+     */
+    struct HandshakeRead
+    {
+        explicit HandshakeRead(boost::asio::io_context &io_context) : timer(io_context) {}
+
+        std::shared_ptr<tcp::socket> socket;
+        std::string ip;
+        uint16_t port = 0;
+        uint32_t network_size = 0;
+        std::string payload;
+        boost::asio::steady_timer timer;
+    };
+
+    auto read = std::make_shared<HandshakeRead>(io_context_);
+    read->socket = socket;
+    read->ip = client_ip;
+    read->port = client_port;
+    handshake_sockets_.insert(socket);
+
+    // Клиент, не приславший запрос вовремя, отключается
+    read->timer.expires_after(HANDSHAKE_TIMEOUT);
+    read->timer.async_wait([read](const boost::system::error_code &ec)
+                           {
+        if (!ec)
         {
-            LOG_ERROR("Error in accept thread: {}", e.what());
-        }
-    }
+            LOG_WARN("Handshake timeout for {}:{}", read->ip, read->port);
+            boost::system::error_code close_ec;
+            read->socket->close(close_ec);
+        } });
 
-    LOG_DEBUG("Accept thread finished");
+    auto fail = [this, read](const std::string &reason)
+    {
+        LOG_WARN("Handshake with {}:{} failed: {}", read->ip, read->port, reason);
+        read->timer.cancel();
+        handshake_sockets_.erase(read->socket);
+        boost::system::error_code ec;
+        read->socket->close(ec);
+    };
+
+    boost::asio::async_read(
+        *socket,
+        boost::asio::buffer(&read->network_size, sizeof(read->network_size)),
+        [this, read, fail](const boost::system::error_code &ec, size_t)
+        {
+            if (ec)
+            {
+                fail(ec.message());
+                return;
+            }
+
+            uint32_t size = ntohl(read->network_size);
+            if (size == 0 || size > MAX_HANDSHAKE_SIZE)
+            {
+                fail("invalid handshake size " + std::to_string(size));
+                return;
+            }
+
+            read->payload.resize(size);
+            boost::asio::async_read(
+                *read->socket,
+                boost::asio::buffer(read->payload.data(), read->payload.size()),
+                [this, read, fail](const boost::system::error_code &ec, size_t)
+                {
+                    if (ec)
+                    {
+                        fail(ec.message());
+                        return;
+                    }
+
+                    read->timer.cancel();
+
+                    PendingClient client;
+                    try
+                    {
+                        client.request = net_utils::parse_payload<HandshakeRequest>(std::move(read->payload));
+                    }
+                    catch (const std::exception &e)
+                    {
+                        fail(e.what());
+                        return;
+                    }
+
+                    handshake_sockets_.erase(read->socket);
+                    client.socket = read->socket;
+                    client.ip = read->ip;
+                    client.port = read->port;
+
+                    if (!handshake_pool_.try_submit(std::move(client)))
+                    {
+                        reject_busy(read->socket);
+                    }
+                });
+        });
+}
+
+void Server::reject_busy(std::shared_ptr<tcp::socket> socket)
+{
+    HandshakeResponse response;
+    response.accepted = false;
+    response.message = "Server is busy";
+    response.retry_after_ms = static_cast<uint32_t>(handshake_pool_.retry_after().count());
+
+    LOG_DEBUG("Handshake queue is full, client asked to retry in {} ms", response.retry_after_ms);
+
+    auto frame = std::make_shared<std::string>(net_utils::make_frame(response));
+    handshake_sockets_.insert(socket);
+
+    // Запрос уже прочитан полностью, поэтому закрытие после записи не теряет ответ
+    boost::asio::async_write(*socket, boost::asio::buffer(*frame),
+                             [this, socket, frame](const boost::system::error_code &, size_t)
+                             {
+                                 handshake_sockets_.erase(socket);
+                                 boost::system::error_code ec;
+                                 socket->shutdown(tcp::socket::shutdown_both, ec);
+                                 socket->close(ec);
+                             });
 }
 
-void Server::handle_client_connection(tcp::socket socket,
-                                      const std::string &client_ip,
-                                      uint16_t client_port)
+void Server::handle_client_connection(PendingClient &client)
 {
+    const std::string &client_ip = client.ip;
+    const uint16_t client_port = client.port;
+    tcp::socket &socket = *client.socket;
+
     try
     {
         LOG_INFO("New connection from {}:{}", client_ip, client_port);
 
-        // Получаем HandshakeRequest от клиента
-        auto handshake = net_utils::receive_data<HandshakeRequest>(socket);
+        const HandshakeRequest &handshake = client.request;
 
-        LOG_INFO("Handshake received: version={}, OS={}, cores={}",
+        LOG_INFO("Handshake received: version={}, OS={}, cores={}, host={}",
                  handshake.client_version,
                  to_string(handshake.system_info.os_type),
-                 handshake.system_info.cpu_cores);
+                 handshake.system_info.cpu_cores,
+                 handshake.system_info.host_fingerprint);
+
+        HandshakeResponse response;
+        response.server_version = SERVER_VERSION;
+
+        // Клиент без общего с сервером формата передачи не сможет получать задачи
+        try
+        {
+            response.protocol = protocol::negotiate(capabilities_, handshake.capabilities);
+        }
+        catch (const std::exception &e)
+        {
+            response.accepted = false;
+            response.message = e.what();
+            net_utils::send_data(socket, response);
+            LOG_WARN("Client {}:{} rejected: {}", client_ip, client_port, e.what());
+            return;
+        }
 
         // Генерируем ID для клиента
-        static std::atomic<uint64_t> next_id{1};
-        uint64_t client_id = next_id++;
+        uint64_t client_id = client_manager_.generate_client_id();
 
         // Отправляем HandshakeResponse
-        HandshakeResponse response;
         response.assigned_client_id = client_id;
-        response.server_version = "1.0.0";
         response.accepted = true;
         response.message = "Connection accepted";
 
         net_utils::send_data(socket, response);
 
-        LOG_INFO("Handshake completed for client {}", client_id);
+        LOG_INFO("Handshake completed for client {}, protocol {}", client_id, protocol::describe(response.protocol));
 
         // Создаём ClientConnection и добавляем в менеджер
         auto connection = std::make_unique<ClientConnection>(
             std::move(socket),
             client_id,
             handshake.system_info);
+        connection->set_protocol(response.protocol);
+
+        // Клиент без кражи работы не получает PEERS и не сообщается другим клиентам
+        uint16_t peer_port = protocol::has_feature(response.protocol, CAP_WORK_STEALING) ? handshake.peer_port : 0;
+        connection->set_peer_endpoint(client_ip, peer_port);
+
+        if (client_manager_.add_client(std::move(connection)) == 0)
+        {
+            return;
+        }
 
-        client_manager_.add_client(std::move(connection));
+        update_host_workers();
+        seed_client_performance(client_manager_.get_client(client_id), handshake.integration_method);
 
         LOG_INFO("Client registered: ID={}, Cores={}",
                  client_id, handshake.system_info.cpu_cores);
         LOG_INFO("Total clients: {}, Total cores: {}",
                  client_manager_.get_client_count(),
                  client_manager_.get_total_cpu_cores());
+
+        // Клиент сразу начинает получать фрагменты выполняющихся заданий
+        start_session(client_manager_.get_client(client_id));
+
+        // Сессия уже запущена, поэтому при остановке клиент получит STOP_WORK
+        request_peers_broadcast();
+        notify_start_waiter();
     }
     catch (const std::exception &e)
     {
@@ -264,236 +658,1565 @@ void Server::stop_accepting_clients()
     // Сначала останавливаем приём через флаг
     client_manager_.stop_accepting();
 
-    // Закрываем acceptor
-    if (acceptor_ && acceptor_->is_open())
-    {
-        boost::system::error_code ec;
-        acceptor_->close(ec);
-        if (ec)
-        {
-            LOG_WARN("Error closing acceptor: {}", ec.message());
-        }
-    }
-
-    // Ждем завершения потока с таймаутом
     if (accept_thread_.joinable())
     {
-        // Попытка с таймаутом
-        auto start = std::chrono::steady_clock::now();
-        const auto timeout = std::chrono::seconds(5);
-
-        while (accept_thread_.joinable())
-        {
-            // Пытаемся подключиться к самим себе, чтобы разблокировать accept()
-            try
-            {
-                boost::asio::io_context temp_io;
-                tcp::socket temp_socket(temp_io);
-                tcp::endpoint endpoint(tcp::v4(), port_);
-
-                boost::system::error_code ec;
-                temp_socket.connect(endpoint, ec);
-                temp_socket.close();
-            }
-            catch (...)
+        // Acceptor закрывается в потоке приёма: ожидающий async_accept отменяется,
+        // новый не запускается, незавершённые handshake прерываются закрытием сокетов,
+        // и io_context_.run() возвращается
+        boost::asio::post(io_context_, [this]()
+                          {
+            boost::system::error_code ec;
+            acceptor_->close(ec);
+            if (ec)
             {
-                // Игнорируем ошибки
+                LOG_WARN("Error closing acceptor: {}", ec.message());
             }
 
-            // Пробуем присоединиться с небольшой задержкой
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-            if (std::chrono::steady_clock::now() - start > timeout)
-            {
-                LOG_WARN("Accept thread did not finish within timeout, detaching");
-                accept_thread_.detach();
-                break;
-            }
-
-            // Если поток все еще работает, проверяем условие цикла в accept_thread_func
-            if (!running_.load() || !client_manager_.is_accepting())
+            auto sockets = handshake_sockets_;
+            for (const auto &socket : sockets)
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
-
-                // Пробуем join
-                if (accept_thread_.joinable())
-                {
-                    try
-                    {
-                        accept_thread_.join();
-                        break;
-                    }
-                    catch (...)
-                    {
-                        // Продолжаем цикл
-                    }
-                }
-            }
-        }
+                socket->close(ec);
+            } });
+        accept_thread_.join();
     }
 
+    // Клиенты, ещё не дождавшиеся регистрации, отключаются
+    handshake_pool_.stop();
+
     LOG_INFO("Client acceptance stopped");
 }
 
-bool Server::distribute_and_send_tasks(const IntegrationParameters &params)
+void Server::register_local_worker()
 {
-    try
+    SystemInfo info = sys_utils::collect_system_info();
+
+    if (info.cpu_cores <= config_.local_worker_reserved_cores)
     {
-        auto clients = client_manager_.get_all_clients();
+        LOG_WARN("Local worker disabled: {} core(s) available, {} reserved for networking",
+                 info.cpu_cores, config_.local_worker_reserved_cores);
+        return;
+    }
 
-        // Распределяем задачи
-        auto task_map = task_distributor_.distribute_tasks(
-            clients,
-            params.lower_limit,
-            params.upper_limit,
-            params.step);
+    // Часть ядер остаётся под приём подключений и обмен с клиентами
+    info.cpu_cores -= config_.local_worker_reserved_cores;
 
-        LOG_INFO("Distributing tasks to {} client(s)...", clients.size());
+    local_worker_ = std::make_unique<LocalWorker>(info.cpu_cores);
 
-        // Отправляем задачи каждому клиенту
-        for (auto *client : clients)
-        {
-            auto it = task_map.find(client->get_client_id());
-            if (it != task_map.end())
-            {
-                if (!send_tasks_to_client(client, it->second))
-                {
-                    LOG_ERROR("Failed to send tasks to client {}", client->get_client_id());
-                    return false;
-                }
-            }
-        }
+    uint64_t client_id = client_manager_.generate_client_id();
+    auto connection = std::make_unique<ClientConnection>(io_context_, client_id, info);
 
-        LOG_INFO("All tasks sent successfully");
-        return true;
-    }
-    catch (const std::exception &e)
+    if (client_manager_.add_client(std::move(connection)) == 0)
     {
-        LOG_ERROR("Error distributing tasks: {}", e.what());
-        return false;
+        LOG_WARN("Failed to register local worker");
+        local_worker_.reset();
+        return;
     }
+
+    update_host_workers();
+    seed_client_performance(client_manager_.get_client(client_id), local_worker_->get_method());
+    notify_start_waiter();
+
+    LOG_INFO("Local worker registered: ID={}, Cores={} ({} reserved)",
+             client_id, info.cpu_cores, config_.local_worker_reserved_cores);
+
+    start_session(client_manager_.get_client(client_id));
 }
 
-bool Server::send_tasks_to_client(ClientConnection *client, const TaskBatch &batch)
+void Server::launch_local_clients()
 {
+    // Клиенты подключаются через loopback и проходят обычный handshake, как на кластере
+    local_launcher_ = std::make_unique<LocalLauncher>(config_.client_path, port_, config_.local_clients);
     try
     {
-        LOG_INFO("Sending {} tasks to client {}", batch.tasks.size(), client->get_client_id());
+        local_launcher_->start();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Failed to start local clients: {}", e.what());
+    }
+}
 
-        net_utils::send_data(client->get_socket(), batch);
-        client->mark_task_sent();
+void Server::admit_job(const JobStatus &job)
+{
+    LOG_INFO("=== Job {} ===", job.id);
+    client_manager_.log_clients_info();
 
-        LOG_INFO("Client {}: {} tasks sent", client->get_client_id(), batch.tasks.size());
+    // Задание могли отменить между извлечением из очереди и передачей планировщику
+    auto status = job_queue_.get_status(job.id);
+    if (!status || status->is_finished())
+    {
+        return;
+    }
 
-        return true;
+    try
+    {
+        IntegrationParameters params = job.params;
+        std::vector<Task> chunks;
+        if (job.params.kernel == KERNEL_QMC)
+        {
+            chunks = task_distributor_.split_qmc_job(
+                job.id,
+                job.params.sampling,
+                job.params.points,
+                job.params.replicas,
+                client_manager_.get_total_cpu_cores());
+        }
+        else if (job.params.output_intervals > 0)
+        {
+            // Точки таблицы делят отрезок на равные части
+            ScanGrid grid;
+            grid.origin = job.params.lower_limit;
+            grid.interval = (job.params.upper_limit - job.params.lower_limit) /
+                            static_cast<double>(job.params.output_intervals);
+            chunks = task_distributor_.split_scan_job(
+                job.id,
+                grid,
+                job.params.output_intervals,
+                job.params.step,
+                client_manager_.get_total_cpu_cores());
+        }
+        else if (job.params.inverse)
+        {
+            // Первый шаг Ньютона от нижнего предела, следующие шаги планирует on_inverse_step_finished
+            auto solver = std::make_unique<InverseSolver>(job.params);
+            if (solver->is_converged())
+            {
+                job_queue_.complete(job.id, solver->get_result());
+                return;
+            }
+            params = solver->get_step_parameters(job.params);
+            chunks = task_distributor_.split_job(
+                job.id,
+                params.lower_limit,
+                params.upper_limit,
+                params.step,
+                client_manager_.get_total_cpu_cores());
+
+            std::lock_guard<std::mutex> lock(inverse_mutex_);
+            inverse_solvers_[job.id] = std::move(solver);
+        }
+        else if (!job.params.queries.empty())
+        {
+            // Один проход по объединению отрезков всех запросов
+            chunks = task_distributor_.split_batch_job(
+                job.id,
+                QueryBatch(job.params.queries).get_segments(),
+                job.params.step,
+                client_manager_.get_total_cpu_cores());
+        }
+        else
+        {
+            chunks = task_distributor_.split_job(
+                job.id,
+                job.params.lower_limit,
+                job.params.upper_limit,
+                job.params.step,
+                client_manager_.get_total_cpu_cores());
+        }
+
+        scheduler_.add_job(job.id, params, job.weight, job.priority, std::move(chunks));
     }
     catch (const std::exception &e)
     {
-        LOG_ERROR("Failed to send tasks to client {}: {}",
-                  client->get_client_id(), e.what());
-        return false;
+        LOG_ERROR("Failed to schedule job {}: {}", job.id, e.what());
+        {
+            std::lock_guard<std::mutex> lock(inverse_mutex_);
+            inverse_solvers_.erase(job.id);
+        }
+        job_queue_.fail(job.id, e.what());
+        return;
+    }
+
+    // Фрагменты менее приоритетных заданий прерываются, их остатки вернутся в очередь
+    for (const auto &[client_id, job_ids] : scheduler_.get_preemption_targets(job.priority))
+    {
+        LOG_INFO("Job {} preempts {} job(s) on client {}", job.id, job_ids.size(), client_id);
+        interrupt_client_jobs(client_id, job_ids);
     }
 }
 
-bool Server::collect_results(ResultAggregator &aggregator)
+void Server::interrupt_client_jobs(uint64_t client_id, const std::set<uint64_t> &job_ids)
 {
-    LOG_INFO("Waiting for results from clients...");
-
-    auto clients = client_manager_.get_all_clients();
+    ClientHandle client = client_manager_.get_client(client_id);
+    if (!client)
+    {
+        return;
+    }
 
-    // Запускаем получение результатов от каждого клиента в отдельных потоках
-    std::vector<std::thread> receive_threads;
-    receive_threads.reserve(clients.size());
+    if (client->is_local())
+    {
+        for (uint64_t job_id : job_ids)
+        {
+            local_worker_->cancel_job(job_id);
+        }
+        return;
+    }
 
-    for (auto *client : clients)
+    if (!client->supports(CAP_CANCEL_JOB))
     {
-        receive_threads.emplace_back([this, client, &aggregator]()
-                                     { receive_results_from_client(client, aggregator); });
+        // Клиент досчитает пакеты заданий, их результаты будут отброшены
+        LOG_DEBUG("Client {} does not support CANCEL_JOB", client_id);
+        return;
     }
 
-    // Ожидаем завершения всех потоков
-    for (auto &thread : receive_threads)
+    try
     {
-        if (thread.joinable())
+        std::lock_guard<std::mutex> lock(client->get_send_mutex());
+        for (uint64_t job_id : job_ids)
         {
-            thread.join();
+            Command cancel_cmd;
+            cancel_cmd.type = CommandType::CANCEL_JOB;
+            cancel_cmd.message = std::to_string(job_id);
+
+            net_utils::send_data(client->get_socket(), cancel_cmd);
         }
     }
+    catch (const std::exception &e)
+    {
+        // Разрыв соединения обработает сессия клиента
+        LOG_WARN("Failed to send CANCEL_JOB to client {}: {}", client_id, e.what());
+    }
+}
+
+void Server::on_job_finished(const JobOutcome &outcome)
+{
+    if (outcome.params.inverse)
+    {
+        on_inverse_step_finished(outcome);
+        return;
+    }
+
+    if (outcome.cancelled)
+    {
+        job_queue_.cancel(outcome.job_id);
+        return;
+    }
 
-    // Ожидаем получения всех результатов с таймаутом 300 секунд
-    bool all_received = aggregator.wait_for_all_results(300);
+    if (!outcome.success)
+    {
+        job_queue_.fail(outcome.job_id, outcome.error_message);
+        return;
+    }
 
-    if (!all_received)
+    if (outcome.scan)
     {
-        LOG_WARN("Not all results received within timeout");
+        // Второй проход: смещения фрагментов прибавляются к значениям таблицы в файле
+        try
+        {
+            outcome.scan->finish();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Job {}: failed to finish output table: {}", outcome.job_id, e.what());
+            job_queue_.fail(outcome.job_id, e.what());
+            return;
+        }
     }
 
-    return all_received;
+    print_final_result(outcome);
+    print_client_shares(outcome);
+
+    job_queue_.complete(outcome.job_id, outcome.value, outcome.standard_error, outcome.query_results);
+    host_profiles_.save();
 }
 
-bool Server::receive_results_from_client(ClientConnection *client, ResultAggregator &aggregator)
+void Server::on_inverse_step_finished(const JobOutcome &outcome)
 {
+    std::lock_guard<std::mutex> lock(inverse_mutex_);
+    auto it = inverse_solvers_.find(outcome.job_id);
+    auto status = job_queue_.get_status(outcome.job_id);
+    if (it == inverse_solvers_.end() || !status)
+    {
+        return;
+    }
+
+    // Решатель больше не нужен, если задание завершится на этом шаге
+    std::unique_ptr<InverseSolver> solver = std::move(it->second);
+    inverse_solvers_.erase(it);
+
+    if (outcome.cancelled)
+    {
+        job_queue_.cancel(outcome.job_id);
+        return;
+    }
+    if (!outcome.success)
+    {
+        job_queue_.fail(outcome.job_id, outcome.error_message);
+        return;
+    }
+
     try
     {
-        LOG_INFO("Waiting for results from client {}", client->get_client_id());
+        solver->add(outcome.value);
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Job {}: inverse query failed: {}", outcome.job_id, e.what());
+        job_queue_.fail(outcome.job_id, e.what());
+        return;
+    }
 
-        auto result_batch = net_utils::receive_data<ResultBatch>(client->get_socket());
-        client->mark_result_received();
+    LOG_INFO("Job {}: inverse step {} over [{}, {}], x = {}, residual = {:.3e}",
+             outcome.job_id, solver->get_iterations(), outcome.params.lower_limit, outcome.params.upper_limit,
+             solver->get_result(), solver->get_residual());
 
-        LOG_INFO("Received {} results from client {} (time: {:.3f}s)",
-                 result_batch.results.size(),
-                 client->get_client_id(),
-                 result_batch.total_time_seconds);
+    if (solver->is_converged())
+    {
+        JobOutcome result = outcome;
+        result.params = status->params;
+        result.value = solver->get_result();
+        print_final_result(result);
 
-        aggregator.add_result(result_batch);
+        job_queue_.complete(outcome.job_id, solver->get_result());
+        host_profiles_.save();
+        return;
+    }
 
-        LOG_INFO("Client {}: results received ({:.3f}s)",
-                 client->get_client_id(),
-                 result_batch.total_time_seconds);
+    // Задание могли отменить, пока шаг не был в планировщике
+    if (status->is_finished())
+    {
+        return;
+    }
 
-        return true;
+    try
+    {
+        IntegrationParameters params = solver->get_step_parameters(status->params);
+        auto chunks = task_distributor_.split_job(
+            outcome.job_id,
+            params.lower_limit,
+            params.upper_limit,
+            params.step,
+            client_manager_.get_total_cpu_cores());
+
+        inverse_solvers_[outcome.job_id] = std::move(solver);
+        scheduler_.add_job(outcome.job_id, params, status->weight, status->priority, std::move(chunks));
     }
     catch (const std::exception &e)
     {
-        LOG_ERROR("Failed to receive results from client {}: {}",
-                  client->get_client_id(), e.what());
-        return false;
+        LOG_ERROR("Failed to schedule job {}: {}", outcome.job_id, e.what());
+        inverse_solvers_.erase(outcome.job_id);
+        job_queue_.fail(outcome.job_id, e.what());
     }
 }
 
-void Server::send_stop_command_to_all_clients()
+void Server::update_host_workers()
 {
-    LOG_INFO("Sending STOP command to all clients");
+    for (const auto &client : client_manager_.take_resized_clients())
+    {
+        if (client->is_local())
+        {
+            if (local_worker_)
+            {
+                local_worker_->set_num_threads(client->get_effective_cores());
+            }
+            continue;
+        }
+
+        if (!client->supports(CAP_SET_WORKERS))
+        {
+            // Клиент не меняет число потоков, но размер пакетов следует за долей ядер
+            continue;
+        }
+
+        try
+        {
+            // Доля читается под мьютексом отправки, поэтому последним уходит актуальное значение
+            std::lock_guard<std::mutex> lock(client->get_send_mutex());
+            uint32_t cores = client->get_effective_cores();
+            if (cores == client->get_worker_threads())
+            {
+                continue;
+            }
+
+            Command resize_cmd;
+            resize_cmd.type = CommandType::SET_WORKERS;
+            resize_cmd.message = std::to_string(cores);
+
+            net_utils::send_data(client->get_socket(), resize_cmd);
+            client->set_worker_threads(cores);
+
+            LOG_INFO("Client {} limited to {} of {} cores", client->get_client_id(), cores, client->get_cpu_cores());
+        }
+        catch (const std::exception &e)
+        {
+            // Разрыв соединения обработает сессия клиента
+            LOG_WARN("Failed to send SET_WORKERS to client {}: {}", client->get_client_id(), e.what());
+        }
+    }
+}
 
+void Server::broadcast_peers()
+{
     auto clients = client_manager_.get_all_clients();
 
-    Command stop_cmd;
-    stop_cmd.type = CommandType::STOP_WORK;
-    stop_cmd.message = "Integration completed";
+    std::vector<ClientHandle> peers;
+    for (const auto &client : *clients)
+    {
+        if (!client->is_local() && client->supports(CAP_WORK_STEALING) && client->get_peer_port() != 0)
+        {
+            peers.push_back(client);
+        }
+    }
+
+    // Соседи по кольцу: каждый клиент знает не больше MAX_PEERS_PER_CLIENT других,
+    // а запросы кражи распределяются между всеми клиентами равномерно
+    std::vector<std::string> entries;
+    entries.reserve(peers.size());
+    for (const auto &peer : peers)
+    {
+        entries.push_back(std::to_string(peer->get_client_id()) + '@' + peer->get_peer_address() + ':' + std::to_string(peer->get_peer_port()));
+    }
 
-    for (auto *client : clients)
+    // peers заполнен в порядке clients, поэтому позиция клиента в кольце - число пройденных соседей
+    size_t peer_index = 0;
+    size_t position = 0;
+    for (const auto &client : *clients)
     {
+        if (client->is_local() || !client->supports(CAP_WORK_STEALING))
+        {
+            continue;
+        }
+
+        // Клиент без порта кражи тоже получает соседей: красть у них он может
+        bool is_peer = peer_index < peers.size() && peers[peer_index] == client;
+        size_t start = is_peer ? ++peer_index : position++;
+
+        Command peers_cmd;
+        peers_cmd.type = CommandType::PEERS;
+        for (size_t i = 0; i < std::min(MAX_PEERS_PER_CLIENT, entries.size()); ++i)
+        {
+            size_t index = (start + i) % entries.size();
+            if (peers[index] == client)
+            {
+                continue;
+            }
+            if (!peers_cmd.message.empty())
+            {
+                peers_cmd.message += ';';
+            }
+            peers_cmd.message += entries[index];
+        }
+
         try
         {
-            net_utils::send_data(client->get_socket(), stop_cmd);
-            LOG_DEBUG("STOP command sent to client {}", client->get_client_id());
+            std::lock_guard<std::mutex> lock(client->get_send_mutex());
+            net_utils::send_data(client->get_socket(), peers_cmd);
         }
         catch (const std::exception &e)
         {
-            LOG_WARN("Failed to send STOP command to client {}: {}",
-                     client->get_client_id(), e.what());
+            // Разрыв соединения обработает сессия клиента
+            LOG_WARN("Failed to send PEERS to client {}: {}", client->get_client_id(), e.what());
         }
     }
+}
+
+void Server::request_peers_broadcast()
+{
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        peers_dirty_ = true;
+    }
+    peers_cv_.notify_one();
+}
+
+void Server::peers_loop()
+{
+    std::unique_lock<std::mutex> lock(peers_mutex_);
+    while (true)
+    {
+        peers_cv_.wait(lock, [this]
+                       { return peers_stopped_ || peers_dirty_; });
+        if (peers_stopped_)
+        {
+            break;
+        }
+
+        // Подключения и отключения за интервал объединяются в одну рассылку
+        peers_cv_.wait_for(lock, PEERS_COALESCE_INTERVAL, [this]
+                           { return peers_stopped_; });
+        if (peers_stopped_)
+        {
+            break;
+        }
+        peers_dirty_ = false;
 
-    LOG_INFO("Stop commands sent to all clients");
+        lock.unlock();
+        broadcast_peers();
+        lock.lock();
+    }
 }
 
-void Server::print_final_result(double final_result, const IntegrationParameters &params)
+void Server::seed_client_performance(const ClientHandle &client, const std::string &method)
 {
-    LOG_INFO("========================================");
-    LOG_INFO("       INTEGRATION COMPLETED");
-    LOG_INFO("========================================");
-    LOG_INFO("Integral of 1/ln(x) from {} to {}", params.lower_limit, params.upper_limit);
-    LOG_INFO("Result = {:.15f}", final_result);
+    if (!client)
+    {
+        return;
+    }
+
+    auto profile = host_profiles_.get(client->get_host_fingerprint());
+    if (!profile)
+    {
+        return;
+    }
+
+    auto evals = profile->thread_evals_per_second.find(method);
+    if (evals == profile->thread_evals_per_second.end())
+    {
+        return;
+    }
+
+    client_performance_.seed(client->get_client_id(), evals->second);
+
+    LOG_INFO("Client {} seeded from host profile: {:.3g} evals/s per thread ({}), {} tasks, {:.1f}% failed, RTT {:.1f} ms",
+             client->get_client_id(),
+             evals->second,
+             method,
+             profile->tasks,
+             100.0 * profile->failure_rate(),
+             1000.0 * profile->rtt_seconds);
+}
+
+void Server::record_host_profile(const ClientHandle &client, const ResultBatch &batch, double rtt_seconds)
+{
+    uint64_t failures = std::count_if(batch.results.begin(), batch.results.end(), [](const Result &result)
+                                      { return !result.success; });
+
+    auto estimate = client_performance_.get_estimate(client->get_client_id());
+
+    host_profiles_.record(client->get_host_fingerprint(),
+                          batch.telemetry.method,
+                          estimate ? estimate->thread_evals_per_second : 0.0,
+                          batch.results.size(),
+                          failures,
+                          rtt_seconds);
+}
+
+void Server::start_session(const ClientHandle &client)
+{
+    if (!client)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    if (sessions_closed_)
+    {
+        return;
+    }
+
+    // Присоединяем потоки сессий, завершившихся после отключения клиентов.
+    // Список просматривается только если такие есть: при массовом
+    // подключении полный проход на каждого клиента стоил бы O(N^2)
+    if (finished_sessions_.load() > 0)
+    {
+        for (auto it = sessions_.begin(); it != sessions_.end();)
+        {
+            if (it->finished->load())
+            {
+                it->thread.join();
+                it = sessions_.erase(it);
+                finished_sessions_--;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    auto finished = std::make_shared<std::atomic<bool>>(false);
+    std::thread thread([this, client, finished]()
+                       {
+        if (client->is_local())
+        {
+            run_local_session(client);
+        }
+        else
+        {
+            run_client_session(client);
+        }
+        finished_sessions_++;
+        finished->store(true); });
+
+    sessions_.push_back(Session{std::move(thread), std::move(finished)});
+}
+
+void Server::run_client_session(ClientHandle client)
+{
+    const uint64_t client_id = client->get_client_id();
+
+    // Выданные клиенту пакеты в порядке отправки
+    std::deque<TaskBatch> in_flight;
+    // Время отправки каждого выданного пакета
+    std::deque<std::chrono::steady_clock::time_point> sent_at;
+    // Время получения предыдущих результатов
+    std::chrono::steady_clock::time_point last_received_at{};
+
+    // Глубина конвейера, размер пакета, методы и функции согласованы при handshake
+    const ProtocolSettings &protocol = client->get_protocol();
+    const size_t pipeline_depth = std::max<uint32_t>(protocol.max_in_flight, 1);
+    WorkerAbilities abilities;
+    abilities.kernels = protocol.kernels;
+    abilities.integrands = protocol.integrands;
+    abilities.features = protocol.features;
+    // Клиент поддерживает согласованный режим суммирования и все менее точные
+    abilities.reductions = protocol.reduction_mode | (protocol.reduction_mode - 1);
+
+    LOG_DEBUG("Session of client {} started", client_id);
+
+    try
+    {
+        while (true)
+        {
+            // Пока клиент считает один пакет, следующий уже ждёт его в сокете
+            while (in_flight.size() < pipeline_depth)
+            {
+                // Доля ядер меняется при подключении и отключении клиентов той же машины,
+                // а размер задач следует за наблюдаемой скоростью клиента
+                size_t max_tasks = std::max<uint32_t>(client->get_effective_cores(), 1);
+                if (protocol.max_batch_tasks != 0)
+                {
+                    max_tasks = std::min<size_t>(max_tasks, protocol.max_batch_tasks);
+                }
+
+                TaskBatch batch = scheduler_.take_batch(client_id,
+                                                        max_tasks,
+                                                        client_performance_.get_max_task_steps(client_id),
+                                                        abilities);
+                if (batch.tasks.empty())
+                {
+                    break;
+                }
+
+                in_flight.push_back(std::move(batch));
+                send_tasks_to_client(client, in_flight.back());
+                sent_at.push_back(std::chrono::steady_clock::now());
+            }
+
+            if (in_flight.empty())
+            {
+                // Задания с методами и функциями, которых нет у клиента, достанутся другим клиентам
+                if (!scheduler_.wait_for_work(abilities))
+                {
+                    break;
+                }
+                continue;
+            }
+
+            // Клиент выполняет пакеты по порядку
+            auto result_batch = net_utils::receive_data<ResultBatch>(client->get_socket());
+            result_batch.client_id = client_id;
+            in_flight.pop_front();
+            client->mark_result_received();
+
+            // Клиент начинает пакет не раньше, чем закончит предыдущий, поэтому
+            // время доставки - ожидание результатов за вычетом времени вычислений
+            auto received_at = std::chrono::steady_clock::now();
+            std::chrono::duration<double> waited = received_at - std::max(sent_at.front(), last_received_at);
+            sent_at.pop_front();
+            last_received_at = received_at;
+
+            LOG_DEBUG("Received {} results from client {} (time: {:.3f}s)",
+                      result_batch.results.size(),
+                      client_id,
+                      result_batch.total_time_seconds);
+
+            client_performance_.update(client_id, result_batch.telemetry, result_batch.total_time_seconds);
+            record_host_profile(client, result_batch, std::max(0.0, waited.count() - result_batch.total_time_seconds));
+
+            scheduler_.complete(result_batch);
+        }
+
+        Command stop_cmd;
+        stop_cmd.type = CommandType::STOP_WORK;
+        stop_cmd.message = "Server stopped";
+
+        std::lock_guard<std::mutex> lock(client->get_send_mutex());
+        net_utils::send_data(client->get_socket(), stop_cmd);
+        LOG_DEBUG("STOP command sent to client {}", client_id);
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Connection to client {} lost: {}", client_id, e.what());
+
+        // Невыполненные фрагменты достанутся другим клиентам
+        for (const auto &batch : in_flight)
+        {
+            scheduler_.requeue(batch);
+        }
+        client_manager_.remove_client(client_id);
+        client_performance_.forget(client_id);
+        update_host_workers();
+        request_peers_broadcast();
+    }
+
+    LOG_DEBUG("Session of client {} finished", client_id);
+}
+
+void Server::run_local_session(ClientHandle client)
+{
+    const uint64_t client_id = client->get_client_id();
+
+    if (!local_worker_)
+    {
+        LOG_ERROR("Local worker is not initialized");
+        return;
+    }
+
+    WorkerAbilities abilities;
+    abilities.kernels = local_worker_->get_supported_kernels();
+    abilities.integrands = local_worker_->get_supported_integrands();
+    abilities.reductions = local_worker_->get_supported_reductions();
+
+    while (true)
+    {
+        TaskBatch batch = scheduler_.take_batch(client_id,
+                                                std::max<uint32_t>(client->get_effective_cores(), 1),
+                                                client_performance_.get_max_task_steps(client_id),
+                                                abilities);
+        if (batch.tasks.empty())
+        {
+            if (!scheduler_.wait_for_work(abilities))
+            {
+                break;
+            }
+            continue;
+        }
+
+        client->mark_task_sent();
+
+        try
+        {
+            // Локальный исполнитель получает пакет напрямую, без сериализации
+            ResultBatch result_batch = local_worker_->execute(client_id, batch);
+            client_performance_.update(client_id, result_batch.telemetry, result_batch.total_time_seconds);
+            record_host_profile(client, result_batch, -1.0);
+            scheduler_.complete(result_batch);
+            client->mark_result_received();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Local worker failed: {}", e.what());
+            scheduler_.requeue(batch);
+            client_manager_.remove_client(client_id);
+            client_performance_.forget(client_id);
+            update_host_workers();
+            break;
+        }
+    }
+}
+
+void Server::send_tasks_to_client(const ClientHandle &client, const TaskBatch &batch)
+{
+    LOG_DEBUG("Sending {} tasks to client {}", batch.tasks.size(), client->get_client_id());
+
+    // Команда START_WORK предупреждает клиента, что за ней следует пакет задач
+    Command start_cmd;
+    start_cmd.type = CommandType::START_WORK;
+    start_cmd.message = std::to_string(batch.tasks.size()) + " tasks";
+
+    std::lock_guard<std::mutex> lock(client->get_send_mutex());
+    net_utils::send_data(client->get_socket(), start_cmd);
+    net_utils::send_data(client->get_socket(), batch);
+    client->mark_task_sent();
+}
+
+void Server::join_sessions()
+{
+    std::vector<Session> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions_closed_ = true;
+        sessions.swap(sessions_);
+    }
+
+    // Планировщик уже остановлен: сессии дождутся выданных пакетов и отправят STOP_WORK
+    for (auto &session : sessions)
+    {
+        if (session.thread.joinable())
+        {
+            session.thread.join();
+        }
+    }
+}
+
+namespace
+{
+    /**
+     * @brief Форматирует ответ на RESULT/WAIT
+     */
+    std::string format_job_result(const JobStatus &status)
+    {
+        switch (status.state)
+        {
+        case JobState::COMPLETED:
+            if (status.params.kernel == KERNEL_QMC)
+            {
+                // Задание квази-Монте-Карло сообщает и погрешность значения
+                return fmt::format("OK {:.15f} {:.3f} {:.3e}", status.result, status.elapsed_seconds, status.standard_error);
+            }
+            if (!status.params.queries.empty())
+            {
+                // Пакетное задание: интеграл по объединению, затем ответы на запросы по порядку
+                std::string response = fmt::format("OK {:.15f} {:.3f}", status.result, status.elapsed_seconds);
+                for (double value : status.query_results)
+                {
+                    response += fmt::format(" {:.15f}", value);
+                }
+                return response;
+            }
+            return fmt::format("OK {:.15f} {:.3f}", status.result, status.elapsed_seconds);
+        case JobState::FAILED:
+            return "ERROR " + status.error_message;
+        case JobState::CANCELLED:
+            return "CANCELLED";
+        default:
+            return "PENDING " + to_string(status.state);
+        }
+    }
+
+    /**
+     * @brief Форматирует область задания квази-Монте-Карло как "a1:b1,a2:b2,..."
+     */
+    std::string format_box(const QmcSampling &sampling)
+    {
+        std::string box;
+        for (size_t i = 0; i < sampling.lower.size(); ++i)
+        {
+            box += fmt::format("{}{}:{}", i == 0 ? "" : ",", sampling.lower[i], sampling.upper[i]);
+        }
+        return box;
+    }
+
+    /**
+     * @brief Форматирует отрезки запросов пакетного задания как "a1:b1,a2:b2,..."
+     */
+    std::string format_ranges(const std::vector<QueryRange> &ranges)
+    {
+        std::string text;
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            text += fmt::format("{}{}:{}", i == 0 ? "" : ",", ranges[i].lower, ranges[i].upper);
+        }
+        return text;
+    }
+
+    /**
+     * @brief Разбирает список отрезков вида "a1:b1,a2:b2,..."
+     * @return false, если запись некорректна или пуста
+     */
+    bool parse_ranges(const std::string &text, std::vector<QueryRange> &ranges)
+    {
+        std::istringstream iss(text);
+        std::string side;
+        while (std::getline(iss, side, ','))
+        {
+            std::istringstream bounds(side);
+            QueryRange range;
+            char separator = 0;
+            if (!(bounds >> range.lower >> separator >> range.upper) || separator != ':' || !(bounds >> std::ws).eof())
+            {
+                return false;
+            }
+            ranges.push_back(range);
+        }
+        return !ranges.empty();
+    }
+
+    /**
+     * @brief Разбирает область задания квази-Монте-Карло вида "a1:b1,a2:b2,..."
+     * @return false, если запись некорректна
+     */
+    bool parse_box(const std::string &text, QmcSampling &sampling)
+    {
+        std::vector<QueryRange> sides;
+        if (!parse_ranges(text, sides))
+        {
+            return false;
+        }
+        for (const auto &side : sides)
+        {
+            sampling.lower.push_back(side.lower);
+            sampling.upper.push_back(side.upper);
+        }
+        return sampling.is_valid();
+    }
+
+    /**
+     * @brief Задаёт функцию задания по названию и остатку команды
+     *
+     * У функции "expression" остаток строки - выражение, у остальных -
+     * необязательный числовой параметр
+     *
+     * @param name Название функции
+     * @param iss Остаток команды
+     * @param spec Функция задания
+     * @param usage Ответ на некорректный параметр
+     * @return Пустая строка или ответ с ошибкой
+     */
+    std::string parse_integrand(const std::string &name, std::istringstream &iss, IntegrandSpec &spec,
+                                const std::string &usage)
+    {
+        auto integrand_id = integrands::from_name(name);
+        if (!integrand_id)
+        {
+            return "ERROR Unknown integrand " + name +
+                   " (expected inv_log, inv_log_pow, pow_over_log, exp_over_log or expression)";
+        }
+        spec.id = *integrand_id;
+        spec.parameter = integrands::default_parameter(*integrand_id);
+
+        if (spec.id == INTEGRAND_EXPRESSION)
+        {
+            // Выражение - остаток строки, в нём могут быть пробелы
+            std::string source;
+            std::getline(iss >> std::ws, source);
+            try
+            {
+                spec.expression = expression::compile(source);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                return std::string("ERROR Invalid expression: ") + e.what();
+            }
+        }
+        else if (!(iss >> std::ws).eof() && !(iss >> spec.parameter))
+        {
+            return usage;
+        }
+        return "";
+    }
+
+    /**
+     * @brief Разбирает метод задания вида "simpson", "simpson:double_double" или "simpson:single:compensated"
+     *
+     * Необязательные суффиксы - режим суммирования узлов на клиентах
+     * (plain, compensated или double_double) и точность вычисления
+     * значений функции (double или single)
+     *
+     * @param method Метод из команды
+     * @param params Параметры задания: заполняются kernel, reduction и precision
+     * @return Пустая строка или ответ с ошибкой
+     */
+    std::string parse_method(const std::string &method, IntegrationParameters &params)
+    {
+        size_t separator = method.find(':');
+        params.kernel = protocol::kernel_from_name(method.substr(0, separator));
+        if (params.kernel == 0)
+        {
+            return "ERROR Unknown method " + method + " (expected trapezoidal or simpson)";
+        }
+        while (separator != std::string::npos)
+        {
+            const size_t begin = separator + 1;
+            separator = method.find(':', begin);
+            const std::string option = method.substr(begin, separator - begin);
+            if (option == "single" || option == "double")
+            {
+                params.precision = option == "single" ? PRECISION_SINGLE : PRECISION_DOUBLE;
+                continue;
+            }
+            params.reduction = protocol::reduction_from_name(option);
+            if (params.reduction == 0)
+            {
+                return "ERROR Unknown option " + option +
+                       " (expected plain, compensated, double_double, single or double)";
+            }
+        }
+        return "";
+    }
+
+    /**
+     * @brief Форматирует ответ на STATUS <job_id>
+     */
+    std::string format_job_status(const JobStatus &status)
+    {
+        std::string response = fmt::format("OK id={} state={} lower={} upper={} step={} method={} integrand={} parameter={} weight={} priority={}",
+                                            status.id,
+                                            to_string(status.state),
+                                            status.params.lower_limit,
+                                            status.params.upper_limit,
+                                            status.params.step,
+                                            protocol::kernel_name(status.params.kernel),
+                                            integrands::name(status.params.integrand.id),
+                                            status.params.integrand.parameter,
+                                            status.weight,
+                                            status.priority);
+        if (status.params.kernel == KERNEL_QMC)
+        {
+            response += fmt::format(" box={} points={} replicas={} seed={}",
+                                    format_box(status.params.sampling),
+                                    status.params.points,
+                                    status.params.replicas,
+                                    status.params.sampling.seed);
+        }
+        if (!status.params.queries.empty())
+        {
+            response += " queries=" + format_ranges(status.params.queries);
+        }
+        if (status.params.output_intervals > 0)
+        {
+            response += fmt::format(" intervals={} output={}", status.params.output_intervals, status.params.output_path);
+        }
+        if (status.params.inverse)
+        {
+            response += fmt::format(" target={}", status.params.target);
+        }
+        if (status.params.reduction != REDUCTION_PLAIN)
+        {
+            response += " summation=" + protocol::reduction_name(status.params.reduction);
+        }
+        if (status.params.precision == PRECISION_SINGLE)
+        {
+            response += " precision=single";
+        }
+        if (status.params.integrand.id == INTEGRAND_EXPRESSION)
+        {
+            response += " expression=" + status.params.integrand.expression.source;
+        }
+        if (status.state == JobState::COMPLETED)
+        {
+            response += fmt::format(" result={:.15f} elapsed={:.3f}", status.result, status.elapsed_seconds);
+            if (!status.query_results.empty())
+            {
+                response += " query_results=";
+                for (size_t i = 0; i < status.query_results.size(); ++i)
+                {
+                    response += fmt::format("{}{:.15f}", i == 0 ? "" : ",", status.query_results[i]);
+                }
+            }
+            if (status.params.kernel == KERNEL_QMC)
+            {
+                response += fmt::format(" standard_error={:.3e}", status.standard_error);
+            }
+        }
+        else if (status.state == JobState::FAILED || status.state == JobState::CANCELLED)
+        {
+            response += " error=" + status.error_message;
+        }
+        return response;
+    }
+} // namespace
+
+void Server::handle_control_command(const std::string &request, ControlServer::Reply reply)
+{
+    std::istringstream iss(request);
+    std::string command;
+    iss >> command;
+    std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+
+    LOG_DEBUG("Control command: '{}'", request);
+
+    if (command == "SUBMIT")
+    {
+        const std::string usage =
+            "ERROR Usage: SUBMIT <lower> <upper> <step> [weight [priority [method [integrand [parameter]]]]]";
+
+        IntegrationParameters params{};
+        uint32_t weight = 1;
+        uint32_t priority = 0;
+        std::string method = protocol::kernel_name(params.kernel);
+        std::string integrand = integrands::name(params.integrand.id);
+        if (!(iss >> params.lower_limit >> params.upper_limit >> params.step) ||
+            (!(iss >> std::ws).eof() && !(iss >> weight)) ||
+            (!(iss >> std::ws).eof() && !(iss >> priority)) ||
+            (!(iss >> std::ws).eof() && !(iss >> method)) ||
+            (!(iss >> std::ws).eof() && !(iss >> integrand)))
+        {
+            reply(usage);
+            return;
+        }
+
+        std::string error = parse_method(method, params);
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+        if (params.kernel == KERNEL_QMC)
+        {
+            reply("ERROR Use QMC to submit quasi-Monte Carlo jobs");
+            return;
+        }
+
+        error = parse_integrand(integrand, iss, params.integrand, usage);
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        if (params.integrand.id == INTEGRAND_EXPRESSION &&
+            !integrands::is_valid_domain(params.integrand, params.lower_limit, params.upper_limit))
+        {
+            reply("ERROR Expression " + params.integrand.expression.source +
+                  " is not defined on the whole range");
+            return;
+        }
+
+        try
+        {
+            reply("OK " + std::to_string(job_queue_.submit(params, weight, priority)));
+        }
+        catch (const std::exception &e)
+        {
+            reply(std::string("ERROR ") + e.what());
+        }
+        return;
+    }
+
+    if (command == "QMC")
+    {
+        const std::string usage =
+            "ERROR Usage: QMC <a1:b1[,a2:b2...]> <points> <replicas> [seed [weight [priority [integrand [parameter]]]]]";
+
+        IntegrationParameters params{};
+        params.kernel = KERNEL_QMC;
+        uint32_t weight = 1;
+        uint32_t priority = 0;
+        std::string box;
+        std::string integrand = integrands::name(params.integrand.id);
+        if (!(iss >> box >> params.points >> params.replicas) ||
+            (!(iss >> std::ws).eof() && !(iss >> params.sampling.seed)) ||
+            (!(iss >> std::ws).eof() && !(iss >> weight)) ||
+            (!(iss >> std::ws).eof() && !(iss >> priority)) ||
+            (!(iss >> std::ws).eof() && !(iss >> integrand)))
+        {
+            reply(usage);
+            return;
+        }
+
+        if (!parse_box(box, params.sampling))
+        {
+            reply(fmt::format("ERROR Invalid box {} (expected 1..{} ranges a:b with a < b, separated by commas)",
+                              box, QmcSampling::MAX_DIMENSIONS));
+            return;
+        }
+
+        std::string error = parse_integrand(integrand, iss, params.integrand, usage);
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        if (params.integrand.id == INTEGRAND_EXPRESSION &&
+            expression::variable_count(params.integrand.expression) > params.sampling.dimensions())
+        {
+            reply(fmt::format("ERROR Expression {} uses x{}, but the box has {} dimension(s)",
+                              params.integrand.expression.source,
+                              expression::variable_count(params.integrand.expression),
+                              params.sampling.dimensions()));
+            return;
+        }
+        if (!integrands::is_valid_box(params.integrand, params.sampling.lower, params.sampling.upper))
+        {
+            reply("ERROR Integrand " + (params.integrand.id == INTEGRAND_EXPRESSION
+                                            ? params.integrand.expression.source
+                                            : integrands::name(params.integrand.id)) +
+                  " is not defined on the whole box");
+            return;
+        }
+
+        try
+        {
+            reply("OK " + std::to_string(job_queue_.submit(params, weight, priority)));
+        }
+        catch (const std::exception &e)
+        {
+            reply(std::string("ERROR ") + e.what());
+        }
+        return;
+    }
+
+    if (command == "SCAN")
+    {
+        const std::string usage =
+            "ERROR Usage: SCAN <lower> <upper> <step> <intervals> <path> [weight [priority [method [integrand [parameter]]]]]";
+
+        IntegrationParameters params{};
+        uint32_t weight = 1;
+        uint32_t priority = 0;
+        std::string method = protocol::kernel_name(params.kernel);
+        std::string integrand = integrands::name(params.integrand.id);
+        if (!(iss >> params.lower_limit >> params.upper_limit >> params.step >> params.output_intervals >>
+              params.output_path) ||
+            (!(iss >> std::ws).eof() && !(iss >> weight)) ||
+            (!(iss >> std::ws).eof() && !(iss >> priority)) ||
+            (!(iss >> std::ws).eof() && !(iss >> method)) ||
+            (!(iss >> std::ws).eof() && !(iss >> integrand)))
+        {
+            reply(usage);
+            return;
+        }
+
+        if (params.output_intervals == 0 || params.output_intervals > ScanGrid::MAX_INTERVALS)
+        {
+            reply(fmt::format("ERROR Invalid number of intervals {} (expected 1..{})",
+                              params.output_intervals, ScanGrid::MAX_INTERVALS));
+            return;
+        }
+
+        std::string error = parse_method(method, params);
+        if (error.empty() && params.kernel == KERNEL_QMC)
+        {
+            error = "ERROR Unknown method " + method + " (expected trapezoidal or simpson)";
+        }
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        error = parse_integrand(integrand, iss, params.integrand, usage);
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        if (params.integrand.id == INTEGRAND_EXPRESSION &&
+            !integrands::is_valid_domain(params.integrand, params.lower_limit, params.upper_limit))
+        {
+            reply("ERROR Expression " + params.integrand.expression.source +
+                  " is not defined on the whole range");
+            return;
+        }
+
+        try
+        {
+            reply("OK " + std::to_string(job_queue_.submit(params, weight, priority)));
+        }
+        catch (const std::exception &e)
+        {
+            reply(std::string("ERROR ") + e.what());
+        }
+        return;
+    }
+
+    if (command == "INVERT")
+    {
+        const std::string usage =
+            "ERROR Usage: INVERT <lower> <target> <step> [weight [priority [method [integrand [parameter]]]]]";
+
+        IntegrationParameters params{};
+        uint32_t weight = 1;
+        uint32_t priority = 0;
+        std::string method = protocol::kernel_name(params.kernel);
+        std::string integrand = integrands::name(params.integrand.id);
+        if (!(iss >> params.lower_limit >> params.target >> params.step) ||
+            (!(iss >> std::ws).eof() && !(iss >> weight)) ||
+            (!(iss >> std::ws).eof() && !(iss >> priority)) ||
+            (!(iss >> std::ws).eof() && !(iss >> method)) ||
+            (!(iss >> std::ws).eof() && !(iss >> integrand)))
+        {
+            reply(usage);
+            return;
+        }
+
+        std::string error = parse_method(method, params);
+        if (error.empty() && params.kernel == KERNEL_QMC)
+        {
+            error = "ERROR Unknown method " + method + " (expected trapezoidal or simpson)";
+        }
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        error = parse_integrand(integrand, iss, params.integrand, usage);
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        // Верхний предел неизвестен до конца поиска
+        params.inverse = true;
+        params.upper_limit = params.lower_limit;
+
+        try
+        {
+            reply("OK " + std::to_string(job_queue_.submit(params, weight, priority)));
+        }
+        catch (const std::exception &e)
+        {
+            reply(std::string("ERROR ") + e.what());
+        }
+        return;
+    }
+
+    if (command == "BATCH")
+    {
+        const std::string usage =
+            "ERROR Usage: BATCH <step> <a1:b1[,a2:b2...]> [weight [priority [method [integrand [parameter]]]]]";
+
+        IntegrationParameters params{};
+        uint32_t weight = 1;
+        uint32_t priority = 0;
+        std::string ranges;
+        std::string method = protocol::kernel_name(params.kernel);
+        std::string integrand = integrands::name(params.integrand.id);
+        if (!(iss >> params.step >> ranges) ||
+            (!(iss >> std::ws).eof() && !(iss >> weight)) ||
+            (!(iss >> std::ws).eof() && !(iss >> priority)) ||
+            (!(iss >> std::ws).eof() && !(iss >> method)) ||
+            (!(iss >> std::ws).eof() && !(iss >> integrand)))
+        {
+            reply(usage);
+            return;
+        }
+
+        if (!parse_ranges(ranges, params.queries) || params.queries.size() > QueryBatch::MAX_QUERIES ||
+            std::any_of(params.queries.begin(), params.queries.end(), [](const QueryRange &query)
+                        { return !(query.lower < query.upper); }))
+        {
+            reply(fmt::format("ERROR Invalid ranges {} (expected 1..{} ranges a:b with a < b, separated by commas)",
+                              ranges, QueryBatch::MAX_QUERIES));
+            return;
+        }
+
+        std::string error = parse_method(method, params);
+        if (error.empty() && params.kernel == KERNEL_QMC)
+        {
+            error = "ERROR Unknown method " + method + " (expected trapezoidal or simpson)";
+        }
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        error = parse_integrand(integrand, iss, params.integrand, usage);
+        if (!error.empty())
+        {
+            reply(error);
+            return;
+        }
+
+        // Пределы задания - границы объединения запросов
+        params.lower_limit = params.queries.front().lower;
+        params.upper_limit = params.queries.front().upper;
+        for (const auto &query : params.queries)
+        {
+            params.lower_limit = std::min(params.lower_limit, query.lower);
+            params.upper_limit = std::max(params.upper_limit, query.upper);
+
+            if (!integrands::is_valid_domain(params.integrand, query.lower, query.upper))
+            {
+                reply(fmt::format("ERROR Integrand {} is not defined on {}:{}",
+                                  params.integrand.id == INTEGRAND_EXPRESSION
+                                      ? params.integrand.expression.source
+                                      : integrands::name(params.integrand.id),
+                                  query.lower, query.upper));
+                return;
+            }
+        }
+
+        try
+        {
+            reply("OK " + std::to_string(job_queue_.submit(params, weight, priority)));
+        }
+        catch (const std::exception &e)
+        {
+            reply(std::string("ERROR ") + e.what());
+        }
+        return;
+    }
+
+    if (command == "STATUS")
+    {
+        uint64_t job_id = 0;
+        if (!(iss >> job_id))
+        {
+            // Состояние кластера
+            reply(fmt::format("OK clients={} hosts={} cores={} queued={} running={}",
+                              client_manager_.get_client_count(),
+                              client_manager_.get_host_count(),
+                              client_manager_.get_total_cpu_cores(),
+                              job_queue_.get_queued_count(),
+                              job_queue_.get_running_count()));
+            return;
+        }
+
+        auto status = job_queue_.get_status(job_id);
+        reply(status ? format_job_status(*status) : "ERROR Unknown job " + std::to_string(job_id));
+        return;
+    }
+
+    if (command == "CLIENTS")
+    {
+        // Ответ в одну строку, клиенты разделены " | ": доля ядер и последние показатели
+        ClientSnapshot clients = client_manager_.get_all_clients();
+        std::string response = "OK " + std::to_string(clients->size());
+        for (const auto &client : *clients)
+        {
+            auto estimate = client_performance_.get_estimate(client->get_client_id());
+            ClientTelemetry report = estimate ? estimate->last_report : ClientTelemetry{};
+
+            response += fmt::format(" | id={} cores={}/{} evals_per_thread={:.4g} steal={:.3f} load={:.2f} mhz={:.0f}",
+                                    client->get_client_id(),
+                                    client->get_effective_cores(),
+                                    client->get_cpu_cores(),
+                                    estimate ? estimate->thread_evals_per_second : 0.0,
+                                    report.steal_fraction,
+                                    report.load_average,
+                                    report.cpu_mhz);
+        }
+        reply(response);
+        return;
+    }
+
+    if (command == "RESULT" || command == "WAIT")
+    {
+        uint64_t job_id = 0;
+        if (!(iss >> job_id))
+        {
+            reply("ERROR Usage: " + command + " <job_id>");
+            return;
+        }
+
+        if (command == "RESULT")
+        {
+            auto status = job_queue_.get_status(job_id);
+            reply(status ? format_job_result(*status) : "ERROR Unknown job " + std::to_string(job_id));
+            return;
+        }
+
+        // Ответ будет отправлен после завершения задания
+        bool known = job_queue_.when_finished(job_id, [reply](const JobStatus &status)
+                                              { reply(format_job_result(status)); });
+        if (!known)
+        {
+            reply("ERROR Unknown job " + std::to_string(job_id));
+        }
+        return;
+    }
+
+    if (command == "CANCEL")
+    {
+        uint64_t job_id = 0;
+        if (!(iss >> job_id))
+        {
+            reply("ERROR Usage: CANCEL <job_id>");
+            return;
+        }
+
+        auto status = job_queue_.get_status(job_id);
+        if (!status)
+        {
+            reply("ERROR Unknown job " + std::to_string(job_id));
+            return;
+        }
+        if (status->is_finished())
+        {
+            reply("ERROR Job " + std::to_string(job_id) + " is already " + to_string(status->state));
+            return;
+        }
+
+        // Задание снимается сразу, а клиенты прерывают его фрагменты в ближайшей контрольной точке
+        auto holders = scheduler_.cancel_job(job_id);
+        if (holders)
+        {
+            for (uint64_t client_id : *holders)
+            {
+                interrupt_client_jobs(client_id, {job_id});
+            }
+        }
+        else
+        {
+            // Задание ещё не передано планировщику
+            job_queue_.cancel(job_id);
+        }
+
+        reply("OK");
+        return;
+    }
+
+    if (command == "SHUTDOWN")
+    {
+        reply("OK");
+        // Цикл serve() остановит сервер, выполняющиеся задания завершатся с ошибкой
+        job_queue_.stop();
+        return;
+    }
+
+    reply("ERROR Unknown command: " + command);
+}
+
+void Server::print_final_result(const JobOutcome &outcome)
+{
+    LOG_INFO("========================================");
+    LOG_INFO("       INTEGRATION COMPLETED (job {})", outcome.job_id);
+    LOG_INFO("========================================");
+    if (outcome.params.kernel == KERNEL_QMC)
+    {
+        LOG_INFO("Quasi-Monte Carlo integral of {} over {}, {} points x {} replicas",
+                 integrands::name(outcome.params.integrand.id), format_box(outcome.params.sampling),
+                 outcome.params.points, outcome.params.replicas);
+        LOG_INFO("Result = {:.15f} +- {:.3e}", outcome.value, outcome.standard_error);
+    }
+    else if (!outcome.params.queries.empty())
+    {
+        LOG_INFO("Batch of {} integrals of {} with step {}", outcome.params.queries.size(),
+                 integrands::name(outcome.params.integrand.id), outcome.params.step);
+        for (size_t i = 0; i < outcome.query_results.size(); ++i)
+        {
+            LOG_DEBUG("  [{}, {}] = {:.15f}", outcome.params.queries[i].lower, outcome.params.queries[i].upper,
+                      outcome.query_results[i]);
+        }
+        LOG_INFO("Result over the union of ranges = {:.15f}", outcome.value);
+    }
+    else if (outcome.params.inverse)
+    {
+        LOG_INFO("Inverse query: integral of {} from {} to x equals {}",
+                 integrands::name(outcome.params.integrand.id), outcome.params.lower_limit, outcome.params.target);
+        LOG_INFO("Result x = {:.15f}", outcome.value);
+    }
+    else if (outcome.scan)
+    {
+        LOG_INFO("Table of the integral of {} from {} to {}: {} intervals written to {}",
+                 integrands::name(outcome.params.integrand.id), outcome.params.lower_limit,
+                 outcome.params.upper_limit, outcome.params.output_intervals, outcome.scan->get_path());
+        LOG_INFO("Result = {:.15f}", outcome.value);
+    }
+    else
+    {
+        LOG_INFO("Integral of 1/ln(x) from {} to {}", outcome.params.lower_limit, outcome.params.upper_limit);
+        LOG_INFO("Result = {:.15f}", outcome.value);
+    }
+    LOG_INFO("========================================");
+}
+
+void Server::print_client_shares(const JobOutcome &outcome)
+{
+    // У задания квази-Монте-Карло диапазон - все точки всех реплик, у пакетного - объединение запросов
+    double total_range = outcome.params.upper_limit - outcome.params.lower_limit;
+    if (outcome.params.kernel == KERNEL_QMC)
+    {
+        total_range = static_cast<double>(outcome.params.points) * outcome.params.replicas;
+    }
+    else if (!outcome.params.queries.empty())
+    {
+        total_range = QueryBatch(outcome.params.queries).get_covered_length();
+    }
+
+    LOG_INFO("Work distribution ({} chunks):", outcome.chunks);
+    for (const auto &[client_id, contribution] : outcome.contributions)
+    {
+        ClientHandle client = client_manager_.get_client(client_id);
+        bool local = client && client->is_local();
+
+        auto it = outcome.client_ranges.find(client_id);
+        double range = it != outcome.client_ranges.end() ? it->second : 0.0;
+
+        LOG_INFO("  Client ID={}{}: {} tasks, {:.1f}% of range, {:.3f}s",
+                 client_id,
+                 local ? " (server, local)" : "",
+                 contribution.tasks,
+                 100.0 * range / total_range,
+                 contribution.time_seconds);
+    }
     LOG_INFO("========================================");
 }
@@ -3,11 +3,28 @@
 #include <boost/asio.hpp>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
 #include <thread>
+#include <vector>
 #include "client_manager.h"
 #include "task_distributor.h"
 #include "result_aggregator.h"
 #include "input_handler.h"
+#include "local_worker.h"
+#include "local_launcher.h"
+#include "job_queue.h"
+#include "job_scheduler.h"
+#include "client_performance.h"
+#include "host_profiles.h"
+#include "control_server.h"
+#include "handshake_pool.h"
+#include "protocol.h"
+#include "inverse_solver.h"
+#include "batch_runner.h"
 
 using boost::asio::ip::tcp;
 
@@ -17,47 +34,67 @@ using boost::asio::ip::tcp;
  */
 
 /**
- * @struct IntegrationParameters
- * @brief Параметры задачи интегрирования
+ * @struct StartPolicy
+ * @brief Условия автоматического начала интегрирования без команды START
+ *
+ * Интегрирование начинается, как только выполнено любое из заданных условий.
+ * Команда START из консоли работает при любой политике
  */
-struct IntegrationParameters
+struct StartPolicy
 {
-    // Нижний предел интегрирования
-    double lower_limit;
-    // Верхний предел интегрирования
-    double upper_limit;
-    // Шаг интегрирования
-    double step;
+    // Начать, когда подключится столько клиентов (0 - условие не используется)
+    size_t min_clients = 0;
+    // Начать, когда суммарное число ядер клиентов достигнет значения (0 - не используется)
+    uint32_t min_cores = 0;
+    // Начать с уже подключенными клиентами по истечении времени (0 - не используется)
+    std::chrono::seconds quorum_timeout{0};
+    // Начать сразу и принимать новых клиентов во время интегрирования
+    bool elastic = false;
 
     /**
-     * @brief Проверка корректности параметров
+     * @brief Проверяет, задано ли хотя бы одно условие автоматического начала
      */
-    bool is_valid() const
+    bool is_automatic() const
     {
-        // ограничения для интегрирования 1/ln(x)
-        bool result = true;
-
-        // Начало не может быть больше конца, шаг должен быть положительным
-        // и быть меньше длины интегрируемого интервала
-        result &= !(lower_limit >= upper_limit || step <= 0.0 || step >= (upper_limit - lower_limit));
-
-        // Нижний предел должен быть положительным
-        result &= !(lower_limit <= 0.0);
-
-        // Интервал не должен содержать x = 1
-        result &= !(lower_limit < 1.0 && upper_limit > 1.0);
-        result &= !(std::abs(lower_limit - 1.0) < 1e-10 || std::abs(upper_limit - 1.0) < 1e-10);
-
-        return result;
+        return min_clients > 0 || min_cores > 0 || quorum_timeout.count() > 0 || elastic;
     }
 };
 
+/**
+ * @struct ServerConfig
+ * @brief Настройки сервера
+ */
+struct ServerConfig
+{
+    // Использовать ядра сервера как локальный исполнитель задач
+    bool local_worker = false;
+    // Количество ядер сервера, оставляемых под сетевое взаимодействие
+    uint32_t local_worker_reserved_cores = 1;
+    // Количество процессов клиента, запускаемых сервером на своей машине (0 - не запускать)
+    size_t local_clients = 0;
+    // Исполняемый файл клиента для local_clients
+    std::string client_path = "client";
+    // Файл профилей производительности машин (пустой - профили не сохраняются)
+    std::string profiles_path = "host_profiles.txt";
+    // Условия начала интегрирования в интерактивном режиме
+    StartPolicy start_policy;
+    // Длина очереди входящих подключений, ещё не принятых сервером
+    int listen_backlog = boost::asio::socket_base::max_listen_connections;
+    // Количество потоков регистрации клиентов
+    size_t handshake_workers = 4;
+    // Наибольшее число клиентов, ожидающих регистрации (остальным предлагается повторить позже)
+    size_t handshake_queue = 1024;
+};
+
 /**
  * @class Server
  * @brief Главный класс сервера
  *
  * Координирует работу всех компонентов: прием клиентов, распределение задач,
- * сбор результатов и управление жизненным циклом
+ * сбор результатов и управление жизненным циклом.
+ *
+ * Каждый подключенный клиент обслуживается своей сессией, которая забирает
+ * у планировщика пакеты фрагментов по мере их выполнения клиентом
  */
 class Server
 {
@@ -65,8 +102,9 @@ public:
     /**
      * @brief Конструктор
      * @param port Порт для прослушивания подключений
+     * @param config Настройки сервера
      */
-    explicit Server(uint16_t port);
+    explicit Server(uint16_t port, const ServerConfig &config = ServerConfig{});
 
     ~Server();
 
@@ -82,7 +120,7 @@ public:
      * Выполняет полный цикл работы сервера:
      * 1. Запрос параметров у пользователя
      * 2. Ожидание подключения клиентов
-     * 3. Ожидание команды START
+     * 3. Ожидание команды START или выполнения условий StartPolicy
      * 4. Распределение задач
      * 5. Сбор результатов
      * 6. Вывод итогового результата
@@ -90,6 +128,43 @@ public:
      */
     void run(const IntegrationParameters &params);
 
+    /**
+     * @brief Запускает сервер в режиме долгоживущего сервиса
+     *
+     * Клиенты подключаются и остаются подключенными между заданиями,
+     * а задания принимаются через локальный управляющий сокет и выполняются
+     * одновременно, деля кластер пропорционально весам. Задание с большим
+     * приоритетом вытесняет фрагменты менее приоритетных заданий.
+     * Работа завершается командой SHUTDOWN.
+     *
+     * Команды управляющего сокета (одна на строку):
+     * - SUBMIT <lower> <upper> <step> [weight [priority [method]]] -> OK <job_id>
+     * - QMC <a1:b1[,a2:b2...]> <points> <replicas> [...] -> OK <job_id>
+     * - BATCH <step> <a1:b1[,a2:b2...]> [...] -> OK <job_id>
+     * - SCAN <lower> <upper> <step> <intervals> <path> [...] -> OK <job_id>
+     * - INVERT <lower> <target> <step> [...] -> OK <job_id>
+     * - STATUS [<job_id>]             -> OK <состояние задания или кластера>
+     * - RESULT <job_id>               -> OK <value> <seconds> [<query values>...] | PENDING <state> | CANCELLED | ERROR <message>
+     * - WAIT <job_id>                 -> как RESULT, но после завершения задания
+     * - CANCEL <job_id>               -> OK
+     * - SHUTDOWN                      -> OK
+     *
+     * @param control_socket_path Путь к файлу управляющего сокета
+     */
+    void serve(const std::string &control_socket_path);
+
+    /**
+     * @brief Выполняет задания файла без участия пользователя и останавливает сервер
+     *
+     * Ждёт выполнения StartPolicy (команда START не читается), затем
+     * выполняет задания по очереди на подключенных клиентах, как команды
+     * управляющего сокета (см. BatchRunner). Приём клиентов не прекращается
+     *
+     * @param entries Задания файла
+     * @return Итоги заданий (пустой список, если сервер остановлен до начала)
+     */
+    std::vector<BatchRow> run_batch(const std::vector<BatchEntry> &entries);
+
     /**
      * @brief Остановка сервера
      */
@@ -102,17 +177,40 @@ private:
     void start_accepting_clients();
 
     /**
-     * @brief Функция потока приёма подключений
+     * @brief Функция потока приёма подключений: выполняет io_context_
      */
     void accept_thread_func();
 
     /**
-     * @brief Обработка подключения одного клиента
-     * @param socket Сокет подключившегося клиента
+     * @brief Запускает асинхронный приём очередного подключения
+     */
+    void accept_next();
+
+    /**
+     * @brief Асинхронно читает запрос handshake подключившегося клиента
+     *
+     * Прочитанный запрос передаётся пулу регистрации. Клиент, не приславший
+     * запрос за HANDSHAKE_TIMEOUT, отключается
+     *
+     * @param socket Сокет клиента
+     * @param client_ip Адрес клиента
+     * @param client_port Порт клиента
+     */
+    void read_handshake(std::shared_ptr<tcp::socket> socket,
+                        const std::string &client_ip,
+                        uint16_t client_port);
+
+    /**
+     * @brief Асинхронно отказывает клиенту, предлагая повторить подключение позже
+     * @param socket Сокет клиента
+     */
+    void reject_busy(std::shared_ptr<tcp::socket> socket);
+
+    /**
+     * @brief Регистрация одного клиента (выполняется пулом регистрации)
+     * @param client Клиент с полученным запросом handshake
      */
-    void handle_client_connection(tcp::socket socket,
-                                  const std::string &client_ip,
-                                  uint16_t client_port);
+    void handle_client_connection(PendingClient &client);
 
     /**
      * @brief Остановка приема новых клиентов
@@ -120,46 +218,160 @@ private:
     void stop_accepting_clients();
 
     /**
-     * @brief Распределение и отправка задачи всем клиентам
-     * @param params Параметры интегрирования
-     * @return true, если задачи успешно отправлены
+     * @brief Ожидает команды START или выполнения условий начала интегрирования
+     * @return false, если сервер остановлен до начала
      */
-    bool distribute_and_send_tasks(const IntegrationParameters &params);
+    bool wait_for_start();
 
     /**
-     * @brief Отправка задач одному клиенту
-     * @param client Указатель на клиента
-     * @param batch Пакет задач
-     * @return true, если успешно отправлено
+     * @brief Проверяет условия StartPolicy по подключенным клиентам
+     * @param quorum_expired Истекло время ожидания кворума
+     * @note Вызывать под start_mutex_
+     */
+    bool start_conditions_met(bool quorum_expired) const;
+
+    /**
+     * @brief Будит ожидание начала интегрирования после изменения состава клиентов
+     */
+    void notify_start_waiter();
+
+    /**
+     * @brief Регистрирует ядра сервера как локального псевдо-клиента
+     */
+    void register_local_worker();
+
+    /**
+     * @brief Запускает config_.local_clients процессов клиента на машине сервера
+     */
+    void launch_local_clients();
+
+    /**
+     * @brief Передаёт задание из очереди планировщику
+     * @param job Задание, забранное из очереди
+     */
+    void admit_job(const JobStatus &job);
+
+    /**
+     * @brief Прерывает выполнение фрагментов заданий на клиенте
+     *
+     * Удалённому клиенту отправляется CANCEL_JOB, локальному исполнителю
+     * флаг отмены выставляется напрямую. Клиент вернёт частичные результаты
+     *
+     * @param client_id ID клиента
+     * @param job_ids ID заданий
      */
-    bool send_tasks_to_client(ClientConnection *client, const TaskBatch &batch);
+    void interrupt_client_jobs(uint64_t client_id, const std::set<uint64_t> &job_ids);
 
     /**
-     * @brief Сбор результатов от всех клиентов
-     * @param aggregator Агрегатор результатов
-     * @return true, если все результаты получены
+     * @brief Обработка завершения задания планировщиком
+     * @param outcome Итог задания
      */
-    bool collect_results(ResultAggregator &aggregator);
+    void on_job_finished(const JobOutcome &outcome);
 
     /**
-     * @brief Получение результатов от одного клиента
-     * @param client Указатель на клиента
-     * @param aggregator Агрегатор результатов
-     * @return true, если успешно получено
+     * @brief Обработка завершения шага обратного запроса: следующий шаг или итог задания
+     * @param outcome Итог задания шага
      */
-    bool receive_results_from_client(ClientConnection *client, ResultAggregator &aggregator);
+    void on_inverse_step_finished(const JobOutcome &outcome);
 
     /**
-     * @brief Отправитка команд завершения работы всем клиентам
+     * @brief Сообщает клиентам с изменившейся долей ядер новое число рабочих потоков
+     *
+     * Вызывается после подключения или отключения клиента: удалённые клиенты
+     * получают команду SET_WORKERS, локальный исполнитель меняет размер пула напрямую
+     */
+    void update_host_workers();
+
+    /**
+     * @brief Рассылает удалённым клиентам адреса друг друга командой PEERS
+     *
+     * Сервер только сообщает адреса: кража задач идёт между клиентами напрямую.
+     * Каждый клиент получает не более MAX_PEERS_PER_CLIENT соседей по кольцу
+     */
+    void broadcast_peers();
+
+    /**
+     * @brief Запрашивает рассылку PEERS после подключения или отключения клиента
+     *
+     * Запросы, пришедшие в течение PEERS_COALESCE_INTERVAL, объединяются в одну рассылку
+     */
+    void request_peers_broadcast();
+
+    /**
+     * @brief Цикл потока рассылки PEERS
+     */
+    void peers_loop();
+
+    /**
+     * @brief Задаёт начальную оценку скорости клиента по профилю его машины
+     * @param client Дескриптор клиента
+     * @param method Название метода интегрирования клиента
+     */
+    void seed_client_performance(const ClientHandle &client, const std::string &method);
+
+    /**
+     * @brief Учитывает пакет результатов в профиле машины клиента
+     * @param client Дескриптор клиента
+     * @param batch Пакет результатов
+     * @param rtt_seconds Время доставки без учёта вычислений (< 0 - не измерено)
+     */
+    void record_host_profile(const ClientHandle &client, const ResultBatch &batch, double rtt_seconds);
+
+    /**
+     * @brief Запускает поток сессии, выдающий клиенту фрагменты заданий
+     * @param client Дескриптор клиента
+     */
+    void start_session(const ClientHandle &client);
+
+    /**
+     * @brief Цикл сессии удалённого клиента
+     *
+     * Забирает у планировщика пакеты фрагментов, отправляет их клиенту
+     * и передаёт планировщику результаты, пока планировщик не остановлен.
+     * При сбое связи невыполненные фрагменты возвращаются планировщику,
+     * а клиент удаляется из реестра
+     *
+     * @param client Дескриптор клиента
      */
-    void send_stop_command_to_all_clients();
+    void run_client_session(ClientHandle client);
+
+    /**
+     * @brief Цикл сессии локального исполнителя
+     * @param client Дескриптор локального клиента
+     */
+    void run_local_session(ClientHandle client);
+
+    /**
+     * @brief Отправка пакета задач одному клиенту
+     * @param client Дескриптор клиента
+     * @param batch Пакет задач
+     * @throws std::exception при ошибке сети
+     */
+    void send_tasks_to_client(const ClientHandle &client, const TaskBatch &batch);
+
+    /**
+     * @brief Останавливает и дожидается завершения всех сессий
+     */
+    void join_sessions();
+
+    /**
+     * @brief Обработка одной команды управляющего сокета
+     * @param request Строка команды
+     * @param reply Функция отправки ответа
+     */
+    void handle_control_command(const std::string &request, ControlServer::Reply reply);
 
     /**
      * @brief Вывести итоговый результат
-     * @param final_result Значение интеграла
-     * @param params Параметры интегрирования
+     * @param outcome Итог задания
+     */
+    void print_final_result(const JobOutcome &outcome);
+
+    /**
+     * @brief Вывести долю работы, выполненную каждым клиентом
+     * @param outcome Итог задания
      */
-    void print_final_result(double final_result, const IntegrationParameters &params);
+    void print_client_shares(const JobOutcome &outcome);
 
     // Контекст ввода/вывода
     boost::asio::io_context io_context_;
@@ -167,18 +379,89 @@ private:
     std::unique_ptr<tcp::acceptor> acceptor_;
     // Порт сервера
     uint16_t port_;
+    // Настройки сервера
+    ServerConfig config_;
+    // Возможности протокола, которые сервер предлагает клиентам
+    ProtocolCapabilities capabilities_;
 
     // Менеджер клиентов
     ClientManager client_manager_;
     // Распределитель задач
     TaskDistributor task_distributor_;
+    // Сглаженная оценка скорости клиентов
+    ClientPerformance client_performance_;
+    // Профили машин, сохраняемые между запусками
+    HostProfileStore host_profiles_;
     // Обработчик пользовательского ввода
     InputHandler input_handler_;
+    // Очередь заданий
+    JobQueue job_queue_;
+    // Планировщик фрагментов выполняющихся заданий
+    JobScheduler scheduler_;
+    // Защищает inverse_solvers_
+    std::mutex inverse_mutex_;
+    // Решатели выполняющихся обратных запросов: job_id -> решатель
+    std::map<uint64_t, std::unique_ptr<InverseSolver>> inverse_solvers_;
+    // Управляющий сокет (режим сервиса)
+    std::unique_ptr<ControlServer> control_server_;
+
+    // Локальный исполнитель на ядрах сервера
+    std::unique_ptr<LocalWorker> local_worker_;
+    // Процессы клиента, запущенные сервером (ServerConfig::local_clients)
+    std::unique_ptr<LocalLauncher> local_launcher_;
+
+    /**
+     * @struct Session
+     * @brief Поток сессии одного клиента
+     */
+    struct Session
+    {
+        std::thread thread;
+        // Выставляется потоком сессии при завершении
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+
+    // Наибольшее число пакетов, одновременно выданных клиенту (предлагается при handshake)
+    static constexpr size_t PIPELINE_DEPTH = 2;
+    // Время на получение запроса handshake от подключившегося клиента
+    static constexpr std::chrono::seconds HANDSHAKE_TIMEOUT{10};
+    // Наибольший размер запроса handshake
+    static constexpr uint32_t MAX_HANDSHAKE_SIZE = 64 * 1024;
+    // Интервал объединения запросов рассылки PEERS
+    static constexpr std::chrono::milliseconds PEERS_COALESCE_INTERVAL{200};
+    // Наибольшее число соседей в команде PEERS
+    static constexpr size_t MAX_PEERS_PER_CLIENT = 16;
+
+    // Регистрация подключившихся клиентов
+    HandshakePool handshake_pool_;
+    // Сокеты клиентов, ещё не прошедших handshake (только в потоке приёма)
+    std::set<std::shared_ptr<tcp::socket>> handshake_sockets_;
+
+    // Поток рассылки PEERS
+    std::thread peers_thread_;
+    std::mutex peers_mutex_;
+    std::condition_variable peers_cv_;
+    // Есть необработанный запрос рассылки
+    bool peers_dirty_ = false;
+    // Поток рассылки остановлен
+    bool peers_stopped_ = false;
+
+    // Защищает sessions_ и sessions_closed_
+    std::mutex sessions_mutex_;
+    // Потоки сессий клиентов
+    std::vector<Session> sessions_;
+    // Новые сессии больше не запускаются
+    bool sessions_closed_ = false;
+    // Число завершившихся, но ещё не присоединённых сессий
+    std::atomic<size_t> finished_sessions_{0};
 
     // Поток приема подключений
     std::thread accept_thread_;
     // Флаг работы сервера
     std::atomic<bool> running_{false};
+    // Защищает start_received_ и ожидание начала интегрирования
+    std::mutex start_mutex_;
+    std::condition_variable start_cv_;
     // Флаг получения команды START
-    std::atomic<bool> start_received_{false};
+    bool start_received_ = false;
 };
@@ -1,101 +1,215 @@
 #include "task_distributor.h"
 #include "logger.h"
+#include <algorithm>
 #include <stdexcept>
 #include <cmath>
 
-std::map<uint64_t, TaskBatch> TaskDistributor::distribute_tasks(
-    const std::vector<ClientConnection *> &clients,
+std::vector<Task> TaskDistributor::split_job(
+    uint64_t job_id,
     double lower,
     double upper,
-    double step)
+    double step,
+    uint32_t total_cores)
 {
     // Валидация параметров
-    if (clients.empty())
+    if (lower >= upper || step <= 0.0)
     {
-        throw std::runtime_error("No clients connected");
+        throw std::invalid_argument("Invalid integration range or step");
     }
 
-    LOG_INFO("Distributing task: range=[{}, {}], step={}, clients={}",
-             lower, upper, step, clients.size());
+    // Общее количество шагов интегрирования
+    uint64_t total_steps = static_cast<uint64_t>(std::ceil((upper - lower) / step));
 
-    // Подсчёт общего количества ядер
-    uint32_t total_cores = 0;
-    for (const auto *client : clients)
+    // Фрагментов должно хватить на все ядра с запасом для балансировки,
+    // но каждый фрагмент должен быть достаточно крупным
+    uint64_t target_chunks = std::max<uint64_t>(
+        MIN_CHUNKS_PER_JOB,
+        static_cast<uint64_t>(std::max<uint32_t>(total_cores, 1)) * CHUNKS_PER_CORE);
+    uint64_t chunk_count = std::clamp<uint64_t>(total_steps / MIN_CHUNK_STEPS, 1, target_chunks);
+
+    std::vector<Task> chunks;
+    chunks.reserve(chunk_count);
+
+    for (uint64_t i = 0; i < chunk_count; ++i)
+    {
+        // Границы фрагментов приходятся на узлы сетки с шагом step
+        uint64_t first_step = i * total_steps / chunk_count;
+        uint64_t last_step = (i + 1) * total_steps / chunk_count;
+
+        Task task;
+        task.id = next_task_id_++;
+        task.job_id = job_id;
+        task.begin = lower + static_cast<double>(first_step) * step;
+        task.end = (i == chunk_count - 1)
+                       ? upper // Последний фрагмент - точно до конца
+                       : lower + static_cast<double>(last_step) * step;
+        task.step = step;
+
+        chunks.push_back(task);
+    }
+
+    LOG_INFO("Job {}: range=[{}, {}], step={} split into {} chunks ({} steps each, {} cores)",
+             job_id, lower, upper, step, chunk_count, total_steps / chunk_count, total_cores);
+
+    return chunks;
+}
+
+std::vector<Task> TaskDistributor::split_qmc_job(
+    uint64_t job_id,
+    const QmcSampling &sampling,
+    uint64_t points,
+    uint32_t replicas,
+    uint32_t total_cores)
+{
+    // Валидация параметров
+    if (!sampling.is_valid() || points == 0 || points > QmcSampling::MAX_POINTS || replicas == 0)
     {
-        total_cores += client->get_cpu_cores();
+        throw std::invalid_argument("Invalid quasi-Monte Carlo parameters");
     }
 
-    LOG_INFO("Total CPU cores available: {}", total_cores);
+    // Фрагментов на все реплики столько же, сколько у обычного задания
+    uint64_t target_chunks = std::max<uint64_t>(
+        MIN_CHUNKS_PER_JOB,
+        static_cast<uint64_t>(std::max<uint32_t>(total_cores, 1)) * CHUNKS_PER_CORE);
+    uint64_t chunks_per_replica = std::clamp<uint64_t>(
+        points / MIN_CHUNK_STEPS, 1, std::max<uint64_t>(target_chunks / replicas, 1));
 
-    // Вычисляем количество задач для каждого клиента
-    auto tasks_per_client = calculate_tasks_per_client(clients, total_cores);
+    std::vector<Task> chunks;
+    chunks.reserve(chunks_per_replica * replicas);
 
-    // Распределяем диапазон
-    double total_range = upper - lower;
-    double current_position = lower;
+    for (uint32_t replica = 0; replica < replicas; ++replica)
+    {
+        for (uint64_t i = 0; i < chunks_per_replica; ++i)
+        {
+            Task task;
+            task.id = next_task_id_++;
+            task.job_id = job_id;
+            task.begin = static_cast<double>(i * points / chunks_per_replica);
+            task.end = static_cast<double>((i + 1) * points / chunks_per_replica);
+            task.step = 1.0;
+            task.sampling = sampling;
+            task.sampling.replica = replica;
+
+            chunks.push_back(task);
+        }
+    }
+
+    LOG_INFO("Job {}: {} dimensions, {} points x {} replicas split into {} chunks ({} points each, {} cores)",
+             job_id, sampling.dimensions(), points, replicas, chunks.size(),
+             points / chunks_per_replica, total_cores);
+
+    return chunks;
+}
 
-    std::map<uint64_t, TaskBatch> result;
-    total_tasks_ = 0;
+std::vector<Task> TaskDistributor::split_batch_job(
+    uint64_t job_id,
+    const std::vector<QueryRange> &segments,
+    double step,
+    uint32_t total_cores)
+{
+    // Валидация параметров
+    if (segments.empty() || step <= 0.0)
+    {
+        throw std::invalid_argument("Invalid batch segments or step");
+    }
 
-    for (size_t i = 0; i < clients.size(); ++i)
+    // Количество шагов интегрирования по всем отрезкам
+    uint64_t total_steps = 0;
+    for (const auto &segment : segments)
     {
-        const auto *client = clients[i];
-        uint32_t num_tasks = tasks_per_client[i];
+        if (segment.lower >= segment.upper)
+        {
+            throw std::invalid_argument("Invalid batch segments or step");
+        }
+        total_steps += static_cast<uint64_t>(std::ceil((segment.upper - segment.lower) / step));
+    }
 
-        TaskBatch batch;
-        batch.tasks.reserve(num_tasks);
+    // Фрагменты того же размера, что у обычного задания той же длины
+    uint64_t target_chunks = std::max<uint64_t>(
+        MIN_CHUNKS_PER_JOB,
+        static_cast<uint64_t>(std::max<uint32_t>(total_cores, 1)) * CHUNKS_PER_CORE);
+    uint64_t chunk_count = std::clamp<uint64_t>(total_steps / MIN_CHUNK_STEPS, 1, target_chunks);
+    uint64_t chunk_steps = (total_steps + chunk_count - 1) / chunk_count;
 
-        double range_for_client = total_range *
-                                  static_cast<double>(client->get_cpu_cores()) /
-                                  static_cast<double>(total_cores);
+    std::vector<Task> chunks;
+    chunks.reserve(chunk_count + segments.size());
 
-        double task_range = range_for_client / num_tasks;
+    for (const auto &segment : segments)
+    {
+        uint64_t segment_steps = static_cast<uint64_t>(std::ceil((segment.upper - segment.lower) / step));
+        uint64_t pieces = (segment_steps + chunk_steps - 1) / chunk_steps;
 
-        for (uint32_t j = 0; j < num_tasks; ++j)
+        // Шаг должен быть меньше длины фрагмента
+        double segment_step = std::min(step, (segment.upper - segment.lower) / 2.0);
+
+        for (uint64_t i = 0; i < pieces; ++i)
         {
+            // Границы фрагментов приходятся на узлы сетки отрезка
+            uint64_t first_step = i * segment_steps / pieces;
+            uint64_t last_step = (i + 1) * segment_steps / pieces;
+
             Task task;
             task.id = next_task_id_++;
-            task.begin = current_position;
-            task.end = (j == num_tasks - 1 && i == clients.size() - 1)
-                           ? upper // Последняя задача - точно до конца
-                           : current_position + task_range;
-            task.step = step;
-
-            batch.tasks.push_back(task);
-            current_position = task.end;
-            total_tasks_++;
+            task.job_id = job_id;
+            task.begin = segment.lower + static_cast<double>(first_step) * step;
+            task.end = (i == pieces - 1)
+                           ? segment.upper // Последний фрагмент - точно до конца отрезка
+                           : segment.lower + static_cast<double>(last_step) * step;
+            task.step = segment_step;
+
+            chunks.push_back(task);
         }
-
-        double first_begin = batch.tasks.front().begin;
-        double last_end = batch.tasks.back().end;
-        
-        LOG_INFO("Client ID={}: assigned {} tasks, range=[{}, {}]",
-                 client->get_client_id(),
-                 num_tasks,
-                 first_begin,
-                 last_end);
-
-        result[client->get_client_id()] = std::move(batch);
     }
 
-    LOG_INFO("Total tasks created: {}", total_tasks_);
+    LOG_INFO("Job {}: {} segments, step={} split into {} chunks (up to {} steps each, {} cores)",
+             job_id, segments.size(), step, chunks.size(), chunk_steps, total_cores);
 
-    return result;
+    return chunks;
 }
 
-std::vector<uint32_t> TaskDistributor::calculate_tasks_per_client(
-    const std::vector<ClientConnection *> &clients,
-    uint32_t total_cores) const
+std::vector<Task> TaskDistributor::split_scan_job(
+    uint64_t job_id,
+    const ScanGrid &grid,
+    uint64_t intervals,
+    double step,
+    uint32_t total_cores)
 {
-    std::vector<uint32_t> result;
-    result.reserve(clients.size());
+    // Валидация параметров
+    if (!grid.is_active() || intervals == 0 || step <= 0.0)
+    {
+        throw std::invalid_argument("Invalid output table or step");
+    }
 
-    // Каждому клиенту выделяем количество задач = количество ядер
-    // (чтобы максимально утилизировать каждое ядро)
-    for (const auto *client : clients)
+    // Общее количество шагов интегрирования
+    uint64_t total_steps = static_cast<uint64_t>(std::ceil((grid.point(intervals) - grid.origin) / step));
+
+    // Фрагменты того же размера, что у обычного задания, но не больше MAX_TASK_POINTS точек таблицы
+    uint64_t target_chunks = std::max<uint64_t>(
+        MIN_CHUNKS_PER_JOB,
+        static_cast<uint64_t>(std::max<uint32_t>(total_cores, 1)) * CHUNKS_PER_CORE);
+    uint64_t chunk_count = std::clamp<uint64_t>(total_steps / MIN_CHUNK_STEPS, 1, target_chunks);
+    chunk_count = std::max(chunk_count, (intervals + ScanGrid::MAX_TASK_POINTS - 1) / ScanGrid::MAX_TASK_POINTS);
+    chunk_count = std::min(chunk_count, intervals);
+
+    std::vector<Task> chunks;
+    chunks.reserve(chunk_count);
+
+    for (uint64_t i = 0; i < chunk_count; ++i)
     {
-        result.push_back(client->get_cpu_cores());
+        // Границы фрагментов приходятся на точки таблицы
+        Task task;
+        task.id = next_task_id_++;
+        task.job_id = job_id;
+        task.begin = grid.point(i * intervals / chunk_count);
+        task.end = grid.point((i + 1) * intervals / chunk_count);
+        task.step = step;
+        task.grid = grid;
+
+        chunks.push_back(task);
     }
 
-    return result;
+    LOG_INFO("Job {}: table of {} intervals over [{}, {}], step={} split into {} chunks ({} cores)",
+             job_id, intervals, grid.origin, grid.point(intervals), step, chunk_count, total_cores);
+
+    return chunks;
 }
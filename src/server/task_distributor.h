@@ -1,20 +1,23 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
-#include <map>
 #include "messages.h"
-#include "client_connection.h"
+#include "query_batch.h"
 
 /**
  * @file task_distributor.h
- * @brief Модуль распределения задач интегрирования между клиентами
+ * @brief Модуль разбиения заданий интегрирования на фрагменты
  */
 
 /**
  * @class TaskDistributor
- * @brief Разделяет общую задачу интегрирования на подзадачи для клиентов
+ * @brief Разделяет задание интегрирования на фрагменты (задачи) для планировщика
  *
- * Распределяет диапазон интегрирования пропорционально количеству ядер каждого клиента
+ * Фрагменты не закрепляются за клиентами заранее: клиенты забирают их из
+ * планировщика по мере освобождения, поэтому фрагментов создаётся в несколько
+ * раз больше, чем ядер в кластере. Границы фрагментов выровнены по шагу
+ * интегрирования, ID задач уникальны в пределах сервера
  */
 class TaskDistributor
 {
@@ -22,39 +25,103 @@ public:
     TaskDistributor() = default;
 
     /**
-     * @brief Распределяет задачу между клиентами
+     * @brief Разбивает диапазон задания на фрагменты
      *
-     * @param clients Список всех клиентов
+     * @param job_id ID задания
      * @param lower Нижний предел интегрирования
      * @param upper Верхний предел интегрирования
      * @param step Шаг интегрирования
-     * @return Карта: client_id -> TaskBatch (задачи для каждого клиента)
+     * @param total_cores Суммарное число ядер кластера на момент разбиения
+     * @return Фрагменты в порядке возрастания границ
      *
      * @throws std::invalid_argument если параметры некорректны
-     * @throws std::runtime_error если нет клиентов
      */
-    std::map<uint64_t, TaskBatch> distribute_tasks(
-        const std::vector<ClientConnection *> &clients,
+    std::vector<Task> split_job(
+        uint64_t job_id,
         double lower,
         double upper,
-        double step);
+        double step,
+        uint32_t total_cores);
 
     /**
-     * @brief Геттер суммарного числа созданных задач
-     * @return Количество задач
+     * @brief Разбивает задание квази-Монте-Карло на отрезки номеров точек
+     *
+     * Каждая реплика делится на отрезки отдельно, фрагмент получает
+     * область и скремблирование своей реплики
+     *
+     * @param job_id ID задания
+     * @param sampling Область и зерно скремблирования
+     * @param points Количество точек в каждой реплике
+     * @param replicas Количество реплик
+     * @param total_cores Суммарное число ядер кластера на момент разбиения
+     * @return Фрагменты реплик по порядку
+     *
+     * @throws std::invalid_argument если параметры некорректны
      */
-    size_t get_total_tasks_count() const { return total_tasks_; }
+    std::vector<Task> split_qmc_job(
+        uint64_t job_id,
+        const QmcSampling &sampling,
+        uint64_t points,
+        uint32_t replicas,
+        uint32_t total_cores);
+
+    /**
+     * @brief Разбивает отрезки пакетного задания на фрагменты
+     *
+     * Фрагменты не пересекают границы отрезков, длинные отрезки делятся на
+     * фрагменты примерно равного числа шагов. Отрезку короче двух шагов
+     * достаётся один фрагмент с шагом в половину его длины
+     *
+     * @param job_id ID задания
+     * @param segments Отрезки объединения запросов (см. QueryBatch)
+     * @param step Шаг интегрирования
+     * @param total_cores Суммарное число ядер кластера на момент разбиения
+     * @return Фрагменты в порядке возрастания границ
+     *
+     * @throws std::invalid_argument если параметры некорректны
+     */
+    std::vector<Task> split_batch_job(
+        uint64_t job_id,
+        const std::vector<QueryRange> &segments,
+        double step,
+        uint32_t total_cores);
+
+    /**
+     * @brief Разбивает задание с таблицей первообразной на фрагменты
+     *
+     * Границы фрагментов - точки таблицы, в каждом фрагменте не больше
+     * ScanGrid::MAX_TASK_POINTS точек
+     *
+     * @param job_id ID задания
+     * @param grid Точки таблицы
+     * @param intervals Количество отрезков таблицы
+     * @param step Шаг интегрирования
+     * @param total_cores Суммарное число ядер кластера на момент разбиения
+     * @return Фрагменты в порядке возрастания границ
+     *
+     * @throws std::invalid_argument если параметры некорректны
+     */
+    std::vector<Task> split_scan_job(
+        uint64_t job_id,
+        const ScanGrid &grid,
+        uint64_t intervals,
+        double step,
+        uint32_t total_cores);
 
-private:
     /**
-     * @brief Вычисляет количество задач для клиента пропорционально его ядрам
+     * @brief Выдаёт новый уникальный ID задачи
+     * @return ID задачи
      */
-    std::vector<uint32_t> calculate_tasks_per_client(
-        const std::vector<ClientConnection *> &clients,
-        uint32_t total_cores) const;
-    
-    // Общее количество задач
-    size_t total_tasks_{0};
+    uint64_t allocate_task_id() { return next_task_id_++; }
+
+    // Количество фрагментов на одно ядро кластера
+    static constexpr uint32_t CHUNKS_PER_CORE = 8;
+    // Минимальное количество фрагментов задания (кластер может вырасти после разбиения)
+    static constexpr uint64_t MIN_CHUNKS_PER_JOB = 64;
+    // Минимальное количество шагов интегрирования во фрагменте
+    static constexpr uint64_t MIN_CHUNK_STEPS = 10000;
+
+private:
     // Счетчик ID задач
-    uint64_t next_task_id_{1};
+    std::atomic<uint64_t> next_task_id_{1};
 };
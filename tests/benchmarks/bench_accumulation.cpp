@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "cancellation_token.h"
+#include "integrands.h"
+#include "simpsons_rule.h"
+#include "trapezoidal_rule.h"
+
+/**
+ * @file bench_accumulation.cpp
+ * @brief Бенчмарк накопителей сумм узлов: цена в скорости и выигрыш в точности
+ *
+ * Интегрирует 1/ln(x) методами трапеций и Симпсона с каждым накопителем
+ * из accumulators.h на одном и том же разбиении. Ошибка суммирования
+ * оценивается по результату double-double того же метода, поэтому в неё
+ * не входит погрешность самого метода. Значащие цифры - -log10 относительной
+ * ошибки (для double-double - точность вычисления значений функции)
+ *
+ * @code
+ * bench_accumulation --evaluations 1000000000 --upper 1000000
+ * @endcode
+ */
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Параметры бенчмарка
+     */
+    struct Options
+    {
+        uint64_t evaluations = 100000000;
+        double lower = 2.0;
+        double upper = 1000000.0;
+    };
+
+    /**
+     * @brief Результат одного прогона
+     */
+    struct Run
+    {
+        DoubleDouble value;
+        double seconds = 0.0;
+    };
+
+    template <class Strategy>
+    Run run(const Options &options)
+    {
+        const IntegrandSpec spec{INTEGRAND_INV_LOG, integrands::default_parameter(INTEGRAND_INV_LOG), {}};
+        const double step = (options.upper - options.lower) / static_cast<double>(options.evaluations);
+        CancellationToken token;
+
+        auto started = Clock::now();
+        PartialIntegral result = Strategy().integrate_partial(options.lower, options.upper, step, spec, token);
+        std::chrono::duration<double> elapsed = Clock::now() - started;
+        return {{result.value, result.value_low}, elapsed.count()};
+    }
+
+    /**
+     * @brief Печатает строку таблицы
+     * @param reference Результат double-double того же метода
+     */
+    void print(const std::string &method, const std::string &reduction, const Run &run, const Run &reference,
+               const Options &options)
+    {
+        double error = std::abs((run.value.hi - reference.value.hi) + (run.value.lo - reference.value.lo));
+        double relative = error / std::abs(reference.value.hi);
+        double digits = relative > 0.0 ? -std::log10(relative) : -std::log10(std::numeric_limits<double>::epsilon());
+        std::cout << fmt::format("{:<12} {:<14} {:>9.3f} {:>10.1f} {:>22.15f} {:>10.2e} {:>7.1f}\n",
+                                 method, reduction, run.seconds,
+                                 static_cast<double>(options.evaluations) / run.seconds / 1e6,
+                                 run.value.hi + run.value.lo, relative, digits);
+    }
+
+    template <template <class, class> class Rule>
+    void measure(const std::string &method, const Options &options)
+    {
+        using integrands::InverseLog;
+        Run plain = run<Rule<InverseLog, PlainAccumulator>>(options);
+        Run compensated = run<Rule<InverseLog, CompensatedAccumulator>>(options);
+        Run double_double = run<Rule<InverseLog, DoubleDoubleAccumulator>>(options);
+
+        print(method, "plain", plain, double_double, options);
+        print(method, "compensated", compensated, double_double, options);
+        print(method, "double_double", double_double, double_double, options);
+    }
+
+    Options parse_options(int argc, char *argv[])
+    {
+        Options options;
+
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            std::string arg = argv[i];
+            if (arg == "--evaluations")
+            {
+                options.evaluations = std::strtoull(argv[i + 1], nullptr, 10);
+            }
+            else if (arg == "--lower")
+            {
+                options.lower = std::atof(argv[i + 1]);
+            }
+            else if (arg == "--upper")
+            {
+                options.upper = std::atof(argv[i + 1]);
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                std::exit(2);
+            }
+        }
+
+        if (options.evaluations < 2 || !(options.lower > 1.0) || !(options.upper > options.lower))
+        {
+            std::cerr << "Expected --evaluations >= 2 and 1 < --lower < --upper\n";
+            std::exit(2);
+        }
+        return options;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options = parse_options(argc, argv);
+
+    std::cout << "integrand:   1/ln(x) on [" << options.lower << ", " << options.upper << "]\n"
+              << "evaluations: " << options.evaluations << "\n\n"
+              << fmt::format("{:<12} {:<14} {:>9} {:>10} {:>22} {:>10} {:>7}\n",
+                             "method", "summation", "time, s", "Meval/s", "value", "rel.error", "digits");
+
+    measure<BasicTrapezoidalRule>("trapezoidal", options);
+    measure<BasicSimpsonsRule>("simpson", options);
+    return 0;
+}
@@ -0,0 +1,387 @@
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "logger.h"
+#include "net_utils.h"
+#include "server.h"
+#include "utils.h"
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+/**
+ * @file bench_connection_storm.cpp
+ * @brief Бенчмарк регистрации клиентов при одновременном подключении
+ *
+ * Запускает сервер в режиме сервиса и одновременно подключает к нему
+ * заданное число клиентов через loopback. Клиенты выполняют handshake
+ * асинхронно из одного потока и повторяют его, если сервер просит
+ * подождать. Измеряется время до принятия всех handshake и до
+ * регистрации всех клиентов сервером (по команде STATUS)
+ *
+ * @code
+ * bench_connection_storm --clients 5000 --workers 4 --queue 1024 --backlog 4096
+ * @endcode
+ */
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Параметры бенчмарка
+     */
+    struct Options
+    {
+        size_t clients = 5000;
+        uint16_t port = 15570;
+        ServerConfig server;
+    };
+
+    /**
+     * @brief Один подключающийся клиент
+     */
+    struct StormClient
+    {
+        explicit StormClient(boost::asio::io_context &io_context)
+            : socket(io_context), timer(io_context) {}
+
+        tcp::socket socket;
+        boost::asio::steady_timer timer;
+        uint32_t network_size = 0;
+        std::string payload;
+        std::array<char, 4096> drain{};
+    };
+
+    /**
+     * @brief Асинхронный генератор подключений
+     */
+    class Storm
+    {
+    public:
+        Storm(boost::asio::io_context &io_context, uint16_t port, size_t clients)
+            : io_context_(io_context),
+              endpoint_(boost::asio::ip::address_v4::loopback(), port),
+              random_(std::random_device{}())
+        {
+            HandshakeRequest request;
+            request.client_version = "bench";
+            request.system_info = sys_utils::collect_system_info();
+            request.integration_method = "Simpson";
+            frame_ = net_utils::make_frame(request);
+
+            for (size_t i = 0; i < clients; ++i)
+            {
+                clients_.push_back(std::make_shared<StormClient>(io_context_));
+            }
+        }
+
+        void start()
+        {
+            started_at_ = Clock::now();
+            for (auto &client : clients_)
+            {
+                connect(client);
+            }
+        }
+
+        size_t accepted() const { return accepted_.load(); }
+        size_t retries() const { return retries_; }
+        size_t connect_errors() const { return connect_errors_; }
+        Clock::time_point started_at() const { return started_at_; }
+        Clock::time_point all_accepted_at() const { return all_accepted_at_; }
+
+        void close_all()
+        {
+            for (auto &client : clients_)
+            {
+                boost::system::error_code ec;
+                client->timer.cancel();
+                client->socket.close(ec);
+            }
+        }
+
+    private:
+        void connect(const std::shared_ptr<StormClient> &client)
+        {
+            client->socket = tcp::socket(io_context_);
+            client->socket.async_connect(endpoint_, [this, client](const boost::system::error_code &ec)
+                                         {
+                if (ec)
+                {
+                    connect_errors_++;
+                    retry(client, std::chrono::milliseconds(100));
+                    return;
+                }
+
+                boost::asio::async_write(client->socket, boost::asio::buffer(frame_),
+                                         [this, client](const boost::system::error_code &ec, size_t)
+                                         {
+                    if (ec)
+                    {
+                        connect_errors_++;
+                        retry(client, std::chrono::milliseconds(100));
+                        return;
+                    }
+                    read_response(client);
+                }); });
+        }
+
+        void read_response(const std::shared_ptr<StormClient> &client)
+        {
+            boost::asio::async_read(
+                client->socket,
+                boost::asio::buffer(&client->network_size, sizeof(client->network_size)),
+                [this, client](const boost::system::error_code &ec, size_t)
+                {
+                    if (ec)
+                    {
+                        connect_errors_++;
+                        retry(client, std::chrono::milliseconds(100));
+                        return;
+                    }
+
+                    client->payload.resize(ntohl(client->network_size));
+                    boost::asio::async_read(
+                        client->socket,
+                        boost::asio::buffer(client->payload.data(), client->payload.size()),
+                        [this, client](const boost::system::error_code &ec, size_t)
+                        {
+                            if (ec)
+                            {
+                                connect_errors_++;
+                                retry(client, std::chrono::milliseconds(100));
+                                return;
+                            }
+
+                            auto response = net_utils::parse_payload<HandshakeResponse>(std::move(client->payload));
+                            if (!response.accepted)
+                            {
+                                retries_++;
+                                retry(client, std::chrono::milliseconds(response.retry_after_ms));
+                                return;
+                            }
+
+                            if (++accepted_ == clients_.size())
+                            {
+                                all_accepted_at_ = Clock::now();
+                            }
+                            drain(client);
+                        });
+                });
+        }
+
+        /**
+         * @brief Читает и отбрасывает команды сервера, чтобы его отправка не блокировалась
+         */
+        void drain(const std::shared_ptr<StormClient> &client)
+        {
+            client->socket.async_read_some(boost::asio::buffer(client->drain),
+                                           [this, client](const boost::system::error_code &ec, size_t)
+                                           {
+                                               if (!ec)
+                                               {
+                                                   drain(client);
+                                               }
+                                           });
+        }
+
+        void retry(const std::shared_ptr<StormClient> &client, std::chrono::milliseconds delay)
+        {
+            boost::system::error_code ec;
+            client->socket.close(ec);
+
+            // Случайная добавка, как у настоящего клиента
+            std::uniform_int_distribution<int64_t> jitter(0, delay.count() / 2);
+            client->timer.expires_after(delay + std::chrono::milliseconds(jitter(random_)));
+            client->timer.async_wait([this, client](const boost::system::error_code &ec)
+                                     {
+                if (!ec)
+                {
+                    connect(client);
+                } });
+        }
+
+        boost::asio::io_context &io_context_;
+        tcp::endpoint endpoint_;
+        std::string frame_;
+        std::vector<std::shared_ptr<StormClient>> clients_;
+        std::mt19937 random_;
+
+        std::atomic<size_t> accepted_{0};
+        size_t retries_ = 0;
+        size_t connect_errors_ = 0;
+        Clock::time_point started_at_;
+        Clock::time_point all_accepted_at_;
+    };
+
+    /**
+     * @brief Запрашивает число зарегистрированных клиентов через управляющий сокет
+     */
+    size_t query_registered_clients(const std::string &socket_path)
+    {
+        boost::asio::io_context io_context;
+        boost::asio::local::stream_protocol::socket socket(io_context);
+        socket.connect(boost::asio::local::stream_protocol::endpoint(socket_path));
+
+        std::string request = "STATUS\n";
+        boost::asio::write(socket, boost::asio::buffer(request));
+
+        boost::asio::streambuf buffer;
+        boost::asio::read_until(socket, buffer, '\n');
+        std::string line((std::istreambuf_iterator<char>(&buffer)), std::istreambuf_iterator<char>());
+
+        auto position = line.find("clients=");
+        return position == std::string::npos ? 0 : std::stoul(line.substr(position + 8));
+    }
+
+    /**
+     * @brief Поднимает лимит открытых файлов: сервер и клиенты работают в одном процессе
+     * @return Доступный лимит
+     */
+    size_t raise_file_limit()
+    {
+#if !defined(_WIN32)
+        rlimit limit{};
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+            getrlimit(RLIMIT_NOFILE, &limit);
+            return static_cast<size_t>(limit.rlim_cur);
+        }
+#endif
+        return 0;
+    }
+
+    Options parse_options(int argc, char *argv[])
+    {
+        Options options;
+        options.server.profiles_path.clear();
+
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            std::string arg = argv[i];
+            long value = std::atol(argv[i + 1]);
+            if (arg == "--clients")
+            {
+                options.clients = static_cast<size_t>(value);
+            }
+            else if (arg == "--port")
+            {
+                options.port = static_cast<uint16_t>(value);
+            }
+            else if (arg == "--workers")
+            {
+                options.server.handshake_workers = static_cast<size_t>(value);
+            }
+            else if (arg == "--queue")
+            {
+                options.server.handshake_queue = static_cast<size_t>(value);
+            }
+            else if (arg == "--backlog")
+            {
+                options.server.listen_backlog = static_cast<int>(value);
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                std::exit(2);
+            }
+        }
+        return options;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options = parse_options(argc, argv);
+    logging::init("bench_connection_storm", spdlog::level::err);
+
+    // Каждому клиенту нужны два дескриптора: свой сокет и сокет сервера
+    size_t file_limit = raise_file_limit();
+    if (file_limit != 0 && file_limit < options.clients * 2 + 64)
+    {
+        size_t clients = (file_limit - 64) / 2;
+        std::cerr << "Open file limit " << file_limit << " allows only " << clients << " clients\n";
+        options.clients = clients;
+    }
+
+    std::string socket_path = (std::filesystem::temp_directory_path() /
+                               ("bench_connection_storm_" + std::to_string(options.port) + ".sock"))
+                                  .string();
+
+    Server server(options.port, options.server);
+    std::thread server_thread([&]()
+                              { server.serve(socket_path); });
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!std::filesystem::exists(socket_path) && Clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    boost::asio::io_context io_context;
+    Storm storm(io_context, options.port, options.clients);
+    storm.start();
+    std::thread storm_thread([&]()
+                             { io_context.run(); });
+
+    // Регистрация завершается после ответа на handshake
+    size_t registered = 0;
+    deadline = Clock::now() + std::chrono::minutes(2);
+    while (Clock::now() < deadline)
+    {
+        if (storm.accepted() == options.clients)
+        {
+            registered = query_registered_clients(socket_path);
+            if (registered >= options.clients)
+            {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto registered_at = Clock::now();
+
+    bool complete = registered >= options.clients;
+    std::chrono::duration<double, std::milli> accept_ms = storm.all_accepted_at() - storm.started_at();
+    std::chrono::duration<double, std::milli> register_ms = registered_at - storm.started_at();
+
+    std::cout << "clients:            " << options.clients << "\n"
+              << "handshake workers:  " << options.server.handshake_workers << "\n"
+              << "handshake queue:    " << options.server.handshake_queue << "\n"
+              << "listen backlog:     " << options.server.listen_backlog << "\n"
+              << "busy retries:       " << storm.retries() << "\n"
+              << "connect errors:     " << storm.connect_errors() << "\n";
+    if (complete)
+    {
+        std::cout << "all accepted in:    " << accept_ms.count() << " ms\n"
+                  << "all registered in:  " << register_ms.count() << " ms\n";
+    }
+    else
+    {
+        std::cout << "timed out: " << storm.accepted() << " accepted, " << registered << " registered\n";
+    }
+
+    server.stop();
+    server_thread.join();
+
+    boost::asio::post(io_context, [&storm]()
+                      { storm.close_all(); });
+    storm_thread.join();
+
+    logging::shutdown();
+    return complete ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "cancellation_token.h"
+#include "integrands.h"
+#include "simpsons_rule.h"
+#include "trapezoidal_rule.h"
+
+/**
+ * @file bench_single_precision.cpp
+ * @brief Бенчмарк вычисления значений в float32: ускорение и погрешность относительно double
+ *
+ * Интегрирует 1/ln(x) методами трапеций и Симпсона со значениями в double
+ * и в float32 (integrands::SinglePrecision) на одном и том же разбиении.
+ * Ошибка считается относительно результата double с компенсированным
+ * суммированием. Нижний предел по умолчанию близок к x = 1, поэтому часть
+ * узлов пересчитывается в double
+ *
+ * @code
+ * bench_single_precision --evaluations 1000000000 --lower 1.01 --upper 1000000
+ * @endcode
+ */
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Single = integrands::SinglePrecision<integrands::InverseLog>;
+
+    /**
+     * @brief Параметры бенчмарка
+     */
+    struct Options
+    {
+        uint64_t evaluations = 100000000;
+        double lower = 1.01;
+        double upper = 1000000.0;
+    };
+
+    /**
+     * @brief Результат одного прогона
+     */
+    struct Run
+    {
+        double value = 0.0;
+        double seconds = 0.0;
+    };
+
+    template <class Strategy>
+    Run run(const Options &options)
+    {
+        const IntegrandSpec spec{INTEGRAND_INV_LOG, integrands::default_parameter(INTEGRAND_INV_LOG), {}};
+        const double step = (options.upper - options.lower) / static_cast<double>(options.evaluations);
+        CancellationToken token;
+
+        auto started = Clock::now();
+        PartialIntegral result = Strategy().integrate_partial(options.lower, options.upper, step, spec, token);
+        std::chrono::duration<double> elapsed = Clock::now() - started;
+        return {result.value + result.value_low, elapsed.count()};
+    }
+
+    /**
+     * @brief Печатает строку таблицы
+     * @param baseline Прогон double с тем же накопителем (для ускорения)
+     * @param reference Результат double с компенсированным суммированием (для ошибки)
+     */
+    void print(const std::string &method, const std::string &variant, const Run &run, const Run &baseline,
+               const Run &reference, const Options &options)
+    {
+        double relative = std::abs(run.value - reference.value) / std::abs(reference.value);
+        std::cout << fmt::format("{:<12} {:<20} {:>9.3f} {:>10.1f} {:>8.2f}x {:>22.15f} {:>10.2e}\n",
+                                 method, variant, run.seconds,
+                                 static_cast<double>(options.evaluations) / run.seconds / 1e6,
+                                 baseline.seconds / run.seconds, run.value, relative);
+    }
+
+    template <template <class, class> class Rule>
+    void measure(const std::string &method, const Options &options)
+    {
+        using integrands::InverseLog;
+        Run plain = run<Rule<InverseLog, PlainAccumulator>>(options);
+        Run compensated = run<Rule<InverseLog, CompensatedAccumulator>>(options);
+        Run single_plain = run<Rule<Single, PlainAccumulator>>(options);
+        Run single_compensated = run<Rule<Single, CompensatedAccumulator>>(options);
+
+        print(method, "double", plain, plain, compensated, options);
+        print(method, "double:compensated", compensated, compensated, compensated, options);
+        print(method, "single", single_plain, plain, compensated, options);
+        print(method, "single:compensated", single_compensated, compensated, compensated, options);
+    }
+
+    Options parse_options(int argc, char *argv[])
+    {
+        Options options;
+
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            std::string arg = argv[i];
+            if (arg == "--evaluations")
+            {
+                options.evaluations = std::strtoull(argv[i + 1], nullptr, 10);
+            }
+            else if (arg == "--lower")
+            {
+                options.lower = std::atof(argv[i + 1]);
+            }
+            else if (arg == "--upper")
+            {
+                options.upper = std::atof(argv[i + 1]);
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                std::exit(2);
+            }
+        }
+
+        if (options.evaluations < 2 || !(options.lower > 1.0) || !(options.upper > options.lower))
+        {
+            std::cerr << "Expected --evaluations >= 2 and 1 < --lower < --upper\n";
+            std::exit(2);
+        }
+        return options;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options = parse_options(argc, argv);
+
+    std::cout << "integrand:   1/ln(x) on [" << options.lower << ", " << options.upper << "]\n"
+              << "evaluations: " << options.evaluations << "\n\n"
+              << fmt::format("{:<12} {:<20} {:>9} {:>10} {:>9} {:>22} {:>10}\n",
+                             "method", "evaluation", "time, s", "Meval/s", "speedup", "value", "rel.error");
+
+    measure<BasicTrapezoidalRule>("trapezoidal", options);
+    measure<BasicSimpsonsRule>("simpson", options);
+    return 0;
+}
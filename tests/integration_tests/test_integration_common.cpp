@@ -1,8 +1,16 @@
 #define BOOST_TEST_MODULE IntegrationCommonTests
 #include <boost/test/included/unit_test.hpp>
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <vector>
+#include <thread>
 
+#include "accumulators.h"
 #include "integration_strategy.h"
+#include "cancellation_token.h"
+#include "integrands.h"
 #include "trapezoidal_rule.h"
 #include "simpsons_rule.h"
 
@@ -86,3 +94,436 @@ BOOST_AUTO_TEST_CASE(FunctionNormalPoints)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+// Реестр подынтегральных функций
+BOOST_AUTO_TEST_SUITE(IntegrandTests)
+
+/**
+ * @brief Методы для каждой функции реестра дают известные значения интегралов
+ */
+BOOST_AUTO_TEST_CASE(IntegrateEachIntegrand)
+{
+    BOOST_TEST_MESSAGE("Testing integrands on [2, 10]...");
+
+    struct Case
+    {
+        std::unique_ptr<IIntegrationStrategy> strategy;
+        double parameter;
+        double expected;
+    };
+
+    Case cases[] = {
+        {std::make_unique<BasicSimpsonsRule<integrands::InverseLogPower>>(), 2.0, 3.66288098741529},
+        {std::make_unique<BasicSimpsonsRule<integrands::PowerOverLog>>(), 1.5, 67.1380077999688},
+        {std::make_unique<BasicSimpsonsRule<integrands::ExpOverLog>>(), 0.0, 0.136724411708678},
+        {std::make_unique<BasicTrapezoidalRule<integrands::ExpOverLog>>(), 0.0, 0.136724411708678}};
+
+    for (const auto &c : cases)
+    {
+        IntegrandSpec integrand{c.strategy->get_integrand(), c.parameter, {}};
+        double result = c.strategy->integrate_partial(2.0, 10.0, 1e-4, integrand, CancellationToken::none()).value;
+        BOOST_TEST_MESSAGE(integrands::name(c.strategy->get_integrand()) << ": " << result);
+        BOOST_CHECK_CLOSE(result, c.expected, 1e-4);
+    }
+}
+
+/**
+ * @brief 1/ln(x)^k с k = 1 и x^s/ln(x) с s = 0 совпадают с 1/ln(x)
+ */
+BOOST_AUTO_TEST_CASE(DefaultParametersMatchInverseLog)
+{
+    BOOST_TEST_MESSAGE("Testing default integrand parameters...");
+
+    SimpsonsRule inverse_log;
+    BasicSimpsonsRule<integrands::InverseLogPower> inverse_log_power;
+    BasicSimpsonsRule<integrands::PowerOverLog> power_over_log;
+
+    double expected = inverse_log.integrate(2.0, 3.0, 0.01);
+    BOOST_CHECK_CLOSE(inverse_log_power.integrate(2.0, 3.0, 0.01), expected, 1e-12);
+    BOOST_CHECK_CLOSE(power_over_log.integrate(2.0, 3.0, 0.01), expected, 1e-12);
+}
+
+/**
+ * @brief Значения в блоке точек совпадают со значениями в отдельных точках
+ */
+BOOST_AUTO_TEST_CASE(BlockMatchesScalar)
+{
+    BOOST_TEST_MESSAGE("Testing block evaluation...");
+
+    double x[7] = {0.1, 0.5, 0.9, 1.5, 2.0, 10.0, 1000.0};
+    double y[7] = {};
+
+    integrands::PowerOverLog function({INTEGRAND_POW_OVER_LOG, -0.5, {}});
+    function.evaluate_block(x, y, 7);
+    for (size_t i = 0; i < 7; ++i)
+    {
+        BOOST_CHECK_EQUAL(y[i], function.evaluate(x[i]));
+    }
+}
+
+/**
+ * @brief Каждая функция проверяет свою область определения
+ */
+BOOST_AUTO_TEST_CASE(DomainValidation)
+{
+    BOOST_TEST_MESSAGE("Testing integrand domains...");
+
+    BasicSimpsonsRule<integrands::InverseLogPower> rule;
+    const IntegrandSpec square{INTEGRAND_INV_LOG_POW, 2.0, {}};
+    const IntegrandSpec root{INTEGRAND_INV_LOG_POW, 0.5, {}};
+
+    // Целая степень определена и слева от 1, нецелая - только при x > 1
+    BOOST_CHECK_NO_THROW(rule.integrate_partial(0.2, 0.9, 0.01, square, CancellationToken::none()));
+    BOOST_CHECK_THROW(rule.integrate_partial(0.2, 0.9, 0.01, root, CancellationToken::none()),
+                      std::invalid_argument);
+    BOOST_CHECK_NO_THROW(rule.integrate_partial(2.0, 3.0, 0.01, root, CancellationToken::none()));
+
+    BOOST_CHECK(integrands::is_valid_domain({INTEGRAND_EXP_OVER_LOG, 0.0, {}}, 2.0, 3.0));
+    BOOST_CHECK(!integrands::is_valid_domain({INTEGRAND_EXP_OVER_LOG, 0.0, {}}, 0.5, 3.0));
+    BOOST_CHECK(!integrands::is_valid_domain({INTEGRAND_POW_OVER_LOG, NAN, {}}, 2.0, 3.0));
+    BOOST_CHECK(!integrands::is_valid_domain({1000, 0.0, {}}, 2.0, 3.0));
+}
+
+/**
+ * @brief Названия функций взаимно однозначны
+ */
+BOOST_AUTO_TEST_CASE(NamesRoundTrip)
+{
+    for (uint32_t id : {INTEGRAND_INV_LOG, INTEGRAND_INV_LOG_POW, INTEGRAND_POW_OVER_LOG, INTEGRAND_EXP_OVER_LOG,
+                        INTEGRAND_EXPRESSION})
+    {
+        auto parsed = integrands::from_name(integrands::name(id));
+        BOOST_REQUIRE(parsed.has_value());
+        BOOST_CHECK_EQUAL(*parsed, id);
+    }
+    BOOST_CHECK(!integrands::from_name("unknown").has_value());
+}
+
+/**
+ * @brief Выражение совпадает со встроенной функцией того же вида
+ */
+BOOST_AUTO_TEST_CASE(ExpressionMatchesBuiltin)
+{
+    BOOST_TEST_MESSAGE("Testing expression integrand...");
+
+    IntegrandSpec integrand{INTEGRAND_EXPRESSION, 0.0, expression::compile("exp(-x) / log(x)")};
+    BOOST_CHECK_EQUAL(integrand.expression.source, "exp(-x)/log(x)");
+
+    BasicSimpsonsRule<integrands::Expression> expression_rule;
+    BasicSimpsonsRule<integrands::ExpOverLog> builtin_rule;
+
+    double result = expression_rule.integrate_partial(2.0, 10.0, 1e-4, integrand, CancellationToken::none()).value;
+    BOOST_CHECK_CLOSE(result, builtin_rule.integrate(2.0, 10.0, 1e-4), 1e-10);
+
+    // Целые степени вычисляются умножениями
+    integrand.expression = expression::compile("1/log(x)^2");
+    result = expression_rule.integrate_partial(2.0, 10.0, 1e-4, integrand, CancellationToken::none()).value;
+    BOOST_CHECK_CLOSE(result, 3.66288098741529, 1e-4);
+}
+
+/**
+ * @brief Интерпретатор вычисляет выражения над блоками любой длины
+ */
+BOOST_AUTO_TEST_CASE(ExpressionInterpreter)
+{
+    expression::Interpreter interpreter(expression::compile("2^3 * x - sqrt(x) + abs(-x)^0.5 + sin(pi/2)"));
+
+    std::vector<double> x(1000);
+    std::vector<double> y(x.size());
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        x[i] = 0.5 + i;
+    }
+    interpreter.evaluate_block(x.data(), y.data(), x.size());
+
+    for (size_t i = 0; i < x.size(); i += 97)
+    {
+        BOOST_CHECK_CLOSE(y[i], 8.0 * x[i] + 1.0, 1e-12);
+    }
+    BOOST_CHECK_CLOSE(interpreter.evaluate(4.0), 33.0, 1e-12);
+}
+
+/**
+ * @brief Ошибки разбора и области определения выражений
+ */
+BOOST_AUTO_TEST_CASE(ExpressionErrors)
+{
+    BOOST_CHECK_THROW(expression::compile(""), std::invalid_argument);
+    BOOST_CHECK_THROW(expression::compile("log(x"), std::invalid_argument);
+    BOOST_CHECK_THROW(expression::compile("foo(x)"), std::invalid_argument);
+    BOOST_CHECK_THROW(expression::compile("x y"), std::invalid_argument);
+
+    ExpressionTape inverse_log = expression::compile("1/log(x)");
+    BOOST_CHECK(expression::is_valid_domain(inverse_log, 2.0, 1000.0));
+    BOOST_CHECK(expression::is_valid_domain(inverse_log, 0.1, 0.9));
+    BOOST_CHECK(!expression::is_valid_domain(inverse_log, 0.5, 2.0));
+    BOOST_CHECK(!expression::is_valid_domain(inverse_log, 1.0, 2.0));
+    BOOST_CHECK(!expression::is_valid_domain(expression::compile("sqrt(x - 3)"), 2.0, 4.0));
+    BOOST_CHECK(expression::is_valid_domain(expression::compile("sqrt(x - 3)"), 3.0, 4.0));
+
+    // Интервальная оценка на частях отрезка снимает завышение оценки x - x
+    BOOST_CHECK(expression::is_valid_domain(expression::compile("1/(x - x + 1)"), 2.0, 3.0));
+
+    // Испорченный байткод не выполняется
+    ExpressionTape broken = inverse_log;
+    broken.code.push_back(expression::encode(expression::OP_ADD));
+    BOOST_CHECK_THROW(expression::Interpreter{broken}, std::invalid_argument);
+    broken.code = {expression::encode(expression::OP_CONST, 7)};
+    BOOST_CHECK_THROW(expression::Interpreter{broken}, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Кооперативная отмена вычислений
+BOOST_AUTO_TEST_SUITE(CancellationTests)
+
+/**
+ * @brief Без отмены integrate_partial() проходит весь отрезок
+ */
+BOOST_AUTO_TEST_CASE(PartialWithoutCancellation)
+{
+    BOOST_TEST_MESSAGE("Testing integrate_partial() without cancellation...");
+
+    std::unique_ptr<IIntegrationStrategy> strategies[] = {
+        std::make_unique<TrapezoidalRule>(),
+        std::make_unique<SimpsonsRule>()};
+
+    for (const auto &strategy : strategies)
+    {
+        CancellationToken token;
+        PartialIntegral result = strategy->integrate_partial(2.0, 3.0, 0.01, token);
+
+        BOOST_CHECK(result.complete);
+        BOOST_CHECK_EQUAL(result.end, 3.0);
+        BOOST_CHECK_EQUAL(result.value, strategy->integrate(2.0, 3.0, 0.01));
+    }
+}
+
+/**
+ * @brief Отмена до начала вычислений возвращает пустую пройденную часть
+ */
+BOOST_AUTO_TEST_CASE(CancelledBeforeStart)
+{
+    BOOST_TEST_MESSAGE("Testing integrate_partial() with a cancelled token...");
+
+    std::unique_ptr<IIntegrationStrategy> strategies[] = {
+        std::make_unique<TrapezoidalRule>(),
+        std::make_unique<SimpsonsRule>()};
+
+    for (const auto &strategy : strategies)
+    {
+        CancellationToken token;
+        token.cancel();
+
+        PartialIntegral result = strategy->integrate_partial(2.0, 3.0, 0.01, token);
+
+        BOOST_CHECK(!result.complete);
+        BOOST_CHECK_EQUAL(result.end, 2.0);
+        BOOST_CHECK_EQUAL(result.value, 0.0);
+    }
+}
+
+/**
+ * @brief Пройденная часть и досчитанный остаток дают полный интеграл
+ */
+BOOST_AUTO_TEST_CASE(CancelledWhileRunning)
+{
+    BOOST_TEST_MESSAGE("Testing cancellation of a running integration...");
+
+    std::unique_ptr<IIntegrationStrategy> strategies[] = {
+        std::make_unique<TrapezoidalRule>(),
+        std::make_unique<SimpsonsRule>()};
+
+    double lower = 2.0;
+    double upper = 1000.0;
+    double step = 1e-5;
+
+    for (const auto &strategy : strategies)
+    {
+        CancellationToken token;
+        std::thread canceller([&token]()
+                              {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            token.cancel(); });
+
+        PartialIntegral partial = strategy->integrate_partial(lower, upper, step, token);
+        canceller.join();
+
+        BOOST_TEST_MESSAGE(strategy->get_method_name() << " stopped at " << partial.end);
+
+        double total = partial.value;
+        if (!partial.complete)
+        {
+            BOOST_CHECK(partial.end > lower && partial.end < upper);
+            total += strategy->integrate(partial.end, upper, step);
+        }
+
+        BOOST_CHECK_CLOSE(total, strategy->integrate(lower, upper, step), 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Накопители сумм узлов
+BOOST_AUTO_TEST_SUITE(AccumulatorTests)
+
+/**
+ * @brief Малые слагаемые после большого не теряются в компенсированных суммах
+ */
+BOOST_AUTO_TEST_CASE(SmallTermsAreKept)
+{
+    BOOST_TEST_MESSAGE("Testing summation of 1 + 10^6 * 1e-17...");
+
+    std::vector<double> terms(1000000, 1e-17);
+
+    PlainAccumulator plain;
+    CompensatedAccumulator compensated;
+    DoubleDoubleAccumulator double_double;
+    plain.add(1.0);
+    plain.add_block(terms.data(), terms.size());
+    compensated.add(1.0);
+    compensated.add_block(terms.data(), terms.size());
+    double_double.add(1.0);
+    double_double.add_block(terms.data(), terms.size());
+
+    // Обычная сумма теряет все слагаемые 1e-17
+    BOOST_CHECK_EQUAL(plain.scaled(1.0, 1.0).hi, 1.0);
+    BOOST_CHECK_EQUAL(plain.scaled(1.0, 1.0).lo, 0.0);
+
+    BOOST_CHECK_CLOSE(compensated.scaled(1.0, 1.0).hi, 1.0 + 1e-11, 1e-14);
+
+    DoubleDouble sum = double_double.scaled(1.0, 1.0);
+    BOOST_CHECK_CLOSE(sum.hi, 1.0 + 1e-11, 1e-14);
+    BOOST_CHECK_CLOSE(sum.lo + (sum.hi - 1.0), 1e-11, 1e-6);
+}
+
+/**
+ * @brief Масштабирование double-double сохраняет младшие разряды
+ */
+BOOST_AUTO_TEST_CASE(DoubleDoubleScaling)
+{
+    BOOST_TEST_MESSAGE("Testing double-double scaling by 1/3...");
+
+    DoubleDoubleAccumulator accumulator;
+    accumulator.add(3.0);
+    DoubleDouble third = accumulator.scaled(1.0, 3.0);
+    BOOST_CHECK_EQUAL(third.hi, 1.0);
+    BOOST_CHECK_EQUAL(third.lo, 0.0);
+
+    // 1/3 в double-double: hi + lo ближе к 1/3, чем hi
+    DoubleDouble q = accumulation::quotient(1.0, 3.0);
+    BOOST_CHECK_EQUAL(q.hi, 1.0 / 3.0);
+    BOOST_CHECK(q.lo != 0.0);
+    BOOST_CHECK_EQUAL(std::fma(-3.0, q.hi, 1.0), 3.0 * q.lo);
+}
+
+/**
+ * @brief Методы с компенсированными накопителями согласуются с обычными и между собой
+ */
+BOOST_AUTO_TEST_CASE(KernelsWithAccumulators)
+{
+    BOOST_TEST_MESSAGE("Testing Simpson and trapezoidal rules with each accumulator...");
+
+    const IntegrandSpec spec{INTEGRAND_INV_LOG, 0.0, {}};
+    const double lower = 2.0;
+    const double upper = 1000.0;
+    const double step = 1e-4;
+    CancellationToken token;
+
+    PartialIntegral plain = BasicSimpsonsRule<integrands::InverseLog>().integrate_partial(lower, upper, step, spec, token);
+    PartialIntegral compensated = BasicSimpsonsRule<integrands::InverseLog, CompensatedAccumulator>()
+                                      .integrate_partial(lower, upper, step, spec, token);
+    PartialIntegral double_double = BasicSimpsonsRule<integrands::InverseLog, DoubleDoubleAccumulator>()
+                                        .integrate_partial(lower, upper, step, spec, token);
+
+    // Обычный накопитель совпадает с прежним методом побитово
+    BOOST_CHECK_EQUAL(plain.value, SimpsonsRule().integrate(lower, upper, step));
+    BOOST_CHECK_EQUAL(plain.value_low, 0.0);
+    BOOST_CHECK_EQUAL(compensated.value_low, 0.0);
+
+    // Компенсированная сумма отличается от double-double не больше чем на округление результата
+    BOOST_CHECK_LE(std::abs(compensated.value - (double_double.value + double_double.value_low)),
+                   2.0 * std::numeric_limits<double>::epsilon() * double_double.value);
+    BOOST_CHECK_CLOSE(plain.value, double_double.value, 1e-10);
+
+    PartialIntegral trapezoid = BasicTrapezoidalRule<integrands::InverseLog, DoubleDoubleAccumulator>()
+                                    .integrate_partial(lower, upper, step, spec, token);
+    BOOST_CHECK(trapezoid.complete);
+    BOOST_CHECK_CLOSE(trapezoid.value, TrapezoidalRule().integrate(lower, upper, step), 1e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Вычисление значений в float32
+BOOST_AUTO_TEST_SUITE(SinglePrecisionTests)
+
+/**
+ * @brief Погрешность значений не больше SINGLE_PRECISION_TOLERANCE, в том числе у x = 1
+ */
+BOOST_AUTO_TEST_CASE(ErrorBoundHolds)
+{
+    BOOST_TEST_MESSAGE("Testing float32 evaluation of 1/ln(x)...");
+
+    const IntegrandSpec spec{INTEGRAND_INV_LOG, 0.0, {}};
+    const integrands::InverseLog exact(spec);
+    const integrands::SinglePrecision<integrands::InverseLog> single(spec);
+    BOOST_CHECK(integrands::supports_single_precision(INTEGRAND_INV_LOG));
+    BOOST_CHECK(!integrands::supports_single_precision(INTEGRAND_EXPRESSION));
+
+    // Точки по всему диапазону и густо вокруг особенности
+    std::vector<double> xs;
+    for (double x = 1e-3; x < 1e9; x *= 1.001)
+    {
+        xs.push_back(x);
+    }
+    for (double d = 1e-9; d < 0.5; d *= 1.01)
+    {
+        xs.push_back(1.0 - d);
+        xs.push_back(1.0 + d);
+    }
+
+    std::vector<double> ys(xs.size());
+    single.evaluate_block(xs.data(), ys.data(), xs.size());
+
+    double max_error = 0.0;
+    for (size_t i = 0; i < xs.size(); ++i)
+    {
+        double expected = exact.evaluate(xs[i]);
+        double error = std::abs(ys[i] - expected) / std::abs(expected);
+        max_error = std::max(max_error, error);
+        BOOST_CHECK_EQUAL(ys[i], single.evaluate(xs[i]));
+    }
+    BOOST_TEST_MESSAGE("Max relative error: " << max_error);
+    BOOST_CHECK_LE(max_error, integrands::SINGLE_PRECISION_TOLERANCE);
+    BOOST_CHECK_GT(max_error, 1e-9);
+}
+
+/**
+ * @brief Интеграл в float32 близок к интегралу в double
+ */
+BOOST_AUTO_TEST_CASE(KernelsInSinglePrecision)
+{
+    BOOST_TEST_MESSAGE("Testing Simpson and trapezoidal rules with float32 evaluation...");
+
+    using Single = integrands::SinglePrecision<integrands::InverseLog>;
+    const IntegrandSpec spec{INTEGRAND_INV_LOG, 0.0, {}};
+    CancellationToken token;
+
+    // Второй отрезок подходит к особенности, где значения пересчитываются в double
+    const double ranges[][2] = {{2.0, 1000.0}, {1.0 + 1e-6, 3.0}};
+    for (const auto &range : ranges)
+    {
+        double single = BasicSimpsonsRule<Single, CompensatedAccumulator>()
+                            .integrate_partial(range[0], range[1], 1e-4, spec, token)
+                            .value;
+        double reference = BasicSimpsonsRule<integrands::InverseLog, CompensatedAccumulator>()
+                               .integrate_partial(range[0], range[1], 1e-4, spec, token)
+                               .value;
+        BOOST_CHECK_CLOSE(single, reference, 1e-4);
+
+        double trapezoid = BasicTrapezoidalRule<Single>().integrate_partial(range[0], range[1], 1e-4, spec, token).value;
+        BOOST_CHECK_CLOSE(trapezoid, TrapezoidalRule().integrate(range[0], range[1], 1e-4), 1e-4);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
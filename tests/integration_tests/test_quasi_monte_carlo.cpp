@@ -0,0 +1,375 @@
+#define BOOST_TEST_MODULE QuasiMonteCarloTests
+#include <boost/test/included/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "exact_sum.h"
+#include "expression.h"
+#include "quasi_monte_carlo.h"
+#include "simpsons_rule.h"
+#include "sobol_sequence.h"
+
+/**
+ * @file test_quasi_monte_carlo.cpp
+ * @brief Модульные тесты для последовательности Соболя и метода квази-Монте-Карло
+ */
+
+namespace
+{
+    /**
+     * @brief Функция-выражение для задачи
+     */
+    IntegrandSpec expression_integrand(const std::string &source)
+    {
+        return {INTEGRAND_EXPRESSION, 0.0, expression::compile(source)};
+    }
+
+    /**
+     * @brief Единичный куб заданной размерности
+     */
+    QmcSampling unit_cube(uint32_t dimensions, uint32_t replica = 0)
+    {
+        QmcSampling sampling;
+        sampling.lower.assign(dimensions, 0.0);
+        sampling.upper.assign(dimensions, 1.0);
+        sampling.seed = 12345;
+        sampling.replica = replica;
+        return sampling;
+    }
+} // namespace
+
+// Последовательность Соболя
+BOOST_AUTO_TEST_SUITE(SobolTests)
+
+/**
+ * @brief Первые 2^m точек в каждом измерении попадают по одной в каждый отрезок длины 2^-m
+ */
+BOOST_AUTO_TEST_CASE(EachDimensionIsStratified)
+{
+    const size_t count = 1024;
+    SobolSequence sequence(SobolSequence::MAX_DIMENSIONS, 7, 3);
+    std::vector<double> points(SobolSequence::MAX_DIMENSIONS * count);
+    sequence.generate(0, count, points.data(), count);
+
+    for (uint32_t d = 0; d < SobolSequence::MAX_DIMENSIONS; ++d)
+    {
+        std::vector<int> cells(count, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            double x = points[d * count + i];
+            BOOST_REQUIRE(x > 0.0 && x < 1.0);
+            cells[static_cast<size_t>(x * count)]++;
+        }
+        BOOST_CHECK_MESSAGE(std::all_of(cells.begin(), cells.end(), [](int c)
+                                        { return c == 1; }),
+                            "dimension " << d + 1 << " is not stratified");
+    }
+}
+
+/**
+ * @brief Первые два измерения образуют (0, m, 2)-сеть: по точке в каждом элементарном прямоугольнике
+ */
+BOOST_AUTO_TEST_CASE(FirstTwoDimensionsFormNet)
+{
+    const uint32_t m = 10;
+    const size_t count = size_t{1} << m;
+    SobolSequence sequence(2, 99, 0);
+    std::vector<double> points(2 * count);
+    sequence.generate(0, count, points.data(), count);
+
+    for (uint32_t a = 0; a <= m; ++a)
+    {
+        const size_t columns = size_t{1} << a;
+        const size_t rows = size_t{1} << (m - a);
+        std::vector<int> cells(count, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t column = static_cast<size_t>(points[i] * columns);
+            size_t row = static_cast<size_t>(points[count + i] * rows);
+            cells[column * rows + row]++;
+        }
+        BOOST_CHECK_MESSAGE(std::all_of(cells.begin(), cells.end(), [](int c)
+                                        { return c == 1; }),
+                            "2^" << a << " x 2^" << m - a << " rectangles are not filled once");
+    }
+}
+
+/**
+ * @brief Точки, вычисленные с пропуском вперёд, совпадают с последовательными
+ */
+BOOST_AUTO_TEST_CASE(SkipAheadMatchesSequential)
+{
+    const size_t count = 1000;
+    const size_t skip = 437;
+    SobolSequence sequence(5, 1, 2);
+
+    std::vector<double> all(5 * count);
+    sequence.generate(0, count, all.data(), count);
+
+    std::vector<double> tail(5 * (count - skip));
+    sequence.generate(skip, count - skip, tail.data(), count - skip);
+
+    for (size_t d = 0; d < 5; ++d)
+    {
+        for (size_t i = skip; i < count; ++i)
+        {
+            BOOST_REQUIRE_EQUAL(all[d * count + i], tail[d * (count - skip) + i - skip]);
+        }
+    }
+}
+
+/**
+ * @brief Реплики скремблированы по-разному, одинаковые параметры дают одинаковые точки
+ */
+BOOST_AUTO_TEST_CASE(ReplicasAreIndependent)
+{
+    std::vector<double> a(3 * 16);
+    std::vector<double> b(3 * 16);
+    std::vector<double> c(3 * 16);
+    SobolSequence(3, 5, 0).generate(0, 16, a.data(), 16);
+    SobolSequence(3, 5, 1).generate(0, 16, b.data(), 16);
+    SobolSequence(3, 5, 0).generate(0, 16, c.data(), 16);
+
+    BOOST_CHECK(a != b);
+    BOOST_CHECK(a == c);
+}
+
+/**
+ * @brief Некорректная размерность
+ */
+BOOST_AUTO_TEST_CASE(InvalidDimensions)
+{
+    BOOST_CHECK_THROW(SobolSequence(0, 0, 0), std::invalid_argument);
+    BOOST_CHECK_THROW(SobolSequence(SobolSequence::MAX_DIMENSIONS + 1, 0, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Метод квази-Монте-Карло
+BOOST_AUTO_TEST_SUITE(QuasiMonteCarloTests)
+
+/**
+ * @brief Интеграл многочлена по кубу
+ */
+BOOST_AUTO_TEST_CASE(IntegratePolynomialOverCube)
+{
+    const uint64_t points = 1 << 16;
+    QmcSampling sampling = unit_cube(3);
+
+    BasicQuasiMonteCarlo<integrands::Expression> qmc;
+    QmcPartial partial = qmc.integrate_partial(0, points, sampling, expression_integrand("x1*x2*x3"),
+                                               CancellationToken::none());
+
+    BOOST_CHECK(partial.complete);
+    BOOST_CHECK_EQUAL(partial.end, points);
+    BOOST_CHECK_SMALL(partial.sum / points - 0.125, 1e-4);
+    // Среднее квадрата: (1/3)^3
+    BOOST_CHECK_SMALL(partial.sum_squares / points - 1.0 / 27.0, 1e-4);
+}
+
+/**
+ * @brief Интеграл по области, отличной от единичного куба, учитывает её объём
+ */
+BOOST_AUTO_TEST_CASE(IntegrateOverBox)
+{
+    const uint64_t points = 1 << 16;
+    QmcSampling sampling;
+    sampling.lower = {2.0, -1.0};
+    sampling.upper = {3.0, 1.0};
+
+    BasicQuasiMonteCarlo<integrands::Expression> qmc;
+    QmcPartial partial = qmc.integrate_partial(0, points, sampling, expression_integrand("x1 + x2^2"),
+                                               CancellationToken::none());
+
+    // Интеграл: (2.5 * 2) + (2/3) = 5.666...
+    double estimate = sampling.volume() * partial.sum / points;
+    BOOST_CHECK_CLOSE(estimate, 5.0 + 2.0 / 3.0, 0.01);
+}
+
+/**
+ * @brief Одномерная функция из реестра совпадает с методом Симпсона
+ */
+BOOST_AUTO_TEST_CASE(BuiltinIntegrandMatchesSimpson)
+{
+    const uint64_t points = 1 << 18;
+    QmcSampling sampling;
+    sampling.lower = {2.0};
+    sampling.upper = {10.0};
+
+    BasicQuasiMonteCarlo<integrands::InverseLog> qmc;
+    QmcPartial partial = qmc.integrate_partial(0, points, sampling, IntegrandSpec{}, CancellationToken::none());
+
+    double expected = SimpsonsRule().integrate(2.0, 10.0, 1e-3);
+    BOOST_CHECK_CLOSE(sampling.volume() * partial.sum / points, expected, 1e-3);
+}
+
+/**
+ * @brief Суммы отрезков точек складываются в сумму всего отрезка
+ */
+BOOST_AUTO_TEST_CASE(ChunkSumsAddUp)
+{
+    QmcSampling sampling = unit_cube(4, 2);
+    IntegrandSpec integrand = expression_integrand("exp(-(x1+x2+x3+x4))");
+    BasicQuasiMonteCarlo<integrands::Expression> qmc;
+
+    QmcPartial whole = qmc.integrate_partial(0, 100000, sampling, integrand, CancellationToken::none());
+    QmcPartial head = qmc.integrate_partial(0, 31337, sampling, integrand, CancellationToken::none());
+    QmcPartial tail = qmc.integrate_partial(31337, 100000, sampling, integrand, CancellationToken::none());
+
+    BOOST_CHECK_CLOSE(head.sum + tail.sum, whole.sum, 1e-10);
+    BOOST_CHECK_CLOSE(head.sum_squares + tail.sum_squares, whole.sum_squares, 1e-10);
+}
+
+/**
+ * @brief Оценки независимых реплик близки и отличаются друг от друга
+ */
+BOOST_AUTO_TEST_CASE(ReplicasGiveIndependentEstimates)
+{
+    const uint64_t points = 1 << 14;
+    IntegrandSpec integrand = expression_integrand("sqrt(x1) * cos(x2)");
+    BasicQuasiMonteCarlo<integrands::Expression> qmc;
+
+    // Интеграл: (2/3) * sin(1)
+    const double expected = 2.0 / 3.0 * std::sin(1.0);
+    std::vector<double> estimates;
+    for (uint32_t replica = 0; replica < 4; ++replica)
+    {
+        QmcPartial partial = qmc.integrate_partial(0, points, unit_cube(2, replica), integrand,
+                                                   CancellationToken::none());
+        estimates.push_back(partial.sum / points);
+        BOOST_CHECK_SMALL(estimates.back() - expected, 1e-3);
+    }
+
+    BOOST_CHECK(estimates[0] != estimates[1]);
+}
+
+/**
+ * @brief Отмена до начала вычислений возвращает пустую часть
+ */
+BOOST_AUTO_TEST_CASE(CancelledBeforeStart)
+{
+    CancellationToken token;
+    token.cancel();
+
+    BasicQuasiMonteCarlo<integrands::Expression> qmc;
+    QmcPartial partial = qmc.integrate_partial(100, 50000, unit_cube(2), expression_integrand("x1*x2"), token);
+
+    BOOST_CHECK(!partial.complete);
+    BOOST_CHECK_EQUAL(partial.end, 100u);
+    BOOST_CHECK_EQUAL(partial.sum, 0.0);
+}
+
+/**
+ * @brief Некорректные параметры
+ */
+BOOST_AUTO_TEST_CASE(InvalidParameters)
+{
+    BasicQuasiMonteCarlo<integrands::Expression> qmc;
+    IntegrandSpec integrand = expression_integrand("x1*x2");
+
+    // Пустой отрезок точек
+    BOOST_CHECK_THROW(qmc.integrate_partial(10, 10, unit_cube(2), integrand, CancellationToken::none()),
+                      std::invalid_argument);
+    // Выражение зависит от x2, а область одномерная
+    BOOST_CHECK_THROW(qmc.integrate_partial(0, 10, unit_cube(1), integrand, CancellationToken::none()),
+                      std::invalid_argument);
+    // Функция одной переменной в двумерной области
+    QmcSampling box = unit_cube(2);
+    box.lower = {2.0, 2.0};
+    box.upper = {3.0, 3.0};
+    BOOST_CHECK_THROW(BasicQuasiMonteCarlo<integrands::InverseLog>().integrate_partial(
+                          0, 10, box, IntegrandSpec{}, CancellationToken::none()),
+                      std::invalid_argument);
+    // Особенность внутри области
+    BOOST_CHECK_THROW(qmc.integrate_partial(0, 10, unit_cube(2), expression_integrand("1/(x1-x2)"),
+                                            CancellationToken::none()),
+                      std::invalid_argument);
+}
+
+/**
+ * @brief Переменные выражений и их области определения
+ */
+BOOST_AUTO_TEST_CASE(ExpressionVariables)
+{
+    ExpressionTape tape = expression::compile("log(x1 + x2) * x4");
+    BOOST_CHECK_EQUAL(expression::variable_count(tape), 4u);
+    BOOST_CHECK_EQUAL(expression::variable_count(expression::compile("x * x1")), 1u);
+    BOOST_CHECK_THROW(expression::compile("x33"), std::invalid_argument);
+    BOOST_CHECK_THROW(expression::compile("x0"), std::invalid_argument);
+
+    std::vector<double> lower = {0.0, 0.0, 0.0, 0.0};
+    std::vector<double> upper = {1.0, 1.0, 1.0, 1.0};
+    BOOST_CHECK(!expression::is_valid_domain(tape, lower, upper));
+
+    lower[1] = 0.5;
+    BOOST_CHECK(expression::is_valid_domain(tape, lower, upper));
+    // Переменной x4 нет в трёхмерной области
+    BOOST_CHECK(!expression::is_valid_domain(tape, {0.0, 0.5, 0.0}, {1.0, 1.0, 1.0}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Точное суммирование частичных результатов
+BOOST_AUTO_TEST_SUITE(ExactSumTests)
+
+/**
+ * @brief Сумма не теряет младшие разряды
+ */
+BOOST_AUTO_TEST_CASE(NoCancellationError)
+{
+    ExactSum sum;
+    sum.add(1e16);
+    sum.add(1.0);
+    sum.add(-1e16);
+    BOOST_CHECK_EQUAL(sum.value(), 1.0);
+
+    ExactSum tenths;
+    for (int i = 0; i < 10; ++i)
+    {
+        tenths.add(0.1);
+    }
+    BOOST_CHECK_EQUAL(tenths.value(), 1.0);
+}
+
+/**
+ * @brief Результат не зависит от порядка слагаемых
+ */
+BOOST_AUTO_TEST_CASE(OrderIndependent)
+{
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+
+    std::vector<double> values(5000);
+    for (double &value : values)
+    {
+        value = std::ldexp(mantissa(random), exponent(random));
+    }
+
+    ExactSum forward;
+    for (double value : values)
+    {
+        forward.add(value);
+    }
+
+    for (int attempt = 0; attempt < 5; ++attempt)
+    {
+        std::shuffle(values.begin(), values.end(), random);
+
+        // Сумма, собранная из двух частей, как результаты разных клиентов
+        ExactSum first;
+        ExactSum second;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            (i % 3 == 0 ? first : second).add(values[i]);
+        }
+        first.add(second);
+
+        BOOST_CHECK_EQUAL(first.value(), forward.value());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,256 @@
+#define BOOST_TEST_MODULE BatchRunnerTests
+#include <boost/test/included/unit_test.hpp>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "batch_runner.h"
+#include "logger.h"
+
+/**
+ * @file test_batch_runner.cpp
+ * @brief Тесты пакетного режима: разбора файла заданий, уточнения шага и файлов итогов
+ */
+
+namespace
+{
+    /**
+     * @brief Инициализирует логгер один раз на все тесты
+     */
+    struct LoggingFixture
+    {
+        LoggingFixture() { logging::init("test_batch_runner", spdlog::level::warn); }
+        ~LoggingFixture() { logging::shutdown(); }
+    };
+
+    /**
+     * @brief Обработчик команд, отвечающий как сервер с заданием I(h) = 1 + h^4
+     *
+     * BATCH отвечает значением и двумя ответами на запросы, задание с шагом 3 - ошибкой
+     */
+    struct FakeServer
+    {
+        std::vector<std::string> requests;
+        std::vector<double> steps;
+
+        void operator()(const std::string &request, BatchRunner::Reply reply)
+        {
+            requests.push_back(request);
+            std::istringstream iss(request);
+            std::string command;
+            iss >> command;
+
+            if (command == "WAIT")
+            {
+                double step = steps.back();
+                if (step == 3.0)
+                {
+                    reply("ERROR Invalid integration parameters");
+                }
+                else if (request == "WAIT 100")
+                {
+                    reply("OK 3.5 0.250 1.5 2");
+                }
+                else
+                {
+                    std::ostringstream oss;
+                    oss.precision(17);
+                    oss << "OK " << 1.0 + std::pow(step, 4) << " 0.125";
+                    reply(oss.str());
+                }
+                return;
+            }
+
+            double lower = 0.0;
+            double upper = 0.0;
+            double step = 0.0;
+            if (command == "BATCH")
+            {
+                iss >> step;
+                steps.push_back(step);
+                reply("OK 100");
+                return;
+            }
+            iss >> lower >> upper >> step;
+            steps.push_back(step);
+            reply("OK " + std::to_string(steps.size()));
+        }
+    };
+} // namespace
+
+BOOST_GLOBAL_FIXTURE(LoggingFixture);
+
+BOOST_AUTO_TEST_SUITE(BatchRunnerTests)
+
+BOOST_AUTO_TEST_CASE(ParsesJobFile)
+{
+    std::istringstream input("# comment\n"
+                             "\n"
+                             "SUBMIT 2 1000 0.001\n"
+                             "  submit 2 1000 tol=1e-9 1 0 trapezoidal\r\n"
+                             "BATCH 0.001 2:10,10:100\n");
+    auto entries = BatchRunner::parse(input);
+
+    BOOST_REQUIRE_EQUAL(entries.size(), 3u);
+    BOOST_CHECK_EQUAL(entries[0].line, 3u);
+    BOOST_CHECK_EQUAL(entries[0].tolerance, 0.0);
+    BOOST_CHECK_EQUAL(entries[1].line, 4u);
+    BOOST_CHECK_EQUAL(entries[1].command, "submit 2 1000 tol=1e-9 1 0 trapezoidal");
+    BOOST_CHECK_EQUAL(entries[1].tolerance, 1e-9);
+    BOOST_CHECK_EQUAL(entries[2].command, "BATCH 0.001 2:10,10:100");
+}
+
+BOOST_AUTO_TEST_CASE(RejectsInvalidLines)
+{
+    std::istringstream shutdown("SUBMIT 2 1000 0.001\nSHUTDOWN\n");
+    BOOST_CHECK_THROW(BatchRunner::parse(shutdown), std::runtime_error);
+
+    std::istringstream negative("SUBMIT 2 1000 tol=-1\n");
+    BOOST_CHECK_THROW(BatchRunner::parse(negative), std::runtime_error);
+
+    // Точность задаётся только для SUBMIT
+    std::istringstream scan("SCAN 2 1000 tol=1e-9 16 table.bin\n");
+    BOOST_CHECK_THROW(BatchRunner::parse(scan), std::runtime_error);
+
+    BOOST_CHECK_THROW(BatchRunner::parse_file("missing_jobs.txt"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(RunsJobsInOrder)
+{
+    FakeServer server;
+    BatchRunner runner([&server](const std::string &request, BatchRunner::Reply reply)
+                       { server(request, std::move(reply)); });
+
+    std::istringstream input("SUBMIT 0 1 0.25\n"
+                             "BATCH 0.001 0:1,1:2\n"
+                             "SUBMIT 0 1 3\n");
+    auto rows = runner.run(BatchRunner::parse(input));
+
+    BOOST_REQUIRE_EQUAL(rows.size(), 3u);
+    BOOST_CHECK(rows[0].success);
+    BOOST_CHECK_EQUAL(rows[0].step, 0.25);
+    BOOST_CHECK_CLOSE(rows[0].value, 1.0 + std::pow(0.25, 4), 1e-6);
+    BOOST_CHECK_EQUAL(rows[0].elapsed_seconds, 0.125);
+    BOOST_CHECK_EQUAL(rows[0].refinements, 1u);
+
+    BOOST_CHECK(rows[1].success);
+    BOOST_CHECK_EQUAL(rows[1].job_id, 100u);
+    BOOST_CHECK(rows[1].extra == std::vector<double>({1.5, 2.0}));
+
+    // Ошибка одного задания не прерывает остальные
+    BOOST_CHECK(!rows[2].success);
+    BOOST_CHECK_EQUAL(rows[2].error_message, "Invalid integration parameters");
+
+    // Каждое задание отправляется после завершения предыдущего
+    BOOST_CHECK_EQUAL(server.requests[0], "SUBMIT 0 1 0.25");
+    BOOST_CHECK_EQUAL(server.requests[1], "WAIT 1");
+    BOOST_CHECK_EQUAL(server.requests[2], "BATCH 0.001 0:1,1:2");
+}
+
+BOOST_AUTO_TEST_CASE(HalvesStepUntilTolerance)
+{
+    FakeServer server;
+    BatchRunner runner([&server](const std::string &request, BatchRunner::Reply reply)
+                       { server(request, std::move(reply)); });
+
+    std::istringstream input("SUBMIT 0 1024 tol=1e-3 1 0 simpson\n");
+    auto rows = runner.run(BatchRunner::parse(input));
+
+    BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+    const BatchRow &row = rows[0];
+    BOOST_REQUIRE_MESSAGE(row.success, row.error_message);
+
+    // Шаги 1, 1/2, 1/4, ...: оценка (h^4 - (h/2)^4) / 15 падает ниже 1e-3 при h = 1/8
+    BOOST_CHECK(server.steps == std::vector<double>({1.0, 0.5, 0.25, 0.125}));
+    BOOST_CHECK_EQUAL(row.refinements, 4u);
+    BOOST_CHECK_EQUAL(row.step, 0.125);
+    BOOST_CHECK_LE(row.error_estimate, 1e-3);
+    BOOST_CHECK_CLOSE(row.elapsed_seconds, 0.5, 1e-9);
+    BOOST_CHECK_EQUAL(server.requests[0], "SUBMIT 0 1024 1 1 0 simpson");
+}
+
+BOOST_AUTO_TEST_CASE(WritesCsvAndColumnarFiles)
+{
+    BatchRow ok;
+    ok.line = 2;
+    ok.command = "BATCH 0.001 \"quoted\"";
+    ok.job_id = 7;
+    ok.success = true;
+    ok.value = 1.25;
+    ok.refinements = 1;
+    ok.extra = {0.5, 0.75};
+
+    BatchRow failed;
+    failed.line = 3;
+    failed.error_message = "Unknown integrand";
+
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string csv_path = (dir / "batch_runner_test.csv").string();
+    const std::string bin_path = (dir / "batch_runner_test.bin").string();
+    BatchRunner::write_csv(csv_path, {ok, failed});
+    BatchRunner::write_columnar(bin_path, {ok, failed});
+
+    std::ifstream csv(csv_path);
+    std::string header;
+    std::string first;
+    std::string second;
+    std::getline(csv, header);
+    std::getline(csv, first);
+    std::getline(csv, second);
+    BOOST_CHECK_EQUAL(header.substr(0, 20), "line,command,job_id,");
+    BOOST_CHECK(first.find("\"BATCH 0.001 \"\"quoted\"\"\"") != std::string::npos);
+    BOOST_CHECK(first.find("0.5;0.75") != std::string::npos);
+    BOOST_CHECK(second.find("\"Unknown integrand\"") != std::string::npos);
+
+    // Двоичный файл: заголовок, затем колонки с названием и числом значений
+    std::ifstream bin(bin_path, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(bin)), std::istreambuf_iterator<char>());
+    BOOST_REQUIRE_GE(data.size(), 12u);
+    BOOST_CHECK_EQUAL(std::string(data.data(), 8), "DIRESULT");
+
+    uint32_t columns = 0;
+    std::memcpy(&columns, data.data() + 8, sizeof(columns));
+    BOOST_REQUIRE_EQUAL(columns, 11u);
+
+    size_t offset = 12;
+    std::vector<std::string> names;
+    std::vector<double> values;
+    for (uint32_t i = 0; i < columns; ++i)
+    {
+        uint8_t type = static_cast<uint8_t>(data[offset]);
+        uint8_t length = static_cast<uint8_t>(data[offset + 1]);
+        names.emplace_back(data.data() + offset + 2, length);
+        offset += 2 + length;
+
+        uint64_t count = 0;
+        std::memcpy(&count, data.data() + offset, sizeof(count));
+        offset += sizeof(count);
+
+        if (names.back() == "value" || names.back() == "extra")
+        {
+            BOOST_CHECK_EQUAL(type, 1);
+            for (uint64_t k = 0; k < count; ++k)
+            {
+                double value = 0.0;
+                std::memcpy(&value, data.data() + offset + k * sizeof(double), sizeof(double));
+                values.push_back(value);
+            }
+        }
+        offset += count * 8;
+    }
+
+    BOOST_CHECK_EQUAL(offset, data.size());
+    BOOST_CHECK_EQUAL(names.front(), "line");
+    BOOST_CHECK_EQUAL(names.back(), "extra");
+    BOOST_CHECK(values == std::vector<double>({1.25, 0.0, 0.5, 0.75}));
+
+    std::filesystem::remove(csv_path);
+    std::filesystem::remove(bin_path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
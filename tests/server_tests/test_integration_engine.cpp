@@ -0,0 +1,226 @@
+#define BOOST_TEST_MODULE IntegrationEngineTests
+#include <boost/test/included/unit_test.hpp>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "local_engine.h"
+#include "logger.h"
+#include "remote_engine.h"
+#include "server.h"
+
+/**
+ * @file test_integration_engine.cpp
+ * @brief Тесты встраиваемой библиотеки: локального и удалённого исполнителя
+ */
+
+namespace
+{
+    /**
+     * @brief Инициализирует логгер один раз на все тесты
+     */
+    struct LoggingFixture
+    {
+        LoggingFixture() { logging::init("test_integration_engine", spdlog::level::warn); }
+        ~LoggingFixture() { logging::shutdown(); }
+    };
+
+    /**
+     * @brief Задание по функции-выражению
+     */
+    IntegrationParameters make_params(const std::string &source, double lower, double upper, double step)
+    {
+        IntegrationParameters params{};
+        params.lower_limit = lower;
+        params.upper_limit = upper;
+        params.step = step;
+        params.integrand = {INTEGRAND_EXPRESSION, 0.0, expression::compile(source)};
+        return params;
+    }
+} // namespace
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+namespace
+{
+    /**
+     * @brief Сервер в режиме сервиса с локальным исполнителем на всех ядрах (клиенты не нужны)
+     */
+    struct ServiceUnderTest
+    {
+        explicit ServiceUnderTest(uint16_t port)
+            : socket_path((std::filesystem::temp_directory_path() /
+                           ("integration_engine_" + std::to_string(port) + ".sock"))
+                              .string())
+        {
+            ServerConfig config;
+            config.profiles_path.clear();
+            config.local_worker = true;
+            config.local_worker_reserved_cores = 0;
+            server = std::make_unique<Server>(port, config);
+
+            thread = std::thread([this]()
+                                 { server->serve(socket_path); });
+
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!std::filesystem::exists(socket_path) && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            BOOST_REQUIRE(std::filesystem::exists(socket_path));
+        }
+
+        ~ServiceUnderTest()
+        {
+            server->stop();
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+
+        std::string socket_path;
+        std::unique_ptr<Server> server;
+        std::thread thread;
+    };
+} // namespace
+
+#endif
+
+BOOST_GLOBAL_FIXTURE(LoggingFixture);
+
+// Исполнитель на ядрах текущего процесса
+BOOST_AUTO_TEST_SUITE(LocalEngineTests)
+
+BOOST_AUTO_TEST_CASE(FutureReturnsIntegral)
+{
+    LocalEngine engine(2);
+
+    IntegrationResult result = engine.submit(make_params("x * x", 0.0, 3.0, 1e-3)).get();
+    BOOST_REQUIRE_MESSAGE(result.success, result.error_message);
+    BOOST_CHECK_CLOSE(result.value, 9.0, 1e-9);
+    BOOST_CHECK_EQUAL(result.step, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentCallsShareOnePool)
+{
+    LocalEngine engine(2);
+
+    // Вызовы из разных потоков выполняются одновременно на общем пуле
+    std::vector<std::future<IntegrationResult>> futures(8);
+    std::vector<std::thread> callers;
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        callers.emplace_back([&engine, &futures, i]()
+                             { futures[i] = engine.submit(make_params("x * x", 0.0, static_cast<double>(i + 1), 1e-3)); });
+    }
+    for (auto &caller : callers)
+    {
+        caller.join();
+    }
+
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        IntegrationResult result = futures[i].get();
+        double upper = static_cast<double>(i + 1);
+        BOOST_REQUIRE_MESSAGE(result.success, result.error_message);
+        BOOST_CHECK_CLOSE(result.value, upper * upper * upper / 3.0, 1e-9);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(IntegrateReachesTolerance)
+{
+    LocalEngine engine(2);
+
+    IntegrationParameters method{};
+    method.kernel = KERNEL_TRAPEZOIDAL;
+    method.integrand = {INTEGRAND_EXPRESSION, 0.0, expression::compile("exp(x)")};
+
+    IntegrationResult result = engine.integrate(0.0, 1.0, 1e-10, method).get();
+    BOOST_REQUIRE_MESSAGE(result.success, result.error_message);
+    BOOST_CHECK_LE(result.error_estimate, 1e-10);
+    BOOST_CHECK_SMALL(result.value - (std::exp(1.0) - 1.0), 1e-9);
+    BOOST_CHECK_LT(result.step, 1.0 / IntegrationEngine::INITIAL_INTERVALS);
+}
+
+BOOST_AUTO_TEST_CASE(CallbackReceivesBatchResults)
+{
+    LocalEngine engine(2);
+
+    IntegrationParameters params = make_params("x * x", 0.0, 0.0, 1e-3);
+    params.queries = {{0.0, 3.0}, {1.0, 2.0}};
+
+    std::promise<IntegrationResult> promise;
+    engine.submit(params, [&promise](const IntegrationResult &result)
+                  { promise.set_value(result); });
+
+    IntegrationResult result = promise.get_future().get();
+    BOOST_REQUIRE_MESSAGE(result.success, result.error_message);
+    BOOST_REQUIRE_EQUAL(result.query_results.size(), 2u);
+    BOOST_CHECK_CLOSE(result.query_results[0], 9.0, 1e-9);
+    BOOST_CHECK_CLOSE(result.query_results[1], 7.0 / 3.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidCallsThrow)
+{
+    LocalEngine engine(1);
+
+    BOOST_CHECK_THROW(engine.submit(make_params("x", 0.0, 1.0, 0.0)), std::invalid_argument);
+    BOOST_CHECK_THROW(engine.integrate(0.0, 1.0, 0.0), std::invalid_argument);
+
+    IntegrationParameters scan = make_params("x", 0.0, 1.0, 1e-3);
+    scan.output_intervals = 4;
+    scan.output_path = "unused.bin";
+    BOOST_CHECK_THROW(engine.submit(scan), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+// Исполнитель, передающий задания серверу
+BOOST_AUTO_TEST_SUITE(RemoteEngineTests)
+
+BOOST_AUTO_TEST_CASE(RemoteMatchesLocal)
+{
+    ServiceUnderTest service(15571);
+    RemoteEngine remote(service.socket_path);
+    LocalEngine local(1);
+
+    IntegrationParameters params = make_params("x * x", 0.0, 3.0, 1e-3);
+    params.reduction = REDUCTION_COMPENSATED;
+    auto remote_future = remote.submit(params);
+    IntegrationResult expected = local.submit(params).get();
+    IntegrationResult actual = remote_future.get();
+    BOOST_REQUIRE_MESSAGE(actual.success, actual.error_message);
+    BOOST_CHECK_CLOSE(actual.value, expected.value, 1e-9);
+
+    IntegrationParameters batch = make_params("x * x", 0.0, 0.0, 1e-3);
+    batch.queries = {{0.0, 3.0}, {1.0, 2.0}};
+    IntegrationResult queries = remote.submit(batch).get();
+    BOOST_REQUIRE_MESSAGE(queries.success, queries.error_message);
+    BOOST_REQUIRE_EQUAL(queries.query_results.size(), 2u);
+    BOOST_CHECK_CLOSE(queries.query_results[1], 7.0 / 3.0, 1e-9);
+
+    // Параметры проверяются до отправки на сервер
+    BOOST_CHECK_THROW(remote.submit(make_params("log(x)", -1.0, 1.0, 1e-3)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(UnreachableServerReportsError)
+{
+    RemoteEngine remote((std::filesystem::temp_directory_path() / "integration_engine_missing.sock").string());
+
+    IntegrationResult result = remote.submit(make_params("x", 0.0, 1.0, 1e-3)).get();
+    BOOST_CHECK(!result.success);
+    BOOST_CHECK(result.error_message.find("Failed to connect") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
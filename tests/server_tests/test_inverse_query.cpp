@@ -0,0 +1,170 @@
+#define BOOST_TEST_MODULE InverseQueryTests
+#include <boost/test/included/unit_test.hpp>
+#include <cmath>
+#include <stdexcept>
+
+#include "integrator.h"
+#include "inverse_solver.h"
+#include "logger.h"
+
+/**
+ * @file test_inverse_query.cpp
+ * @brief Тесты обратного запроса: выбора отрезков и сходимости поиска x по значению интеграла
+ */
+
+namespace
+{
+    /**
+     * @brief Инициализирует логгер один раз на все тесты
+     */
+    struct LoggingFixture
+    {
+        LoggingFixture() { logging::init("test_inverse_query", spdlog::level::warn); }
+        ~LoggingFixture() { logging::shutdown(); }
+    };
+
+    /**
+     * @brief Точный интеграл x^2 по отрезку
+     */
+    double exact(double lower, double upper)
+    {
+        return (upper * upper * upper - lower * lower * lower) / 3.0;
+    }
+
+    /**
+     * @brief Параметры обратного запроса для функции 1/ln(x)
+     */
+    IntegrationParameters inverse_log(double lower, double target)
+    {
+        IntegrationParameters params{};
+        params.lower_limit = lower;
+        params.upper_limit = lower;
+        params.step = 0.001;
+        params.kernel = KERNEL_SIMPSON;
+        params.integrand = {INTEGRAND_INV_LOG, 0.0, {}};
+        params.inverse = true;
+        params.target = target;
+        return params;
+    }
+
+    /**
+     * @brief Вычисляет отрезок шага так же, как клиент
+     */
+    double integrate(const IntegrationParameters &params)
+    {
+        Task task;
+        task.id = 1;
+        task.kernel = params.kernel;
+        task.integrand = params.integrand;
+        task.begin = params.lower_limit;
+        task.end = params.upper_limit;
+        task.step = params.step;
+
+        Result result = Integrator().execute_task(task);
+        BOOST_REQUIRE(result.success && !result.partial);
+        return result.value;
+    }
+
+    /**
+     * @brief Выполняет шаги поиска до сходимости
+     * @return Суммарная длина вычисленных отрезков
+     */
+    double solve(InverseSolver &solver, const IntegrationParameters &params)
+    {
+        double length = 0.0;
+        while (!solver.is_converged())
+        {
+            IntegrationParameters step = solver.get_step_parameters(params);
+            BOOST_REQUIRE(integrands::is_valid_domain(step.integrand, step.lower_limit, step.upper_limit));
+            BOOST_REQUIRE_LT(step.step, step.upper_limit - step.lower_limit);
+            length += step.upper_limit - step.lower_limit;
+            solver.add(integrate(step));
+        }
+        return length;
+    }
+} // namespace
+
+BOOST_GLOBAL_FIXTURE(LoggingFixture);
+
+BOOST_AUTO_TEST_SUITE(InverseQueryTests)
+
+BOOST_AUTO_TEST_CASE(NewtonStepsReuseKnownPoints)
+{
+    IntegrationParameters params{};
+    params.lower_limit = 1.0;
+    params.step = 0.01;
+    params.integrand = {INTEGRAND_EXPRESSION, 0.0, expression::compile("x*x")};
+    params.inverse = true;
+    params.target = 100.0;
+    BOOST_REQUIRE(params.is_valid());
+
+    // Интеграл выпуклый: первый шаг Ньютона перелетает решение, дальше поиск идёт внутри вилки
+    InverseSolver solver(params);
+    double previous = 0.0;
+    while (!solver.is_converged())
+    {
+        const QueryRange interval = solver.get_interval();
+        if (solver.get_iterations() > 1)
+        {
+            // Каждый следующий отрезок короче: интегрируется только путь от ближайшей известной точки
+            BOOST_CHECK_LT(interval.upper - interval.lower, previous);
+        }
+        previous = interval.upper - interval.lower;
+        solver.add(exact(interval.lower, interval.upper));
+    }
+
+    BOOST_CHECK_CLOSE(solver.get_result(), std::cbrt(301.0), 1e-10);
+    BOOST_CHECK_LE(std::abs(solver.get_residual()), 1e-10);
+    BOOST_CHECK_LE(solver.get_iterations(), 12u);
+}
+
+BOOST_AUTO_TEST_CASE(InverseLogarithmicIntegral)
+{
+    // li(x) - li(2) = 1000
+    IntegrationParameters params = inverse_log(2.0, 1000.0);
+    BOOST_REQUIRE(params.is_valid());
+
+    InverseSolver solver(params);
+    const double length = solve(solver, params);
+    const double x = solver.get_result();
+
+    // Проверка независимым интегрированием всего отрезка
+    IntegrationParameters check = params;
+    check.upper_limit = x;
+    BOOST_CHECK_CLOSE(integrate(check), 1000.0, 1e-9);
+
+    // Вычисленные отрезки ненамного длиннее самого отрезка [2, x]
+    BOOST_CHECK_LT(length, 1.5 * (x - 2.0));
+    BOOST_CHECK_LE(solver.get_iterations(), 16u);
+}
+
+BOOST_AUTO_TEST_CASE(StepsStayInsideTheDomain)
+{
+    // Шаг Ньютона из x = 2 влево пересекает особенность x = 1 и укорачивается
+    IntegrationParameters params = inverse_log(2.0, -3.0);
+    BOOST_REQUIRE(params.is_valid());
+
+    InverseSolver solver(params);
+    BOOST_CHECK_GT(solver.get_interval().lower, 1.0);
+    solve(solver, params);
+
+    BOOST_CHECK_GT(solver.get_result(), 1.0);
+    BOOST_CHECK_LT(solver.get_result(), 2.0);
+    BOOST_CHECK_LE(std::abs(solver.get_residual()), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(RejectsInvalidQueries)
+{
+    IntegrationParameters params = inverse_log(2.0, 0.0);
+    BOOST_CHECK(!params.is_valid());
+
+    params.target = 10.0;
+    params.inverse = false;
+    BOOST_CHECK_THROW(InverseSolver{params}, std::invalid_argument);
+
+    params.inverse = true;
+    InverseSolver solver(params);
+    BOOST_CHECK_THROW(solver.add(std::nan("")), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
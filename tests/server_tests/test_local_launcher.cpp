@@ -0,0 +1,76 @@
+#define BOOST_TEST_MODULE LocalLauncherTests
+#include <boost/test/included/unit_test.hpp>
+#include <vector>
+
+#include "local_launcher.h"
+#include "logger.h"
+
+/**
+ * @file test_local_launcher.cpp
+ * @brief Тесты разбиения ядер между клиентами, запускаемыми сервером
+ */
+
+namespace
+{
+    /**
+     * @brief Инициализирует логгер один раз на все тесты
+     */
+    struct LoggingFixture
+    {
+        LoggingFixture() { logging::init("test_local_launcher", spdlog::level::warn); }
+        ~LoggingFixture() { logging::shutdown(); }
+    };
+
+    using Groups = std::vector<std::vector<int>>;
+} // namespace
+
+BOOST_GLOBAL_FIXTURE(LoggingFixture);
+
+BOOST_AUTO_TEST_SUITE(LocalLauncherTests)
+
+BOOST_AUTO_TEST_CASE(ParsesSysfsCpuLists)
+{
+    BOOST_CHECK(LocalLauncher::parse_cpu_list("0-3,8-9,12") == std::vector<int>({0, 1, 2, 3, 8, 9, 12}));
+    BOOST_CHECK(LocalLauncher::parse_cpu_list("5") == std::vector<int>({5}));
+    BOOST_CHECK(LocalLauncher::parse_cpu_list("").empty());
+    BOOST_CHECK(LocalLauncher::parse_cpu_list("3-1").empty());
+    BOOST_CHECK(LocalLauncher::parse_cpu_list("a-b").empty());
+}
+
+BOOST_AUTO_TEST_CASE(OneClientPerNode)
+{
+    Groups nodes = {{0, 1, 2, 3}, {4, 5, 6, 7}};
+    BOOST_CHECK(LocalLauncher::split_cpus(nodes, 2) == nodes);
+
+    // Меньше клиентов, чем узлов: каждый получает соседние узлы целиком
+    Groups four = {{0, 1}, {2, 3}, {4, 5}, {6, 7}};
+    BOOST_CHECK(LocalLauncher::split_cpus(four, 2) == Groups({{0, 1, 2, 3}, {4, 5, 6, 7}}));
+    BOOST_CHECK(LocalLauncher::split_cpus(four, 1) == Groups({{0, 1, 2, 3, 4, 5, 6, 7}}));
+}
+
+BOOST_AUTO_TEST_CASE(SeveralClientsPerNode)
+{
+    // Число клиентов кратно числу узлов: группы не пересекают границы узлов
+    Groups nodes = {{0, 1, 2, 3}, {4, 5, 6, 7}};
+    BOOST_CHECK(LocalLauncher::split_cpus(nodes, 4) == Groups({{0, 1}, {2, 3}, {4, 5}, {6, 7}}));
+
+    // Ядер меньше, чем клиентов: ядра делятся по кругу
+    BOOST_CHECK(LocalLauncher::split_cpus({{0, 1}}, 3) == Groups({{0}, {1}, {0}}));
+}
+
+BOOST_AUTO_TEST_CASE(NodesCoverAllowedCpus)
+{
+    Groups nodes = LocalLauncher::read_numa_nodes();
+    BOOST_REQUIRE(!nodes.empty());
+    for (const auto &node : nodes)
+    {
+        BOOST_CHECK(!node.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(RejectsZeroClients)
+{
+    BOOST_CHECK_THROW(LocalLauncher("client", 5555, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,228 @@
+#define BOOST_TEST_MODULE PrefixScanTests
+#include <boost/test/included/unit_test.hpp>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "integrator.h"
+#include "job_scheduler.h"
+#include "logger.h"
+#include "scan_output.h"
+#include "task_distributor.h"
+
+/**
+ * @file test_prefix_scan.cpp
+ * @brief Тесты заданий с таблицей первообразной: фрагментов, префиксных сумм клиента и файла таблицы
+ */
+
+namespace
+{
+    /**
+     * @brief Инициализирует логгер один раз на все тесты
+     */
+    struct LoggingFixture
+    {
+        LoggingFixture() { logging::init("test_prefix_scan", spdlog::level::warn); }
+        ~LoggingFixture() { logging::shutdown(); }
+    };
+
+    /**
+     * @brief Временный файл таблицы, удаляемый после теста
+     */
+    struct TableFile
+    {
+        explicit TableFile(const std::string &name)
+            : path((std::filesystem::temp_directory_path() / name).string())
+        {
+        }
+
+        ~TableFile()
+        {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+
+        /**
+         * @brief Читает значения таблицы
+         */
+        std::vector<double> read() const
+        {
+            std::vector<double> values(std::filesystem::file_size(path) / sizeof(double));
+            std::ifstream in(path, std::ios::binary);
+            in.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(double)));
+            return values;
+        }
+
+        std::string path;
+    };
+
+    /**
+     * @brief Точный интеграл x^2 по отрезку
+     */
+    double exact(double lower, double upper)
+    {
+        return (upper * upper * upper - lower * lower * lower) / 3.0;
+    }
+} // namespace
+
+BOOST_GLOBAL_FIXTURE(LoggingFixture);
+
+BOOST_AUTO_TEST_SUITE(PrefixScanTests)
+
+BOOST_AUTO_TEST_CASE(OffsetsAreAppliedInTableOrder)
+{
+    TableFile file("prefix_scan_offsets.bin");
+    {
+        ScanOutput output(file.path, 6);
+
+        // Фрагменты приходят не по порядку, а первый разделён прерыванием
+        BOOST_CHECK(output.write(3, {10.0, 30.0, 60.0}));
+        BOOST_CHECK(output.write(1, {2.0, 5.0}));
+        BOOST_CHECK(output.write(0, {1.0}));
+        BOOST_CHECK_EQUAL(output.get_total(), 66.0);
+
+        output.finish();
+    }
+
+    std::vector<double> expected = {0.0, 1.0, 3.0, 6.0, 16.0, 36.0, 66.0};
+    auto values = file.read();
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(GapsAreReported)
+{
+    TableFile file("prefix_scan_gaps.bin");
+    ScanOutput output(file.path, 4);
+
+    BOOST_CHECK(output.write(0, {1.0}));
+    BOOST_CHECK(output.write(2, {1.0, 2.0}));
+    BOOST_CHECK_THROW(output.finish(), std::runtime_error);
+
+    // Значения за пределами таблицы не записываются
+    BOOST_CHECK(!output.write(3, {1.0, 2.0}));
+    BOOST_CHECK(!output.write(4, {1.0}));
+    BOOST_CHECK_THROW(ScanOutput(file.path, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(ChunksEndOnTablePoints)
+{
+    ScanGrid grid;
+    grid.origin = 2.0;
+    grid.interval = 0.3;
+    const uint64_t intervals = 3 * ScanGrid::MAX_TASK_POINTS + 7;
+
+    TaskDistributor distributor;
+    auto chunks = distributor.split_scan_job(1, grid, intervals, 1.0, 1);
+
+    BOOST_REQUIRE(!chunks.empty());
+    BOOST_CHECK_EQUAL(chunks.front().begin, grid.origin);
+    BOOST_CHECK_EQUAL(chunks.back().end, grid.point(intervals));
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        BOOST_CHECK(chunks[i].is_valid());
+        BOOST_CHECK_LE(grid.index(chunks[i].end) - grid.index(chunks[i].begin), ScanGrid::MAX_TASK_POINTS);
+        if (i > 0)
+        {
+            BOOST_CHECK_EQUAL(chunks[i - 1].end, chunks[i].begin);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(IntegratorReturnsLocalPrefixSums)
+{
+    Task task;
+    task.id = 1;
+    task.kernel = KERNEL_SIMPSON;
+    task.integrand = {INTEGRAND_EXPRESSION, 0.0, expression::compile("x*x")};
+    task.grid.origin = 1.0;
+    task.grid.interval = 0.25;
+    task.begin = task.grid.point(4);
+    task.end = task.grid.point(12);
+    // Шаг больше расстояния между точками таблицы
+    task.step = 0.5;
+
+    Integrator integrator;
+    Result result = integrator.execute_task(task);
+
+    BOOST_REQUIRE(result.success);
+    BOOST_CHECK(!result.partial);
+    BOOST_REQUIRE_EQUAL(result.cumulative.size(), 8u);
+    for (size_t k = 0; k < result.cumulative.size(); ++k)
+    {
+        BOOST_CHECK_CLOSE(result.cumulative[k], exact(task.begin, task.grid.point(5 + k)), 1e-10);
+    }
+    BOOST_CHECK_EQUAL(result.value, result.cumulative.back());
+
+    // Отменённая задача останавливается на точке таблицы
+    CancellationToken token;
+    token.cancel();
+    Result cancelled = integrator.execute_task(task, token);
+    BOOST_REQUIRE(cancelled.success);
+    BOOST_CHECK(cancelled.partial);
+    BOOST_CHECK_EQUAL(cancelled.end, task.begin);
+    BOOST_CHECK(cancelled.cumulative.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SchedulerAssemblesTheTable)
+{
+    TableFile file("prefix_scan_scheduler.bin");
+
+    IntegrationParameters params{};
+    params.lower_limit = 1.0;
+    params.upper_limit = 5.0;
+    params.step = 0.001;
+    params.kernel = KERNEL_SIMPSON;
+    params.integrand = {INTEGRAND_EXPRESSION, 0.0, expression::compile("x*x")};
+    params.output_intervals = 400;
+    params.output_path = file.path;
+    BOOST_REQUIRE(params.is_valid());
+
+    ScanGrid grid;
+    grid.origin = params.lower_limit;
+    grid.interval = (params.upper_limit - params.lower_limit) / static_cast<double>(params.output_intervals);
+
+    std::optional<JobOutcome> outcome;
+    uint64_t next_task_id = 1000000;
+    JobScheduler scheduler([&outcome](const JobOutcome &result)
+                           { outcome = result; },
+                           [&next_task_id]()
+                           { return next_task_id++; });
+
+    TaskDistributor distributor;
+    scheduler.add_job(1, params, 1, 0, distributor.split_scan_job(1, grid, params.output_intervals, params.step, 1));
+
+    // Медленный клиент получает фрагменты частями по 250 шагов (25 точек таблицы)
+    Integrator integrator;
+    while (!outcome)
+    {
+        TaskBatch tasks = scheduler.take_batch(1, 4, 250);
+        BOOST_REQUIRE(!tasks.tasks.empty());
+
+        ResultBatch results;
+        results.client_id = 1;
+        for (const auto &task : tasks.tasks)
+        {
+            BOOST_CHECK(task.grid.is_point(task.begin) && task.grid.is_point(task.end));
+            results.results.push_back(integrator.execute_task(task));
+        }
+        scheduler.complete(results);
+    }
+
+    BOOST_REQUIRE(outcome->success);
+    BOOST_REQUIRE(outcome->scan);
+    outcome->scan->finish();
+    BOOST_CHECK_CLOSE(outcome->value, exact(1.0, 5.0), 1e-10);
+
+    auto values = file.read();
+    BOOST_REQUIRE_EQUAL(values.size(), params.output_intervals + 1);
+    BOOST_CHECK_EQUAL(values[0], 0.0);
+    for (uint64_t k = 1; k < values.size(); ++k)
+    {
+        BOOST_CHECK_CLOSE(values[k], exact(1.0, grid.point(k)), 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,396 @@
+#define BOOST_TEST_MODULE ProtocolNegotiationTests
+#include <boost/test/included/unit_test.hpp>
+#include <stdexcept>
+#include <string>
+
+#include "messages.h"
+#include "net_utils.h"
+#include "protocol.h"
+
+/**
+ * @file test_protocol_negotiation.cpp
+ * @brief Тесты согласования возможностей протокола и совместимости handshake разных версий
+ */
+
+namespace
+{
+    /**
+     * @brief Запрос handshake клиента, не сообщающего возможности
+     */
+    struct LegacyHandshakeRequest
+    {
+        std::string client_version;
+        SystemInfo system_info;
+        std::string integration_method;
+        uint16_t peer_port = 0;
+
+        template <class Archive>
+        void serialize(Archive &archive)
+        {
+            archive(client_version, system_info, integration_method, peer_port);
+        }
+    };
+
+    /**
+     * @brief Ответ сервера, не согласующего протокол
+     */
+    struct LegacyHandshakeResponse
+    {
+        uint64_t assigned_client_id = 0;
+        std::string server_version;
+        bool accepted = true;
+        std::string message;
+
+        template <class Archive>
+        void serialize(Archive &archive)
+        {
+            archive(assigned_client_id, server_version, accepted, message);
+        }
+    };
+
+    /**
+     * @brief Пакет задач сервера, не передающего методы задач
+     */
+    struct LegacyTaskBatch
+    {
+        std::vector<Task> tasks;
+
+        template <class Archive>
+        void serialize(Archive &archive)
+        {
+            archive(tasks);
+        }
+    };
+
+    /**
+     * @brief Сериализует сообщение одного типа и читает его как сообщение другого
+     */
+    template <typename To, typename From>
+    To reinterpret_message(const From &message)
+    {
+        std::string frame = net_utils::make_frame(message);
+        return net_utils::parse_payload<To>(frame.substr(sizeof(uint32_t)));
+    }
+
+    ProtocolCapabilities server_capabilities()
+    {
+        ProtocolCapabilities capabilities = protocol::local_capabilities();
+        capabilities.max_in_flight = 2;
+        return capabilities;
+    }
+} // namespace
+
+// Выбор параметров соединения
+BOOST_AUTO_TEST_SUITE(NegotiationTests)
+
+/**
+ * @brief Стороны одной версии включают все общие возможности
+ */
+BOOST_AUTO_TEST_CASE(SameVersionEnablesEverything)
+{
+    auto settings = protocol::negotiate(server_capabilities(), protocol::local_capabilities());
+
+    BOOST_CHECK_EQUAL(settings.protocol_version, protocol::CURRENT_VERSION);
+    BOOST_CHECK_EQUAL(settings.features, protocol::local_capabilities().features);
+    BOOST_CHECK_EQUAL(settings.wire_format, static_cast<uint32_t>(WIRE_CEREAL_BINARY));
+    BOOST_CHECK_EQUAL(settings.max_in_flight, 2u);
+    BOOST_CHECK_EQUAL(settings.max_batch_tasks, 0u);
+}
+
+/**
+ * @brief Ограничения и наборы возможностей клиента сужают параметры
+ */
+BOOST_AUTO_TEST_CASE(ClientLimitsAreRespected)
+{
+    ProtocolCapabilities client = protocol::local_capabilities();
+    client.features &= ~static_cast<uint64_t>(CAP_WORK_STEALING);
+    client.kernels = KERNEL_SIMPSON;
+    client.max_batch_tasks = 8;
+    client.max_in_flight = 1;
+
+    auto settings = protocol::negotiate(server_capabilities(), client);
+
+    BOOST_CHECK(!protocol::has_feature(settings, CAP_WORK_STEALING));
+    BOOST_CHECK(protocol::has_feature(settings, CAP_CANCEL_JOB));
+    BOOST_CHECK_EQUAL(settings.kernels, static_cast<uint32_t>(KERNEL_SIMPSON));
+    BOOST_CHECK_EQUAL(settings.max_batch_tasks, 8u);
+    BOOST_CHECK_EQUAL(settings.max_in_flight, 1u);
+}
+
+/**
+ * @brief Клиент без выбора метода по задаче получает только задания методом Симпсона
+ */
+BOOST_AUTO_TEST_CASE(KernelsRequireTaskKernelFeature)
+{
+    ProtocolCapabilities client = protocol::local_capabilities();
+    client.features &= ~static_cast<uint64_t>(CAP_TASK_KERNEL);
+
+    auto settings = protocol::negotiate(server_capabilities(), client);
+    BOOST_CHECK_EQUAL(settings.kernels, static_cast<uint32_t>(KERNEL_SIMPSON));
+
+    auto full = protocol::negotiate(server_capabilities(), protocol::local_capabilities());
+    BOOST_CHECK_EQUAL(full.kernels, static_cast<uint32_t>(KERNEL_TRAPEZOIDAL | KERNEL_SIMPSON | KERNEL_QMC));
+}
+
+/**
+ * @brief Функции - пересечение наборов, а сторона без набора считает только 1/ln(x)
+ */
+BOOST_AUTO_TEST_CASE(IntegrandsAreNegotiated)
+{
+    auto full = protocol::negotiate(server_capabilities(), protocol::local_capabilities());
+    BOOST_CHECK_EQUAL(full.integrands, integrands::all_bits());
+
+    ProtocolCapabilities client = protocol::local_capabilities();
+    client.integrands = integrand_bit(INTEGRAND_INV_LOG) | integrand_bit(INTEGRAND_EXP_OVER_LOG);
+    auto narrowed = protocol::negotiate(server_capabilities(), client);
+    BOOST_CHECK_EQUAL(narrowed.integrands, client.integrands);
+
+    client.integrands = 0;
+    auto unreported = protocol::negotiate(server_capabilities(), client);
+    BOOST_CHECK_EQUAL(unreported.integrands, integrand_bit(INTEGRAND_INV_LOG));
+}
+
+/**
+ * @brief Без общего формата передачи соединение невозможно
+ */
+BOOST_AUTO_TEST_CASE(NoCommonWireFormatThrows)
+{
+    ProtocolCapabilities client = protocol::local_capabilities();
+    client.wire_formats = 1u << 31;
+
+    BOOST_CHECK_THROW(protocol::negotiate(server_capabilities(), client), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Совместимость с клиентами и серверами без согласования
+BOOST_AUTO_TEST_SUITE(MixedVersionTests)
+
+/**
+ * @brief Запрос старого клиента читается, клиент получает возможности старой версии
+ */
+BOOST_AUTO_TEST_CASE(LegacyClientRequestIsAccepted)
+{
+    LegacyHandshakeRequest legacy;
+    legacy.client_version = "1.0.0";
+    legacy.integration_method = "Simpson's rule";
+    legacy.peer_port = 4242;
+
+    auto request = reinterpret_message<HandshakeRequest>(legacy);
+    BOOST_CHECK_EQUAL(request.peer_port, 4242);
+    BOOST_CHECK_EQUAL(request.capabilities.protocol_version, 0u);
+
+    auto settings = protocol::negotiate(server_capabilities(), request.capabilities);
+    BOOST_CHECK_EQUAL(settings.protocol_version, 0u);
+    BOOST_CHECK_EQUAL(settings.features, protocol::legacy_capabilities().features);
+    BOOST_CHECK_EQUAL(settings.max_in_flight, 2u);
+}
+
+/**
+ * @brief Старый клиент читает ответ нового сервера, не замечая новых полей
+ */
+BOOST_AUTO_TEST_CASE(LegacyClientReadsNewResponse)
+{
+    HandshakeResponse response;
+    response.assigned_client_id = 7;
+    response.message = "Connection accepted";
+    response.protocol = protocol::negotiate(server_capabilities(), protocol::local_capabilities());
+
+    auto legacy = reinterpret_message<LegacyHandshakeResponse>(response);
+    BOOST_CHECK_EQUAL(legacy.assigned_client_id, 7u);
+    BOOST_CHECK(legacy.accepted);
+    BOOST_CHECK_EQUAL(legacy.message, "Connection accepted");
+}
+
+/**
+ * @brief Новый клиент читает ответ старого сервера и видит, что протокол не согласован
+ */
+BOOST_AUTO_TEST_CASE(NewClientReadsLegacyResponse)
+{
+    LegacyHandshakeResponse legacy;
+    legacy.assigned_client_id = 9;
+    legacy.message = "Connection accepted";
+
+    auto response = reinterpret_message<HandshakeResponse>(legacy);
+    BOOST_CHECK_EQUAL(response.assigned_client_id, 9u);
+    BOOST_CHECK_EQUAL(response.retry_after_ms, 0u);
+    BOOST_CHECK_EQUAL(response.protocol.protocol_version, 0u);
+
+    auto settings = protocol::legacy_settings(protocol::local_capabilities());
+    BOOST_CHECK(protocol::has_feature(settings, CAP_WORK_STEALING));
+    BOOST_CHECK_EQUAL(settings.max_in_flight, 2u);
+}
+
+/**
+ * @brief Новые поля сохраняются при обмене между новыми версиями
+ */
+BOOST_AUTO_TEST_CASE(CapabilitiesRoundTrip)
+{
+    HandshakeRequest request;
+    request.capabilities = protocol::local_capabilities();
+    request.capabilities.max_batch_tasks = 16;
+
+    auto parsed = reinterpret_message<HandshakeRequest>(request);
+    BOOST_CHECK_EQUAL(parsed.capabilities.protocol_version, protocol::CURRENT_VERSION);
+    BOOST_CHECK_EQUAL(parsed.capabilities.features, request.capabilities.features);
+    BOOST_CHECK_EQUAL(parsed.capabilities.max_batch_tasks, 16u);
+}
+
+/**
+ * @brief Методы задач передаются в пакете, а пакет без них оставляет метод по умолчанию
+ */
+BOOST_AUTO_TEST_CASE(TaskKernelsRoundTrip)
+{
+    TaskBatch batch;
+    batch.tasks.resize(3);
+    batch.tasks[0].kernel = KERNEL_SIMPSON;
+    batch.tasks[1].kernel = KERNEL_TRAPEZOIDAL;
+
+    auto parsed = reinterpret_message<TaskBatch>(batch);
+    BOOST_REQUIRE_EQUAL(parsed.tasks.size(), 3u);
+    BOOST_CHECK_EQUAL(parsed.tasks[0].kernel, static_cast<uint32_t>(KERNEL_SIMPSON));
+    BOOST_CHECK_EQUAL(parsed.tasks[1].kernel, static_cast<uint32_t>(KERNEL_TRAPEZOIDAL));
+    BOOST_CHECK_EQUAL(parsed.tasks[2].kernel, 0u);
+
+    LegacyTaskBatch legacy;
+    legacy.tasks.resize(2);
+
+    auto from_legacy = reinterpret_message<TaskBatch>(legacy);
+    BOOST_REQUIRE_EQUAL(from_legacy.tasks.size(), 2u);
+    BOOST_CHECK_EQUAL(from_legacy.tasks[0].kernel, 0u);
+    BOOST_CHECK_EQUAL(from_legacy.tasks[0].integrand.id, static_cast<uint32_t>(INTEGRAND_INV_LOG));
+}
+
+/**
+ * @brief Функции задач передаются в пакете вместе с параметрами и байткодом выражений
+ */
+BOOST_AUTO_TEST_CASE(TaskIntegrandsRoundTrip)
+{
+    TaskBatch batch;
+    batch.tasks.resize(2);
+    batch.tasks[0].integrand = {INTEGRAND_INV_LOG_POW, 2.5, {}};
+    batch.tasks[1].integrand = {INTEGRAND_EXPRESSION, 0.0, expression::compile("exp(-x)/log(x)^2")};
+    batch.tasks[1].begin = 2.0;
+    batch.tasks[1].end = 3.0;
+    batch.tasks[1].step = 0.01;
+
+    auto parsed = reinterpret_message<TaskBatch>(batch);
+    BOOST_REQUIRE_EQUAL(parsed.tasks.size(), 2u);
+    BOOST_CHECK_EQUAL(parsed.tasks[0].integrand.id, static_cast<uint32_t>(INTEGRAND_INV_LOG_POW));
+    BOOST_CHECK_EQUAL(parsed.tasks[0].integrand.parameter, 2.5);
+    BOOST_CHECK_EQUAL(parsed.tasks[1].integrand.id, static_cast<uint32_t>(INTEGRAND_EXPRESSION));
+    BOOST_CHECK(parsed.tasks[0].integrand.expression.empty());
+    BOOST_CHECK_EQUAL(parsed.tasks[1].integrand.expression.source, "exp(-x)/log(x)^2");
+    BOOST_CHECK(parsed.tasks[1].integrand.expression.code == batch.tasks[1].integrand.expression.code);
+    BOOST_CHECK(parsed.tasks[1].is_valid());
+}
+
+/**
+ * @brief Области задач квази-Монте-Карло и суммы квадратов результатов передаются в пакетах
+ */
+BOOST_AUTO_TEST_CASE(QmcTaskRoundTrip)
+{
+    TaskBatch batch;
+    batch.tasks.resize(1);
+    batch.tasks[0].kernel = KERNEL_QMC;
+    batch.tasks[0].begin = 4096.0;
+    batch.tasks[0].end = 8192.0;
+    batch.tasks[0].step = 1.0;
+    batch.tasks[0].integrand = {INTEGRAND_EXPRESSION, 0.0, expression::compile("x1*x2")};
+    batch.tasks[0].sampling.lower = {0.0, -1.0};
+    batch.tasks[0].sampling.upper = {1.0, 1.0};
+    batch.tasks[0].sampling.seed = 77;
+    batch.tasks[0].sampling.replica = 3;
+
+    auto parsed = reinterpret_message<TaskBatch>(batch);
+    BOOST_REQUIRE_EQUAL(parsed.tasks.size(), 1u);
+    BOOST_CHECK_EQUAL(parsed.tasks[0].kernel, static_cast<uint32_t>(KERNEL_QMC));
+    BOOST_CHECK(parsed.tasks[0].sampling.lower == batch.tasks[0].sampling.lower);
+    BOOST_CHECK(parsed.tasks[0].sampling.upper == batch.tasks[0].sampling.upper);
+    BOOST_CHECK_EQUAL(parsed.tasks[0].sampling.seed, 77u);
+    BOOST_CHECK_EQUAL(parsed.tasks[0].sampling.replica, 3u);
+    BOOST_CHECK(parsed.tasks[0].is_valid());
+
+    // Номера точек должны быть целыми
+    parsed.tasks[0].end = 8192.5;
+    BOOST_CHECK(!parsed.tasks[0].is_valid());
+
+    ResultBatch results;
+    results.results.resize(2);
+    results.results[0].value = 1.5;
+    results.results[0].sum_squares = 2.25;
+    results.results[1].sum_squares = 7.0;
+
+    auto parsed_results = reinterpret_message<ResultBatch>(results);
+    BOOST_REQUIRE_EQUAL(parsed_results.results.size(), 2u);
+    BOOST_CHECK_EQUAL(parsed_results.results[0].sum_squares, 2.25);
+    BOOST_CHECK_EQUAL(parsed_results.results[1].sum_squares, 7.0);
+}
+
+/**
+ * @brief Таблицы задач и значения таблиц результатов передаются в пакетах
+ */
+BOOST_AUTO_TEST_CASE(ScanTaskRoundTrip)
+{
+    TaskBatch batch;
+    batch.tasks.resize(2);
+    batch.tasks[1].grid.origin = 2.0;
+    batch.tasks[1].grid.interval = 0.5;
+    batch.tasks[1].begin = batch.tasks[1].grid.point(2);
+    batch.tasks[1].end = batch.tasks[1].grid.point(10);
+    batch.tasks[1].step = 0.01;
+
+    auto parsed = reinterpret_message<TaskBatch>(batch);
+    BOOST_REQUIRE_EQUAL(parsed.tasks.size(), 2u);
+    BOOST_CHECK(!parsed.tasks[0].grid.is_active());
+    BOOST_CHECK_EQUAL(parsed.tasks[1].grid.origin, 2.0);
+    BOOST_CHECK_EQUAL(parsed.tasks[1].grid.interval, 0.5);
+    BOOST_CHECK(parsed.tasks[1].is_valid());
+
+    // Границы задачи с таблицей должны быть точками таблицы
+    parsed.tasks[1].end = 6.25;
+    BOOST_CHECK(!parsed.tasks[1].is_valid());
+
+    ResultBatch results;
+    results.results.resize(2);
+    results.results[0].cumulative = {1.0, 2.5, 4.0};
+
+    auto parsed_results = reinterpret_message<ResultBatch>(results);
+    BOOST_REQUIRE_EQUAL(parsed_results.results.size(), 2u);
+    BOOST_CHECK(parsed_results.results[0].cumulative == results.results[0].cumulative);
+    BOOST_CHECK(parsed_results.results[1].cumulative.empty());
+}
+
+/**
+ * @brief Возможности без набора функций (версия 1 до их появления) читаются полностью
+ */
+BOOST_AUTO_TEST_CASE(CapabilitiesWithoutIntegrands)
+{
+    struct CapabilitiesV1
+    {
+        uint32_t protocol_version = 1;
+        uint64_t features = CAP_CANCEL_JOB | CAP_TASK_KERNEL;
+        uint32_t wire_formats = WIRE_CEREAL_BINARY;
+        uint32_t reduction_modes = REDUCTION_PLAIN;
+        uint32_t kernels = KERNEL_TRAPEZOIDAL;
+        uint32_t max_batch_tasks = 4;
+        uint32_t max_in_flight = 1;
+    } v1;
+
+    LegacyHandshakeRequest legacy;
+    std::string frame = net_utils::make_frame(legacy);
+    frame += std::string(reinterpret_cast<const char *>(&v1.protocol_version), sizeof(v1.protocol_version));
+    frame += std::string(reinterpret_cast<const char *>(&v1.features), sizeof(v1.features));
+    for (uint32_t field : {v1.wire_formats, v1.reduction_modes, v1.kernels, v1.max_batch_tasks, v1.max_in_flight})
+    {
+        frame += std::string(reinterpret_cast<const char *>(&field), sizeof(field));
+    }
+
+    auto request = net_utils::parse_payload<HandshakeRequest>(frame.substr(sizeof(uint32_t)));
+    BOOST_CHECK_EQUAL(request.capabilities.protocol_version, 1u);
+    BOOST_CHECK_EQUAL(request.capabilities.kernels, static_cast<uint32_t>(KERNEL_TRAPEZOIDAL));
+    BOOST_CHECK_EQUAL(request.capabilities.max_batch_tasks, 4u);
+    BOOST_CHECK_EQUAL(request.capabilities.integrands, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
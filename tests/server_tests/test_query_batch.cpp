@@ -0,0 +1,205 @@
+#define BOOST_TEST_MODULE QueryBatchTests
+#include <boost/test/included/unit_test.hpp>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "job_scheduler.h"
+#include "logger.h"
+#include "query_batch.h"
+#include "task_distributor.h"
+
+/**
+ * @file test_query_batch.cpp
+ * @brief Тесты пакетных заданий: разбиения запросов на отрезки и сборки ответов
+ */
+
+namespace
+{
+    /**
+     * @brief Инициализирует логгер один раз на все тесты
+     */
+    struct LoggingFixture
+    {
+        LoggingFixture() { logging::init("test_query_batch", spdlog::level::warn); }
+        ~LoggingFixture() { logging::shutdown(); }
+    };
+
+    /**
+     * @brief Первообразная функции f(x) = x^2
+     */
+    double antiderivative(double x)
+    {
+        return x * x * x / 3.0;
+    }
+
+    /**
+     * @brief Точный интеграл x^2 по отрезку
+     */
+    double exact(double lower, double upper)
+    {
+        return antiderivative(upper) - antiderivative(lower);
+    }
+} // namespace
+
+BOOST_GLOBAL_FIXTURE(LoggingFixture);
+
+BOOST_AUTO_TEST_SUITE(QueryBatchTests)
+
+BOOST_AUTO_TEST_CASE(SegmentsCoverTheUnionOnly)
+{
+    // Перекрывающиеся запросы и разрыв [5, 7]
+    QueryBatch batch({{2.0, 4.0}, {3.0, 5.0}, {7.0, 8.0}, {3.0, 4.0}});
+
+    const auto &segments = batch.get_segments();
+    BOOST_REQUIRE_EQUAL(segments.size(), 4u);
+    BOOST_CHECK_EQUAL(segments[0].lower, 2.0);
+    BOOST_CHECK_EQUAL(segments[0].upper, 3.0);
+    BOOST_CHECK_EQUAL(segments[1].lower, 3.0);
+    BOOST_CHECK_EQUAL(segments[1].upper, 4.0);
+    BOOST_CHECK_EQUAL(segments[2].lower, 4.0);
+    BOOST_CHECK_EQUAL(segments[2].upper, 5.0);
+    BOOST_CHECK_EQUAL(segments[3].lower, 7.0);
+    BOOST_CHECK_EQUAL(segments[3].upper, 8.0);
+
+    // Стоимость - длина объединения, а не сумма длин запросов
+    BOOST_CHECK_CLOSE(batch.get_covered_length(), 4.0, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(AnswersAreSumsOfSegments)
+{
+    std::vector<QueryRange> queries = {{2.0, 4.0}, {3.0, 5.0}, {7.0, 8.0}, {3.0, 4.0}, {2.0, 4.5}};
+    QueryBatch batch(queries);
+
+    // Каждый отрезок приходит двумя половинами в обратном порядке
+    const auto segments = batch.get_segments();
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it)
+    {
+        double middle = 0.5 * (it->lower + it->upper);
+        BOOST_CHECK(batch.add(middle, exact(middle, it->upper)));
+        BOOST_CHECK(batch.add(it->lower, exact(it->lower, middle)));
+    }
+
+    auto answers = batch.get_answers();
+    BOOST_REQUIRE_EQUAL(answers.size(), queries.size());
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        BOOST_CHECK_CLOSE(answers[i], exact(queries[i].lower, queries[i].upper), 1e-12);
+    }
+    BOOST_CHECK_CLOSE(batch.get_total(), exact(2.0, 5.0) + exact(7.0, 8.0), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(RejectsResultsOutsideSegments)
+{
+    QueryBatch batch({{2.0, 3.0}, {4.0, 5.0}});
+
+    BOOST_CHECK(!batch.add(1.0, 1.0));
+    BOOST_CHECK(!batch.add(3.5, 1.0));
+    BOOST_CHECK(!batch.add(5.0, 1.0));
+    BOOST_CHECK_EQUAL(batch.get_total(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(RejectsInvalidQueries)
+{
+    BOOST_CHECK_THROW(QueryBatch({}), std::invalid_argument);
+    BOOST_CHECK_THROW(QueryBatch({{3.0, 3.0}}), std::invalid_argument);
+    BOOST_CHECK_THROW(QueryBatch({{2.0, 3.0}, {5.0, 4.0}}), std::invalid_argument);
+    BOOST_CHECK_THROW(QueryBatch(std::vector<QueryRange>(QueryBatch::MAX_QUERIES + 1, {2.0, 3.0})),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(ChunksStayInsideSegments)
+{
+    QueryBatch batch({{2.0, 1000.0}, {500.0, 500.0005}, {1500.0, 1600.0}});
+    TaskDistributor distributor;
+    auto chunks = distributor.split_batch_job(1, batch.get_segments(), 0.001, 16);
+
+    // Фрагменты покрывают отрезки подряд и не пересекают их границы
+    size_t chunk = 0;
+    for (const auto &segment : batch.get_segments())
+    {
+        BOOST_REQUIRE_LT(chunk, chunks.size());
+        BOOST_CHECK_EQUAL(chunks[chunk].begin, segment.lower);
+        while (chunk < chunks.size() && chunks[chunk].end < segment.upper)
+        {
+            BOOST_CHECK_EQUAL(chunks[chunk].end, chunks[chunk + 1].begin);
+            ++chunk;
+        }
+        BOOST_REQUIRE_LT(chunk, chunks.size());
+        BOOST_CHECK_EQUAL(chunks[chunk].end, segment.upper);
+        ++chunk;
+    }
+    BOOST_CHECK_EQUAL(chunk, chunks.size());
+
+    // Отрезок короче шага получает один фрагмент с уменьшенным шагом
+    for (const auto &task : chunks)
+    {
+        BOOST_CHECK(task.step < task.end - task.begin);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SchedulerAnswersQueriesFromOneSweep)
+{
+    std::vector<QueryRange> queries;
+    for (int i = 0; i < 50; ++i)
+    {
+        queries.push_back({2.0 + i, 60.0 + 0.5 * i});
+    }
+
+    std::optional<JobOutcome> outcome;
+    uint64_t next_task_id = 1000000;
+    JobScheduler scheduler([&outcome](const JobOutcome &result)
+                           { outcome = result; },
+                           [&next_task_id]()
+                           { return next_task_id++; });
+
+    IntegrationParameters params{};
+    params.queries = queries;
+    params.lower_limit = 2.0;
+    params.upper_limit = 84.5;
+    params.step = 0.01;
+
+    QueryBatch batch(queries);
+    TaskDistributor distributor;
+    scheduler.add_job(1, params, 1, 0, distributor.split_batch_job(1, batch.get_segments(), params.step, 4));
+
+    // "Клиент" прерывает каждый фрагмент на середине и досчитывает остаток следующим пакетом
+    size_t evaluated_tasks = 0;
+    while (!outcome)
+    {
+        TaskBatch tasks = scheduler.take_batch(1, 8, 1000);
+        BOOST_REQUIRE(!tasks.tasks.empty());
+
+        ResultBatch results;
+        results.client_id = 1;
+        for (const auto &task : tasks.tasks)
+        {
+            Result result;
+            result.task_id = task.id;
+            result.job_id = task.job_id;
+            result.success = true;
+            result.end = task.end;
+            if (task.end - task.begin > 1.0)
+            {
+                result.partial = true;
+                result.end = task.begin + 0.5 * (task.end - task.begin);
+            }
+            result.value = exact(task.begin, result.end);
+            results.results.push_back(result);
+            ++evaluated_tasks;
+        }
+        scheduler.complete(results);
+    }
+
+    BOOST_REQUIRE(outcome->success);
+    BOOST_REQUIRE_EQUAL(outcome->query_results.size(), queries.size());
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        BOOST_CHECK_CLOSE(outcome->query_results[i], exact(queries[i].lower, queries[i].upper), 1e-10);
+    }
+    BOOST_CHECK_CLOSE(outcome->value, exact(2.0, 84.5), 1e-10);
+    BOOST_CHECK_GT(evaluated_tasks, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,210 @@
+#define BOOST_TEST_MODULE ServerShutdownTests
+#include <boost/test/included/unit_test.hpp>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "logger.h"
+#include "net_utils.h"
+#include "server.h"
+#include "utils.h"
+
+/**
+ * @file test_server_shutdown.cpp
+ * @brief Тесты скорости и полноты остановки сервера
+ */
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+namespace
+{
+    // Допустимое время остановки сервера
+    const auto MAX_TEARDOWN = std::chrono::milliseconds(100);
+
+    /**
+     * @brief Инициализирует логгер один раз на все тесты
+     */
+    struct LoggingFixture
+    {
+        LoggingFixture() { logging::init("test_server_shutdown", spdlog::level::warn); }
+        ~LoggingFixture() { logging::shutdown(); }
+    };
+
+    /**
+     * @brief Сервер в режиме сервиса, работающий в отдельном потоке
+     */
+    struct ServiceUnderTest
+    {
+        explicit ServiceUnderTest(uint16_t port)
+            : port(port),
+              socket_path((std::filesystem::temp_directory_path() /
+                           ("server_shutdown_" + std::to_string(port) + ".sock"))
+                              .string())
+        {
+            ServerConfig config;
+            config.profiles_path.clear();
+            server = std::make_unique<Server>(port, config);
+
+            thread = std::thread([this]()
+                                 { server->serve(socket_path); });
+
+            // Управляющий сокет открывается после начала приёма клиентов
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!std::filesystem::exists(socket_path) && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            BOOST_REQUIRE(std::filesystem::exists(socket_path));
+        }
+
+        ~ServiceUnderTest()
+        {
+            server->stop();
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+
+        /**
+         * @brief Останавливает сервер и возвращает время остановки
+         */
+        std::chrono::milliseconds stop()
+        {
+            auto start = std::chrono::steady_clock::now();
+            server->stop();
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            thread.join();
+            return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+        }
+
+        uint16_t port;
+        std::string socket_path;
+        std::unique_ptr<Server> server;
+        std::thread thread;
+    };
+
+    /**
+     * @brief Подключает клиента и выполняет handshake
+     * @return Сокет зарегистрированного клиента
+     */
+    std::unique_ptr<tcp::socket> connect_client(boost::asio::io_context &io_context, uint16_t port)
+    {
+        auto socket = std::make_unique<tcp::socket>(io_context);
+        socket->connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+
+        HandshakeRequest request;
+        request.client_version = "test";
+        request.system_info = sys_utils::collect_system_info();
+        net_utils::send_data(*socket, request);
+
+        auto response = net_utils::receive_data<HandshakeResponse>(*socket);
+        BOOST_REQUIRE(response.accepted);
+
+        // Команда PEERS приходит после регистрации клиента
+        auto peers = net_utils::receive_data<Command>(*socket);
+        BOOST_REQUIRE(peers.type == CommandType::PEERS);
+
+        return socket;
+    }
+
+    /**
+     * @brief Читает команды клиента до STOP_WORK
+     * @return true, если STOP_WORK получена
+     */
+    bool receive_stop(tcp::socket &socket)
+    {
+        try
+        {
+            while (true)
+            {
+                auto cmd = net_utils::receive_data<Command>(socket);
+                if (cmd.type == CommandType::STOP_WORK)
+                {
+                    return true;
+                }
+            }
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+    }
+} // namespace
+
+BOOST_GLOBAL_FIXTURE(LoggingFixture);
+
+// Остановка сервера
+BOOST_AUTO_TEST_SUITE(TeardownTests)
+
+/**
+ * @brief Остановка сервера без клиентов
+ */
+BOOST_AUTO_TEST_CASE(IdleServerStopsQuickly)
+{
+    ServiceUnderTest service(15561);
+
+    auto elapsed = service.stop();
+    BOOST_TEST_MESSAGE("Idle teardown: " << elapsed.count() << " ms");
+    BOOST_CHECK(elapsed < MAX_TEARDOWN);
+}
+
+/**
+ * @brief Остановка сервера с подключенными простаивающими клиентами
+ */
+BOOST_AUTO_TEST_CASE(ServerWithClientsStopsQuickly)
+{
+    ServiceUnderTest service(15562);
+
+    boost::asio::io_context io_context;
+    std::vector<std::unique_ptr<tcp::socket>> clients;
+    for (int i = 0; i < 4; ++i)
+    {
+        clients.push_back(connect_client(io_context, service.port));
+    }
+
+    auto elapsed = service.stop();
+    BOOST_TEST_MESSAGE("Teardown with " << clients.size() << " clients: " << elapsed.count() << " ms");
+    BOOST_CHECK(elapsed < MAX_TEARDOWN);
+
+    // Каждый клиент получает STOP_WORK до завершения stop()
+    for (auto &client : clients)
+    {
+        BOOST_CHECK(receive_stop(*client));
+    }
+}
+
+/**
+ * @brief Порт освобождается сразу: потоки приёма не переживают сервер
+ */
+BOOST_AUTO_TEST_CASE(PortIsReusableAfterStop)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        ServiceUnderTest service(15563);
+        auto elapsed = service.stop();
+        BOOST_CHECK(elapsed < MAX_TEARDOWN);
+    }
+
+    // После остановки подключения к порту отклоняются
+    boost::asio::io_context io_context;
+    tcp::socket socket(io_context);
+    boost::system::error_code ec;
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), 15563), ec);
+    BOOST_CHECK(ec);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#else
+
+BOOST_AUTO_TEST_CASE(LocalSocketsUnsupported)
+{
+    BOOST_TEST_MESSAGE("Control sockets are not supported on this platform, skipping");
+}
+
+#endif